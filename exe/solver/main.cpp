@@ -42,6 +42,7 @@
 #include "solver/calib_solver_io.h"
 #include "calib/calib_param_manager.h"
 #include "calib/calib_data_manager.h"
+#include "util/profiler.h"
 #include "filesystem"
 
 namespace {
@@ -87,12 +88,18 @@ int main(int argc, char **argv) {
 
         // create data manager
         auto dataMagr = ns_ikalibr::CalibDataManager::Create();
-        dataMagr->LoadCalibData();
+        {
+            ns_ikalibr::Profiler::Scope profile("LoadCalibData");
+            dataMagr->LoadCalibData();
+        }
 
         // pass parameter manager and data manager to solver for solving
         auto solver = ns_ikalibr::CalibSolver::Create(dataMagr, paramMagr);
         // the calibration results are stored in 'paramMagr'
-        solver->Process();
+        {
+            ns_ikalibr::Profiler::Scope profile("Process");
+            solver->Process();
+        }
 
         // solve finished, save calibration results (file type: JSON | YAML | XML | BINARY)
         const auto filename = ns_ikalibr::Configor::DataStream::OutputPath + "/ikalibr_param" +
@@ -100,7 +107,17 @@ int main(int argc, char **argv) {
         paramMagr->Save(filename, ns_ikalibr::Configor::Preference::OutputDataFormat);
 
         // save the by-products from the spatiotemporal calibration to the disk
-        ns_ikalibr::CalibSolverIO::Create(solver)->SaveByProductsToDisk();
+        {
+            ns_ikalibr::Profiler::Scope profile("SaveByProductsToDisk");
+            ns_ikalibr::CalibSolverIO::Create(solver)->SaveByProductsToDisk();
+        }
+
+        // time and memory consumption of stages in the calibration
+        if (ns_ikalibr::IsOptionWith(ns_ikalibr::OutputOption::ProfileReport,
+                                     ns_ikalibr::Configor::Preference::Outputs)) {
+            ns_ikalibr::Profiler::SaveReport(ns_ikalibr::Configor::DataStream::OutputPath +
+                                             "/profile");
+        }
 
         static constexpr auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
         spdlog::info(
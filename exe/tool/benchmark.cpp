@@ -0,0 +1,431 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "ros/ros.h"
+#include "spdlog/spdlog.h"
+#include "config/configor.h"
+#include "util/status.hpp"
+#include "util/utils_tpl.hpp"
+#include "util/profiler.h"
+#include "solver/calib_solver.h"
+#include "spdlog/fmt/bundled/color.h"
+#include "calib/calib_param_manager.h"
+#include "calib/calib_data_manager.h"
+#include "calib/estimator.h"
+#include "calib/estimator_tpl.hpp"
+#include "calib/synthetic_data_generator.h"
+#include "core/event_preprocessing.h"
+#include "core/visual_reproj_association.h"
+#include "factor/data_correspondence.h"
+#include "filesystem"
+#include "functional"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsFrom(const Clock::time_point &start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// perturb the spatiotemporal parameters (except the ones of the reference IMU) as the ground truth
+void PerturbSpatTempParams(const CalibParamManager::Ptr &parMagr, std::uint32_t seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<double> angDist(-0.2, 0.2);  // rad
+    std::uniform_real_distribution<double> posDist(-0.2, 0.2);  // m
+    std::uniform_real_distribution<double> toDist(-0.02, 0.02);  // s
+    auto RandVec3 = [&engine](std::uniform_real_distribution<double> &dist) {
+        Eigen::Vector3d vec;
+        // the evaluation order of the arguments is unspecified, so we assign them one by one
+        for (int i = 0; i < 3; ++i) {
+            vec(i) = dist(engine);
+        }
+        return vec;
+    };
+    auto Perturb = [&](auto &so3Map, auto &posMap, auto &toMap) {
+        for (auto &[topic, so3] : so3Map) {
+            if (topic == Configor::DataStream::ReferIMU) {
+                continue;
+            }
+            so3 = Sophus::SO3d::exp(RandVec3(angDist));
+            posMap.at(topic) = RandVec3(posDist);
+            if (Configor::Prior::OptTemporalParams) {
+                toMap.at(topic) = toDist(engine);
+            }
+        }
+    };
+    auto &EXTRI = parMagr->EXTRI;
+    auto &TEMPORAL = parMagr->TEMPORAL;
+    Perturb(EXTRI.SO3_BiToBr, EXTRI.POS_BiInBr, TEMPORAL.TO_BiToBr);
+    Perturb(EXTRI.SO3_RjToBr, EXTRI.POS_RjInBr, TEMPORAL.TO_RjToBr);
+    Perturb(EXTRI.SO3_LkToBr, EXTRI.POS_LkInBr, TEMPORAL.TO_LkToBr);
+    Perturb(EXTRI.SO3_CmToBr, EXTRI.POS_CmInBr, TEMPORAL.TO_CmToBr);
+    Perturb(EXTRI.SO3_EsToBr, EXTRI.POS_EsInBr, TEMPORAL.TO_EsToBr);
+}
+
+/**
+ * build factors on the ground truth using 'addFactors', and evaluate the residuals and jacobians of
+ * the problem for several times, the throughput is recorded in the profiler
+ */
+void BenchmarkFactors(const std::string &name,
+                      const SyntheticDataGenerator::Ptr &generator,
+                      const CalibParamManager::Ptr &truth,
+                      const std::function<void(const Estimator::Ptr &)> &addFactors) {
+    constexpr int EvalRepeat = 5;
+    Profiler::Scope profile("Benchmark::" + name);
+
+    auto estimator = Estimator::Create(generator->GetSplines(), truth);
+    auto start = Clock::now();
+    addFactors(estimator);
+    const double buildTime = SecondsFrom(start);
+
+    const int blockNum = estimator->NumResidualBlocks();
+    if (blockNum == 0) {
+        spdlog::warn("no factor is involved in benchmark '{}'!", name);
+        return;
+    }
+
+    ceres::Problem::EvaluateOptions options;
+    options.num_threads = Configor::Preference::AvailableThreads();
+    double cost = 0.0;
+    std::vector<double> residuals, gradient;
+    ceres::CRSMatrix jacobian;
+    start = Clock::now();
+    for (int i = 0; i < EvalRepeat; ++i) {
+        estimator->Evaluate(options, &cost, &residuals, &gradient, &jacobian);
+    }
+    const double evalTime = SecondsFrom(start) / EvalRepeat;
+
+    profile.AddMetric("residual_blocks", blockNum)
+        .AddMetric("residuals", estimator->NumResiduals())
+        .AddMetric("build/blocks_per_sec", blockNum / buildTime)
+        .AddMetric("evaluate/blocks_per_sec", blockNum / evalTime)
+        .AddMetric("evaluate/residuals_per_sec", estimator->NumResiduals() / evalTime)
+        // the cost on the ground truth, which should be small for the synthetic data
+        .AddMetric("cost", cost);
+    spdlog::info(
+        "benchmark '{}': residual blocks: {}, build: {:.1f} (blocks/s), evaluate: {:.1f} "
+        "(blocks/s), cost on the ground truth: {:.3e}",
+        name, blockNum, blockNum / buildTime, blockNum / evalTime, cost);
+}
+
+// grab events into the active event surface and extract normal flows from it
+void BenchmarkEventSurface(const std::string &topic,
+                           const std::vector<EventArray::Ptr> &arrays,
+                           const CalibParamManager::Ptr &truth) {
+    Profiler::Scope profile("Benchmark::EventSurface");
+
+    auto sea = ActiveEventSurface::Create(truth->INTRI.Camera.at(topic));
+    EventNormFlow normFlow(sea);
+    std::size_t eventNum = 0, nfNum = 0;
+    double grabTime = 0.0, nfTime = 0.0;
+    for (const auto &array : arrays) {
+        auto start = Clock::now();
+        sea->GrabEvent(array);
+        grabTime += SecondsFrom(start);
+        eventNum += array->GetEventNum();
+
+        start = Clock::now();
+        nfNum += normFlow.ExtractNormFlows()->nfs.size();
+        nfTime += SecondsFrom(start);
+    }
+    if (eventNum == 0) {
+        spdlog::warn("no event is involved in benchmark for event camera '{}'!", topic);
+        return;
+    }
+    profile.AddMetric("events", static_cast<double>(eventNum))
+        .AddMetric("grab/events_per_sec", eventNum / grabTime)
+        .AddMetric("norm_flow/arrays_per_sec", arrays.size() / nfTime)
+        .AddMetric("norm_flows", static_cast<double>(nfNum));
+    spdlog::info(
+        "benchmark event surface for '{}': events: {}, grab: {:.1f} (events/s), normal flow "
+        "extraction: {:.1f} (arrays/s)",
+        topic, eventNum, eventNum / grabTime, arrays.size() / nfTime);
+}
+
+// compare the estimated spatiotemporal parameters with the ground truth
+void ReportAccuracy(const CalibParamManager::Ptr &estimate, const CalibParamManager::Ptr &truth) {
+    Profiler::Scope profile("Benchmark::Accuracy");
+    auto Report = [&profile](const auto &estSO3, const auto &truthSO3, const auto &estPOS,
+                             const auto &truthPOS, const auto &estTO, const auto &truthTO) {
+        for (const auto &[topic, so3] : estSO3) {
+            const double rotErr =
+                (so3.inverse() * truthSO3.at(topic)).log().norm() * IMUIntrinsics::RAD_TO_DEG;
+            const double posErr = (estPOS.at(topic) - truthPOS.at(topic)).norm();
+            const double toErr = std::abs(estTO.at(topic) - truthTO.at(topic)) * 1E3;
+            profile.AddMetric(topic + "/rot_error_deg", rotErr)
+                .AddMetric(topic + "/pos_error_m", posErr)
+                .AddMetric(topic + "/time_offset_error_ms", toErr);
+            spdlog::info(
+                "accuracy of '{}': rotation: {:.4f} (deg), translation: {:.4f} (m), time offset: "
+                "{:.4f} (ms)",
+                topic, rotErr, posErr, toErr);
+        }
+    };
+    const auto &e = estimate->EXTRI, &t = truth->EXTRI;
+    const auto &eT = estimate->TEMPORAL, &tT = truth->TEMPORAL;
+    Report(e.SO3_BiToBr, t.SO3_BiToBr, e.POS_BiInBr, t.POS_BiInBr, eT.TO_BiToBr, tT.TO_BiToBr);
+    Report(e.SO3_RjToBr, t.SO3_RjToBr, e.POS_RjInBr, t.POS_RjInBr, eT.TO_RjToBr, tT.TO_RjToBr);
+    Report(e.SO3_LkToBr, t.SO3_LkToBr, e.POS_LkInBr, t.POS_LkInBr, eT.TO_LkToBr, tT.TO_LkToBr);
+}
+
+/**
+ * simulate the synthetic data from the configure file and the ros params, and perform both the
+ * component-level and the end-to-end benchmarks, the report is saved to '{OutputPath}/benchmark'
+ */
+void Benchmark() {
+    // load settings
+    auto configPath = GetParamFromROS<std::string>("/ikalibr_benchmark/config_path");
+    spdlog::info("loading configure from yaml file '{}'...", configPath);
+    if (!std::filesystem::exists(configPath)) {
+        throw Status(Status::CRITICAL, "configure file dose not exist: '{}'", configPath);
+    }
+    if (!Configor::LoadConfigure(configPath)) {
+        throw Status(Status::CRITICAL, "load configure file from '{}' failed!", configPath);
+    }
+    Configor::PrintMainFields();
+
+    if (!Configor::DataStream::RGBDTopics.empty()) {
+        spdlog::warn("rgbd cameras are not supported in the benchmark, they are ignored!");
+        Configor::DataStream::RGBDTopics.clear();
+    }
+
+    // settings of the synthetic data
+    const auto seed = GetParamFromROS<int>("/ikalibr_benchmark/seed");
+    const auto duration = GetParamFromROS<double>("/ikalibr_benchmark/duration");
+    const auto landmarkNum = GetParamFromROS<int>("/ikalibr_benchmark/landmark_num");
+    const auto imuFreq = GetParamFromROS<double>("/ikalibr_benchmark/imu_freq");
+    const auto gyroNoise = GetParamFromROS<double>("/ikalibr_benchmark/imu_gyro_noise");
+    const auto acceNoise = GetParamFromROS<double>("/ikalibr_benchmark/imu_acce_noise");
+    const auto lidarFreq = GetParamFromROS<double>("/ikalibr_benchmark/lidar_freq");
+    const auto lidarRings = GetParamFromROS<int>("/ikalibr_benchmark/lidar_rings");
+    const auto lidarColumns = GetParamFromROS<int>("/ikalibr_benchmark/lidar_columns");
+    const auto rangeNoise = GetParamFromROS<double>("/ikalibr_benchmark/lidar_range_noise");
+    const auto radarFreq = GetParamFromROS<double>("/ikalibr_benchmark/radar_freq");
+    const auto radarTargetNum = GetParamFromROS<int>("/ikalibr_benchmark/radar_target_num");
+    const auto velNoise = GetParamFromROS<double>("/ikalibr_benchmark/radar_vel_noise");
+    const auto cameraFreq = GetParamFromROS<double>("/ikalibr_benchmark/camera_freq");
+    const auto pixelNoise = GetParamFromROS<double>("/ikalibr_benchmark/camera_pixel_noise");
+    const auto eventArrayFreq = GetParamFromROS<double>("/ikalibr_benchmark/event_array_freq");
+    const auto eventSampleFreq =
+        GetParamFromROS<double>("/ikalibr_benchmark/event_sample_freq");
+
+    // the ground-truth parameters
+    auto truth = CalibParamManager::InitParamsFromConfigor();
+    PerturbSpatTempParams(truth, seed);
+    spdlog::info("the ground-truth parameters for the synthetic data:");
+    truth->ShowParamStatus();
+    const std::string benchmarkPath = Configor::DataStream::OutputPath + "/benchmark";
+    if (!std::filesystem::exists(benchmarkPath) &&
+        !std::filesystem::create_directories(benchmarkPath)) {
+        throw Status(Status::CRITICAL, "create the benchmark directory '{}' failed!",
+                     benchmarkPath);
+    }
+    truth->Save(benchmarkPath + "/truth_param" + Configor::GetFormatExtension(),
+                Configor::Preference::OutputDataFormat);
+
+    // simulate the synthetic data
+    auto generator = SyntheticDataGenerator::Create(truth, 0.0, duration, seed, landmarkNum);
+    std::map<std::string, std::vector<IMUFrame::Ptr>> imuMes;
+    std::map<std::string, std::vector<RadarTargetArray::Ptr>> radarMes;
+    std::map<std::string, std::vector<LiDARFrame::Ptr>> lidarMes;
+    std::map<std::string, ns_veta::Veta::Ptr> cameraFeats;
+    std::map<std::string, std::vector<EventArray::Ptr>> eventMes;
+    {
+        Profiler::Scope profile("Benchmark::Simulation");
+        for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+            imuMes[topic] = generator->SimulateIMU(topic, imuFreq, gyroNoise, acceNoise);
+        }
+        for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+            radarMes[topic] =
+                generator->SimulateRadar(topic, radarFreq, radarTargetNum, velNoise);
+        }
+        for (const auto &[topic, _] : Configor::DataStream::LiDARTopics) {
+            lidarMes[topic] = generator->SimulateLiDAR(topic, lidarFreq, lidarRings,
+                                                       lidarColumns, rangeNoise);
+        }
+        for (const auto &[topic, _] : Configor::DataStream::CameraTopics) {
+            cameraFeats[topic] =
+                generator->SimulateCameraFeatures(topic, cameraFreq, pixelNoise);
+        }
+        for (const auto &[topic, _] : Configor::DataStream::EventTopics) {
+            eventMes[topic] =
+                generator->SimulateEvents(topic, eventArrayFreq, eventSampleFreq);
+        }
+    }
+
+    /**
+     * component-level benchmarks on the ground truth: the factors in the estimator, the visual
+     * reprojection data association, and the event preprocessing
+     */
+    BenchmarkFactors("InertialFactors", generator, truth, [&](const Estimator::Ptr &est) {
+        for (const auto &[topic, frames] : imuMes) {
+            const auto &config = Configor::DataStream::IMUTopics.at(topic);
+            for (const auto &frame : frames) {
+                est->AddIMUGyroMeasurement(frame, topic, OptOption::ALL, config.GyroWeight);
+                est->AddIMUAcceMeasurement<TimeDeriv::LIN_POS_SPLINE>(
+                    frame, topic, OptOption::ALL, config.AcceWeight);
+            }
+        }
+    });
+    BenchmarkFactors("RadarFactors", generator, truth, [&](const Estimator::Ptr &est) {
+        for (const auto &[topic, arrays] : radarMes) {
+            const double weight = Configor::DataStream::RadarTopics.at(topic).Weight;
+            for (const auto &array : arrays) {
+                for (const auto &tar : array->GetTargets()) {
+                    est->AddRadarMeasurement<TimeDeriv::LIN_POS_SPLINE>(
+                        tar, topic, OptOption::ALL, weight);
+                }
+            }
+        }
+    });
+    // the inverse depths and the global scale are parameters in the estimator
+    std::map<std::string, std::vector<VisualReProjCorrSeq::Ptr>> visualCorrs;
+    double visualGlobalScale = 1.0;
+    for (const auto &[topic, veta] : cameraFeats) {
+        Profiler::Scope profile("Benchmark::VisualReProjAssociation");
+        visualCorrs[topic] = VisualReProjAssociator::Create(
+                                 EnumCast::stringToEnum<CameraModelType>(
+                                     Configor::DataStream::CameraTopics.at(topic).Type))
+                                 ->Association(*veta, truth->INTRI.Camera.at(topic));
+        profile.AddMetric("landmarks", static_cast<double>(veta->structure.size()));
+    }
+    BenchmarkFactors("VisualReprojFactors", generator, truth, [&](const Estimator::Ptr &est) {
+        for (const auto &[topic, corrs] : visualCorrs) {
+            const double weight = Configor::DataStream::CameraTopics.at(topic).Weight;
+            for (const auto &corr : corrs) {
+                for (const auto &c : corr->corrs) {
+                    est->AddVisualReprojection<TimeDeriv::LIN_POS_SPLINE>(
+                        c, topic, &visualGlobalScale, corr->invDepthFir.get(), OptOption::ALL,
+                        weight * c->weight);
+                }
+            }
+        }
+    });
+    for (const auto &[topic, arrays] : eventMes) {
+        BenchmarkEventSurface(topic, arrays, truth);
+    }
+
+    /**
+     * the end-to-end calibration. Optical and event cameras can not be calibrated here, as
+     * they require images (or the SfM from thirdparty tools), they are removed from the
+     * configor, and are only benchmarked on the component level above
+     */
+    if (!Configor::DataStream::CameraTopics.empty() ||
+        !Configor::DataStream::EventTopics.empty()) {
+        spdlog::warn(
+            "optical and event cameras are not involved in the end-to-end calibration of the "
+            "benchmark!");
+        Configor::DataStream::CameraTopics.clear();
+        Configor::DataStream::EventTopics.clear();
+    }
+    std::size_t lidarFrameNum = 0, radarArrayNum = 0;
+    for (const auto &[topic, frames] : lidarMes) {
+        lidarFrameNum += frames.size();
+    }
+    for (const auto &[topic, arrays] : radarMes) {
+        radarArrayNum += arrays.size();
+    }
+
+    auto paramMagr = CalibParamManager::InitParamsFromConfigor();
+    auto dataMagr = CalibDataManager::Create();
+    {
+        Profiler::Scope profile("LoadCalibData");
+        dataMagr->LoadCalibData(std::move(imuMes), std::move(radarMes), std::move(lidarMes),
+                                {}, {});
+    }
+    auto solver = CalibSolver::Create(dataMagr, paramMagr);
+    {
+        Profiler::Scope profile("Process");
+        auto start = Clock::now();
+        solver->Process();
+        const double time = SecondsFrom(start);
+        profile.AddMetric("lidar/frames_per_sec", lidarFrameNum / time)
+            .AddMetric("radar/arrays_per_sec", radarArrayNum / time)
+            .AddMetric("time_range_per_sec", duration / time);
+    }
+    paramMagr->Save(benchmarkPath + "/ikalibr_param" + Configor::GetFormatExtension(),
+                    Configor::Preference::OutputDataFormat);
+    ReportAccuracy(paramMagr, truth);
+
+    Profiler::SaveReport(benchmarkPath);
+    spdlog::info("the benchmark report is saved to '{}'.", benchmarkPath);
+
+    static constexpr auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+    spdlog::info(fmt::format(FStyle, "benchmark finished!!! Everything is fine!!!"));
+}
+
+}  // namespace ns_ikalibr
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "ikalibr_benchmark");
+    try {
+        ns_ikalibr::ConfigSpdlog();
+
+        ns_ikalibr::PrintIKalibrLibInfo();
+
+        ns_ikalibr::Benchmark();
+
+    } catch (const ns_ikalibr::IKalibrStatus &status) {
+        // if error happened, print it
+        static constexpr auto FStyle = fmt::emphasis::italic | fmt::fg(fmt::color::green);
+        static constexpr auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        switch (status.flag) {
+            case ns_ikalibr::Status::FINE:
+                // this case usually won't happen
+                spdlog::info(fmt::format(FStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::WARNING:
+                spdlog::warn(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::ERROR:
+                spdlog::error(fmt::format(WECStyle, "{}", status.what));
+                break;
+            case ns_ikalibr::Status::CRITICAL:
+                spdlog::critical(fmt::format(WECStyle, "{}", status.what));
+                break;
+        }
+    } catch (const std::exception &e) {
+        // an unknown exception not thrown by this program
+        static constexpr auto WECStyle = fmt::emphasis::italic | fmt::fg(fmt::color::red);
+        spdlog::critical(fmt::format(WECStyle, "unknown error happened: '{}'", e.what()));
+    }
+
+    ros::shutdown();
+    return 0;
+}
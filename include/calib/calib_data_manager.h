@@ -45,6 +45,8 @@
 #include "util/status.hpp"
 #include "veta/veta.h"
 #include "rosbag/bag.h"
+#include "mutex"
+#include "optional"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -73,6 +75,9 @@ private:
 
     std::map<std::string, std::vector<OpticalFlowTripleTracePtr>> _visualOpticalFlowTrace;
     std::map<std::string, std::vector<FeatureTrackingCurvePtr>> _visualFeatTrackingCurve;
+    // guards the insertion and topic-based query of SfM data and optical flow traces, which may be
+    // performed by concurrent initialization preparations
+    mutable std::mutex _visualDataMutex;
 
     double _rawStartTimestamp{};
     double _rawEndTimestamp{};
@@ -220,7 +225,35 @@ public:
     // load camera, lidar, imu data from the ros bag [according to the config file]
     void LoadCalibData();
 
+    /**
+     * load raw measurements from the memory rather than the ros bag, e.g., the synthetic ones from
+     * the 'SyntheticDataGenerator', they would be adjusted and aligned as the ones from the ros bag.
+     * all topics in the config file except rgbd ones should be given here
+     */
+    void LoadCalibData(std::map<std::string, std::vector<IMUFrame::Ptr>> imuMes,
+                       std::map<std::string, std::vector<RadarTargetArray::Ptr>> radarMes,
+                       std::map<std::string, std::vector<LiDARFrame::Ptr>> lidarMes,
+                       std::map<std::string, std::vector<CameraFrame::Ptr>> camMes,
+                       std::map<std::string, std::vector<EventArray::Ptr>> eventMes);
+
 protected:
+    // load raw calibration data from the ros bag, without any adjustment
+    void LoadCalibDataFromBag();
+
+    // the key of the calibration data cache, which is composed of the information of the ros bag
+    // and the configure fields that affect data loading and adjustment. 'std::nullopt' is returned
+    // if the ros bag can not be inspected, then the cache is skipped
+    static std::optional<std::string> CalibDataCacheKey();
+
+    static std::optional<std::string> CalibDataCachePath();
+
+    // save the adjusted and aligned calibration data to a binary cache file
+    bool SaveCalibDataToCache(const std::string &filename) const;
+
+    // load the adjusted and aligned calibration data from a binary cache file, returns false if
+    // the cache does not exist, or it is outdated or broken
+    bool LoadCalibDataFromCache(const std::string &filename);
+
     // make sure the first imu frame is before camera and lidar data
     // assign the '_alignedStartTimestamp' and '_alignedEndTimestamp'
     void AdjustCalibDataSequence();
@@ -39,9 +39,13 @@
 #include "calib/calib_param_manager.h"
 #include "calib/time_deriv.hpp"
 #include "ceres/ceres.h"
+#include "Eigen/Sparse"
 #include "config/configor.h"
 #include "ctraj/core/pose.hpp"
 #include "ctraj/core/spline_bundle.h"
+#include "factor/fixed_size_auto_diff.hpp"
+#include "factor/marginalization_prior_factor.hpp"
+#include "unordered_set"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -143,19 +147,59 @@ public:
 private:
     SplineBundleType::Ptr splines;
     CalibParamManager::Ptr parMagr;
+    // residual blocks kept alive when this estimator is reused over batch optimizations
+    std::unordered_set<ceres::ResidualBlockId> persistentBlocks;
+    // the time window of the sliding-window optimization, knots in it, and all knots of splines
+    std::optional<std::pair<double, double>> timeWindow;
+    std::unordered_set<const double *> windowKnots, allKnots;
+    // the time margin of data (stamped by sensors) that may involve knots in the time window
+    double windowMargin{};
+
+    // a modification of this problem recorded when residual blocks are built in parallel
+    struct ProblemOp {
+        enum class Type {
+            ADD_PARAM_BLOCK,
+            ADD_PARAM_BLOCK_WITH_MANIFOLD,
+            SET_MANIFOLD,
+            SET_CONSTANT,
+            SET_LOWER_BOUND,
+            SET_UPPER_BOUND,
+            ADD_RESIDUAL_BLOCK
+        };
+        Type type;
+        double *block = nullptr;
+        // the size of the parameter block, or the index of the bound
+        int index = 0;
+        double bound = 0.0;
+        ceres::Manifold *manifold = nullptr;
+        ceres::CostFunction *costFunc = nullptr;
+        ceres::LossFunction *lossFunc = nullptr;
+        std::vector<double *> blocks;
+    };
+    // modifications made by the current thread are recorded to this buffer if it is not null
+    static thread_local std::vector<ProblemOp> *recordedOps;
 
     // manifolds
     static std::shared_ptr<ceres::EigenQuaternionManifold> QUATER_MANIFOLD;
     static std::shared_ptr<ceres::SphereManifold<3>> GRAVITY_MANIFOLD;
 
 public:
-    Estimator(SplineBundleType::Ptr splines, CalibParamManager::Ptr calibParamManager);
+    Estimator(SplineBundleType::Ptr splines,
+              CalibParamManager::Ptr calibParamManager,
+              const ceres::Problem::Options &options = DefaultProblemOptions());
 
     static Ptr Create(const SplineBundleType::Ptr &splines,
-                      const CalibParamManager::Ptr &calibParamManager);
+                      const CalibParamManager::Ptr &calibParamManager,
+                      const ceres::Problem::Options &options = DefaultProblemOptions());
 
     static ceres::Problem::Options DefaultProblemOptions();
 
+    /**
+     * problem options for an estimator reused over batch optimizations, residual and parameter
+     * blocks are removed frequently from such one, thus the fast removal is enabled
+     */
+    static ceres::Problem::Options PersistentProblemOptions();
+
     static ceres::Solver::Options DefaultSolverOptions(int threadNum = -1,
                                                        bool toStdout = true,
                                                        bool useCUDA = false);
@@ -164,11 +208,145 @@ public:
         const ceres::Solver::Options &options = Estimator::DefaultSolverOptions(),
         const SpatialTemporalPrioriPtr &priori = nullptr);
 
+    /**
+     * choose the linear solver for this problem by its structure ('AutoLinearSolver'). Parameter
+     * blocks are grouped into independent landmark ones (e.g., inverse depths, eliminated first),
+     * knots of splines, and others (spatiotemporal parameters, ...). Dense schur is kept for small
+     * reduced systems, while sparse schur, iterative schur, or sparse normal cholesky (if there is
+     * no landmark) is used for large ones, with the elimination ordering of above groups
+     */
+    [[nodiscard]] ceres::Solver::Options SelectLinearSolver(
+        const ceres::Solver::Options &options) const;
+
     Eigen::MatrixXd GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
                                      int numThread = 1);
 
+    /**
+     * the hessian matrix (J^T * J, in tangent spaces) of the considered parameter blocks, the
+     * jacobian and the hessian are both kept sparse
+     */
+    Eigen::SparseMatrix<double> GetSparseHessianMatrix(
+        const std::vector<double *> &consideredParBlocks,
+        int numThread = 1,
+        const std::vector<ceres::ResidualBlockId> &consideredResBlocks = {});
+
+    /**
+     * the marginal covariance (in tangent spaces) of the given parameter blocks, all other variable
+     * blocks in this problem (knots, landmarks, ...) are marginalized by the schur complement on
+     * the sparse hessian, thus only the covariance of the given blocks is dense. Rows and columns
+     * of constant blocks are zeros, and all given blocks should be in this problem
+     */
+    Eigen::MatrixXd GetMarginalCovariance(const std::vector<double *> &parBlocks,
+                                          int numThread = 1);
+
     void PrintParameterInfo() const;
 
+    /**
+     * count the residual blocks in this problem for each type of factor, the factor type is
+     * obtained from the cost function (cost function wrappers such as auto-diff ones are unwrapped)
+     */
+    [[nodiscard]] std::map<std::string, int> GetResidualBlockCountOfFactors() const;
+
+    /**
+     * mark all residual blocks currently in this problem as persistent ones, which would not be
+     * removed by 'RemoveNonPersistentBlocks'
+     */
+    void MarkResidualBlocksPersistent();
+
+    /**
+     * remove all residual blocks that are not marked as persistent, as well as parameter blocks
+     * that are no longer involved in any residual block (their memory may be released by callers)
+     */
+    void RemoveNonPersistentBlocks();
+
+    /**
+     * set parameter blocks involved in inertial and radar factors (knots of splines, intrinsics
+     * and extrinsics of imus, gravity, and extrinsics of radars) to be constant or variable
+     * according to the given option. Note that the time offset blocks are only switched, their
+     * bounds are not changed
+     */
+    void SetInertialAndRadarParamsState(Opt option);
+
+    /**
+     * restrict this problem to the time window [sTime, eTime] (by the reference imu) for the
+     * sliding-window optimization. Residual blocks involving knots out of the window would be
+     * dropped when adding them, so as their parameter blocks
+     */
+    void SetTimeWindow(double sTime, double eTime);
+
+    /**
+     * whether data in [sTime, eTime] (stamped by sensors) may involve knots in the time window, a
+     * cheap check to skip data out of the window before creating their factors. Time offsets, the
+     * readout time, and the support of splines are considered in the margin
+     */
+    [[nodiscard]] bool MayInvolveTimeWindow(double sTime, double eTime) const;
+
+    /**
+     * set the head knots of the time window constant, which are shared with the previous window
+     * and have been optimized there, to make windows connected smoothly
+     */
+    void FixTimeWindowHeadKnots();
+
+    /**
+     * residual blocks that would leave the time window when it slides to the next start time,
+     * i.e., the ones involving knots before the next window, and ones involving no knot at all
+     */
+    [[nodiscard]] std::vector<ceres::ResidualBlockId> GetResidualBlocksLeavingTimeWindow(
+        double nextSTime) const;
+
+    /**
+     * marginalize the given residual blocks into a prior on the spatiotemporal parameters and
+     * intrinsics involved in them (knots, landmarks, ... are all marginalized), which would be
+     * carried to the next time window. A null pointer is returned if no such block is involved
+     */
+    MarginalizationPrior::Ptr MarginalizeToPrior(
+        const std::vector<ceres::ResidualBlockId> &residualBlocks, int numThread = 1);
+
+    /**
+     * param blocks:
+     * [ BLOCK | ... | BLOCK ] (spatiotemporal parameters and intrinsics)
+     */
+    void AddMarginalizationPrior(const MarginalizationPrior::Ptr &prior);
+
+    using ceres::Problem::AddResidualBlock;
+
+    /**
+     * hides the one of 'ceres::Problem', residual blocks involving knots out of the time window (if
+     * set) are not added, and null pointers are returned for them
+     */
+    ceres::ResidualBlockId AddResidualBlock(ceres::CostFunction *costFunction,
+                                            ceres::LossFunction *lossFunction,
+                                            const std::vector<double *> &parameterBlocks);
+
+    /**
+     * add measurements indexed by [0, count) to this problem in two phases (the speed-up option
+     * 'ParallelProblemBuild'), where 'AddMeasurement(index)' calls 'Add*' functions of this
+     * estimator. Firstly, they are called concurrently: spline metas and cost functions are
+     * created, while modifications of this problem are recorded rather than applied. Then recorded
+     * modifications are applied serially in the order of indexes, thus the problem is identical to
+     * the one built serially. Note that 'AddMeasurement' should only read shared data
+     */
+    template <class Func>
+    void AddInParallel(int count, const Func &AddMeasurement);
+
+    /**
+     * following functions hide the ones of 'ceres::Problem', the modification is recorded if
+     * residual blocks are being built in parallel, otherwise applied directly. If the time window
+     * is set, knots out of it are not added, and blocks not in this problem (only involved in
+     * dropped residual blocks) are not configured
+     */
+    void AddParameterBlock(double *values, int size);
+
+    void AddParameterBlock(double *values, int size, ceres::Manifold *manifold);
+
+    void SetManifold(double *values, ceres::Manifold *manifold);
+
+    void SetParameterBlockConstant(const double *values);
+
+    void SetParameterLowerBound(double *values, int index, double lowerBound);
+
+    void SetParameterUpperBound(double *values, int index, double upperBound);
+
 public:
     void AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
                                const std::string &topic,
@@ -557,7 +735,70 @@ protected:
                         const SplineMetaType &splineMeta,
                         bool setToConst);
 
-    static Eigen::MatrixXd CRSMatrix2EigenMatrix(ceres::CRSMatrix *jacobian_crs_matrix);
+    /**
+     * create the auto-diff cost function of a spline factor whose parameter blocks are organized
+     * as [ SO3 | ... | SO3 | (LIN_SCALE | ... | LIN_SCALE) | OTHER_BLOCKS ]. If the factor only
+     * touches one or two consecutive segments of each spline, a fixed-size cost function with
+     * static jets is created, otherwise a dynamic one. Two segments are the common case when time
+     * offsets are optimized, as the metas are padded by 'TimeOffsetPadding' (smaller than the knot
+     * distance). Metas spanning more segments, i.e., padding larger than the knot distance, or
+     * consisting of several pieces, fall back to the dynamic one. The cost function takes the
+     * ownership of the functor.
+     */
+    template <class Functor, int NumResiduals, int... OtherBlockSizes>
+    static ceres::CostFunction *CreateSplineAutoDiffCostFunc(Functor *functor,
+                                                             const SplineMetaType &so3Meta);
+
+    template <class Functor, int NumResiduals, int... OtherBlockSizes>
+    static ceres::CostFunction *CreateSplineAutoDiffCostFunc(Functor *functor,
+                                                             const SplineMetaType &so3Meta,
+                                                             const SplineMetaType &scaleMeta);
+
+    /**
+     * add parameter blocks organized as [ SO3 | ... | SO3 | (LIN_SCALE | ... | LIN_SCALE) |
+     * OTHER_BLOCKS ] to a dynamic cost function and set its residual number
+     */
+    template <int NumResiduals, int... OtherBlockSizes>
+    static void SetSplineCostFuncBlocks(ceres::DynamicCostFunction *costFunc,
+                                        const SplineMetaType &so3Meta,
+                                        const SplineMetaType *scaleMeta = nullptr);
+
+    template <class Functor, int NumResiduals, int So3KnotNum, int ScaleKnotNum,
+              int... OtherBlockSizes>
+    static ceres::CostFunction *CreateFixedSizeSplineAutoDiffCostFunc(Functor *functor);
+
+    // the number of segments of a continuous meta, zero if the meta consists of several pieces
+    static int SegmentNumOfMeta(const SplineMetaType &meta);
+
+    static Eigen::SparseMatrix<double, Eigen::RowMajor> CRSMatrix2SparseMatrix(
+        const ceres::CRSMatrix &jacobianCRSMatrix);
+
+    /**
+     * the information matrix (in tangent spaces) of the kept variable blocks, with all other
+     * variable blocks involved in the considered residual blocks (all ones if empty) marginalized
+     */
+    Eigen::MatrixXd GetMarginalInformation(
+        const std::vector<double *> &keptParBlocks,
+        int numThread,
+        const std::vector<ceres::ResidualBlockId> &consideredResBlocks = {});
+
+    // knots of splines
+    [[nodiscard]] std::unordered_set<const double *> GetKnotParamBlocks() const;
+
+    // spatiotemporal parameters and intrinsics maintained in the parameter manager
+    [[nodiscard]] std::unordered_set<const double *> GetCalibParamBlocks() const;
+
+    // whether the parameter block is a knot out of the time window (if set)
+    [[nodiscard]] bool IsKnotOutOfTimeWindow(const double *block) const;
+
+    // set the buffer of the calling thread, null to apply modifications directly
+    static void SetRecordedOps(std::vector<ProblemOp> *ops);
+
+    // apply recorded modifications in order, the buffer is released after applied
+    void ApplyRecordedOps(std::vector<ProblemOp> &ops);
+
+    // release cost and loss functions in recorded modifications without applying them
+    static void DiscardRecordedOps(std::vector<ProblemOp> &ops);
 
     std::optional<std::pair<Eigen::Vector3d, Eigen::Matrix3d>> InertialVelIntegration(
         const std::vector<IMUFrame::Ptr> &data,
@@ -608,6 +849,76 @@ protected:
      */
     [[nodiscard]] bool TimeInRangeForSplines(const std::pair<double, double> &timePair) const;
 };
+
+template <int NumResiduals, int... OtherBlockSizes>
+void Estimator::SetSplineCostFuncBlocks(ceres::DynamicCostFunction *costFunc,
+                                        const SplineMetaType &so3Meta,
+                                        const SplineMetaType *scaleMeta) {
+    // so3 knots param block [each has four sub params]
+    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+        costFunc->AddParameterBlock(4);
+    }
+    // pos knots param block [each has three sub params]
+    if (scaleMeta != nullptr) {
+        for (int i = 0; i < static_cast<int>(scaleMeta->NumParameters()); ++i) {
+            costFunc->AddParameterBlock(3);
+        }
+    }
+    (costFunc->AddParameterBlock(OtherBlockSizes), ...);
+    costFunc->SetNumResiduals(NumResiduals);
+}
+
+template <class Functor, int NumResiduals, int So3KnotNum, int ScaleKnotNum, int... OtherBlockSizes>
+ceres::CostFunction *Estimator::CreateFixedSizeSplineAutoDiffCostFunc(Functor *functor) {
+    using BlockSizes = typename ConcatIntSeq<typename RepeatIntSeq<4, So3KnotNum>::Type,
+                                             typename RepeatIntSeq<3, ScaleKnotNum>::Type,
+                                             IntSeq<OtherBlockSizes...>>::Type;
+    return FixedSizeAutoDiffCostFunction<Functor, NumResiduals, BlockSizes>::Create(functor);
+}
+
+template <class Functor, int NumResiduals, int... OtherBlockSizes>
+ceres::CostFunction *Estimator::CreateSplineAutoDiffCostFunc(Functor *functor,
+                                                             const SplineMetaType &so3Meta) {
+    constexpr int Order = Configor::Prior::SplineOrder;
+    switch (SegmentNumOfMeta(so3Meta)) {
+        case 1:
+            return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order, 0,
+                                                         OtherBlockSizes...>(functor);
+        case 2:
+            return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order + 1, 0,
+                                                         OtherBlockSizes...>(functor);
+        default:
+            break;
+    }
+    auto costFunc = new ceres::DynamicAutoDiffCostFunction<Functor>(functor);
+    SetSplineCostFuncBlocks<NumResiduals, OtherBlockSizes...>(costFunc, so3Meta);
+    return costFunc;
+}
+
+template <class Functor, int NumResiduals, int... OtherBlockSizes>
+ceres::CostFunction *Estimator::CreateSplineAutoDiffCostFunc(Functor *functor,
+                                                             const SplineMetaType &so3Meta,
+                                                             const SplineMetaType &scaleMeta) {
+    constexpr int Order = Configor::Prior::SplineOrder;
+    const int so3SegNum = SegmentNumOfMeta(so3Meta), scaleSegNum = SegmentNumOfMeta(scaleMeta);
+    // the knot distances of the two splines may differ, so do the segment numbers
+    if (so3SegNum == 1 && scaleSegNum == 1) {
+        return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order, Order,
+                                                     OtherBlockSizes...>(functor);
+    } else if (so3SegNum == 1 && scaleSegNum == 2) {
+        return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order, Order + 1,
+                                                     OtherBlockSizes...>(functor);
+    } else if (so3SegNum == 2 && scaleSegNum == 1) {
+        return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order + 1, Order,
+                                                     OtherBlockSizes...>(functor);
+    } else if (so3SegNum == 2 && scaleSegNum == 2) {
+        return CreateFixedSizeSplineAutoDiffCostFunc<Functor, NumResiduals, Order + 1, Order + 1,
+                                                     OtherBlockSizes...>(functor);
+    }
+    auto costFunc = new ceres::DynamicAutoDiffCostFunction<Functor>(functor);
+    SetSplineCostFuncBlocks<NumResiduals, OtherBlockSizes...>(costFunc, so3Meta, &scaleMeta);
+    return costFunc;
+}
 }  // namespace ns_ikalibr
 
 #endif  // IKALIBR_ESTIMATOR_H
@@ -51,6 +51,56 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 }
 
 namespace ns_ikalibr {
+template <class Func>
+void Estimator::AddInParallel(int count, const Func &AddMeasurement) {
+    const int threads = Configor::Preference::AvailableThreads();
+    if (!IsOptionWith(SpeedUpOption::ParallelProblemBuild, Configor::Preference::SpeedUps) ||
+        threads < 2 || count < Configor::Preference::ParallelProblemBuildMin) {
+        for (int i = 0; i < count; ++i) {
+            AddMeasurement(i);
+        }
+        return;
+    }
+
+    /**
+     * measurements are split into contiguous chunks (more than threads for load balancing), whose
+     * modifications are recorded to their own buffers, thus the order is kept when applying them
+     */
+    const int chunkCount = std::min(count, threads * 8);
+    std::vector<std::vector<ProblemOp>> chunkOps(chunkCount);
+    std::vector<std::exception_ptr> exceptions(chunkCount, nullptr);
+#pragma omp parallel for num_threads(threads) schedule(dynamic) default(none) \
+    shared(count, chunkCount, chunkOps, exceptions, AddMeasurement)
+    for (int c = 0; c < chunkCount; ++c) {
+        SetRecordedOps(&chunkOps.at(c));
+        try {
+            const auto sIdx = static_cast<int>(static_cast<std::int64_t>(count) * c / chunkCount);
+            const auto eIdx =
+                static_cast<int>(static_cast<std::int64_t>(count) * (c + 1) / chunkCount);
+            for (int i = sIdx; i < eIdx; ++i) {
+                AddMeasurement(i);
+            }
+        } catch (...) {
+            exceptions.at(c) = std::current_exception();
+        }
+        SetRecordedOps(nullptr);
+    }
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            for (auto &ops : chunkOps) {
+                DiscardRecordedOps(ops);
+            }
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // the second phase: insert recorded parameter and residual blocks to this problem serially
+    for (auto &ops : chunkOps) {
+        ApplyRecordedOps(ops);
+    }
+}
+
 /**
  * param blocks:
  * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
@@ -96,33 +146,18 @@ void Estimator::AddIMUAcceMeasurement(const IMUFrame::Ptr &imuFrame,
     }
     // create a cost function
     constexpr int derivIMU = TimeDeriv::Deriv<type, TimeDeriv::LIN_ACCE>();
-    auto costFunc = IMUAcceFactor<Configor::Prior::SplineOrder, derivIMU>::Create(
-        so3Meta, scaleMeta, imuFrame, acceWeight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
+    ceres::CostFunction *costFunc;
+    if (IsOptionWith(SpeedUpOption::AnalyticIMUFactor, Configor::Preference::SpeedUps)) {
+        using Factor = IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, derivIMU>;
+        auto analyticCostFunc = Factor::Create(so3Meta, scaleMeta, imuFrame, acceWeight);
+        SetSplineCostFuncBlocks<3, 3, 6, 3, 4, 3, 1>(analyticCostFunc, so3Meta, &scaleMeta);
+        costFunc = analyticCostFunc;
+    } else {
+        using Functor = IMUAcceFactor<Configor::Prior::SplineOrder, derivIMU>;
+        costFunc = CreateSplineAutoDiffCostFunc<Functor, 3, 3, 6, 3, 4, 3, 1>(
+            new Functor(so3Meta, scaleMeta, imuFrame, acceWeight), so3Meta, scaleMeta);
     }
 
-    // ACCE_BIAS
-    costFunc->AddParameterBlock(3);
-    // ACCE_MAP_COEFF
-    costFunc->AddParameterBlock(6);
-    // GRAVITY
-    costFunc->AddParameterBlock(3);
-    // SO3_BiToBr
-    costFunc->AddParameterBlock(4);
-    // POS_BiInBr
-    costFunc->AddParameterBlock(3);
-    // TO_BiToBr
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(3);
-
     // organize the param block vector
     std::vector<double *> paramBlockVec;
 
@@ -229,23 +264,10 @@ void Estimator::AddRadarMeasurement(const RadarTarget::Ptr &radarFrame,
     static constexpr int derivRadar = TimeDeriv::Deriv<type, TimeDeriv::LIN_VEL>();
 
     // create a cost function
-    auto costFunc = RadarFactor<Configor::Prior::SplineOrder, derivRadar>::Create(
-        so3Meta, scaleMeta, radarFrame, weight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-    costFunc->AddParameterBlock(4);  // SO3_RtoB
-    costFunc->AddParameterBlock(3);  // POS_RinB
-    costFunc->AddParameterBlock(1);  // TIME_OFFSET_RtoB
-
-    // the Residual
-    costFunc->SetNumResiduals(1);
+    // SO3_RjToBr | POS_RjInBr | TO_RjToBr
+    using Functor = RadarFactor<Configor::Prior::SplineOrder, derivRadar>;
+    auto costFunc = CreateSplineAutoDiffCostFunc<Functor, 1, 4, 3, 1>(
+        new Functor(so3Meta, scaleMeta, radarFrame, weight), so3Meta, scaleMeta);
 
     // organize the param block vector
     std::vector<double *> paramBlockVec;
@@ -379,23 +401,10 @@ void Estimator::AddLiDARPointToSurfelConstraint(const PointToSurfelCorrPtr &ptsC
     }
     static constexpr int derivLiDAR = TimeDeriv::Deriv<type, TimeDeriv::LIN_POS>();
     // create a cost function
-    auto costFunc = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
-        so3Meta, scaleMeta, ptsCorr, weight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-
-    costFunc->AddParameterBlock(4);
-    costFunc->AddParameterBlock(3);
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(1);
+    // SO3_LkToBr | POS_LkInBr | TO_LkToBr
+    using Functor = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>;
+    auto costFunc = CreateSplineAutoDiffCostFunc<Functor, 1, 4, 3, 1>(
+        new Functor(so3Meta, scaleMeta, ptsCorr, weight), so3Meta, scaleMeta);
 
     // organize the param block vector
     std::vector<double *> paramBlockVec;
@@ -488,23 +497,10 @@ void Estimator::AddRGBDPointTiSurfelConstraint(const PointToSurfelCorrPtr &ptsCo
     }
     static constexpr int derivLiDAR = TimeDeriv::Deriv<type, TimeDeriv::LIN_POS>();
     // create a cost function
-    auto costFunc = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>::Create(
-        so3Meta, scaleMeta, ptsCorr, weight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
-    }
-    // pos knots param block [each has three sub params]
-    for (int i = 0; i < static_cast<int>(scaleMeta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(3);
-    }
-
-    costFunc->AddParameterBlock(4);
-    costFunc->AddParameterBlock(3);
-    costFunc->AddParameterBlock(1);
-
-    costFunc->SetNumResiduals(1);
+    // SO3_DnToBr | POS_DnInBr | TO_DnToBr
+    using Functor = PointToSurfelFactor<Configor::Prior::SplineOrder, derivLiDAR>;
+    auto costFunc = CreateSplineAutoDiffCostFunc<Functor, 1, 4, 3, 1>(
+        new Functor(so3Meta, scaleMeta, ptsCorr, weight), so3Meta, scaleMeta);
 
     // organize the param block vector
     std::vector<double *> paramBlockVec;
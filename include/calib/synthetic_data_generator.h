@@ -0,0 +1,161 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_SYNTHETIC_DATA_GENERATOR_H
+#define IKALIBR_SYNTHETIC_DATA_GENERATOR_H
+
+#include "calib/calib_param_manager.h"
+#include "config/configor.h"
+#include "ctraj/core/spline_bundle.h"
+#include "sensor/event.h"
+#include "sensor/imu.h"
+#include "sensor/lidar.h"
+#include "sensor/radar.h"
+#include "veta/veta.h"
+#include "optional"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * the synthetic multi-sensor data generator, used to benchmark the calibration offline without any
+ * ros bag. The ground-truth trajectory of the reference IMU is represented by a spline bundle (the
+ * same as the one in the 'CalibSolver'), and the procedural scene is an indoor room with several
+ * pillars. Measurements of sensors are simulated using the ground-truth spatiotemporal parameters
+ * (and intrinsics) in the given parameter manager.
+ */
+class SyntheticDataGenerator {
+public:
+    using Ptr = std::shared_ptr<SyntheticDataGenerator>;
+    using SplineBundleType = ns_ctraj::SplineBundle<Configor::Prior::SplineOrder>;
+
+    struct AxisAlignedBox {
+        Eigen::Vector3d min, max;
+    };
+
+private:
+    // the ground-truth parameters
+    CalibParamManager::Ptr _parMagr;
+    // the ground-truth trajectory of the reference IMU
+    SplineBundleType::Ptr _splines;
+    // the procedural scene: the room (the sensors are inside) and pillars in it
+    AxisAlignedBox _room;
+    std::vector<AxisAlignedBox> _pillars;
+    // landmarks on the surfaces of the scene, for cameras, event cameras, and radars
+    std::vector<Eigen::Vector3d> _landmarks;
+
+    std::uint32_t _seed;
+    std::mt19937 _engine;
+
+public:
+    SyntheticDataGenerator(CalibParamManager::Ptr parMagr,
+                           double st,
+                           double et,
+                           std::uint32_t seed,
+                           int landmarkNum = 2000);
+
+    static Ptr Create(const CalibParamManager::Ptr &parMagr,
+                      double st,
+                      double et,
+                      std::uint32_t seed,
+                      int landmarkNum = 2000);
+
+    [[nodiscard]] const SplineBundleType::Ptr &GetSplines() const;
+
+    [[nodiscard]] const std::vector<Eigen::Vector3d> &GetLandmarks() const;
+
+    // the ground-truth pose of the reference IMU, i.e., from {Br} to {W}
+    [[nodiscard]] Sophus::SE3d CurBrToW(double timeByBr) const;
+
+    [[nodiscard]] bool TimeInRange(double timeByBr) const;
+
+    // the first hit of the ray on the scene, return the distance from the origin to the hit point
+    [[nodiscard]] std::optional<double> RayCast(const Eigen::Vector3d &origin,
+                                                const Eigen::Vector3d &dir) const;
+
+    // inertial frames (intrinsics involved) stamped by the IMU
+    std::vector<IMUFrame::Ptr> SimulateIMU(const std::string &topic,
+                                           double freq,
+                                           double gyroNoise = 0.0,
+                                           double acceNoise = 0.0);
+
+    // scans from a spinning LiDAR, the points are stamped individually (motion distortion involved)
+    std::vector<LiDARFrame::Ptr> SimulateLiDAR(const std::string &topic,
+                                               double freq,
+                                               int rings,
+                                               int columns,
+                                               double rangeNoise = 0.0);
+
+    // target arrays with doppler velocities of landmarks in the field of view
+    std::vector<RadarTargetArray::Ptr> SimulateRadar(const std::string &topic,
+                                                     double freq,
+                                                     int targetNum,
+                                                     double velNoise = 0.0);
+
+    /**
+     * undistorted pinhole features of landmarks, which are organized as the SfM data, i.e., views
+     * (stamped by the camera), poses (from the camera to the world) and tracked landmarks
+     */
+    ns_veta::Veta::Ptr SimulateCameraFeatures(const std::string &topic,
+                                              double freq,
+                                              double pixelNoise = 0.0);
+
+    /**
+     * events are triggered when the (distorted) projections of landmarks move to new pixels, the
+     * motion is sampled at 'sampleFreq', and events are packed as arrays at 'arrayFreq'
+     */
+    std::vector<EventArray::Ptr> SimulateEvents(const std::string &topic,
+                                                double arrayFreq,
+                                                double sampleFreq);
+
+protected:
+    void CreateGroundTruthSplines(double st, double et);
+
+    void CreateScene(int landmarkNum);
+
+    // the ground-truth pose of the sensor (from the sensor to the world) at the time stamped by it
+    [[nodiscard]] std::optional<Sophus::SE3d> CurSenToW(const Sophus::SE3d &SE3_SenToBr,
+                                                        double TO_SenToBr,
+                                                        double timeBySen) const;
+
+    static double GaussianNoise(std::mt19937 &engine, double sigma);
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_SYNTHETIC_DATA_GENERATOR_H
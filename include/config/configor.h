@@ -46,7 +46,7 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 namespace ns_ikalibr {
 // myenumGenor OutputOption ParamInEachIter BSplines LiDARMaps VisualMaps RadarMaps HessianMat
 // VisualLiDARCovisibility VisualKinematics ColorizedLiDARMap AlignedInertialMes VisualReprojErrors
-// RadarDopplerErrors
+// RadarDopplerErrors ProfileReport
 enum class OutputOption : std::uint32_t {
     /**
      * @brief options
@@ -66,10 +66,80 @@ enum class OutputOption : std::uint32_t {
     RadarDopplerErrors = 1 << 12,
     VisualOpticalFlowErrors = 1 << 13,
     LiDARPointToSurfelErrors = 1 << 14,
+    // time and memory consumption of stages, see 'Profiler'
+    ProfileReport = 1 << 15,
     ALL = ParamInEachIter | BSplines | LiDARMaps | VisualMaps | RadarMaps | HessianMat |
           VisualLiDARCovisibility | VisualKinematics | ColorizedLiDARMap | AlignedInertialMes |
           VisualReprojErrors | RadarDopplerErrors | VisualOpticalFlowErrors |
-          LiDARPointToSurfelErrors
+          LiDARPointToSurfelErrors | ProfileReport
+};
+
+// myenumGenor SpeedUpOption ParallelDataLoading CalibDataCache AnalyticIMUFactor ParallelInitPrep
+// ParallelDataAssociation IncrementalDataAssociation MultiResolutionNDT CompactLiDARScans
+// InformativePointToSurfel ParallelSurfelMapBuild TiledLiDARMap WarmStartLiDAROdometry
+// PersistentEstimator AutoLinearSolver SlidingWindowOptimization ParallelProblemBuild
+enum class SpeedUpOption : std::uint32_t {
+    /**
+     * @brief options
+     */
+    NONE = 1 << 0,
+    // decode the ros bag in topic- and time-sharded chunks using multiple threads
+    ParallelDataLoading = 1 << 1,
+    // cache the adjusted calibration data to the output path, so that later runs on the same ros
+    // bag with the same data configure skip decoding (opt-in, as it writes large files to the disk)
+    CalibDataCache = 1 << 2,
+    // evaluate the inertial factors using hand-derived jacobians rather than automatic
+    // differentiation, the residuals are identical
+    AnalyticIMUFactor = 1 << 3,
+    // run the LiDAR odometers (one thread per LiDAR) beside the camera preparations of
+    // sensor-inertial alignments in the initialization, the estimators are still solved serially
+    ParallelInitPrep = 1 << 4,
+    // associate scans of LiDARs (and RGBDs) to the surfel map concurrently in the batch
+    // optimizations, the correspondences are identical
+    ParallelDataAssociation = 1 << 5,
+    // keep a persistent surfel map of LiDAR scans over batch optimizations, only scans moved under
+    // the updated splines are re-inserted and re-associated (approximate, changes the results)
+    IncrementalDataAssociation = 1 << 6,
+    // register scans in the ndt lidar odometers coarse to fine over a resolution pyramid, which
+    // widens the convergence basin and reduces iterations at the finest level (changes the results)
+    MultiResolutionNDT = 1 << 7,
+    // store raw lidar scans compactly (float relative point times, structure-of-arrays) once
+    // unpacked, scans are converted on demand, which cuts the memory of long sequences
+    CompactLiDARScans = 1 << 8,
+    // keep only the most informative point-to-surfel correspondences of each lidar scan (normal-
+    // and position-diverse ones), which cuts the residual blocks (changes the results)
+    InformativePointToSurfel = 1 << 9,
+    // build the surfel map of the global lidar map in parallel: points are partitioned by their
+    // octree key at a coarse depth, each partition is built as an independent sub-tree, and the
+    // leaf surfels of sub-trees are then merged into the global map
+    ParallelSurfelMapBuild = 1 << 10,
+    // build the global lidar map out of core: scans are merged into spatial tiles that are voxel
+    // down sampled ('MapDownSample') and spilled to the disk once filled, the surfel map and the
+    // saved map are consumed tile by tile (changes the results, as the map is down sampled)
+    TiledLiDARMap = 1 << 11,
+    // warm start the ndt odometer on undistorted scans in initialization using relative poses of
+    // the first odometer pass (on raw scans), or the motion of the last frame, as translation
+    // guesses, rather than zero translations (changes the results)
+    WarmStartLiDAROdometry = 1 << 12,
+    // keep one estimator alive over batch optimizations: inertial and radar residual blocks are
+    // added once and only toggled between stages, while association-dependent ones (lidar, visual,
+    // optical flow, and priori) are removed and re-added in each stage
+    PersistentEstimator = 1 << 13,
+    // choose the linear solver by the problem structure rather than always the dense schur one:
+    // sparse schur, iterative schur, or sparse normal cholesky for large problems, eliminating
+    // independent landmark blocks (e.g., inverse depths) first and then knots of splines
+    AutoLinearSolver = 1 << 14,
+    // optimize overlapping time windows of splines one by one in batch optimizations for long
+    // recordings, marginalizing leaving knots into a prior on spatiotemporal parameters
+    SlidingWindowOptimization = 1 << 15,
+    // create spline metas and cost functions of measurements in parallel, and then insert them to
+    // the problem in a final serial pass (the built problem is identical to the serial one)
+    ParallelProblemBuild = 1 << 16,
+    ALL = ParallelDataLoading | CalibDataCache | AnalyticIMUFactor | ParallelInitPrep |
+          ParallelDataAssociation | IncrementalDataAssociation | MultiResolutionNDT |
+          CompactLiDARScans | InformativePointToSurfel | ParallelSurfelMapBuild | TiledLiDARMap |
+          WarmStartLiDAROdometry | PersistentEstimator | AutoLinearSolver |
+          SlidingWindowOptimization | ParallelProblemBuild
 };
 
 struct Configor {
@@ -260,6 +330,11 @@ public:
         static double TimeOffsetPadding;
         static double ReadoutTimePadding;
         static double MapDownSample;
+        const static double MapTileSize;
+        const static std::size_t MapTilePointMax;
+        const static std::size_t MapInMemoryPointMax;
+        const static double SlidingWindowLength;
+        const static double SlidingWindowOverlap;
 
         static struct KnotTimeDist {
             static double SO3Spline;
@@ -276,6 +351,8 @@ public:
             static double Resolution;
             static double KeyFrameDownSample;
 
+            const static int PyramidLevels;
+
         public:
             template <class Archive>
             void serialize(Archive &ar) {
@@ -294,8 +371,12 @@ public:
             // 0.1, 0.2, 0.4, 0.8, 1.6, ...
             const static double MapResolution;
             const static std::uint8_t MapDepthLevels;
+            const static std::uint8_t MapPartitionDepth;
+            const static std::size_t ParallelMapBuildPointMin;
 
             const static int PointToSurfelCountInScan;
+            const static int InformativePointToSurfelCountInScan;
+            const static double ScanMovementMin;
 
         public:
             template <class Archive>
@@ -313,6 +394,9 @@ public:
         // the loss function used for rgbd velocity factor (pixel) (on the image pixel plane)
         const static double LossForOpticalFlowFactor;
 
+        // the position quantization resolution (m) of compact lidar scans, zero keeps floats
+        const static float CompactLiDARScanResolution;
+
     public:
         template <class Archive>
         void serialize(Archive &ar) {
@@ -327,6 +411,12 @@ public:
 
     static struct Preference {
         static bool UseCudaInSolving;
+        // the max dimension of the reduced (schur complement) system solved by dense and sparse
+        // factorizations respectively, used by the 'AutoLinearSolver' speed-up
+        const static int DenseSchurDimMax;
+        const static int SparseSchurDimMax;
+        // measurements fewer than this are added to the problem serially
+        const static int ParallelProblemBuildMin;
         static OutputOption Outputs;
         static std::set<std::string> OutputsStr;
         // str for file configuration, and enum for internal use
@@ -335,6 +425,9 @@ public:
         const static std::map<CerealArchiveType::Enum, std::string> FileExtension;
         static int ThreadsToUse;
 
+        static SpeedUpOption SpeedUps;
+        static std::set<std::string> SpeedUpsStr;
+
         const static std::string SO3_SPLINE, SCALE_SPLINE;
 
         // in visualizator
@@ -343,12 +436,26 @@ public:
 
         static int AvailableThreads();
 
+        /**
+         * threads available for a task in the current (possibly nested) parallel region, i.e.,
+         * 'AvailableThreads()' is shared by threads of all enclosing teams, to avoid
+         * oversubscription when parallel regions are nested
+         */
+        static int AvailableThreadsInRegion();
+
     public:
         template <class Archive>
         void serialize(Archive &ar) {
             ar(CEREAL_NVP(UseCudaInSolving), cereal::make_nvp("Outputs", OutputsStr),
-               cereal::make_nvp("OutputDataFormat", OutputDataFormatStr), CEREAL_NVP(ThreadsToUse),
-               CEREAL_NVP(SplineScaleInViewer), CEREAL_NVP(CoordSScaleInViewer));
+               cereal::make_nvp("OutputDataFormat", OutputDataFormatStr), CEREAL_NVP(ThreadsToUse));
+            // 'SpeedUps' is optional, configure files written before it was introduced are still
+            // loadable, and all speed-up options stay disabled for them
+            try {
+                ar(cereal::make_nvp("SpeedUps", SpeedUpsStr));
+            } catch (const cereal::Exception &) {
+                SpeedUpsStr.clear();
+            }
+            ar(CEREAL_NVP(SplineScaleInViewer), CEREAL_NVP(CoordSScaleInViewer));
         }
     } preference;
 
@@ -126,8 +126,12 @@ public:
         Circle CircleAt(double t) const { return {PosAt(t), RadiusAt(t)}; }
 
         double PointToCircleDistance(const Event::Ptr& event) const {
-            auto c = CircleAt(event->GetTimestamp());
-            return std::abs(c.second - (event->GetPos().cast<double>() - c.first).norm());
+            return PointToCircleDistance(event->GetTimestamp(), event->GetPos());
+        }
+
+        double PointToCircleDistance(double t, const Event::PosType& pos) const {
+            auto c = CircleAt(t);
+            return std::abs(c.second - (pos.cast<double>() - c.first).norm());
         }
 
         friend std::ostream& operator<<(std::ostream& os, const TimeVaryingCircle& obj) {
@@ -72,6 +72,9 @@ public:
 
     void GrabEvent(const Event::Ptr &event, bool drawEventMat = false);
 
+    void GrabEvent(
+        double et, std::uint16_t ex, std::uint16_t ey, bool ep, bool drawEventMat = false);
+
     void GrabEvent(const EventArray::Ptr &events, bool drawEventMat = false);
 
     [[nodiscard]] cv::Mat GetEventImgMat(bool resetMat, bool undistoMat = false);
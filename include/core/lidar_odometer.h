@@ -39,6 +39,7 @@
 #include "util/cloud_define.hpp"
 #include "ctraj/core/pose.hpp"
 #include "pclomp/ndt_omp.hpp"
+#include "optional"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -55,6 +56,7 @@ public:
 private:
     float _ndtResolution;
     int _threads;
+    int _pyramidLevels;
 
     // the key frame index in the '_frames'
     std::vector<std::size_t> _keyFrameIdx;
@@ -64,18 +66,27 @@ private:
     IKalibrPointCloud::Ptr _map;
     double _mapTime;
 
-    // ndt
+    // ndt (the finest level, i.e., the one with resolution '_ndtResolution')
     pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr _ndt;
+    // ndt pyramid from the coarsest level to the finest one ('_ndt'), each level owns its own
+    // voxel covariance grid and the resolution is doubled per level
+    std::vector<pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr> _ndtPyramid;
+    // leaf sizes to down sample sources of levels in '_ndtPyramid'
+    std::vector<float> _sourceLeafSizes;
 
     bool _initialized;
 
+    // the position and the yaw-pitch-roll of the last key frame
+    Eigen::Vector3d _lastKeyPos;
+    Eigen::Vector3d _lastKeyYPR;
+
     // pose sequence
     std::vector<ns_ctraj::Posed> _poseSeq;
 
 public:
-    LiDAROdometer(float ndtResolution, int threads);
+    LiDAROdometer(float ndtResolution, int threads, int pyramidLevels = 1);
 
-    static LiDAROdometer::Ptr Create(float ndtResolution, int threads);
+    static LiDAROdometer::Ptr Create(float ndtResolution, int threads, int pyramidLevels = 1);
 
     ns_ctraj::Posed FeedFrame(const LiDARFramePtr &frame,
                               const Eigen::Matrix4d &predCurToLast = Eigen::Matrix4d::Identity(),
@@ -99,12 +110,29 @@ public:
 
     [[nodiscard]] double GetMapTime() const;
 
+    /**
+     * obtain the relative pose between two frames fed to this odometer, which is used to warm
+     * start another odometer pass over (re-processed, e.g., undistorted) frames of the same scans
+     * @param lastTime the timestamp of the last frame
+     * @param curTime the timestamp of the current frame
+     * @return the transform from the current frame to the last one, 'std::nullopt' if not found
+     */
+    [[nodiscard]] std::optional<Eigen::Matrix4d> GetRelativePose(double lastTime,
+                                                                 double curTime) const;
+
 protected:
     bool CheckKeyFrame(const ns_ctraj::Posed &LtoM);
 
-    void UpdateMap(const LiDARFramePtr &frame, const ns_ctraj::Posed &LtoM);
+    /**
+     * @param sources the down sampled frames used as sources of levels in registration (empty if
+     * not registered), the one down sampled using '_ndtResolution' (keyed by '_sourceLeafSizes')
+     * is reused, otherwise the frame is down sampled here
+     */
+    void UpdateMap(const LiDARFramePtr &frame,
+                   const ns_ctraj::Posed &LtoM,
+                   const std::vector<IKalibrPointCloud::Ptr> &sources = {});
 
-    static void DownSampleCloud(const IKalibrPointCloud::Ptr &inCloud,
+    static void DownSampleCloud(const IKalibrPointCloud::ConstPtr &inCloud,
                                 const IKalibrPointCloud::Ptr &outCloud,
                                 float leafSize);
 };
@@ -0,0 +1,139 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_LIDAR_TILED_MAP_H
+#define IKALIBR_LIDAR_TILED_MAP_H
+
+#include "config/configor.h"
+#include "util/cloud_define.hpp"
+#include "array"
+#include "functional"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * an out-of-core global lidar map. Points are merged into cubic spatial tiles, a tile is spilled to
+ * the disk (as a chunk) once it's filled, or if too many points are kept in memory. Tiles keep the
+ * raw points (the surfel map is built from them), they are only voxel down sampled for viewing and
+ * saving. Tiles are consumed one by one, i.e., the whole map is never materialized unless
+ * 'ToCloud' is called
+ */
+class LiDARTiledMap {
+public:
+    using Ptr = std::shared_ptr<LiDARTiledMap>;
+    using TileKey = std::array<int, 3>;
+
+    struct Tile {
+        // points kept in memory
+        IKalibrPointCloud::Ptr cloud;
+        // number of chunks spilled to the disk
+        int chunks = 0;
+    };
+
+private:
+    double _tileSize;
+    float _leafSize;
+    std::size_t _tilePointMax;
+    std::size_t _inMemoryPointMax;
+
+    // the directory where chunks are spilled, which is removed on destruction
+    std::string _spillDir;
+
+    std::map<TileKey, Tile> _tiles;
+    std::size_t _inMemoryPoints;
+
+public:
+    LiDARTiledMap(double tileSize,
+                  float leafSize,
+                  std::size_t tilePointMax,
+                  std::size_t inMemoryPointMax);
+
+    static Ptr Create(double tileSize = Configor::Prior::MapTileSize,
+                      float leafSize = static_cast<float>(Configor::Prior::MapDownSample),
+                      std::size_t tilePointMax = Configor::Prior::MapTilePointMax,
+                      std::size_t inMemoryPointMax = Configor::Prior::MapInMemoryPointMax);
+
+    virtual ~LiDARTiledMap();
+
+    /**
+     * merge (valid) points of a cloud expressed in the world frame to tiles
+     */
+    void Insert(const IKalibrPointCloud::ConstPtr &cloudInW);
+
+    [[nodiscard]] std::vector<TileKey> GetTileKeys() const;
+
+    /**
+     * load a tile (both its spilled chunks and the in-memory points)
+     * @param downSample whether down sample the raw points of the tile
+     */
+    [[nodiscard]] IKalibrPointCloud::Ptr LoadTile(const TileKey &key,
+                                                  bool downSample = false) const;
+
+    /**
+     * visit tiles one by one, only one tile is loaded at a time
+     * @param downSample whether down sample the raw points of tiles
+     */
+    void ForEachTile(
+        const std::function<void(const TileKey &, const IKalibrPointCloud::Ptr &)> &func,
+        bool downSample = false) const;
+
+    /**
+     * assemble the whole (down sampled) map, only for consumers that require the whole map
+     */
+    [[nodiscard]] IKalibrPointCloud::Ptr ToCloud() const;
+
+    /**
+     * save (down sampled) tiles as pcd files named by their keys to the directory
+     * @return the number of tiles saved
+     */
+    std::size_t SaveTiles(const std::string &dir) const;
+
+    static std::string TileName(const TileKey &key);
+
+protected:
+    [[nodiscard]] TileKey KeyOf(const IKalibrPoint &p) const;
+
+    [[nodiscard]] IKalibrPointCloud::Ptr DownSample(const IKalibrPointCloud::Ptr &cloud) const;
+
+    [[nodiscard]] std::string ChunkFilename(const TileKey &key, int chunk) const;
+
+    void Spill(const TileKey &key, Tile &tile);
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_LIDAR_TILED_MAP_H
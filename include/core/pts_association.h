@@ -48,6 +48,8 @@ namespace ns_ikalibr {
 
 struct PointToSurfelCorr;
 using PointToSurfelCorrPtr = std::shared_ptr<PointToSurfelCorr>;
+class LiDARTiledMap;
+using LiDARTiledMapPtr = std::shared_ptr<LiDARTiledMap>;
 
 struct PointToSurfelCondition {
     double pointToSurfelMax;
@@ -86,11 +88,37 @@ public:
                                      double resolution,
                                      std::uint8_t depth);
 
+    /**
+     * build the surfel map from an out-of-core tiled map, tiles (raw points, as the dense map
+     * used by the other constructor) are loaded and inserted one by one
+     */
+    explicit PointToSurfelAssociator(const LiDARTiledMapPtr &tiledMapInW,
+                                     double resolution,
+                                     std::uint8_t depth);
+
     static Ptr Create(const IKalibrPointCloud::Ptr &mapInW, double resolution, std::uint8_t depth);
 
-    std::vector<PointToSurfelCorrPtr> Association(const IKalibrPointCloud::Ptr &mapCloud,
-                                                  const IKalibrPointCloud::Ptr &rawCloud,
-                                                  const PointToSurfelCondition &condition);
+    static Ptr Create(const LiDARTiledMapPtr &tiledMapInW, double resolution, std::uint8_t depth);
+
+    std::vector<PointToSurfelCorrPtr> Association(const IKalibrPointCloud::ConstPtr &mapCloud,
+                                                  const IKalibrPointCloud::ConstPtr &rawCloud,
+                                                  const PointToSurfelCondition &condition) const;
+
+    /**
+     * insert (valid) points of a cloud expressed in the world frame to the surfel map
+     */
+    void InsertCloud(const IKalibrPointCloud::ConstPtr &cloudInW);
+
+    /**
+     * erase points of a cloud previously inserted by 'InsertCloud' from the surfel map
+     */
+    void EraseCloud(const IKalibrPointCloud::ConstPtr &cloudInW);
+
+    /**
+     * the code of the voxel (of the given depth) containing the point, which is derived by the
+     * coder of the surfel map, thus is consistent with the nodes queried in association
+     */
+    [[nodiscard]] ufo::map::Code VoxelCode(float x, float y, float z, std::uint8_t depth) const;
 
     static double SurfelScore(const ufo::map::SurfelMap &m, const ufo::map::Node &n);
 
@@ -116,8 +144,16 @@ protected:
             ufoCloud[i].z = pclCloud.points[i].z;
         }
 
-        map.insertSurfelPoint(std::begin(ufoCloud), std::end(ufoCloud));
+        InsertPointsToSurfelMap(map, ufoCloud);
     }
+
+    /**
+     * insert points to the surfel map, if 'ParallelSurfelMapBuild' is enabled, points would be
+     * partitioned by their octree key at depth 'MapPartitionDepth', sub-trees of partitions are
+     * built independently on worker threads, and their leaf surfels are merged into the map
+     */
+    static void InsertPointsToSurfelMap(ufo::map::SurfelMap &map,
+                                        const ufo::map::PointCloud &ufoCloud);
 };
 }  // namespace ns_ikalibr
 #endif  // IKALIBR_PTS_ASSOCIATION_H
@@ -37,6 +37,7 @@
 
 #include "config/configor.h"
 #include "ctraj/core/spline_bundle.h"
+#include "util/cloud_define.hpp"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -85,14 +86,35 @@ public:
                                               const std::string &topic,
                                               Option option);
 
+    /**
+     * undistort a single frame to the reference (world) frame, which is thread-safe, so that
+     * frames can be streamed rather than being undistorted (and kept) all at once
+     */
+    std::optional<LiDARFramePtr> UndistortToRef(const LiDARFramePtr &lidarFrame,
+                                                const std::string &topic,
+                                                bool correctPos);
+
 protected:
     std::optional<LiDARFramePtr> UndistortToScan(const LiDARFramePtr &lidarFrame,
                                                  const std::string &topic,
                                                  bool correctPos);
 
-    std::optional<LiDARFramePtr> UndistortToRef(const LiDARFramePtr &lidarFrame,
-                                                const std::string &topic,
-                                                bool correctPos);
+    /**
+     * undistort frames concurrently using the given single-frame undistorter
+     */
+    static std::vector<LiDARFramePtr> UndistortFrames(
+        const std::vector<LiDARFramePtr> &data,
+        const std::function<std::optional<LiDARFramePtr>(const LiDARFramePtr &)> &undistorter);
+
+    /**
+     * undistort points of a raw scan to the target frame, points sharing the same timestamp are
+     * transformed together using the pose evaluated once
+     * @param SE3_WToTar the transformation from the world frame to the target frame
+     */
+    IKalibrPointCloud::Ptr UndistortScan(const IKalibrPointCloud::ConstPtr &rawScan,
+                                         const std::string &topic,
+                                         bool correctPos,
+                                         const Sophus::SE3d &SE3_WToTar) const;
 };
 }  // namespace ns_ikalibr
 
@@ -0,0 +1,109 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_SPLINE_POSE_CACHE_H
+#define IKALIBR_SPLINE_POSE_CACHE_H
+
+#include "atomic"
+#include "config/configor.h"
+#include "ctraj/core/spline_bundle.h"
+#include "optional"
+#include "shared_mutex"
+#include "unordered_map"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * memoizing pose queries (reference imu to world) on the so3 and position splines. Control points
+ * of splines are changed in place by the ceres solver, thus the owner of splines should call
+ * 'SplinesChanged' once they are modified, which invalidates all caches
+ */
+class SplinePoseCache {
+public:
+    using Ptr = std::shared_ptr<SplinePoseCache>;
+    using SplineBundleType = ns_ctraj::SplineBundle<Configor::Prior::SplineOrder>;
+
+private:
+    const SplineBundleType::So3SplineType &_so3Spline;
+    const SplineBundleType::RdSplineType &_posSpline;
+
+    // the max count of cached poses, the cache is cleared once it's full
+    std::size_t _capacity;
+
+    // the epoch of splines when the cached poses were evaluated
+    std::uint64_t _epoch;
+    std::unordered_map<double, std::optional<Sophus::SE3d>> _cache;
+    mutable std::shared_mutex _mutex;
+
+    // increased every time splines are changed
+    static std::atomic<std::uint64_t> SplineEpoch;
+
+public:
+    SplinePoseCache(const SplineBundleType::Ptr &splines, std::size_t capacity);
+
+    static Ptr Create(const SplineBundleType::Ptr &splines, std::size_t capacity = 1 << 18);
+
+    /**
+     * invalidate poses in all caches, call this once control points of splines are changed
+     */
+    static void SplinesChanged();
+
+    /**
+     * obtain the pose of the reference imu at the given time
+     * @param timeByBr the time stamped by the reference imu
+     * @return the pose, 'std::nullopt' if the time is out of range of splines
+     */
+    std::optional<Sophus::SE3d> BrToW(double timeByBr);
+
+    /**
+     * obtain poses of the reference imu at a sequence of times, times are sorted and deduplicated
+     * so that each distinct time is evaluated (or looked up) only once
+     * @param timesByBr the times stamped by the reference imu
+     * @return the poses in the order of 'timesByBr'
+     */
+    std::vector<std::optional<Sophus::SE3d>> BrToW(const std::vector<double> &timesByBr);
+
+protected:
+    std::optional<Sophus::SE3d> Evaluate(double timeByBr) const;
+
+    // clear the cache if splines have been changed, requires the unique lock
+    void SyncEpoch();
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_SPLINE_POSE_CACHE_H
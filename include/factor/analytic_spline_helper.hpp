@@ -0,0 +1,275 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
+#define IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
+
+#include "ctraj/utils/eigen_utils.hpp"
+#include "ctraj/utils/sophus_utils.hpp"
+#include "util/utils.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * closed-form evaluation of uniform (cumulative) b-splines together with the jacobians of the
+ * evaluated quantities with respect to the control points, used by hand-derived cost functions.
+ * the rotation control points are perturbed on the left, i.e., 'knot <- Exp(phi) * knot', which
+ * is consistent with 'ceres::EigenQuaternionManifold' up to the factor handled in
+ * 'LiftToQuaternionJacobian'.
+ */
+template <int Order>
+struct AnalyticSplineHelper {
+public:
+    static constexpr int N = Order;
+    static constexpr int DEG = Order - 1;
+
+    using MatN = Eigen::Matrix<double, N, N>;
+    using VecN = Eigen::Matrix<double, N, 1>;
+    using Mat3 = Eigen::Matrix3d;
+    using Vec3 = Eigen::Vector3d;
+
+    struct LieEvaluation {
+        // rotation, body-frame angular velocity, acceleration and jerk
+        Sophus::SO3d rot;
+        Vec3 vel, acce, jerk;
+        // 'rot' is perturbed on the right, i.e., 'rot <- rot * Exp(jRot[i] * phi_i)'
+        std::array<Mat3, N> jRot, jVel, jAcce;
+
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+public:
+    static const MatN &BlendingMatrix() {
+        static const MatN mat = ComputeBlendingMatrix(false);
+        return mat;
+    }
+
+    static const MatN &CumulativeBlendingMatrix() {
+        static const MatN mat = ComputeBlendingMatrix(true);
+        return mat;
+    }
+
+    /**
+     * the 'Deriv'-order time derivative of [1, u, u^2, ..., u^(N-1)]
+     */
+    template <int Deriv>
+    static VecN BaseCoeffsWithTime(double u) {
+        VecN res = VecN::Zero();
+        if constexpr (Deriv < N) {
+            for (int i = Deriv; i < N; ++i) {
+                double coeff = 1.0;
+                for (int j = 0; j < Deriv; ++j) {
+                    coeff *= static_cast<double>(i - j);
+                }
+                res(i) = coeff * std::pow(u, i - Deriv);
+            }
+        }
+        return res;
+    }
+
+    /**
+     * blending weights of the 'Deriv'-order time derivative of a Rd spline
+     */
+    template <int Deriv>
+    static VecN RdWeights(double u, double dtInv) {
+        return std::pow(dtInv, Deriv) * BlendingMatrix() * BaseCoeffsWithTime<Deriv>(u);
+    }
+
+    template <int Dime>
+    static Eigen::Matrix<double, Dime, 1> EvaluateRd(double const *const *sKnots,
+                                                     const VecN &weights) {
+        Eigen::Matrix<double, Dime, 1> res = Eigen::Matrix<double, Dime, 1>::Zero();
+        for (int i = 0; i < N; ++i) {
+            res += weights(i) * Eigen::Map<const Eigen::Matrix<double, Dime, 1>>(sKnots[i]);
+        }
+        return res;
+    }
+
+    /**
+     * evaluate the so3 spline, jacobians are computed only if 'withJacobians' is true
+     */
+    static void EvaluateLie(double const *const *sKnots,
+                            double u,
+                            double dtInv,
+                            LieEvaluation *res,
+                            bool withJacobians) {
+        const VecN coeff = CumulativeBlendingMatrix() * BaseCoeffsWithTime<0>(u);
+        const VecN dCoeff = dtInv * CumulativeBlendingMatrix() * BaseCoeffsWithTime<1>(u);
+        const VecN ddCoeff =
+            dtInv * dtInv * CumulativeBlendingMatrix() * BaseCoeffsWithTime<2>(u);
+        const VecN dddCoeff =
+            dtInv * dtInv * dtInv * CumulativeBlendingMatrix() * BaseCoeffsWithTime<3>(u);
+
+        Eigen::Map<const Sophus::SO3d> const p0(sKnots[0]);
+
+        res->rot = p0;
+        res->vel.setZero(), res->acce.setZero(), res->jerk.setZero();
+        if (withJacobians) {
+            for (int i = 0; i < N; ++i) {
+                res->jRot[i].setZero(), res->jVel[i].setZero(), res->jAcce[i].setZero();
+            }
+            res->jRot[0] = p0.matrix().transpose();
+        }
+
+        for (int j = 1; j < N; ++j) {
+            Eigen::Map<const Sophus::SO3d> const pLast(sKnots[j - 1]);
+            Eigen::Map<const Sophus::SO3d> const pCur(sKnots[j]);
+
+            const Vec3 delta = (pLast.inverse() * pCur).log();
+            const Sophus::SO3d expKDelta = Sophus::SO3d::exp(coeff(j) * delta);
+            const Mat3 adj = expKDelta.inverse().matrix();
+
+            const Vec3 velLast = adj * res->vel, acceLast = adj * res->acce;
+            const Vec3 velCur = dCoeff(j) * delta, acceCur = ddCoeff(j) * delta;
+
+            res->rot *= expKDelta;
+            res->vel = velLast + velCur;
+            res->acce = acceLast + acceCur + res->vel.cross(velCur);
+            res->jerk = adj * res->jerk + dddCoeff(j) * delta + 2.0 * res->acce.cross(velCur) +
+                        res->vel.cross(acceCur) + velCur.cross(res->vel.cross(velCur));
+
+            if (!withJacobians) {
+                continue;
+            }
+
+            // propagate the jacobians of the former control points
+            for (int i = 0; i < j; ++i) {
+                res->jRot[i] = adj * res->jRot[i];
+                res->jVel[i] = adj * res->jVel[i];
+            }
+            // jacobians of 'delta' with respect to the last and current control points
+            const Mat3 jDeltaCur = RightJacobianInv(delta) * pCur.matrix().transpose();
+            const Mat3 jExpKDelta = coeff(j) * RightJacobian(coeff(j) * delta);
+            const Mat3 velLastHat = Sophus::SO3d::hat(velLast);
+
+            for (const auto &[i, jDelta] : {std::pair<int, Mat3>(j - 1, -jDeltaCur),
+                                            std::pair<int, Mat3>(j, jDeltaCur)}) {
+                const Mat3 jExp = jExpKDelta * jDelta;
+                res->jRot[i] += jExp;
+                res->jVel[i] += velLastHat * jExp + dCoeff(j) * jDelta;
+                res->jAcce[i] = adj * res->jAcce[i] + Sophus::SO3d::hat(acceLast) * jExp +
+                                ddCoeff(j) * jDelta +
+                                Sophus::SO3d::hat(res->vel) * dCoeff(j) * jDelta;
+            }
+            const Mat3 velCurHat = Sophus::SO3d::hat(velCur);
+            for (int i = 0; i <= j; ++i) {
+                if (i < j - 1) {
+                    res->jAcce[i] = adj * res->jAcce[i];
+                }
+                res->jAcce[i] -= velCurHat * res->jVel[i];
+            }
+        }
+    }
+
+    /**
+     * 'ceres::EigenQuaternionManifold' updates a quaternion as 'q <- [delta, 1] * q', i.e., a left
+     * perturbation with rotation vector '2 * delta', and its plus jacobian has orthonormal columns,
+     * thus an ambient jacobian reproducing the given local one is 'jLocal * 2 * plusJac^T'
+     */
+    template <int Rows>
+    static Eigen::Matrix<double, Rows, 4> LiftToQuaternionJacobian(
+        const Eigen::Matrix<double, Rows, 3> &jLocal, const double *q) {
+        const double x = q[0], y = q[1], z = q[2], w = q[3];
+        Eigen::Matrix<double, 4, 3> plusJac;
+        plusJac << w, z, -y,  // x
+            -z, w, x,         // y
+            y, -x, w,         // z
+            -x, -y, -z;       // w
+        return 2.0 * jLocal * plusJac.transpose();
+    }
+
+    static Mat3 RightJacobian(const Vec3 &phi) {
+        const double theta2 = phi.squaredNorm();
+        const Mat3 phiHat = Sophus::SO3d::hat(phi);
+        if (theta2 < 1E-10) {
+            return Mat3::Identity() - 0.5 * phiHat;
+        }
+        const double theta = std::sqrt(theta2);
+        return Mat3::Identity() - (1.0 - std::cos(theta)) / theta2 * phiHat +
+               (theta - std::sin(theta)) / (theta2 * theta) * phiHat * phiHat;
+    }
+
+    static Mat3 RightJacobianInv(const Vec3 &phi) {
+        const double theta2 = phi.squaredNorm();
+        const Mat3 phiHat = Sophus::SO3d::hat(phi);
+        if (theta2 < 1E-10) {
+            return Mat3::Identity() + 0.5 * phiHat;
+        }
+        const double theta = std::sqrt(theta2);
+        return Mat3::Identity() + 0.5 * phiHat +
+               (1.0 / theta2 - (1.0 + std::cos(theta)) / (2.0 * theta * std::sin(theta))) *
+                   phiHat * phiHat;
+    }
+
+protected:
+    static MatN ComputeBlendingMatrix(bool cumulative) {
+        auto Binomial = [](int n, int k) {
+            double res = 1.0;
+            for (int i = 1; i <= k; ++i) {
+                res = res * static_cast<double>(n - k + i) / static_cast<double>(i);
+            }
+            return res;
+        };
+        MatN m = MatN::Zero();
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                double sum = 0.0;
+                for (int s = j; s < N; ++s) {
+                    sum += std::pow(-1.0, s - j) * Binomial(N, s - j) *
+                           std::pow(N - s - 1.0, N - 1.0 - i);
+                }
+                m(j, i) = Binomial(N - 1, N - 1 - i) * sum;
+            }
+        }
+        if (cumulative) {
+            for (int i = 0; i < N; ++i) {
+                for (int j = i + 1; j < N; ++j) {
+                    m.row(i) += m.row(j);
+                }
+            }
+        }
+        double factorial = 1.0;
+        for (int i = 2; i < N; ++i) {
+            factorial *= i;
+        }
+        return m / factorial;
+    }
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_ANALYTIC_SPLINE_HELPER_HPP
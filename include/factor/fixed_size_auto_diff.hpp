@@ -0,0 +1,118 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_FIXED_SIZE_AUTO_DIFF_HPP
+#define IKALIBR_FIXED_SIZE_AUTO_DIFF_HPP
+
+#include "ceres/autodiff_cost_function.h"
+#include "util/utils.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+template <int... Is>
+using IntSeq = std::integer_sequence<int, Is...>;
+
+template <class... Seqs>
+struct ConcatIntSeq;
+
+template <int... As>
+struct ConcatIntSeq<IntSeq<As...>> {
+    using Type = IntSeq<As...>;
+};
+
+template <int... As, int... Bs, class... Rest>
+struct ConcatIntSeq<IntSeq<As...>, IntSeq<Bs...>, Rest...> {
+    using Type = typename ConcatIntSeq<IntSeq<As..., Bs...>, Rest...>::Type;
+};
+
+template <int Value, int Count>
+struct RepeatIntSeq {
+    using Type =
+        typename ConcatIntSeq<IntSeq<Value>, typename RepeatIntSeq<Value, Count - 1>::Type>::Type;
+};
+
+template <int Value>
+struct RepeatIntSeq<Value, 0> {
+    using Type = IntSeq<>;
+};
+
+/**
+ * adapts a functor written for 'ceres::DynamicAutoDiffCostFunction', i.e., taking
+ * 'T const *const *params', to the separated-argument form required by the fixed-size
+ * 'ceres::AutoDiffCostFunction', the adaptor takes the ownership of the functor
+ */
+template <class Functor>
+struct FixedSizeAutoDiffAdaptor {
+private:
+    std::unique_ptr<Functor> _functor;
+
+public:
+    explicit FixedSizeAutoDiffAdaptor(Functor *functor)
+        : _functor(functor) {}
+
+    template <class... Args>
+    bool operator()(Args... args) const {
+        // the last argument is the residual array
+        constexpr std::size_t ParamBlockNum = sizeof...(Args) - 1;
+        using T = std::remove_pointer_t<std::tuple_element_t<ParamBlockNum, std::tuple<Args...>>>;
+        return Invoke<T>(std::forward_as_tuple(args...),
+                         std::make_index_sequence<ParamBlockNum>());
+    }
+
+protected:
+    template <class T, class Tuple, std::size_t... Is>
+    bool Invoke(const Tuple &args, std::index_sequence<Is...>) const {
+        const T *params[] = {std::get<Is>(args)...};
+        return (*_functor)(params, std::get<sizeof...(Is)>(args));
+    }
+};
+
+template <class Functor, int NumResiduals, class BlockSizeSeq>
+struct FixedSizeAutoDiffCostFunction;
+
+template <class Functor, int NumResiduals, int... BlockSizes>
+struct FixedSizeAutoDiffCostFunction<Functor, NumResiduals, IntSeq<BlockSizes...>> {
+    using Type =
+        ceres::AutoDiffCostFunction<FixedSizeAutoDiffAdaptor<Functor>, NumResiduals, BlockSizes...>;
+
+    static Type *Create(Functor *functor) {
+        return new Type(new FixedSizeAutoDiffAdaptor<Functor>(functor));
+    }
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_FIXED_SIZE_AUTO_DIFF_HPP
@@ -41,6 +41,8 @@
 #include "ctraj/spline/ceres_spline_helper.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "ceres/dynamic_cost_function.h"
+#include "factor/analytic_spline_helper.hpp"
 #include "sensor/imu.h"
 #include "util/utils.h"
 #include "config/configor.h"
@@ -167,8 +169,216 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * the analytic-jacobian counterpart of 'IMUAcceFactor', with identical parameter blocks and
+ * residuals, jacobians of quaternion blocks are given in the ambient space that is consistent with
+ * 'ceres::EigenQuaternionManifold'
+ */
+template <int Order, int TimeDeriv>
+struct IMUAcceAnalyticFactor : public ceres::DynamicCostFunction {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta, _scaleMeta;
+    IMUFrame::Ptr _imuFrame{};
+
+    double _so3DtInv, _scaleDtInv;
+    double _weight;
+
+public:
+    explicit IMUAcceAnalyticFactor(ns_ctraj::SplineMeta<Order> rotMeta,
+                                   ns_ctraj::SplineMeta<Order> linScaleMeta,
+                                   IMUFrame::Ptr imuFrame,
+                                   double weight)
+        : _so3Meta(std::move(rotMeta)),
+          _scaleMeta(std::move(linScaleMeta)),
+          _imuFrame(std::move(imuFrame)),
+          _so3DtInv(1.0 / _so3Meta.segments.front().dt),
+          _scaleDtInv(1.0 / _scaleMeta.segments.front().dt),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &rotMeta,
+                       const ns_ctraj::SplineMeta<Order> &linScaleMeta,
+                       const IMUFrame::Ptr &imuFrame,
+                       double weight) {
+        return new IMUAcceAnalyticFactor(rotMeta, linScaleMeta, imuFrame, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUAcceAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | LIN_SCALE | ... | LIN_SCALE | ACCE_BIAS | ACCE_MAP_COEFF | GRAVITY |
+     *   SO3_BiToBr | POS_BiInBr | TO_BiToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        const std::size_t SO3_NUM = _so3Meta.NumParameters();
+        const std::size_t LIN_SCALE_NUM = _scaleMeta.NumParameters();
+
+        const std::size_t ACCE_BIAS_OFFSET = SO3_NUM + LIN_SCALE_NUM;
+        const std::size_t ACCE_MAP_COEFF_OFFSET = ACCE_BIAS_OFFSET + 1;
+        const std::size_t GRAVITY_OFFSET = ACCE_MAP_COEFF_OFFSET + 1;
+        const std::size_t SO3_BiToBr_OFFSET = GRAVITY_OFFSET + 1;
+        const std::size_t POS_BiInBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+        const std::size_t TO_BiToBr_OFFSET = POS_BiInBr_OFFSET + 1;
+
+        // get value
+        Eigen::Map<const Sophus::SO3d> const SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> POS_BiInBr(sKnots[POS_BiInBr_OFFSET]);
+        const double TO_BiToBr = sKnots[TO_BiToBr_OFFSET][0];
+
+        const double timeByBr = _imuFrame->GetTimestamp() + TO_BiToBr;
+
+        // calculate the so3 and lin scale offset
+        std::pair<std::size_t, double> iuSo3, iuScale;
+        _so3Meta.ComputeSplineIndex(timeByBr, iuSo3.first, iuSo3.second);
+        _scaleMeta.ComputeSplineIndex(timeByBr, iuScale.first, iuScale.second);
+
+        const std::size_t SO3_OFFSET = iuSo3.first;
+        const std::size_t LIN_SCALE_OFFSET = iuScale.first + SO3_NUM;
+
+        typename Helper::LieEvaluation so3;
+        Helper::EvaluateLie(sKnots + SO3_OFFSET, iuSo3.second, _so3DtInv, &so3,
+                            sJacobians != nullptr);
+
+        const auto scaleWeights =
+            Helper::template RdWeights<TimeDeriv>(iuScale.second, _scaleDtInv);
+        const Eigen::Vector3d ACCE_BrToBr0InBr0 =
+            Helper::template EvaluateRd<3>(sKnots + LIN_SCALE_OFFSET, scaleWeights);
+
+        Eigen::Map<const Eigen::Vector3d> acceBias(sKnots[ACCE_BIAS_OFFSET]);
+        Eigen::Map<const Eigen::Vector3d> gravity(sKnots[GRAVITY_OFFSET]);
+
+        const double *acceCoeff = sKnots[ACCE_MAP_COEFF_OFFSET];
+        Eigen::Matrix3d acceMapMat = Eigen::Matrix3d::Zero();
+        acceMapMat.diagonal() = Eigen::Map<const Eigen::Vector3d>(acceCoeff, 3);
+        acceMapMat(0, 1) = *(acceCoeff + 3);
+        acceMapMat(0, 2) = *(acceCoeff + 4);
+        acceMapMat(1, 2) = *(acceCoeff + 5);
+
+        /**
+         * the specific force expressed in the reference imu frame:
+         * f = R^T * (a - g) + (hat(alpha) + hat(omega)^2) * p
+         * where 'R', 'omega' and 'alpha' are the rotation, body-frame angular velocity and
+         * acceleration of the reference imu, 'p' is the position of the imu in the reference one
+         */
+        const Eigen::Matrix3d SO3_Br0ToBr = so3.rot.inverse().matrix();
+        const Eigen::Matrix3d SO3_BrToBi = SO3_BiToBr.inverse().matrix();
+        const Eigen::Matrix3d velHat = Sophus::SO3d::hat(so3.vel);
+        const Eigen::Matrix3d acceHat = Sophus::SO3d::hat(so3.acce);
+        const Eigen::Matrix3d leverMat = acceHat + velHat * velHat;
+
+        const Eigen::Vector3d linAcceInBr = SO3_Br0ToBr * (ACCE_BrToBr0InBr0 - gravity);
+        const Eigen::Vector3d forceInBr = linAcceInBr + leverMat * POS_BiInBr;
+        const Eigen::Vector3d forceInBi = SO3_BrToBi * forceInBr;
+
+        Eigen::Map<Eigen::Vector3d> residuals(sResiduals);
+        residuals = _weight * (acceMapMat * forceInBi + acceBias - _imuFrame->GetAcce());
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        // d(residuals) / d(forceInBr)
+        const Eigen::Matrix3d jForceInBr = _weight * acceMapMat * SO3_BrToBi;
+
+        // so3 knots
+        const Eigen::Matrix3d posHat = Sophus::SO3d::hat(POS_BiInBr);
+        const Eigen::Matrix3d jLinAcceRot = jForceInBr * Sophus::SO3d::hat(linAcceInBr);
+        const Eigen::Matrix3d jVel =
+            -jForceInBr * (Sophus::SO3d::hat(so3.vel.cross(POS_BiInBr)) + velHat * posHat);
+        const Eigen::Matrix3d jAcce = -jForceInBr * posHat;
+        for (std::size_t i = 0; i < SO3_NUM; ++i) {
+            if (sJacobians[i] == nullptr) {
+                continue;
+            }
+            Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jKnot(sJacobians[i]);
+            if (i < SO3_OFFSET || i >= SO3_OFFSET + Order) {
+                jKnot.setZero();
+            } else {
+                const std::size_t k = i - SO3_OFFSET;
+                const Eigen::Matrix3d jLocal =
+                    jLinAcceRot * so3.jRot[k] + jVel * so3.jVel[k] + jAcce * so3.jAcce[k];
+                jKnot = Helper::template LiftToQuaternionJacobian<3>(jLocal, sKnots[i]);
+            }
+        }
+
+        // lin scale knots
+        const Eigen::Matrix3d jLinAcce = jForceInBr * SO3_Br0ToBr;
+        for (std::size_t i = SO3_NUM; i < SO3_NUM + LIN_SCALE_NUM; ++i) {
+            if (sJacobians[i] == nullptr) {
+                continue;
+            }
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jKnot(sJacobians[i]);
+            if (i < LIN_SCALE_OFFSET || i >= LIN_SCALE_OFFSET + Order) {
+                jKnot.setZero();
+            } else {
+                jKnot = scaleWeights(i - LIN_SCALE_OFFSET) * jLinAcce;
+            }
+        }
+
+        if (auto j = sJacobians[ACCE_BIAS_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jBlock(j);
+            jBlock = _weight * Eigen::Matrix3d::Identity();
+        }
+
+        if (auto j = sJacobians[ACCE_MAP_COEFF_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 6, Eigen::RowMajor>> jCoeff(j);
+            jCoeff.setZero();
+            jCoeff(0, 0) = forceInBi(0), jCoeff(1, 1) = forceInBi(1), jCoeff(2, 2) = forceInBi(2);
+            jCoeff(0, 3) = forceInBi(1), jCoeff(0, 4) = forceInBi(2), jCoeff(1, 5) = forceInBi(2);
+            jCoeff *= _weight;
+        }
+
+        if (auto j = sJacobians[GRAVITY_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jBlock(j);
+            jBlock = -jLinAcce;
+        }
+
+        if (auto j = sJacobians[SO3_BiToBr_OFFSET]; j != nullptr) {
+            const Eigen::Matrix3d jLocal = jForceInBr * Sophus::SO3d::hat(forceInBr);
+            Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jBlock(j);
+            jBlock =
+                Helper::template LiftToQuaternionJacobian<3>(jLocal, sKnots[SO3_BiToBr_OFFSET]);
+        }
+
+        if (auto j = sJacobians[POS_BiInBr_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jBlock(j);
+            jBlock = jForceInBr * leverMat;
+        }
+
+        if (auto j = sJacobians[TO_BiToBr_OFFSET]; j != nullptr) {
+            // time derivative of the specific force, the jerk of the linear scale spline vanishes
+            // if its order is not enough
+            const auto scaleDotWeights =
+                Helper::template RdWeights<TimeDeriv + 1>(iuScale.second, _scaleDtInv);
+            const Eigen::Vector3d ACCE_DOT_BrToBr0InBr0 =
+                Helper::template EvaluateRd<3>(sKnots + LIN_SCALE_OFFSET, scaleDotWeights);
+            const Eigen::Matrix3d leverDotMat =
+                Sophus::SO3d::hat(so3.jerk) + acceHat * velHat + velHat * acceHat;
+            const Eigen::Vector3d forceDotInBr = -velHat * linAcceInBr +
+                                                 SO3_Br0ToBr * ACCE_DOT_BrToBr0InBr0 +
+                                                 leverDotMat * POS_BiInBr;
+            Eigen::Map<Eigen::Vector3d> jBlock(j);
+            jBlock = jForceInBr * forceDotInBr;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 1>;
 extern template struct IMUAcceFactor<Configor::Prior::SplineOrder, 0>;
+
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+extern template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 0>;
 }  // namespace ns_ikalibr
 #endif  // IKALIBR_IMU_ACCE_FACTOR_HPP
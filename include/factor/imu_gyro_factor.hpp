@@ -40,6 +40,8 @@
 #include "ctraj/spline/spline_segment.h"
 #include "ctraj/spline/ceres_spline_helper_jet.h"
 #include "ceres/dynamic_autodiff_cost_function.h"
+#include "ceres/dynamic_cost_function.h"
+#include "factor/analytic_spline_helper.hpp"
 #include "sensor/imu.h"
 #include "util/utils.h"
 #include "config/configor.h"
@@ -131,7 +133,147 @@ public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * the analytic-jacobian counterpart of 'IMUGyroFactor', with identical parameter blocks and
+ * residuals, jacobians of quaternion blocks are given in the ambient space that is consistent with
+ * 'ceres::EigenQuaternionManifold'
+ */
+template <int Order>
+struct IMUGyroAnalyticFactor : public ceres::DynamicCostFunction {
+private:
+    using Helper = AnalyticSplineHelper<Order>;
+
+    ns_ctraj::SplineMeta<Order> _so3Meta;
+    IMUFrame::Ptr _frame{};
+
+    double _so3DtInv;
+    double _weight;
+
+public:
+    explicit IMUGyroAnalyticFactor(ns_ctraj::SplineMeta<Order> so3Meta,
+                                   IMUFrame::Ptr frame,
+                                   double weight)
+        : _so3Meta(std::move(so3Meta)),
+          _frame(std::move(frame)),
+          _so3DtInv(1.0 / _so3Meta.segments.front().dt),
+          _weight(weight) {}
+
+    static auto Create(const ns_ctraj::SplineMeta<Order> &so3Meta,
+                       const IMUFrame::Ptr &frame,
+                       double weight) {
+        return new IMUGyroAnalyticFactor(so3Meta, frame, weight);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(IMUGyroAnalyticFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr | TO_BiToBr ]
+     */
+    bool Evaluate(double const *const *sKnots,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        // array offset
+        const std::size_t SO3_NUM = _so3Meta.NumParameters();
+        const std::size_t GYRO_BIAS_OFFSET = SO3_NUM;
+        const std::size_t GYRO_MAP_COEFF_OFFSET = GYRO_BIAS_OFFSET + 1;
+        const std::size_t SO3_AtoG_OFFSET = GYRO_MAP_COEFF_OFFSET + 1;
+        const std::size_t SO3_BiToBr_OFFSET = SO3_AtoG_OFFSET + 1;
+        const std::size_t TO_BiToBr_OFFSET = SO3_BiToBr_OFFSET + 1;
+
+        const double TO_BiToBr = sKnots[TO_BiToBr_OFFSET][0];
+        const double timeByBr = _frame->GetTimestamp() + TO_BiToBr;
+
+        // calculate the so3 offset
+        std::pair<std::size_t, double> iuCur;
+        _so3Meta.ComputeSplineIndex(timeByBr, iuCur.first, iuCur.second);
+        const std::size_t SO3_OFFSET = iuCur.first;
+
+        typename Helper::LieEvaluation so3;
+        Helper::EvaluateLie(sKnots + SO3_OFFSET, iuCur.second, _so3DtInv, &so3,
+                            sJacobians != nullptr);
+
+        Eigen::Map<const Eigen::Vector3d> gyroBias(sKnots[GYRO_BIAS_OFFSET]);
+        const double *gyroCoeff = sKnots[GYRO_MAP_COEFF_OFFSET];
+        Eigen::Matrix3d gyroMapMat = Eigen::Matrix3d::Zero();
+        gyroMapMat.diagonal() = Eigen::Map<const Eigen::Vector3d>(gyroCoeff, 3);
+        gyroMapMat(0, 1) = *(gyroCoeff + 3);
+        gyroMapMat(0, 2) = *(gyroCoeff + 4);
+        gyroMapMat(1, 2) = *(gyroCoeff + 5);
+
+        Eigen::Map<const Sophus::SO3d> const SO3_AtoG(sKnots[SO3_AtoG_OFFSET]);
+        Eigen::Map<const Sophus::SO3d> const SO3_BiToBr(sKnots[SO3_BiToBr_OFFSET]);
+
+        // the rotation of the spline is canceled out: 'SO3_BiToBr0^T * SO3_BrToBr0 * w_Br'
+        const Eigen::Matrix3d SO3_BrToBi = SO3_BiToBr.inverse().matrix();
+        const Eigen::Vector3d gyroInBi = SO3_BrToBi * so3.vel;
+        const Eigen::Vector3d gyroInA = SO3_AtoG * gyroInBi;
+
+        Eigen::Map<Eigen::Vector3d> residuals(sResiduals);
+        residuals = _weight * (gyroMapMat * gyroInA + gyroBias - _frame->GetGyro());
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        // d(residuals) / d(gyroInBi)
+        const Eigen::Matrix3d jGyroInBi = _weight * gyroMapMat * SO3_AtoG.matrix();
+        const Eigen::Matrix3d jVel = jGyroInBi * SO3_BrToBi;
+
+        for (std::size_t i = 0; i < SO3_NUM; ++i) {
+            if (sJacobians[i] == nullptr) {
+                continue;
+            }
+            Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jKnot(sJacobians[i]);
+            if (i < SO3_OFFSET || i >= SO3_OFFSET + Order) {
+                jKnot.setZero();
+            } else {
+                const Eigen::Matrix3d jLocal = jVel * so3.jVel[i - SO3_OFFSET];
+                jKnot = Helper::template LiftToQuaternionJacobian<3>(jLocal, sKnots[i]);
+            }
+        }
+
+        if (auto j = sJacobians[GYRO_BIAS_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jBlock(j);
+            jBlock = _weight * Eigen::Matrix3d::Identity();
+        }
+
+        if (auto j = sJacobians[GYRO_MAP_COEFF_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Matrix<double, 3, 6, Eigen::RowMajor>> jCoeff(j);
+            jCoeff.setZero();
+            jCoeff(0, 0) = gyroInA(0), jCoeff(1, 1) = gyroInA(1), jCoeff(2, 2) = gyroInA(2);
+            jCoeff(0, 3) = gyroInA(1), jCoeff(0, 4) = gyroInA(2), jCoeff(1, 5) = gyroInA(2);
+            jCoeff *= _weight;
+        }
+
+        if (auto j = sJacobians[SO3_AtoG_OFFSET]; j != nullptr) {
+            const Eigen::Matrix3d jLocal = -_weight * gyroMapMat * Sophus::SO3d::hat(gyroInA);
+            Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jBlock(j);
+            jBlock = Helper::template LiftToQuaternionJacobian<3>(jLocal, sKnots[SO3_AtoG_OFFSET]);
+        }
+
+        if (auto j = sJacobians[SO3_BiToBr_OFFSET]; j != nullptr) {
+            const Eigen::Matrix3d jLocal = jVel * Sophus::SO3d::hat(so3.vel);
+            Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jBlock(j);
+            jBlock =
+                Helper::template LiftToQuaternionJacobian<3>(jLocal, sKnots[SO3_BiToBr_OFFSET]);
+        }
+
+        if (auto j = sJacobians[TO_BiToBr_OFFSET]; j != nullptr) {
+            Eigen::Map<Eigen::Vector3d> jBlock(j);
+            jBlock = jVel * so3.acce;
+        }
+
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
 extern template struct IMUGyroFactor<Configor ::Prior::SplineOrder>;
+extern template struct IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>;
 }  // namespace ns_ikalibr
 
 #endif  // IKALIBR_IMU_GYRO_FACTOR_HPP
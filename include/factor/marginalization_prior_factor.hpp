@@ -0,0 +1,166 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_MARGINALIZATION_PRIOR_FACTOR_HPP
+#define IKALIBR_MARGINALIZATION_PRIOR_FACTOR_HPP
+
+#include "ceres/dynamic_cost_function.h"
+#include "ceres/manifold.h"
+#include "Eigen/Dense"
+#include "util/utils.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * the linearized prior on parameter blocks obtained by marginalizing residual blocks (and
+ * parameter blocks only involved in them) out of an estimator
+ */
+struct MarginalizationPrior {
+public:
+    using Ptr = std::shared_ptr<MarginalizationPrior>;
+
+public:
+    // parameter blocks the prior is on
+    std::vector<double *> blocks;
+    // manifolds of parameter blocks, nullptr for euclidean ones (not owned)
+    std::vector<const ceres::Manifold *> manifolds;
+    // values of parameter blocks when marginalized (the linearization point)
+    std::vector<Eigen::VectorXd> linPoints;
+    // the marginal information matrix in tangent spaces of parameter blocks
+    Eigen::MatrixXd information;
+
+public:
+    static Ptr Create() { return std::make_shared<MarginalizationPrior>(); }
+
+    [[nodiscard]] int AmbientSize(int i) const { return static_cast<int>(linPoints.at(i).size()); }
+
+    [[nodiscard]] int TangentSize(int i) const {
+        return manifolds.at(i) != nullptr ? manifolds.at(i)->TangentSize() : AmbientSize(i);
+    }
+};
+
+struct MarginalizationPriorFactor : public ceres::DynamicCostFunction {
+private:
+    MarginalizationPrior::Ptr _prior;
+    // the square root of the information matrix, i.e., information = sqrtInfo^T * sqrtInfo
+    Eigen::MatrixXd _sqrtInfo;
+    std::vector<int> _tangentOffsets;
+
+public:
+    explicit MarginalizationPriorFactor(MarginalizationPrior::Ptr prior)
+        : _prior(std::move(prior)) {
+        int tangentDim = 0;
+        for (int i = 0; i < static_cast<int>(_prior->blocks.size()); ++i) {
+            _tangentOffsets.push_back(tangentDim);
+            tangentDim += _prior->TangentSize(i);
+            this->AddParameterBlock(_prior->AmbientSize(i));
+        }
+        // the information matrix may be rank deficient (unobservable directions)
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(_prior->information);
+        const Eigen::VectorXd &eigenValues = solver.eigenvalues();
+        const double minEigenValue = std::max(eigenValues.maxCoeff(), 0.0) * 1E-12;
+        Eigen::VectorXd sqrtEigenValues =
+            (eigenValues.array() > minEigenValue).select(eigenValues.array().sqrt(), 0.0).matrix();
+        _sqrtInfo = sqrtEigenValues.asDiagonal() * solver.eigenvectors().transpose();
+        this->SetNumResiduals(tangentDim);
+    }
+
+    static auto Create(const MarginalizationPrior::Ptr &prior) {
+        return new MarginalizationPriorFactor(prior);
+    }
+
+    static std::size_t TypeHashCode() { return typeid(MarginalizationPriorFactor).hash_code(); }
+
+public:
+    /**
+     * param blocks:
+     * [ BLOCK | ... | BLOCK ]
+     */
+    bool Evaluate(double const *const *sParams,
+                  double *sResiduals,
+                  double **sJacobians) const override {
+        const int blockNum = static_cast<int>(_prior->blocks.size());
+        const auto tangentDim = static_cast<int>(_sqrtInfo.cols());
+
+        // the difference to the linearization point in tangent spaces
+        Eigen::VectorXd delta(tangentDim);
+        for (int i = 0; i < blockNum; ++i) {
+            const auto *manifold = _prior->manifolds.at(i);
+            const auto &linPoint = _prior->linPoints.at(i);
+            if (manifold != nullptr) {
+                manifold->Minus(sParams[i], linPoint.data(), delta.data() + _tangentOffsets.at(i));
+            } else {
+                delta.segment(_tangentOffsets.at(i), linPoint.size()) =
+                    Eigen::Map<const Eigen::VectorXd>(sParams[i], linPoint.size()) - linPoint;
+            }
+        }
+
+        Eigen::Map<Eigen::VectorXd> residuals(sResiduals, tangentDim);
+        residuals = _sqrtInfo * delta;
+
+        if (sJacobians == nullptr) {
+            return true;
+        }
+
+        for (int i = 0; i < blockNum; ++i) {
+            if (sJacobians[i] == nullptr) {
+                continue;
+            }
+            const int ambientSize = _prior->AmbientSize(i), tangentSize = _prior->TangentSize(i);
+            Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+                jacobian(sJacobians[i], tangentDim, ambientSize);
+            const auto *manifold = _prior->manifolds.at(i);
+            if (manifold != nullptr) {
+                // the jacobian of 'Minus' is evaluated at the current value rather than the
+                // linearization point, which holds to the first order
+                Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+                    minusJacobian(tangentSize, ambientSize);
+                manifold->MinusJacobian(sParams[i], minusJacobian.data());
+                jacobian = _sqrtInfo.middleCols(_tangentOffsets.at(i), tangentSize) * minusJacobian;
+            } else {
+                jacobian = _sqrtInfo.middleCols(_tangentOffsets.at(i), tangentSize);
+            }
+        }
+        return true;
+    }
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_MARGINALIZATION_PRIOR_FACTOR_HPP
@@ -67,6 +67,34 @@ public:
         init();
     }
 
+    /** \brief Append points to the input target incrementally, only the voxels the new points
+     * fall in are updated, instead of rebuilding the voxel structure over the whole target.
+     * \note only the DIRECT* neighborhood search methods are supported for such a target, the
+     * target is not appended if the KDTREE one is set.
+     * \param[in] target the accumulated input target, which already contains \p cloud
+     * \param[in] cloud the points newly appended to \p target
+     */
+    inline void appendInputTarget(const PointCloudTargetConstPtr &target,
+                                  const PointCloudTargetConstPtr &cloud) {
+        if (search_method == KDTREE) {
+            PCL_ERROR("[pclomp::%s::appendInputTarget] KDTREE search is not supported!\n",
+                      getClassName().c_str());
+            return;
+        }
+        if (target_ != target) {
+            pcl::Registration<PointSource, PointTarget>::setInputTarget(target);
+        }
+        if (!target_cells_.isIncremental()) {
+            // Switch from the batch mode, the voxel structure is rebuilt from the whole target,
+            // which already contains 'cloud'
+            target_cells_.setLeafSize(resolution_, resolution_, resolution_);
+            target_cells_.setInputCloud(target_);
+            target_cells_.insertCloud(PointCloudTarget());
+        } else {
+            target_cells_.insertCloud(*cloud);
+        }
+    }
+
     /** \brief Set/change the voxel grid resolution.
      * \param[in] resolution side length of voxels
      */
@@ -74,7 +102,8 @@ public:
         // Prevents unnessary voxel initiations
         if (resolution_ != resolution) {
             resolution_ = resolution;
-            if (input_) init();
+            // An incrementally built target is rebuilt in the batch mode as well
+            if (input_ || target_cells_.isIncremental()) init();
         }
     }
 
@@ -504,6 +533,15 @@ void pclomp::NormalDistributionsTransform<PointSource, PointTarget>::computeTran
     nr_iterations_ = 0;
     converged_ = false;
 
+    // The kd-tree over the centroids is not maintained for an incrementally built target
+    if (search_method == KDTREE && target_cells_.isIncremental()) {
+        PCL_ERROR(
+            "[pclomp::%s::computeTransformation] KDTREE search is not supported for an "
+            "incrementally built target!\n",
+            getClassName().c_str());
+        return;
+    }
+
     double gauss_c1, gauss_c2;
 
     // Initializes the guassian fitting parameters (eq. 6.8) [Magnusson 2009]
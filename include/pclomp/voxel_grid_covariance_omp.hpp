@@ -1,6 +1,7 @@
 #ifndef PCL_VOXEL_GRID_COVARIANCE_OMP_H_
 #define PCL_VOXEL_GRID_COVARIANCE_OMP_H_
 
+#include "algorithm"
 #include "Eigen/Cholesky"
 #include "Eigen/Dense"
 #include "map"
@@ -65,7 +66,10 @@ public:
               cov_(Eigen::Matrix3d::Identity()),
               icov_(Eigen::Matrix3d::Zero()),
               evecs_(Eigen::Matrix3d::Identity()),
-              evals_(Eigen::Vector3d::Zero()) {}
+              evals_(Eigen::Vector3d::Zero()),
+              nr_accumulated_(0),
+              pt_sum_(Eigen::Vector3d::Zero()),
+              pt_outer_sum_(Eigen::Matrix3d::Zero()) {}
 
         /** \brief Get the voxel covariance.
          * \return covariance matrix
@@ -122,8 +126,18 @@ public:
         /** \brief Eigen values of voxel covariance matrix */
         Eigen::Vector3d evals_;
 
-        /** \brief Points inside the cell */
+        /** \brief Points inside the cell (not kept by incremental insertion) */
         pcl::PointCloud<PointT> pointList_;
+
+        /** \brief Number of points accumulated by incremental insertion (unlike \ref nr_points,
+         * never invalidated) */
+        int nr_accumulated_;
+
+        /** \brief Accumulated point sum, used for incremental insertion */
+        Eigen::Vector3d pt_sum_;
+
+        /** \brief Accumulated x*xT sum, used for incremental insertion */
+        Eigen::Matrix3d pt_outer_sum_;
     };
 
     /** \brief Pointer to VoxelGridCovariance leaf structure */
@@ -140,6 +154,7 @@ public:
      */
     VoxelGridCovariance()
         : searchable_(true),
+          incremental_(false),
           min_points_per_voxel_(6),
           min_covar_eigvalue_mult_(0.01),
           leaves_(),
@@ -240,15 +255,12 @@ public:
      */
     inline LeafConstPtr getLeaf(PointT &p) {
         // Generate index associated with p
-        int ijk0 = static_cast<int>(floor(p.x * inverse_leaf_size_[0]) - min_b_[0]);
-        int ijk1 = static_cast<int>(floor(p.y * inverse_leaf_size_[1]) - min_b_[1]);
-        int ijk2 = static_cast<int>(floor(p.z * inverse_leaf_size_[2]) - min_b_[2]);
-
-        // Compute the centroid leaf index
-        int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+        Eigen::Vector4i ijk(static_cast<int>(floor(p.x * inverse_leaf_size_[0])),
+                            static_cast<int>(floor(p.y * inverse_leaf_size_[1])),
+                            static_cast<int>(floor(p.z * inverse_leaf_size_[2])), 0);
 
         // Find leaf associated with index
-        auto leaf_iter = leaves_.find(idx);
+        auto leaf_iter = leaves_.find(getLeafIndex(ijk));
         if (leaf_iter != leaves_.end()) {
             // If such a leaf exists return the pointer to the leaf structure
             LeafConstPtr ret(&(leaf_iter->second));
@@ -263,15 +275,12 @@ public:
      */
     inline LeafConstPtr getLeaf(Eigen::Vector3f &p) {
         // Generate index associated with p
-        int ijk0 = static_cast<int>(floor(p[0] * inverse_leaf_size_[0]) - min_b_[0]);
-        int ijk1 = static_cast<int>(floor(p[1] * inverse_leaf_size_[1]) - min_b_[1]);
-        int ijk2 = static_cast<int>(floor(p[2] * inverse_leaf_size_[2]) - min_b_[2]);
-
-        // Compute the centroid leaf index
-        int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+        Eigen::Vector4i ijk(static_cast<int>(floor(p[0] * inverse_leaf_size_[0])),
+                            static_cast<int>(floor(p[1] * inverse_leaf_size_[1])),
+                            static_cast<int>(floor(p[2] * inverse_leaf_size_[2])), 0);
 
         // Find leaf associated with index
-        auto leaf_iter = leaves_.find(idx);
+        auto leaf_iter = leaves_.find(getLeafIndex(ijk));
         if (leaf_iter != leaves_.end()) {
             // If such a leaf exists return the pointer to the leaf structure
             LeafConstPtr ret(&(leaf_iter->second));
@@ -280,6 +289,23 @@ public:
             return NULL;
     }
 
+    /** \brief Insert points into the voxel structure incrementally. Leaves are indexed by their
+     * absolute voxel coordinates rather than relative to the bounding box of the input, so only
+     * the leaves touched by \p cloud are recomputed, in time linear in the size of \p cloud.
+     * \note the kd-tree over the centroids is not maintained in this mode, so only the
+     * 'getNeighborhoodAtPoint*' searches are available. Calling \ref filter afterwards rebuilds
+     * the structure from \ref input_ in the batch mode. Conversely, when switching from the batch
+     * mode, the structure is first rebuilt from \ref input_ (if given) incrementally, thus \p cloud
+     * should not be contained in \ref input_ then.
+     * \param[in] cloud the points to insert
+     */
+    void insertCloud(const PointCloud &cloud);
+
+    /** \brief Get whether the voxel structure is built incrementally by \ref insertCloud.
+     * \return true if built incrementally
+     */
+    inline bool isIncremental() const { return incremental_; }
+
     /** \brief Get the voxels surrounding point p, not including the voxel contating point p.
      * \note Only voxels containing a sufficient number of points are used (slower than radius
      * search in practice).
@@ -464,9 +490,45 @@ protected:
      */
     void applyFilter(PointCloud &output);
 
+    /** \brief Compute the index of the leaf at the (absolute) voxel coordinates ijk.
+     * \note in the incremental mode, coordinates are packed into 21 bits per axis, i.e., they are
+     * unique within +/- 2^20 voxels from the origin
+     */
+    inline size_t getLeafIndex(const Eigen::Vector4i &ijk) const {
+        if (incremental_) {
+            constexpr size_t mask = (size_t(1) << 21) - 1;
+            constexpr int offset = 1 << 20;
+            return (static_cast<size_t>(ijk[0] + offset) & mask) |
+                   (static_cast<size_t>(ijk[1] + offset) & mask) << 21 |
+                   (static_cast<size_t>(ijk[2] + offset) & mask) << 42;
+        } else {
+            return static_cast<size_t>((ijk - min_b_).dot(divb_mul_));
+        }
+    }
+
+    /** \brief Compute the covariance, its eigen decomposition and inverse of a leaf.
+     * \param[in,out] leaf the leaf, whose \ref Leaf::mean_ is normalized and \ref Leaf::cov_
+     * holds the x*xT sum, leaf.nr_points is set to -1 if the covariance is degenerate
+     * \param[in] pt_sum the point sum of the leaf
+     * \param[in] eigensolver the solver to reuse
+     */
+    void computeLeafCovariance(Leaf &leaf,
+                               const Eigen::Vector3d &pt_sum,
+                               Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> &eigensolver) const;
+
+    /** \brief Accumulate points into their leaves in the incremental mode.
+     * \param[in] cloud the points to accumulate
+     * \param[out] touched the indices of leaves touched by \p cloud are appended to it
+     */
+    void accumulateCloud(const PointCloud &cloud, std::vector<size_t> &touched);
+
     /** \brief Flag to determine if voxel structure is searchable. */
     bool searchable_;
 
+    /** \brief Flag to determine if voxel structure is built incrementally (see \ref insertCloud).
+     */
+    bool incremental_;
+
     /** \brief Minimum points contained with in a voxel to allow it to be useable. */
     int min_points_per_voxel_;
 
@@ -494,6 +556,7 @@ protected:
 template <typename PointT>
 void pclomp::VoxelGridCovariance<PointT>::applyFilter(PointCloud &output) {
     voxel_centroids_leaf_indices_.clear();
+    incremental_ = false;
 
     // Has the input dataset been set already?
     if (!input_) {
@@ -716,13 +779,8 @@ void pclomp::VoxelGridCovariance<PointT>::applyFilter(PointCloud &output) {
 
     // Eigen values and vectors calculated to prevent near singluar matrices
     Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
-    Eigen::Matrix3d eigen_val;
     Eigen::Vector3d pt_sum;
 
-    // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the
-    // max eigen value.
-    double min_covar_eigvalue;
-
     for (auto it = leaves_.begin(); it != leaves_.end(); ++it) {
         // Normalize the centroid
         Leaf &leaf = it->second;
@@ -766,44 +824,124 @@ void pclomp::VoxelGridCovariance<PointT>::applyFilter(PointCloud &output) {
             // Stores the voxel indice for fast access searching
             if (searchable_) voxel_centroids_leaf_indices_.push_back(static_cast<int>(it->first));
 
-            // Single pass covariance calculation
-            leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose())) / leaf.nr_points +
-                        leaf.mean_ * leaf.mean_.transpose();
-            leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
+            computeLeafCovariance(leaf, pt_sum, eigensolver);
+        }
+    }
 
-            // Normalize Eigen Val such that max no more than 100x min.
-            eigensolver.compute(leaf.cov_);
-            eigen_val = eigensolver.eigenvalues().asDiagonal();
-            leaf.evecs_ = eigensolver.eigenvectors();
+    output.width = static_cast<uint32_t>(output.points.size());
+}
 
-            if (eigen_val(0, 0) < 0 || eigen_val(1, 1) < 0 || eigen_val(2, 2) <= 0) {
-                leaf.nr_points = -1;
-                continue;
-            }
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void pclomp::VoxelGridCovariance<PointT>::computeLeafCovariance(
+    Leaf &leaf,
+    const Eigen::Vector3d &pt_sum,
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> &eigensolver) const {
+    // Single pass covariance calculation
+    leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose())) / leaf.nr_points +
+                leaf.mean_ * leaf.mean_.transpose();
+    leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
+
+    // Normalize Eigen Val such that max no more than 100x min.
+    eigensolver.compute(leaf.cov_);
+    Eigen::Matrix3d eigen_val = eigensolver.eigenvalues().asDiagonal();
+    leaf.evecs_ = eigensolver.eigenvectors();
+
+    if (eigen_val(0, 0) < 0 || eigen_val(1, 1) < 0 || eigen_val(2, 2) <= 0) {
+        leaf.nr_points = -1;
+        return;
+    }
 
-            // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+    // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
 
-            min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val(2, 2);
-            if (eigen_val(0, 0) < min_covar_eigvalue) {
-                eigen_val(0, 0) = min_covar_eigvalue;
+    // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the
+    // max eigen value.
+    double min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val(2, 2);
+    if (eigen_val(0, 0) < min_covar_eigvalue) {
+        eigen_val(0, 0) = min_covar_eigvalue;
 
-                if (eigen_val(1, 1) < min_covar_eigvalue) {
-                    eigen_val(1, 1) = min_covar_eigvalue;
-                }
+        if (eigen_val(1, 1) < min_covar_eigvalue) {
+            eigen_val(1, 1) = min_covar_eigvalue;
+        }
 
-                leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse();
-            }
-            leaf.evals_ = eigen_val.diagonal();
+        leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse();
+    }
+    leaf.evals_ = eigen_val.diagonal();
 
-            leaf.icov_ = leaf.cov_.inverse();
-            if (leaf.icov_.maxCoeff() == std::numeric_limits<float>::infinity() ||
-                leaf.icov_.minCoeff() == -std::numeric_limits<float>::infinity()) {
-                leaf.nr_points = -1;
-            }
+    leaf.icov_ = leaf.cov_.inverse();
+    if (leaf.icov_.maxCoeff() == std::numeric_limits<float>::infinity() ||
+        leaf.icov_.minCoeff() == -std::numeric_limits<float>::infinity()) {
+        leaf.nr_points = -1;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void pclomp::VoxelGridCovariance<PointT>::insertCloud(const PointCloud &cloud) {
+    // First pass: accumulate the new points into their leaves, recording the touched ones
+    std::vector<size_t> touched;
+    if (!incremental_) {
+        // Switch from the batch mode, leaf indices of which are relative to the bounding box, so
+        // the leaves are rebuilt from the input rather than kept
+        leaves_.clear();
+        voxel_centroids_ = PointCloudPtr(new PointCloud);
+        voxel_centroids_leaf_indices_.clear();
+        searchable_ = false;
+        min_b_.setZero();
+        max_b_.setZero();
+        incremental_ = true;
+        if (input_) accumulateCloud(*input_, touched);
+    }
+    accumulateCloud(cloud, touched);
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    // Second pass: recompute the distributions of the touched leaves only
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
+    for (const auto &idx : touched) {
+        Leaf &leaf = leaves_[idx];
+        leaf.nr_points = leaf.nr_accumulated_;
+        leaf.mean_ = leaf.pt_sum_ / leaf.nr_points;
+        leaf.centroid.resize(4);
+        leaf.centroid << leaf.mean_.template cast<float>(), 0.0f;
+
+        if (leaf.nr_points >= min_points_per_voxel_) {
+            leaf.cov_ = leaf.pt_outer_sum_;
+            computeLeafCovariance(leaf, leaf.pt_sum_, eigensolver);
         }
     }
+}
 
-    output.width = static_cast<uint32_t>(output.points.size());
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void pclomp::VoxelGridCovariance<PointT>::accumulateCloud(const PointCloud &cloud,
+                                                          std::vector<size_t> &touched) {
+    touched.reserve(touched.size() + cloud.points.size());
+    for (const auto &p : cloud.points) {
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) continue;
+
+        Eigen::Vector4i ijk(static_cast<int>(floor(p.x * inverse_leaf_size_[0])),
+                            static_cast<int>(floor(p.y * inverse_leaf_size_[1])),
+                            static_cast<int>(floor(p.z * inverse_leaf_size_[2])), 0);
+        // Grow the bounding box, which bounds the neighborhood search
+        if (leaves_.empty()) {
+            min_b_ = max_b_ = ijk;
+        } else {
+            min_b_ = min_b_.cwiseMin(ijk);
+            max_b_ = max_b_.cwiseMax(ijk);
+        }
+
+        size_t idx = getLeafIndex(ijk);
+        Leaf &leaf = leaves_[idx];
+
+        Eigen::Vector3d pt3d(p.x, p.y, p.z);
+        leaf.pt_sum_ += pt3d;
+        leaf.pt_outer_sum_ += pt3d * pt3d.transpose();
+        // Only the sums are kept, as the point lists would grow with the target
+        ++leaf.nr_accumulated_;
+
+        touched.push_back(idx);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -829,7 +967,7 @@ int pclomp::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint(
             (Eigen::Vector4i() << relative_coordinates.col(ni), 0).finished();
         // Checking if the specified cell is in the grid
         if ((diff2min <= displacement.array()).all() && (diff2max >= displacement.array()).all()) {
-            auto leaf_iter = leaves_.find(((ijk + displacement - min_b_).dot(divb_mul_)));
+            auto leaf_iter = leaves_.find(getLeafIndex(ijk + displacement));
             if (leaf_iter != leaves_.end() &&
                 leaf_iter->second.nr_points >= min_points_per_voxel_) {
                 LeafConstPtr leaf = &(leaf_iter->second);
@@ -90,37 +90,80 @@ public:
 class EventArray {
 public:
     using Ptr = std::shared_ptr<EventArray>;
+    using PosScalar = Event::PosType::Scalar;
 
 private:
     double _timestamp;
-    std::vector<Event::Ptr> _events;
+    // events are stored as structure-of-arrays, as an event array from a modern sensor holds
+    // tens of thousands of events, one heap-allocated 'Event' per event is too expensive
+    std::vector<double> _evTimestamps;
+    std::vector<PosScalar> _evXs;
+    std::vector<PosScalar> _evYs;
+    std::vector<std::uint8_t> _evPolarities;
 
 public:
     explicit EventArray(double timestamp = INVALID_TIME_STAMP,
-                        const std::vector<Event::Ptr>& events = {});
+                        std::vector<double> evTimestamps = {},
+                        std::vector<PosScalar> evXs = {},
+                        std::vector<PosScalar> evYs = {},
+                        std::vector<std::uint8_t> evPolarities = {});
 
     static Ptr Create(double timestamp = INVALID_TIME_STAMP,
-                      const std::vector<Event::Ptr>& events = {});
+                      std::vector<double> evTimestamps = {},
+                      std::vector<PosScalar> evXs = {},
+                      std::vector<PosScalar> evYs = {},
+                      std::vector<std::uint8_t> evPolarities = {});
 
-    [[nodiscard]] double GetTimestamp() const;
+    // create from individual events, only for small event sets (e.g., clusters)
+    static Ptr Create(double timestamp, const std::vector<Event::Ptr>& events);
 
-    [[nodiscard]] std::vector<Event::Ptr> GetEvents() const;
+    [[nodiscard]] double GetTimestamp() const;
 
     void SetTimestamp(double timestamp);
 
+    [[nodiscard]] std::size_t GetEventNum() const;
+
+    [[nodiscard]] bool IsEmpty() const;
+
+    [[nodiscard]] double GetEventTimestamp(std::size_t idx) const;
+
+    [[nodiscard]] Event::PosType GetEventPos(std::size_t idx) const;
+
+    [[nodiscard]] bool GetEventPolarity(std::size_t idx) const;
+
+    // materialize the 'idx'-th event, only for small event sets
+    [[nodiscard]] Event::Ptr GetEvent(std::size_t idx) const;
+
+    [[nodiscard]] const std::vector<double>& GetEventTimestamps() const;
+
+    [[nodiscard]] const std::vector<PosScalar>& GetEventXs() const;
+
+    [[nodiscard]] const std::vector<PosScalar>& GetEventYs() const;
+
+    [[nodiscard]] const std::vector<std::uint8_t>& GetEventPolarities() const;
+
+    // add 'dt' to timestamps of all events in this array (the array timestamp is not changed)
+    void ShiftEventTimestamps(double dt);
+
     [[nodiscard]] cv::Mat DrawRawEventFrame(const ns_veta::PinholeIntrinsicPtr& intri) const;
 
     static cv::Mat DrawRawEventFrame(const std::vector<Ptr>::const_iterator& sIter,
                                      const std::vector<Ptr>::const_iterator& eIter,
                                      const ns_veta::PinholeIntrinsicPtr& intri);
 
+protected:
+    void DrawRawEventFrame(cv::Mat& eventFrame) const;
+
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 public:
     template <class Archive>
     void serialize(Archive& ar) {
-        ar(cereal::make_nvp("timestamp", _timestamp), cereal::make_nvp("events", _events));
+        ar(cereal::make_nvp("timestamp", _timestamp),
+           cereal::make_nvp("event_timestamps", _evTimestamps),
+           cereal::make_nvp("event_xs", _evXs), cereal::make_nvp("event_ys", _evYs),
+           cereal::make_nvp("event_polarities", _evPolarities));
     }
 };
 }  // namespace ns_ikalibr
@@ -72,6 +72,28 @@ protected:
                 "' for event cameras! It's incompatible with the type of ros message to load in!");
         }
     }
+
+    template <class MsgType>
+    static EventArray::Ptr UnpackEventArray(typename MsgType::ConstPtr msg) {
+        // unpack events into structure-of-arrays directly, no per-event allocation
+        const std::size_t size = msg->events.size();
+        std::vector<double> evTimestamps(size);
+        std::vector<EventArray::PosScalar> evXs(size), evYs(size);
+        std::vector<std::uint8_t> evPolarities(size);
+
+        for (std::size_t i = 0; i != size; ++i) {
+            const auto &event = msg->events[i];
+            evTimestamps[i] = event.ts.toSec();
+            evXs[i] = event.x, evYs[i] = event.y;
+            evPolarities[i] = event.polarity;
+        }
+
+        const double timestamp =
+            msg->header.stamp.isZero() ? evTimestamps.back() : msg->header.stamp.toSec();
+
+        return EventArray::Create(timestamp, std::move(evTimestamps), std::move(evXs),
+                                  std::move(evYs), std::move(evPolarities));
+    }
 };
 
 class PropheseeEventDataLoader : public EventDataLoader {
@@ -38,6 +38,8 @@
 #include "util/utils.h"
 #include "util/cloud_define.hpp"
 #include "ctraj/utils/macros.hpp"
+#include "array"
+#include "limits"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -45,6 +47,54 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
+/**
+ * the compact representation of a lidar scan, points are stored in the structure-of-arrays layout
+ * with float time offsets relative to the frame timestamp, and positions are optionally quantized
+ * to 16-bit integers. A point takes 16 bytes (10 bytes if quantized) rather than 32 bytes
+ */
+class LiDARCompactScan {
+public:
+    using Ptr = std::shared_ptr<LiDARCompactScan>;
+
+private:
+    std::uint32_t _width;
+    std::uint32_t _height;
+    bool _isDense;
+
+    // the quantization resolution of positions, zero if positions are not quantized
+    float _resolution;
+    // [x, y, z] arrays, either the float ones or the quantized ones are used
+    std::array<std::vector<float>, 3> _pos;
+    std::array<std::vector<std::int16_t>, 3> _quantPos;
+    // the time offsets of points relative to the frame timestamp
+    std::vector<float> _timeOffsets;
+
+public:
+    // a non-positive resolution keeps float positions, otherwise positions are quantized using
+    // this resolution (enlarged for scans that exceed the 16-bit range)
+    LiDARCompactScan(const IKalibrPointCloud &scan, double timebase, float resolution);
+
+    static LiDARCompactScan::Ptr Create(const IKalibrPointCloud &scan,
+                                        double timebase,
+                                        float resolution = 0.0f);
+
+    // convert to the 'IKalibrPointCloud' scan, point timestamps are 'timebase + offset'
+    [[nodiscard]] IKalibrPointCloud::Ptr ToCloud(double timebase) const;
+
+    [[nodiscard]] std::size_t Size() const;
+
+    // nan for invalid points
+    [[nodiscard]] Eigen::Vector3f GetPosition(std::size_t idx) const;
+
+    [[nodiscard]] float GetTimeOffset(std::size_t idx) const;
+
+    [[nodiscard]] std::size_t MemoryBytes() const;
+
+protected:
+    // the sentinel of quantized nan coordinates
+    static constexpr std::int16_t QUANT_NAN = std::numeric_limits<std::int16_t>::min();
+};
+
 struct LiDARFrame {
 public:
     using Ptr = std::shared_ptr<LiDARFrame>;
@@ -52,8 +102,10 @@ public:
 private:
     // the timestamp of this lidar scan
     double _timestamp;
-    // the lidar scan [x, y, z, timestamp]
+    // the lidar scan [x, y, z, timestamp], null if this frame is compacted
     IKalibrPointCloud::Ptr _scan;
+    // the compact lidar scan, which is valid if this frame is compacted
+    LiDARCompactScan::Ptr _compactScan;
 
 public:
     // constructor
@@ -65,13 +117,30 @@ public:
         double timestamp = INVALID_TIME_STAMP,
         const IKalibrPointCloud::Ptr &scan = boost::make_shared<IKalibrPointCloud>());
 
-    // access
-    [[nodiscard]] IKalibrPointCloud::Ptr GetScan() const;
+    // access, if this frame is compacted, the scan is converted on demand (not cached), thus it's
+    // read-only and should be obtained once where it's used repeatedly
+    [[nodiscard]] IKalibrPointCloud::ConstPtr GetScan() const;
+
+    // access the scan to modify it in place, which throws if this frame is compacted
+    [[nodiscard]] const IKalibrPointCloud::Ptr &GetMutableScan();
 
     [[nodiscard]] double GetTimestamp() const;
 
+    // attention: point times of a compacted frame are relative, so they are shifted together
     void SetTimestamp(double timestamp);
 
+    // replace the scan by the compact one, see 'LiDARCompactScan' for the resolution
+    void Compact(float resolution = 0.0f);
+
+    [[nodiscard]] bool IsCompact() const;
+
+    // the frame itself if it's not compacted, otherwise a (temporary) frame holding the converted
+    // scan, which is used where the scan is accessed repeatedly, e.g., in undistortion and then
+    // association of a data association stage
+    static LiDARFrame::Ptr Decompacted(const LiDARFrame::Ptr &frame);
+
+    [[nodiscard]] const LiDARCompactScan::Ptr &GetCompactScan() const;
+
     friend std::ostream &operator<<(std::ostream &os, const LiDARFrame &frame);
 };
 
@@ -45,6 +45,8 @@
 #include <sensor_msgs/PointCloud2.h>
 #include <pcl/point_cloud.h>
 #include <pcl_conversions/pcl_conversions.h>
+#include "mutex"
+#include "optional"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -59,6 +61,21 @@ public:
 protected:
     LidarModelType _lidarModel;
 
+    /**
+     * the byte layout of the 'sensor_msgs::PointCloud2' messages of this topic, which is resolved
+     * once and reused as long as the point step and fields of messages are unchanged
+     */
+    struct PointCloud2Layout {
+        std::uint32_t pointStep;
+        std::size_t fieldCount;
+        std::uint32_t xOffset, yOffset, zOffset;
+        // the offset and 'sensor_msgs::PointField' datatype of the time field, if exists
+        std::optional<std::pair<std::uint32_t, std::uint8_t>> time;
+    };
+    std::optional<PointCloud2Layout> _pc2Layout;
+    // messages of a topic may be unpacked concurrently when loading data in parallel
+    std::mutex _pc2LayoutMutex;
+
 public:
     explicit LiDARDataLoader(LidarModelType lidarModel)
         : _lidarModel(lidarModel) {}
@@ -80,6 +97,30 @@ protected:
                 "' for LiDARs! It's incompatible with the type of ros message to load in!");
         }
     }
+
+    /**
+     * decode the raw buffer of a 'sensor_msgs::PointCloud2' message to the lidar cloud directly in
+     * a single pass, points with nan positions or out of the depth range are dropped. The time of
+     * a point is 'timeBase + timeScale * value' ('value' is read from field 'timeField')
+     */
+    IKalibrPointCloud::Ptr DecodePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                             const std::string &timeField,
+                                             double timeBase,
+                                             double timeScale,
+                                             double depthMin,
+                                             double depthMax);
+
+    PointCloud2Layout GetPointCloud2Layout(const sensor_msgs::PointCloud2 &msg,
+                                           const std::string &timeField);
+
+    template <typename TimeType>
+    static std::size_t DecodePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                         const PointCloud2Layout &layout,
+                                         double timeBase,
+                                         double timeScale,
+                                         double depthMin,
+                                         double depthMax,
+                                         IKalibrPointCloud &cloud);
 };
 
 class Velodyne16 : public LiDARDataLoader {
@@ -43,6 +43,8 @@
 #include "core/rot_only_vo.h"
 #include "ctraj/core/pose.hpp"
 #include "ctraj/core/spline_bundle.h"
+#include "array"
+#include "functional"
 #include "optional"
 #include "pcl/point_cloud.h"
 
@@ -64,6 +66,7 @@ using ColorPointCloudPtr = boost::shared_ptr<pcl::PointCloud<PointXYZRGBA>>;
 
 struct PointXYZT;
 using IKalibrPointCloudPtr = boost::shared_ptr<pcl::PointCloud<PointXYZT>>;
+using IKalibrPointCloudConstPtr = boost::shared_ptr<const pcl::PointCloud<PointXYZT>>;
 
 namespace ns_ikalibr {
 struct CalibParamManager;
@@ -95,6 +98,13 @@ struct EventArray;
 using EventArrayPtr = std::shared_ptr<EventArray>;
 struct OpticalFlowCurveCorr;
 using OpticalFlowCurveCorrPtr = std::shared_ptr<OpticalFlowCurveCorr>;
+class SplinePoseCache;
+using SplinePoseCachePtr = std::shared_ptr<SplinePoseCache>;
+class PointToSurfelAssociator;
+using PointToSurfelAssociatorPtr = std::shared_ptr<PointToSurfelAssociator>;
+class LiDARTiledMap;
+using LiDARTiledMapPtr = std::shared_ptr<LiDARTiledMap>;
+struct PointToSurfelCondition;
 
 struct ImagesInfo {
 public:
@@ -145,6 +155,8 @@ public:
         std::map<std::string, std::vector<VisualReProjCorrSeqPtr>> visualCorrs;
         // lidar global map
         IKalibrPointCloudPtr lidarMap;
+        // out-of-core lidar global map, used instead of 'lidarMap' if 'TiledLiDARMap' is enabled
+        LiDARTiledMapPtr lidarTiledMap;
         // lidar point-to-surfel correspondences
         std::map<std::string, std::vector<PointToSurfelCorrPtr>> lidarCorrs;
         // radar global map
@@ -184,6 +196,28 @@ public:
         std::map<std::string, std::vector<LiDARFramePtr>> undistFramesInMap;
     };
 
+    struct LiDARMapAsset {
+    public:
+        using Ptr = std::shared_ptr<LiDARMapAsset>;
+
+        struct ScanState {
+            // the undistorted scan expressed in the world frame, nullptr if it's unavailable
+            LiDARFramePtr frameInMap;
+            // the time span and the max point range of the raw scan
+            double timeMin, timeMax, rangeMax;
+            // lidar poses at the start, middle, and end of the scan when it was undistorted
+            std::array<std::optional<Sophus::SE3d>, 3> SE3_LkToW;
+            // point-to-surfel correspondences of this scan (before downsampling)
+            std::vector<PointToSurfelCorrPtr> corrs;
+        };
+
+    public:
+        // the persistent surfel map (associator) built from all undistorted scans
+        PointToSurfelAssociatorPtr associator;
+        // states of scans for each lidar
+        std::map<std::string, std::vector<ScanState>> scans;
+    };
+
 private:
     // the data manager for calibration
     CalibDataManagerPtr _dataMagr;
@@ -193,6 +227,8 @@ private:
     SpatialTemporalPrioriPtr _priori;
     // rotation and linear scale splines (acceleration, velocity, or translation)
     SplineBundleType::Ptr _splines;
+    // memoized pose queries on splines, invalidated once splines are changed
+    SplinePoseCachePtr _poseCache;
     // options used for ceres-related optimization
     ceres::Solver::Options _ceresOption;
     // viewer used to visualize entities in calibration
@@ -201,6 +237,14 @@ private:
     BackUp::Ptr _backup;
     // storge temporal results from initialization, which would be destroyed after initialization
     InitAsset::Ptr _initAsset;
+    // the persistent lidar map for the incremental data association in batch optimizations
+    LiDARMapAsset::Ptr _lidarMapAsset;
+    // the estimator reused over batch optimizations, in which inertial and radar residual blocks
+    // are kept alive (only maintained when 'PersistentEstimator' is enabled)
+    EstimatorPtr _persistentEstimator;
+    // the structure-related options (time offsets of imus and radars) the persistent estimator is
+    // built with, the estimator would be rebuilt once they change
+    OptOption _persistentEstimatorOpt;
     // indicates whether the solving is finished
     bool _solveFinished;
 
@@ -281,6 +325,20 @@ protected:
      */
     void InitPrepLiDARInertialAlign() const;
 
+    /**
+     * the odometry part of 'InitPrepLiDARInertialAlign', i.e., the extrinsic rotation recovery and
+     * the odometry on undistorted scans, which only involves parameters of LiDARs. Rotations are
+     * written to 'parMagr', and viewer updates are appended to 'viewerUpdates' (performed in place
+     * if it's null), so that this could run beside other preparations on a copy of parameters
+     */
+    void InitPrepLiDAROdometry(const CalibParamManagerPtr &parMagr,
+                               std::vector<std::function<void()>> *viewerUpdates) const;
+
+    /**
+     * the alignment part of 'InitPrepLiDARInertialAlign', i.e., the hand-eye rotation alignment
+     */
+    void InitPrepLiDARHandEyeAlign() const;
+
     /**
      * detailed sensor-inertial alignment for RGBD camera and IMU, this is the preparation for final
      * one-shot sensor-inertial alignment
@@ -299,6 +357,12 @@ protected:
      */
     void InitPrepInertialInertialAlign();
 
+    /**
+     * perform the preparations of all sensor-inertial alignments (except the event-inertial ones),
+     * if 'ParallelInitPrep' is enabled, the LiDAR odometry would be performed beside other ones
+     */
+    void InitPrepSensorInertialAlign();
+
     /**
      * detailed sensor-inertial alignment for event camera and IMU, i.e., event-inertial
      * alignment, this is the preparation for final one-shot sensor-inertial alignment
@@ -334,6 +398,16 @@ protected:
     std::tuple<IKalibrPointCloudPtr, std::map<std::string, std::vector<LiDARFramePtr>>>
     BuildGlobalMapOfLiDAR() const;
 
+    /**
+     * build the out-of-core global map for LiDARs, scans are undistorted in batches and streamed
+     * to tiles of the map, rather than being concatenated in memory
+     * @param undistFrames if not null, undistorted frames (expressed in the map frame) are kept
+     * here, otherwise they are dropped once merged to tiles
+     * @return the tiled map
+     */
+    LiDARTiledMapPtr BuildTiledGlobalMapOfLiDAR(
+        std::map<std::string, std::vector<LiDARFramePtr>> *undistFrames = nullptr) const;
+
     /**
      * build the global map for radars, this is only for visualization if translation spline
      * is employed
@@ -386,6 +460,41 @@ protected:
         const std::map<std::string, std::vector<LiDARFramePtr>> &undistFrames,
         int ptsCountInEachScan) const;
 
+    /**
+     * perform data association for LiDARs using the out-of-core tiled map. Scans are undistorted
+     * and associated one by one, and dropped once associated, i.e., undistorted scans are never
+     * kept all at once
+     * @param tiledMap the tiled global map
+     * @param ptsCountInEachScan construct how many correspondences in each scan
+     * @return the point-to-surfel correspondences for each LiDAR
+     */
+    std::map<std::string, std::vector<PointToSurfelCorrPtr>> DataAssociationForLiDARs(
+        const LiDARTiledMapPtr &tiledMap, int ptsCountInEachScan) const;
+
+    /**
+     * perform data association for LiDARs using the constructed associator
+     * @param associator the point-to-surfel associator of the global map
+     * @param mapDownSampled the down sampled global map for visualization
+     * @param undistFrames the undistorted scans expressed in the global coordinate frame
+     * @param ptsCountInEachScan construct how many correspondences in each scan
+     * @return the point-to-surfel correspondences for each LiDAR
+     */
+    std::map<std::string, std::vector<PointToSurfelCorrPtr>> DataAssociationForLiDARs(
+        const PointToSurfelAssociatorPtr &associator,
+        IKalibrPointCloudPtr mapDownSampled,
+        const std::map<std::string, std::vector<LiDARFramePtr>> &undistFrames,
+        int ptsCountInEachScan) const;
+
+    /**
+     * perform data association for LiDARs incrementally. The surfel map is kept over calls, only
+     * scans whose points moved more than 'ScanMovementMin' under the current splines are
+     * re-undistorted and re-inserted, and only points in the changed surfels are re-associated
+     * @param ptsCountInEachScan construct how many correspondences in each scan
+     * @return the global lidar map and the point-to-surfel correspondences for each LiDAR
+     */
+    std::pair<IKalibrPointCloudPtr, std::map<std::string, std::vector<PointToSurfelCorrPtr>>>
+    IncrementalDataAssociationForLiDARs(int ptsCountInEachScan);
+
     /**
      * perform data association for pos-derived cameras
      * @return the visual reprojection correspondences for each optical camera
@@ -429,6 +538,51 @@ protected:
         const std::map<std::string, std::vector<IKalibrPointCloudPtr>> &scanInLFrame,
         int ptsCountInEachScan) const;
 
+    /**
+     * perform point-to-surfel association for scans of sensors. If the speed-up option
+     * 'ParallelDataAssociation' is enabled, scans are associated concurrently (the surfel map is
+     * read-only), and correspondences are merged in the order of scans
+     * @param associator the point-to-surfel associator
+     * @param condition the condition for point-to-surfel association
+     * @param scans the (scan in the global frame, scan in the local frame) pairs of each sensor
+     * @return the point-to-surfel correspondences of each scan for each sensor
+     */
+    static std::map<std::string, std::vector<std::vector<PointToSurfelCorrPtr>>>
+    PointToSurfelAssociation(
+        const PointToSurfelAssociatorPtr &associator,
+        const PointToSurfelCondition &condition,
+        const std::map<
+            std::string,
+            std::vector<std::pair<IKalibrPointCloudConstPtr, IKalibrPointCloudConstPtr>>> &scans);
+
+    /**
+     * uniformly sample point-to-surfel correspondences over surfels if they are too many
+     * @param corrs the point-to-surfel correspondences of a sensor
+     * @param expectCount the expected count of correspondences
+     * @return the sampled correspondences
+     */
+    static std::vector<PointToSurfelCorrPtr> DownsamplePointToSurfel(
+        const std::vector<PointToSurfelCorrPtr> &corrs, int expectCount);
+
+    /**
+     * select the most informative point-to-surfel correspondences of a scan under a budget.
+     * Correspondences are bucketed by surfels and their quantized normals (one candidate for each
+     * bucket), then candidates are greedily selected to maximize the determinant of the
+     * point-to-plane information matrix (of the scan pose), which prefers diverse normals
+     * @param corrs the point-to-surfel correspondences of a scan
+     * @param budget the max count of selected correspondences
+     * @return the selected correspondences
+     */
+    static std::vector<PointToSurfelCorrPtr> SelectInformativePointToSurfel(
+        const std::vector<PointToSurfelCorrPtr> &corrs, int budget);
+
+    /**
+     * append the point-to-surfel correspondences of scans to the ones of a sensor, only the
+     * informative ones are appended if 'SpeedUpOption::InformativePointToSurfel' is enabled
+     */
+    static void AppendPointToSurfelOfScan(std::vector<PointToSurfelCorrPtr> &dst,
+                                          const std::vector<PointToSurfelCorrPtr> &corrsOfScan);
+
     /**
      * the final continuous-time-based batch optimization
      * @param optOption the option for optimization, deciding which variable (state) would be
@@ -448,7 +602,7 @@ protected:
         const std::map<std::string, std::vector<OpticalFlowCorrPtr>> &visualVelCorrs,
         const std::map<std::string, std::vector<OpticalFlowCurveCorrPtr>> &eventCorrs,
         const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>>
-            &rgbdPtsCorrs = std::nullopt) const;
+            &rgbdPtsCorrs = std::nullopt);
 
     /**
      * compute the pose of IMU in the global (world) coordinate frame
@@ -497,6 +651,33 @@ protected:
      */
     std::optional<Sophus::SE3d> CurRjToW(double timeByRj, const std::string &topic) const;
 
+    /**
+     * compute poses of a sensor in the global (world) coordinate frame for a sequence of times,
+     * distinct times are evaluated only once
+     * @param timesBySen the times stamped by the sensor, i.e., the raw timestamps
+     * @param TO_SenToBr the time offset from the sensor to the reference IMU
+     * @param SE3_SenToBr the extrinsic from the sensor to the reference IMU
+     * @return the sensor poses, if a timestamp is out of range, the pose is 'std::nullopt'
+     */
+    std::vector<std::optional<Sophus::SE3d>> CurSenToW(const std::vector<double> &timesBySen,
+                                                       double TO_SenToBr,
+                                                       const Sophus::SE3d &SE3_SenToBr) const;
+
+    std::vector<std::optional<Sophus::SE3d>> CurLkToW(const std::vector<double> &timesByLk,
+                                                      const std::string &topic) const;
+
+    std::vector<std::optional<Sophus::SE3d>> CurCmToW(const std::vector<double> &timesByCm,
+                                                      const std::string &topic) const;
+
+    std::vector<std::optional<Sophus::SE3d>> CurEsToW(const std::vector<double> &timesByEs,
+                                                      const std::string &topic) const;
+
+    std::vector<std::optional<Sophus::SE3d>> CurDnToW(const std::vector<double> &timesByDn,
+                                                      const std::string &topic) const;
+
+    std::vector<std::optional<Sophus::SE3d>> CurRjToW(const std::vector<double> &timesByRj,
+                                                      const std::string &topic) const;
+
     /**
      * create a spline bundle, including the rotation and linear scale splines
      * @param st the starr timestamp
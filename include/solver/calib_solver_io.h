@@ -37,6 +37,7 @@
 
 #include "util/cereal_archive_helper.hpp"
 #include "ctraj/core/pose.hpp"
+#include "util/cloud_define.hpp"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -66,6 +67,11 @@ protected:
 
     void SaveLiDARMaps() const;
 
+    /**
+     * obtain the lidar global map, which is assembled from tiles if the tiled map is used
+     */
+    [[nodiscard]] IKalibrPointCloud::Ptr GetLiDARMap() const;
+
     void SaveVisualMaps() const;
 
     void SaveRadarMaps() const;
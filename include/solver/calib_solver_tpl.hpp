@@ -50,11 +50,17 @@ void CalibSolver::AddRadarFactor(Estimator::Ptr &estimator,
                                  Estimator::Opt option) const {
     double weight = Configor::DataStream::RadarTopics.at(radarTopic).Weight;
 
-    for (const auto &targetAry : _dataMagr->GetRadarMeasurements(radarTopic)) {
+    const auto &data = _dataMagr->GetRadarMeasurements(radarTopic);
+    estimator->AddInParallel(static_cast<int>(data.size()), [&](int i) {
+        const auto &targetAry = data.at(i);
+        const double time = targetAry->GetTimestamp();
+        if (!estimator->MayInvolveTimeWindow(time, time)) {
+            return;
+        }
         for (const auto &tar : targetAry->GetTargets()) {
             estimator->AddRadarMeasurement<type>(tar, radarTopic, option, weight);
         }
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -63,9 +69,15 @@ void CalibSolver::AddAcceFactor(Estimator::Ptr &estimator,
                                 Estimator::Opt option) const {
     double weight = Configor::DataStream::IMUTopics.at(imuTopic).AcceWeight;
 
-    for (const auto &item : _dataMagr->GetIMUMeasurements(imuTopic)) {
+    const auto &data = _dataMagr->GetIMUMeasurements(imuTopic);
+    estimator->AddInParallel(static_cast<int>(data.size()), [&](int i) {
+        const auto &item = data.at(i);
+        const double time = item->GetTimestamp();
+        if (!estimator->MayInvolveTimeWindow(time, time)) {
+            return;
+        }
         estimator->AddIMUAcceMeasurement<type>(item, imuTopic, option, weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -75,10 +87,14 @@ void CalibSolver::AddLiDARPointToSurfelFactor(Estimator::Ptr &estimator,
                                               Estimator::Opt option) {
     double weight = Configor::DataStream::LiDARTopics.at(lidarTopic).Weight;
 
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timestamp, corr->timestamp)) {
+            return;
+        }
         estimator->AddLiDARPointToSurfelConstraint<type>(corr, lidarTopic, option,
                                                          weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -88,10 +104,14 @@ void CalibSolver::AddRGBDPointToSurfelFactor(Estimator::Ptr &estimator,
                                              Estimator::Opt option) {
     double weight = Configor::DataStream::RGBDTopics.at(rgbdTopic).Weight;
 
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timestamp, corr->timestamp)) {
+            return;
+        }
         estimator->AddRGBDPointTiSurfelConstraint<type>(corr, rgbdTopic, option,
                                                         weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -102,12 +122,16 @@ void CalibSolver::AddVisualReprojectionFactor(Estimator::Ptr &estimator,
                                               Estimator::Opt option) {
     double weight = Configor::DataStream::CameraTopics.at(camTopic).Weight;
 
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
         for (const auto &c : corr->corrs) {
+            if (!estimator->MayInvolveTimeWindow(std::min(c->ti, c->tj), std::max(c->ti, c->tj))) {
+                continue;
+            }
             estimator->AddVisualReprojection<type>(
                 c, camTopic, globalScale, corr->invDepthFir.get(), option, weight * c->weight);
         }
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -116,10 +140,14 @@ void CalibSolver::AddRGBDOpticalFlowFactor(Estimator::Ptr &estimator,
                                            const std::vector<OpticalFlowCorr::Ptr> &corrs,
                                            Estimator::Opt option) {
     double weight = Configor::DataStream::RGBDTopics.at(rgbdTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         estimator->AddRGBDOpticalFlowConstraint<type, IsInvDepth>(corr, rgbdTopic, option,
                                                                   weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -128,10 +156,14 @@ void CalibSolver::AddVisualOpticalFlowFactor(Estimator::Ptr &estimator,
                                              const std::vector<OpticalFlowCorr::Ptr> &corrs,
                                              Estimator::Opt option) {
     double weight = Configor::DataStream::CameraTopics.at(camTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         estimator->AddVisualOpticalFlowConstraint<type, IsInvDepth>(corr, camTopic, option,
                                                                     weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -140,10 +172,14 @@ void CalibSolver::AddEventOpticalFlowFactor(EstimatorPtr &estimator,
                                             const std::vector<OpticalFlowCorrPtr> &corrs,
                                             OptOption option) {
     double weight = Configor::DataStream::EventTopics.at(eventTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         estimator->AddEventOpticalFlowConstraint<type, IsInvDepth>(corr, eventTopic, option,
                                                                    weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -152,10 +188,14 @@ void CalibSolver::AddEventOpticalFlowFactor(EstimatorPtr &estimator,
                                             const std::vector<OpticalFlowCurveCorr::Ptr> &corrs,
                                             OptOption option) {
     double weight = Configor::DataStream::EventTopics.at(eventTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->firTime, corr->lastTime)) {
+            return;
+        }
         estimator->AddEventOpticalFlowConstraint<type, IsInvDepth>(corr, eventTopic, option,
                                                                    weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -164,7 +204,11 @@ void CalibSolver::AddVisualOpticalFlowReprojFactor(Estimator::Ptr &estimator,
                                                    const std::vector<OpticalFlowCorr::Ptr> &corrs,
                                                    Estimator::Opt option) {
     double weight = 10.0 * Configor::DataStream::CameraTopics.at(camTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         /**
          * given a optical flow tracking correspondence (triple tracking, three points), we throw
          * the middle feature to the camera frame and reproject it to the first and last camera
@@ -176,7 +220,7 @@ void CalibSolver::AddVisualOpticalFlowReprojFactor(Estimator::Ptr &estimator,
          */
         estimator->AddVisualOpticalFlowReprojConstraint<type, IsInvDepth>(corr, camTopic, option,
                                                                           weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type>
@@ -185,10 +229,14 @@ void CalibSolver::AddVisualPPPTrifocalTensorFactor(EstimatorPtr &estimator,
                                                    const std::vector<OpticalFlowCorrPtr> &corrs,
                                                    OptOption option) {
     double weight = 1E5 * Configor::DataStream::CameraTopics.at(camTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         estimator->AddVisualPPPTrifocalTensorFactorForVelCam<type>(corr, camTopic, option,
                                                                    weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -197,7 +245,11 @@ void CalibSolver::AddRGBDOpticalFlowReprojFactor(Estimator::Ptr &estimator,
                                                  const std::vector<OpticalFlowCorr::Ptr> &corrs,
                                                  Estimator::Opt option) {
     double weight = 10.0 * Configor::DataStream::RGBDTopics.at(camTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->timeAry.front(), corr->timeAry.back())) {
+            return;
+        }
         /**
          * given a optical flow tracking correspondence (triple tracking, three points), we throw
          * the middle feature to the camera frame and reproject it to the first and last camera
@@ -209,7 +261,7 @@ void CalibSolver::AddRGBDOpticalFlowReprojFactor(Estimator::Ptr &estimator,
          */
         estimator->AddRGBDOpticalFlowReprojConstraint<type, IsInvDepth>(corr, camTopic, option,
                                                                         weight * corr->weight);
-    }
+    });
 }
 
 template <TimeDeriv::ScaleSplineType type, bool IsInvDepth>
@@ -218,7 +270,11 @@ void CalibSolver::AddEventOpticalFlowReprojFactor(EstimatorPtr &estimator,
                                                   const std::vector<OpticalFlowCurveCorrPtr> &corrs,
                                                   OptOption option) {
     double weight = 10.0 * Configor::DataStream::EventTopics.at(eventTopic).Weight;
-    for (const auto &corr : corrs) {
+    estimator->AddInParallel(static_cast<int>(corrs.size()), [&](int i) {
+        const auto &corr = corrs.at(i);
+        if (!estimator->MayInvolveTimeWindow(corr->firTime, corr->lastTime)) {
+            return;
+        }
         /**
          * given a optical flow tracking correspondence (triple tracking, three points), we throw
          * the middle feature to the camera frame and reproject it to the first and last camera
@@ -230,7 +286,7 @@ void CalibSolver::AddEventOpticalFlowReprojFactor(EstimatorPtr &estimator,
          */
         estimator->AddEventOpticalFlowReprojConstraint<type, IsInvDepth>(corr, eventTopic, option,
                                                                          weight * corr->weight);
-    }
+    });
 }
 }  // namespace ns_ikalibr
 
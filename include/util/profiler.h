@@ -0,0 +1,137 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IKALIBR_PROFILER_H
+#define IKALIBR_PROFILER_H
+
+#include "chrono"
+#include "ctime"
+#include "map"
+#include "mutex"
+#include "string"
+#include "vector"
+#include "cereal/cereal.hpp"
+#include "cereal/types/map.hpp"
+#include "cereal/types/string.hpp"
+#include "util/utils.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+struct ProfileRecord {
+public:
+    // the name of the profiled stage, e.g., the function name
+    std::string stage;
+    // the index of this stage, as a stage may be profiled for multiple times
+    int index = 0;
+    // the wall-clock time (s) when this stage starts, relative to the start of the program
+    double startTime = 0.0;
+    // the wall-clock time (s) cost by this stage
+    double wallTime = 0.0;
+    // the cpu time (s) of the process (all threads) cost by this stage
+    double cpuTime = 0.0;
+    // the resident set size (MB) of the process when this stage ends
+    double rss = 0.0;
+    // the peak resident set size (MB) of the process when this stage ends
+    double peakRSS = 0.0;
+    // additional stage-specific metrics, e.g., residual block counts and solver timings
+    std::map<std::string, double> metrics;
+
+public:
+    template <class Archive>
+    void serialize(Archive &ar) {
+        ar(CEREAL_NVP(stage), CEREAL_NVP(index), cereal::make_nvp("start_time", startTime),
+           cereal::make_nvp("wall_time", wallTime), cereal::make_nvp("cpu_time", cpuTime),
+           CEREAL_NVP(rss), cereal::make_nvp("peak_rss", peakRSS), CEREAL_NVP(metrics));
+    }
+};
+
+/**
+ * the profiler collects time and memory consumption of stages in the calibration, the records are
+ * stored globally (like the 'Configor') and can be output as a report
+ */
+class Profiler {
+public:
+    /**
+     * the scoped profiler, the stage starts when it is constructed and ends when it is
+     * deconstructed, where the record would be committed to the 'Profiler'
+     */
+    class Scope {
+    private:
+        ProfileRecord _record;
+        std::chrono::steady_clock::time_point _wallStart;
+        std::clock_t _cpuStart;
+
+    public:
+        explicit Scope(std::string stage);
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        Scope &AddMetric(const std::string &key, double value);
+
+        ~Scope();
+    };
+
+private:
+    static std::mutex _mutex;
+    static std::vector<ProfileRecord> _records;
+    static const std::chrono::steady_clock::time_point _origin;
+
+public:
+    // thread-safe, the index of the record would be assigned here
+    static void Commit(ProfileRecord record);
+
+    static std::vector<ProfileRecord> GetRecords();
+
+    // the current and peak resident set size (MB) of the process, read from '/proc/self/status'
+    static std::pair<double, double> ResidentSetSize();
+
+    // wall-clock time (s) from the start of the program
+    static double ElapsedTime();
+
+    /**
+     * save the records to the directory as a json report ('profile.json'), the stage records and
+     * their metrics are also output as csv files ('stages.csv' and 'metrics.csv')
+     */
+    static void SaveReport(const std::string &saveDir);
+};
+
+}  // namespace ns_ikalibr
+
+#endif  // IKALIBR_PROFILER_H
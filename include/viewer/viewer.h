@@ -43,6 +43,7 @@
 #include "util/cloud_define.hpp"
 #include "veta/veta.h"
 #include "ufo/map/surfel_map.h"
+#include "mutex"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -85,6 +86,8 @@ private:
     SplineBundleType::Ptr _splines;
 
     std::map<std::string, std::vector<std::size_t>> _entities;
+    // entities may be added from multiple threads (e.g., the concurrent initialization)
+    std::recursive_mutex _entityMutex;
 
 public:
     explicit Viewer(CalibParamManagerPtr parMagr, SplineBundleType::Ptr splines);
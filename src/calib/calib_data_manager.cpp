@@ -43,6 +43,8 @@
 #include "sensor/radar_data_loader.h"
 #include "spdlog/spdlog.h"
 #include "util/tqdm.h"
+#include "util/utils_tpl.hpp"
+#include "omp.h"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -61,6 +63,107 @@ CalibDataManager::Ptr CalibDataManager::Create() { return std::make_shared<Calib
 void CalibDataManager::LoadCalibData() {
     spdlog::info("loading calibration data...");
 
+    const bool useCache =
+        IsOptionWith(SpeedUpOption::CalibDataCache, Configor::Preference::SpeedUps);
+    const auto cacheFile = useCache ? CalibDataCachePath() : std::nullopt;
+    if (useCache && cacheFile == std::nullopt) {
+        spdlog::warn("the ros bag '{}' can not be inspected, skip the calibration data cache.",
+                     Configor::DataStream::BagPath);
+    }
+
+    if (cacheFile != std::nullopt && LoadCalibDataFromCache(*cacheFile)) {
+        // the cached data has been adjusted and aligned
+        spdlog::info("calibration data is loaded from the cache '{}'.", *cacheFile);
+        OutputDataStatus();
+    } else {
+        LoadCalibDataFromBag();
+
+        AdjustCalibDataSequence();
+        AlignTimestamp();
+
+        if (cacheFile != std::nullopt) {
+            if (SaveCalibDataToCache(*cacheFile)) {
+                spdlog::info("calibration data is cached to '{}'.", *cacheFile);
+            } else {
+                spdlog::warn("save calibration data to the cache '{}' failed!", *cacheFile);
+            }
+        }
+    }
+
+    /**
+     * to calibrate velocity-spline-derived cameras, high sampling frequency is required (larger
+     * than 30 Hz), to perform high-precision optical flow velocity recovery
+     */
+    for (const auto &[topic, _] : Configor::DataStream::VelCameraTopics()) {
+        auto freq = GetCameraAvgFrequency(topic);
+        spdlog::info("sampling frequency for camera '{}': {:.3f}", topic, freq);
+        if (freq < 29.0) {
+            throw Status(
+                Status::WARNING,
+                "Sampling frequency of vel camera '{}' (freq: {:.3f}) is too small!!! "
+                "Frequency larger than 30 Hz is required!!! Please change 'ScaleSplineType' of "
+                "this camera to 'LIN_POS_SPLINE' which would perform a SfM-based calibration!!! Do "
+                "not forget to change its weight!",
+                topic, freq);
+        }
+    }
+
+    for (const auto &[topic, _] : Configor::DataStream::RGBDTopics) {
+        auto freq = GetRGBDAvgFrequency(topic);
+        spdlog::info("sampling frequency for rgbd camera '{}': {:.3f}", topic, freq);
+        if (freq < 29.0) {
+            throw Status(Status::WARNING,
+                         "Sampling frequency of rgbd camera '{}' (freq: {:.3f}) is too small!!! "
+                         "Frequency larger than 30 Hz is required!!! Please throw the depth "
+                         "information and treat it an optical camera, and perform "
+                         "'LIN_POS_SPLINE'-based calibration.",
+                         topic, freq);
+        }
+    }
+}
+
+void CalibDataManager::LoadCalibData(
+    std::map<std::string, std::vector<IMUFrame::Ptr>> imuMes,
+    std::map<std::string, std::vector<RadarTargetArray::Ptr>> radarMes,
+    std::map<std::string, std::vector<LiDARFrame::Ptr>> lidarMes,
+    std::map<std::string, std::vector<CameraFrame::Ptr>> camMes,
+    std::map<std::string, std::vector<EventArray::Ptr>> eventMes) {
+    spdlog::info("loading calibration data from the memory...");
+
+    if (!Configor::DataStream::RGBDTopics.empty()) {
+        throw Status(Status::ERROR,
+                     "rgbd cameras are not supported when loading calibration data from the "
+                     "memory!");
+    }
+
+    _imuMes = std::move(imuMes);
+    _radarMes = std::move(radarMes);
+    _lidarMes = std::move(lidarMes);
+    _camMes = std::move(camMes);
+    _eventMes = std::move(eventMes);
+
+    for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+        CheckTopicExists(topic, _imuMes);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+        CheckTopicExists(topic, _radarMes);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::LiDARTopics) {
+        CheckTopicExists(topic, _lidarMes);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::CameraTopics) {
+        CheckTopicExists(topic, _camMes);
+    }
+    for (const auto &[topic, _] : Configor::DataStream::EventTopics) {
+        CheckTopicExists(topic, _eventMes);
+    }
+    OutputDataStatus();
+
+    AdjustCalibDataSequence();
+    AlignTimestamp();
+}
+
+void CalibDataManager::LoadCalibDataFromBag() {
     // open the ros bag
     auto bag = std::make_unique<rosbag::Bag>();
     if (!std::filesystem::exists(Configor::DataStream::BagPath)) {
@@ -135,119 +238,265 @@ void CalibDataManager::LoadCalibData() {
     // for rgbd cameras
     std::map<std::string, CameraDataLoader::Ptr> rgbdColorDataLoaders;
     std::map<std::string, DepthDataLoader::Ptr> rgbdDepthDataLoaders;
-    // temporal data containers ('list' containers)
-    std::map<std::string, std::list<CameraFrame::Ptr>> rgbdColorMesTemp;
-    std::map<std::string, std::list<DepthFrame::Ptr>> rgbdDepthMesTemp;
+    // the number of messages of each topic in the expected time range
+    std::map<std::string, std::uint32_t> mesNumInTopics;
 
     // get type enum from the string
     for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
         imuDataLoaders.insert({topic, IMUDataLoader::GetLoader(config.Type)});
-        // reserve tp speed up the data loading
-        auto size = MessageNumInTopic(bag.get(), topic, begTime, endTime);
-        if (size > 0) {
-            _imuMes[topic].reserve(size);
-        }
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
     }
     for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
         radarDataLoaders.insert({topic, RadarDataLoader::GetLoader(config.Type)});
-        // reserve tp speed up the data loading
-        auto size = MessageNumInTopic(bag.get(), topic, begTime, endTime);
-        if (size > 0) {
-            _radarMes[topic].reserve(size);
-        }
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
     }
     for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
         lidarDataLoaders.insert({topic, LiDARDataLoader::GetLoader(config.Type)});
-        // reserve tp speed up the data loading
-        auto size = MessageNumInTopic(bag.get(), topic, begTime, endTime);
-        if (size > 0) {
-            _lidarMes[topic].reserve(size);
-        }
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
     }
     for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
         cameraDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
-        // reserve tp speed up the data loading
-        auto size = MessageNumInTopic(bag.get(), topic, begTime, endTime);
-        if (size > 0) {
-            _camMes[topic].reserve(size);
-        }
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
     }
     for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
         rgbdColorDataLoaders.insert({topic, CameraDataLoader::GetLoader(config.Type)});
         bool isInverse = config.DepthFactor < 0.0f;
         rgbdDepthDataLoaders.insert(
             {config.DepthTopic, DepthDataLoader::GetLoader(config.Type, isInverse)});
-        // reserve tp speed up the data loading
-        // 'rgbdColorMesTemp' and 'rgbdDepthMesTemp' are std::list, three is no need to 'reserve'
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
+        mesNumInTopics[config.DepthTopic] =
+            MessageNumInTopic(bag.get(), config.DepthTopic, begTime, endTime);
     }
     for (const auto &[topic, config] : Configor::DataStream::EventTopics) {
         eventDataLoaders.insert({topic, EventDataLoader::GetLoader(config.Type)});
-        // reserve tp speed up the data loading
-        auto size = MessageNumInTopic(bag.get(), topic, begTime, endTime);
-        if (size > 0) {
-            _eventMes[topic].reserve(size);
-        }
+        mesNumInTopics[topic] = MessageNumInTopic(bag.get(), topic, begTime, endTime);
     }
 
-    // read raw data
-    auto bar = std::make_shared<tqdm>();
-    int idx = 0;
-    for (auto iter = view.begin(); iter != view.end(); ++iter, ++idx) {
-        bar->progress(idx, static_cast<int>(view.size()));
-        const auto &item = *iter;
+    // the unpacked measurements, the rgbd ones are stored in 'list' containers temporally
+    struct MesBuffer {
+        std::map<std::string, std::vector<IMUFrame::Ptr>> imuMes;
+        std::map<std::string, std::vector<RadarTargetArray::Ptr>> radarMes;
+        std::map<std::string, std::vector<LiDARFrame::Ptr>> lidarMes;
+        std::map<std::string, std::vector<CameraFrame::Ptr>> camMes;
+        std::map<std::string, std::vector<EventArray::Ptr>> eventMes;
+        std::map<std::string, std::list<CameraFrame::Ptr>> rgbdColorMes;
+        std::map<std::string, std::list<DepthFrame::Ptr>> rgbdDepthMes;
+    };
+
+    // lidar scans are compacted once unpacked, so that the full scans never pile up in memory
+    const bool compactScans =
+        IsOptionWith(SpeedUpOption::CompactLiDARScans, Configor::Preference::SpeedUps);
+
+    // unpack a message instance using the data loader of its topic, shared by the serial and
+    // parallel loading, so that they produce the same measurements
+    auto UnpackMessage = [&](const rosbag::MessageInstance &item, MesBuffer &buffer) {
         const std::string &topic = item.getTopic();
-        if (imuDataLoaders.cend() != imuDataLoaders.find(topic)) {
+        if (auto imuIter = imuDataLoaders.find(topic); imuIter != imuDataLoaders.cend()) {
             // is an inertial frame
-            auto mes = imuDataLoaders.at(topic)->UnpackFrame(item);
+            auto mes = imuIter->second->UnpackFrame(item);
             if (mes != nullptr) {
-                _imuMes[topic].push_back(mes);
+                buffer.imuMes[topic].push_back(mes);
             }
-        } else if (radarDataLoaders.cend() != radarDataLoaders.find(topic)) {
+        } else if (auto radarIter = radarDataLoaders.find(topic);
+                   radarIter != radarDataLoaders.cend()) {
             // is a radar frame
-            auto mes = radarDataLoaders.at(topic)->UnpackScan(item);
+            auto mes = radarIter->second->UnpackScan(item);
             if (mes != nullptr) {
-                _radarMes[topic].push_back(mes);
+                buffer.radarMes[topic].push_back(mes);
             }
-        } else if (lidarDataLoaders.cend() != lidarDataLoaders.find(topic)) {
+        } else if (auto lidarIter = lidarDataLoaders.find(topic);
+                   lidarIter != lidarDataLoaders.cend()) {
             // is a lidar frame
-            auto mes = lidarDataLoaders.at(topic)->UnpackScan(item);
+            auto mes = lidarIter->second->UnpackScan(item);
             if (mes != nullptr) {
-                _lidarMes[topic].push_back(mes);
+                if (compactScans) {
+                    mes->Compact(Configor::Prior::CompactLiDARScanResolution);
+                }
+                buffer.lidarMes[topic].push_back(mes);
             }
-        } else if (rgbdColorDataLoaders.cend() != rgbdColorDataLoaders.find(topic)) {
+        } else if (auto colorIter = rgbdColorDataLoaders.find(topic);
+                   colorIter != rgbdColorDataLoaders.cend()) {
             // is a rgbd color frame
-            auto mes = rgbdColorDataLoaders.at(topic)->UnpackFrame(item);
+            auto mes = colorIter->second->UnpackFrame(item);
             if (mes != nullptr) {
                 // id: uint64_t from timestamp (raw, millisecond)
                 mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                rgbdColorMesTemp[topic].push_back(mes);
+                buffer.rgbdColorMes[topic].push_back(mes);
             }
-        } else if (rgbdDepthDataLoaders.cend() != rgbdDepthDataLoaders.find(topic)) {
+        } else if (auto depthIter = rgbdDepthDataLoaders.find(topic);
+                   depthIter != rgbdDepthDataLoaders.cend()) {
             // is a rgbd depth frame
-            auto mes = rgbdDepthDataLoaders.at(topic)->UnpackFrame(item);
+            auto mes = depthIter->second->UnpackFrame(item);
             if (mes != nullptr) {
                 // id: uint64_t from timestamp (raw, millisecond)
                 mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                rgbdDepthMesTemp[topic].push_back(mes);
+                buffer.rgbdDepthMes[topic].push_back(mes);
             }
-        } else if (cameraDataLoaders.cend() != cameraDataLoaders.find(topic)) {
+        } else if (auto camIter = cameraDataLoaders.find(topic);
+                   camIter != cameraDataLoaders.cend()) {
             // is a camera frame
-            auto mes = cameraDataLoaders.at(topic)->UnpackFrame(item);
+            auto mes = camIter->second->UnpackFrame(item);
             if (mes != nullptr) {
                 // id: uint64_t from timestamp (raw, millisecond)
                 mes->SetId(static_cast<ns_veta::IndexT>(mes->GetTimestamp() * 1E3));
-                _camMes[topic].push_back(mes);
+                buffer.camMes[topic].push_back(mes);
             }
-        } else if (eventDataLoaders.cend() != eventDataLoaders.find(topic)) {
-            // is a camera frame
-            auto mes = eventDataLoaders.at(topic)->UnpackData(item);
+        } else if (auto eventIter = eventDataLoaders.find(topic);
+                   eventIter != eventDataLoaders.cend()) {
+            // is an event array
+            auto mes = eventIter->second->UnpackData(item);
             if (mes != nullptr) {
-                _eventMes[topic].push_back(mes);
+                buffer.eventMes[topic].push_back(mes);
+            }
+        }
+    };
+
+    MesBuffer mesBuffer;
+    // reserve tp speed up the data loading
+    // 'rgbdColorMes' and 'rgbdDepthMes' are std::list, three is no need to 'reserve'
+    auto ReserveMes = [&mesNumInTopics](auto &mesMap, const auto &topics) {
+        for (const auto &[topic, _] : topics) {
+            if (auto size = mesNumInTopics.at(topic); size > 0) {
+                mesMap[topic].reserve(size);
+            }
+        }
+    };
+    ReserveMes(mesBuffer.imuMes, Configor::DataStream::IMUTopics);
+    ReserveMes(mesBuffer.radarMes, Configor::DataStream::RadarTopics);
+    ReserveMes(mesBuffer.lidarMes, Configor::DataStream::LiDARTopics);
+    ReserveMes(mesBuffer.camMes, Configor::DataStream::CameraTopics);
+    ReserveMes(mesBuffer.eventMes, Configor::DataStream::EventTopics);
+
+    const int threads = Configor::Preference::AvailableThreads();
+    if (IsOptionWith(SpeedUpOption::ParallelDataLoading, Configor::Preference::SpeedUps) &&
+        threads > 1) {
+        /**
+         * the query is split into shards, each of which covers a single topic in a time chunk
+         * ([chunk begin, chunk end], no overlap between chunks), so that heavy topics (lidars,
+         * cameras, event cameras) are decoded by multiple workers. Each worker opens its own
+         * bag, as 'rosbag::Bag' is not thread-safe. Measurements of a topic are then merged in
+         * the order of their chunks, which keeps them identical to the serial loading.
+         */
+        struct Shard {
+            std::string topic;
+            ros::Time begTime, endTime;
+        };
+        std::vector<Shard> shards;
+        const std::uint64_t totalMesNum = std::max<std::uint64_t>(view.size(), 1);
+        const std::uint64_t begNSec = begTime.toNSec(), endNSec = endTime.toNSec();
+        const std::uint64_t spanNSec = endNSec - begNSec;
+        for (const auto &[topic, mesNum] : mesNumInTopics) {
+            if (mesNum == 0) {
+                continue;
+            }
+            // about 4 shards for each thread, distributed according to the message number
+            std::uint64_t chunkNum = std::clamp<std::uint64_t>(
+                std::uint64_t(mesNum) * threads * 4 / totalMesNum, 1,
+                std::min<std::uint64_t>(mesNum, 1024));
+            for (std::uint64_t i = 0; i < chunkNum; ++i) {
+                std::uint64_t sNSec = begNSec + spanNSec * i / chunkNum;
+                std::uint64_t eNSec = endNSec;
+                if (i + 1 != chunkNum) {
+                    std::uint64_t nextNSec = begNSec + spanNSec * (i + 1) / chunkNum;
+                    if (nextNSec <= sNSec) {
+                        // no valid time point in this chunk
+                        continue;
+                    }
+                    eNSec = nextNSec - 1;
+                }
+                Shard shard{topic, ros::Time(), ros::Time()};
+                shard.begTime.fromNSec(sNSec), shard.endTime.fromNSec(eNSec);
+                shards.push_back(shard);
+            }
+        }
+        spdlog::info("load data from '{}' topics using '{}' shards and '{}' threads in parallel",
+                     mesNumInTopics.size(), shards.size(), threads);
+
+        std::vector<MesBuffer> shardBuffers(shards.size());
+        // each thread holds its own ros bag
+        std::vector<std::unique_ptr<rosbag::Bag>> threadBags(threads);
+        std::exception_ptr exception = nullptr;
+        auto bar = std::make_shared<tqdm>();
+        std::uint64_t loadedMesNum = 0;
+
+#pragma omp parallel for num_threads(threads) schedule(dynamic) default(none) \
+    shared(shards, shardBuffers, threadBags, exception, bar, loadedMesNum, totalMesNum, UnpackMessage)
+        for (int i = 0; i < static_cast<int>(shards.size()); ++i) {
+            try {
+                auto &curBag = threadBags.at(omp_get_thread_num());
+                if (curBag == nullptr) {
+                    curBag = std::make_unique<rosbag::Bag>();
+                    curBag->open(Configor::DataStream::BagPath, rosbag::BagMode::Read);
+                }
+                const auto &shard = shards.at(i);
+                auto shardView = rosbag::View();
+                shardView.addQuery(*curBag, rosbag::TopicQuery({shard.topic}), shard.begTime,
+                                   shard.endTime);
+                for (const auto &item : shardView) {
+                    UnpackMessage(item, shardBuffers.at(i));
+                }
+#pragma omp critical
+                {
+                    loadedMesNum += shardView.size();
+                    bar->progress(static_cast<int>(loadedMesNum), static_cast<int>(totalMesNum));
+                }
+            } catch (...) {
+#pragma omp critical
+                {
+                    if (exception == nullptr) {
+                        exception = std::current_exception();
+                    }
+                }
+            }
+        }
+        bar->finish();
+        for (auto &curBag : threadBags) {
+            if (curBag != nullptr) {
+                curBag->close();
+            }
+        }
+        bag->close();
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+
+        // merge measurements of shards, shards of a topic are organized in time order
+        auto MergeMes = [](auto &dstMap, auto &srcMap) {
+            for (auto &[topic, mes] : srcMap) {
+                auto &dst = dstMap[topic];
+                dst.insert(dst.end(), std::make_move_iterator(mes.begin()),
+                           std::make_move_iterator(mes.end()));
             }
+        };
+        for (auto &buffer : shardBuffers) {
+            MergeMes(mesBuffer.imuMes, buffer.imuMes);
+            MergeMes(mesBuffer.radarMes, buffer.radarMes);
+            MergeMes(mesBuffer.lidarMes, buffer.lidarMes);
+            MergeMes(mesBuffer.camMes, buffer.camMes);
+            MergeMes(mesBuffer.eventMes, buffer.eventMes);
+            MergeMes(mesBuffer.rgbdColorMes, buffer.rgbdColorMes);
+            MergeMes(mesBuffer.rgbdDepthMes, buffer.rgbdDepthMes);
         }
+    } else {
+        // read raw data
+        auto bar = std::make_shared<tqdm>();
+        int idx = 0;
+        for (auto iter = view.begin(); iter != view.end(); ++iter, ++idx) {
+            bar->progress(idx, static_cast<int>(view.size()));
+            UnpackMessage(*iter, mesBuffer);
+        }
+        bar->finish();
+        bag->close();
     }
-    bar->finish();
-    bag->close();
+
+    _imuMes = std::move(mesBuffer.imuMes);
+    _radarMes = std::move(mesBuffer.radarMes);
+    _lidarMes = std::move(mesBuffer.lidarMes);
+    _camMes = std::move(mesBuffer.camMes);
+    _eventMes = std::move(mesBuffer.eventMes);
+    // temporal data containers ('list' containers)
+    auto &rgbdColorMesTemp = mesBuffer.rgbdColorMes;
+    auto &rgbdDepthMesTemp = mesBuffer.rgbdDepthMes;
 
     for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
         CheckTopicExists(topic, _imuMes);
@@ -341,40 +590,6 @@ void CalibDataManager::LoadCalibData() {
     }
 
     OutputDataStatus();
-
-    AdjustCalibDataSequence();
-    AlignTimestamp();
-
-    /**
-     * to calibrate velocity-spline-derived cameras, high sampling frequency is required (larger
-     * than 30 Hz), to perform high-precision optical flow velocity recovery
-     */
-    for (const auto &[topic, _] : Configor::DataStream::VelCameraTopics()) {
-        auto freq = GetCameraAvgFrequency(topic);
-        spdlog::info("sampling frequency for camera '{}': {:.3f}", topic, freq);
-        if (freq < 29.0) {
-            throw Status(
-                Status::WARNING,
-                "Sampling frequency of vel camera '{}' (freq: {:.3f}) is too small!!! "
-                "Frequency larger than 30 Hz is required!!! Please change 'ScaleSplineType' of "
-                "this camera to 'LIN_POS_SPLINE' which would perform a SfM-based calibration!!! Do "
-                "not forget to change its weight!",
-                topic, freq);
-        }
-    }
-
-    for (const auto &[topic, _] : Configor::DataStream::RGBDTopics) {
-        auto freq = GetRGBDAvgFrequency(topic);
-        spdlog::info("sampling frequency for rgbd camera '{}': {:.3f}", topic, freq);
-        if (freq < 29.0) {
-            throw Status(Status::WARNING,
-                         "Sampling frequency of rgbd camera '{}' (freq: {:.3f}) is too small!!! "
-                         "Frequency larger than 30 Hz is required!!! Please throw the depth "
-                         "information and treat it an optical camera, and perform "
-                         "'LIN_POS_SPLINE'-based calibration.",
-                         topic, freq);
-        }
-    }
 }
 
 void CalibDataManager::AdjustCalibDataSequence() {
@@ -673,7 +888,11 @@ void CalibDataManager::AlignTimestamp() {
     for (const auto &[topic, data] : _lidarMes) {
         for (const auto &item : data) {
             item->SetTimestamp(item->GetTimestamp() - _rawStartTimestamp);
-            for (auto &p : *item->GetScan()) {
+            // point times of compacted frames are relative, which have been shifted with frames
+            if (item->IsCompact()) {
+                continue;
+            }
+            for (auto &p : *item->GetMutableScan()) {
                 p.timestamp -= _rawStartTimestamp;
             }
         }
@@ -693,9 +912,7 @@ void CalibDataManager::AlignTimestamp() {
             // array
             array->SetTimestamp(array->GetTimestamp() - _rawStartTimestamp);
             // targets
-            for (auto &tar : array->GetEvents()) {
-                tar->SetTimestamp(tar->GetTimestamp() - _rawStartTimestamp);
-            }
+            array->ShiftEventTimestamps(-_rawStartTimestamp);
         }
     }
     OutputDataStatus();
@@ -895,14 +1112,17 @@ const std::map<std::string, ns_veta::Veta::Ptr> &CalibDataManager::GetSfMData()
 }
 
 const ns_veta::Veta::Ptr &CalibDataManager::GetSfMData(const std::string &camTopic) const {
+    std::lock_guard<std::mutex> lock(_visualDataMutex);
     return _sfmData.at(camTopic);
 }
 
 void CalibDataManager::SetSfMData(const std::string &camTopic, const ns_veta::Veta::Ptr &veta) {
+    std::lock_guard<std::mutex> lock(_visualDataMutex);
     _sfmData[camTopic] = veta;
 }
 void CalibDataManager::SetVisualOpticalFlowTrace(
     const std::string &visualTopic, const std::vector<OpticalFlowTripleTrace::Ptr> &dynamics) {
+    std::lock_guard<std::mutex> lock(_visualDataMutex);
     _visualOpticalFlowTrace[visualTopic] = dynamics;
 }
 
@@ -918,6 +1138,7 @@ const std::vector<FeatureTrackingCurvePtr> &CalibDataManager::GetVisualFeatureTr
 
 const std::vector<OpticalFlowTripleTrace::Ptr> &CalibDataManager::GetVisualOpticalFlowTrace(
     const std::string &visualTopic) const {
+    std::lock_guard<std::mutex> lock(_visualDataMutex);
     return _visualOpticalFlowTrace.at(visualTopic);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
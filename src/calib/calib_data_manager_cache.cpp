@@ -0,0 +1,648 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/calib_data_manager.h"
+#include "util/utils_tpl.hpp"
+#include "spdlog/spdlog.h"
+#include "filesystem"
+#include "fstream"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "fcntl.h"
+#include "unistd.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+/**
+ * the layout of the calibration data cache file (all blocks are 8-byte aligned):
+ * | magic | version | key | timestamps | imu | radar | lidar | camera | rgbd | event |
+ * each block is stored as [byte size (uint64) | raw bytes | padding], and the measurements of a
+ * topic are stored column by column (e.g., timestamps, xyz, ...), so that the file can be mapped
+ * into memory and the columns are directly accessed without any parsing.
+ */
+const static std::string CalibDataCacheMagic = "iKalibr-calib-data-cache";
+// increase the version once the layout changes
+const static std::uint64_t CalibDataCacheVersion = 1;
+
+class CalibDataCacheWriter {
+private:
+    std::ofstream _file;
+
+public:
+    explicit CalibDataCacheWriter(const std::string &filename)
+        : _file(filename, std::ios::binary | std::ios::out | std::ios::trunc) {}
+
+    [[nodiscard]] bool IsGood() const { return _file.good(); }
+
+    template <typename Type>
+    void WriteColumn(const Type *data, std::size_t size) {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        const std::uint64_t bytes = size * sizeof(Type);
+        _file.write(reinterpret_cast<const char *>(&bytes), sizeof(std::uint64_t));
+        if (bytes > 0) {
+            _file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        }
+        static const char padding[8] = {};
+        if (auto rem = bytes % 8; rem != 0) {
+            _file.write(padding, static_cast<std::streamsize>(8 - rem));
+        }
+    }
+
+    template <typename Type>
+    void WriteColumn(const std::vector<Type> &column) {
+        WriteColumn(column.data(), column.size());
+    }
+
+    template <typename Type>
+    void WriteValue(const Type &value) {
+        WriteColumn(&value, 1);
+    }
+
+    void WriteString(const std::string &str) { WriteColumn(str.data(), str.size()); }
+
+    // mats are stored as three columns: [rows, cols, type], data offsets, and the data bytes
+    void WriteMats(const std::vector<cv::Mat> &mats) {
+        std::vector<std::int32_t> headers;
+        std::vector<std::uint64_t> offsets{0};
+        headers.reserve(mats.size() * 3), offsets.reserve(mats.size() + 1);
+        for (const auto &mat : mats) {
+            headers.push_back(mat.rows);
+            headers.push_back(mat.cols);
+            headers.push_back(mat.type());
+            offsets.push_back(offsets.back() + mat.total() * mat.elemSize());
+        }
+        std::vector<std::uint8_t> bytes(offsets.back());
+        for (int i = 0; i < static_cast<int>(mats.size()); ++i) {
+            if (mats.at(i).empty()) {
+                continue;
+            }
+            cv::Mat mat = mats.at(i).isContinuous() ? mats.at(i) : mats.at(i).clone();
+            std::memcpy(bytes.data() + offsets.at(i), mat.data, offsets.at(i + 1) - offsets.at(i));
+        }
+        WriteColumn(headers), WriteColumn(offsets), WriteColumn(bytes);
+    }
+};
+
+class CalibDataCacheReader {
+private:
+    const std::uint8_t *_data;
+    std::size_t _size;
+    std::size_t _cursor;
+
+public:
+    explicit CalibDataCacheReader(const std::string &filename)
+        : _data(nullptr),
+          _size(0),
+          _cursor(0) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+            void *addr = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                _data = static_cast<const std::uint8_t *>(addr);
+                _size = fileStat.st_size;
+                // the columns are mostly read sequentially
+                madvise(addr, _size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+
+    ~CalibDataCacheReader() {
+        if (_data != nullptr) {
+            munmap(const_cast<std::uint8_t *>(_data), _size);
+        }
+    }
+
+    CalibDataCacheReader(const CalibDataCacheReader &) = delete;
+
+    CalibDataCacheReader &operator=(const CalibDataCacheReader &) = delete;
+
+    [[nodiscard]] bool IsMapped() const { return _data != nullptr; }
+
+    // returns the pointer to the mapped column and the element count of it
+    template <typename Type>
+    std::pair<const Type *, std::size_t> ReadColumn() {
+        static_assert(std::is_trivially_copyable_v<Type>);
+        if (_cursor + sizeof(std::uint64_t) > _size) {
+            throw Status(Status::ERROR, "the calibration data cache is broken!");
+        }
+        std::uint64_t bytes;
+        std::memcpy(&bytes, _data + _cursor, sizeof(std::uint64_t));
+        _cursor += sizeof(std::uint64_t);
+        if (bytes % sizeof(Type) != 0 || _cursor + bytes > _size) {
+            throw Status(Status::ERROR, "the calibration data cache is broken!");
+        }
+        const auto *column = reinterpret_cast<const Type *>(_data + _cursor);
+        _cursor += bytes + (bytes % 8 == 0 ? 0 : 8 - bytes % 8);
+        return {column, bytes / sizeof(Type)};
+    }
+
+    template <typename Type>
+    Type ReadValue() {
+        auto [value, size] = ReadColumn<Type>();
+        if (size != 1) {
+            throw Status(Status::ERROR, "the calibration data cache is broken!");
+        }
+        return *value;
+    }
+
+    std::string ReadString() {
+        auto [str, size] = ReadColumn<char>();
+        return {str, size};
+    }
+
+    std::vector<cv::Mat> ReadMats() {
+        auto [headers, headerSize] = ReadColumn<std::int32_t>();
+        auto [offsets, offsetSize] = ReadColumn<std::uint64_t>();
+        auto [bytes, byteSize] = ReadColumn<std::uint8_t>();
+        if (headerSize % 3 != 0 || offsetSize != headerSize / 3 + 1 ||
+            offsets[offsetSize - 1] != byteSize) {
+            throw Status(Status::ERROR, "the calibration data cache is broken!");
+        }
+        CheckColumnOffsets({offsets, offsetSize}, byteSize);
+        std::vector<cv::Mat> mats(headerSize / 3);
+        for (std::size_t i = 0; i < mats.size(); ++i) {
+            const int rows = headers[i * 3 + 0], cols = headers[i * 3 + 1];
+            const int type = headers[i * 3 + 2];
+            // the header should be valid, and describe exactly the bytes of this mat
+            if (rows < 0 || cols < 0 || type != CV_MAT_TYPE(type) ||
+                static_cast<std::uint64_t>(rows) * static_cast<std::uint64_t>(cols) *
+                        CV_ELEM_SIZE(type) !=
+                    offsets[i + 1] - offsets[i]) {
+                throw Status(Status::ERROR, "the calibration data cache is broken!");
+            }
+            if (rows == 0 || cols == 0) {
+                continue;
+            }
+            // copy the data, as the mapped memory would be released after loading
+            auto *ptr = const_cast<std::uint8_t *>(bytes + offsets[i]);
+            mats.at(i) = cv::Mat(rows, cols, type, ptr).clone();
+        }
+        return mats;
+    }
+
+    template <typename Type>
+    static void CheckColumnSize(const std::pair<const Type *, std::size_t> &column,
+                                std::size_t expectedSize) {
+        if (column.second != expectedSize) {
+            throw Status(Status::ERROR, "the calibration data cache is broken!");
+        }
+    }
+
+    // offsets of variable-length records should be non-decreasing and within the data column
+    static void CheckColumnOffsets(const std::pair<const std::uint64_t *, std::size_t> &offsets,
+                                   std::size_t dataSize) {
+        for (std::size_t i = 0; i < offsets.second; ++i) {
+            if (offsets.first[i] > dataSize || (i > 0 && offsets.first[i - 1] > offsets.first[i])) {
+                throw Status(Status::ERROR, "the calibration data cache is broken!");
+            }
+        }
+    }
+};
+
+std::optional<std::string> CalibDataManager::CalibDataCacheKey() {
+    const auto &bagPath = Configor::DataStream::BagPath;
+    // errors (e.g., a wrong path) are reported when loading data from the bag
+    std::error_code ec;
+    const auto canonicalPath = std::filesystem::canonical(bagPath, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto size = std::filesystem::file_size(canonicalPath, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto mtime = std::filesystem::last_write_time(canonicalPath, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    std::stringstream stream;
+    stream << "bag: " << canonicalPath.string() << ", size: " << size
+           << ", mtime: " << mtime.time_since_epoch().count()
+           << fmt::format(", begin time: {:.9f}, duration: {:.9f}, time offset padding: {:.9f}",
+                          Configor::DataStream::BeginTime, Configor::DataStream::Duration,
+                          Configor::Prior::TimeOffsetPadding);
+    for (const auto &[topic, config] : Configor::DataStream::IMUTopics) {
+        stream << ", imu: " << topic << '|' << config.Type;
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RadarTopics) {
+        stream << ", radar: " << topic << '|' << config.Type;
+    }
+    for (const auto &[topic, config] : Configor::DataStream::LiDARTopics) {
+        stream << ", lidar: " << topic << '|' << config.Type;
+    }
+    for (const auto &[topic, config] : Configor::DataStream::CameraTopics) {
+        stream << ", camera: " << topic << '|' << config.Type;
+    }
+    for (const auto &[topic, config] : Configor::DataStream::RGBDTopics) {
+        // the sign of the depth factor determines the depth data loader
+        stream << ", rgbd: " << topic << '|' << config.Type << '|' << config.DepthTopic << '|'
+               << (config.DepthFactor < 0.0);
+    }
+    for (const auto &[topic, config] : Configor::DataStream::EventTopics) {
+        stream << ", event: " << topic << '|' << config.Type;
+    }
+    return stream.str();
+}
+
+std::optional<std::string> CalibDataManager::CalibDataCachePath() {
+    const auto key = CalibDataCacheKey();
+    if (key == std::nullopt) {
+        return std::nullopt;
+    }
+    // the hash of the key is used to distinguish caches from different data configures, while the
+    // full key is stored in the cache file and checked when loading
+    return fmt::format("{}/cache/calib_data_{:016x}.bin", Configor::DataStream::OutputPath,
+                       std::hash<std::string>{}(*key));
+}
+
+bool CalibDataManager::SaveCalibDataToCache(const std::string &filename) const {
+    const auto key = CalibDataCacheKey();
+    if (key == std::nullopt) {
+        return false;
+    }
+    auto parentPath = std::filesystem::path(filename).parent_path();
+    if (!std::filesystem::exists(parentPath) && !std::filesystem::create_directories(parentPath)) {
+        return false;
+    }
+    // write to a temporary file first, so that a broken cache would never be left
+    const std::string tmpFilename = filename + ".tmp";
+    {
+        CalibDataCacheWriter writer(tmpFilename);
+        if (!writer.IsGood()) {
+            return false;
+        }
+        writer.WriteString(CalibDataCacheMagic);
+        writer.WriteValue(CalibDataCacheVersion);
+        writer.WriteString(*key);
+        writer.WriteColumn(std::vector<double>{_rawStartTimestamp, _rawEndTimestamp,
+                                               _alignedStartTimestamp, _alignedEndTimestamp});
+
+        // imu: timestamps, gyroscope, accelerometer
+        writer.WriteValue<std::uint64_t>(_imuMes.size());
+        for (const auto &[topic, mes] : _imuMes) {
+            std::vector<double> t, gyro, acce;
+            t.reserve(mes.size()), gyro.reserve(mes.size() * 3), acce.reserve(mes.size() * 3);
+            for (const auto &frame : mes) {
+                t.push_back(frame->GetTimestamp());
+                const Eigen::Vector3d g = frame->GetGyro(), a = frame->GetAcce();
+                gyro.insert(gyro.end(), g.data(), g.data() + 3);
+                acce.insert(acce.end(), a.data(), a.data() + 3);
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(gyro), writer.WriteColumn(acce);
+        }
+
+        // radar: array timestamps, target offsets, target timestamps, xyz, radial velocities
+        writer.WriteValue<std::uint64_t>(_radarMes.size());
+        for (const auto &[topic, mes] : _radarMes) {
+            std::vector<double> t, tarT, tarXYZ, tarVel;
+            std::vector<std::uint64_t> offsets{0};
+            t.reserve(mes.size()), offsets.reserve(mes.size() + 1);
+            for (const auto &array : mes) {
+                t.push_back(array->GetTimestamp());
+                for (const auto &tar : array->GetTargets()) {
+                    tarT.push_back(tar->GetTimestamp());
+                    const Eigen::Vector3d &xyz = tar->GetTargetXYZ();
+                    tarXYZ.insert(tarXYZ.end(), xyz.data(), xyz.data() + 3);
+                    tarVel.push_back(tar->GetRadialVelocity());
+                }
+                offsets.push_back(tarT.size());
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(offsets), writer.WriteColumn(tarT);
+            writer.WriteColumn(tarXYZ), writer.WriteColumn(tarVel);
+        }
+
+        // lidar: frame timestamps, point offsets, cloud shapes, x, y, z, point timestamps
+        writer.WriteValue<std::uint64_t>(_lidarMes.size());
+        for (const auto &[topic, mes] : _lidarMes) {
+            std::vector<double> t, ptT;
+            std::vector<std::uint64_t> offsets{0};
+            std::vector<std::uint32_t> shapes;
+            std::vector<float> x, y, z;
+            std::size_t ptNum = 0;
+            for (const auto &frame : mes) {
+                ptNum += frame->IsCompact() ? frame->GetCompactScan()->Size()
+                                            : frame->GetScan()->size();
+            }
+            t.reserve(mes.size()), offsets.reserve(mes.size() + 1), shapes.reserve(mes.size() * 3);
+            x.reserve(ptNum), y.reserve(ptNum), z.reserve(ptNum), ptT.reserve(ptNum);
+            for (const auto &frame : mes) {
+                const auto &scan = frame->GetScan();
+                t.push_back(frame->GetTimestamp());
+                shapes.push_back(scan->width);
+                shapes.push_back(scan->height);
+                shapes.push_back(scan->is_dense);
+                for (const auto &p : scan->points) {
+                    x.push_back(p.x), y.push_back(p.y), z.push_back(p.z);
+                    ptT.push_back(p.timestamp);
+                }
+                offsets.push_back(ptT.size());
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(offsets), writer.WriteColumn(shapes);
+            writer.WriteColumn(x), writer.WriteColumn(y), writer.WriteColumn(z);
+            writer.WriteColumn(ptT);
+        }
+
+        // camera: timestamps, ids, grey images, color images
+        writer.WriteValue<std::uint64_t>(_camMes.size());
+        for (const auto &[topic, mes] : _camMes) {
+            std::vector<double> t;
+            std::vector<std::uint64_t> ids;
+            std::vector<cv::Mat> grey, color;
+            for (const auto &frame : mes) {
+                t.push_back(frame->GetTimestamp());
+                ids.push_back(frame->GetId());
+                grey.push_back(frame->GetImage());
+                color.push_back(frame->GetColorImage());
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(ids);
+            writer.WriteMats(grey), writer.WriteMats(color);
+        }
+
+        // rgbd: timestamps, ids, grey images, color images, depth images
+        writer.WriteValue<std::uint64_t>(_rgbdMes.size());
+        for (const auto &[topic, mes] : _rgbdMes) {
+            std::vector<double> t;
+            std::vector<std::uint64_t> ids;
+            std::vector<cv::Mat> grey, color, depth;
+            for (const auto &frame : mes) {
+                t.push_back(frame->GetTimestamp());
+                ids.push_back(frame->GetId());
+                grey.push_back(frame->GetImage());
+                color.push_back(frame->GetColorImage());
+                depth.push_back(frame->GetDepthImage());
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(ids);
+            writer.WriteMats(grey), writer.WriteMats(color), writer.WriteMats(depth);
+        }
+
+        // event: array timestamps, event offsets, event timestamps, x, y, polarities
+        writer.WriteValue<std::uint64_t>(_eventMes.size());
+        for (const auto &[topic, mes] : _eventMes) {
+            std::vector<double> t, evT;
+            std::vector<std::uint64_t> offsets{0};
+            std::vector<EventArray::PosScalar> evX, evY;
+            std::vector<std::uint8_t> evP;
+            t.reserve(mes.size()), offsets.reserve(mes.size() + 1);
+            for (const auto &array : mes) {
+                t.push_back(array->GetTimestamp());
+                // events are stored as structure-of-arrays, append the columns directly
+                const auto &aryT = array->GetEventTimestamps();
+                evT.insert(evT.end(), aryT.cbegin(), aryT.cend());
+                const auto &aryX = array->GetEventXs(), &aryY = array->GetEventYs();
+                evX.insert(evX.end(), aryX.cbegin(), aryX.cend());
+                evY.insert(evY.end(), aryY.cbegin(), aryY.cend());
+                const auto &aryP = array->GetEventPolarities();
+                evP.insert(evP.end(), aryP.cbegin(), aryP.cend());
+                offsets.push_back(evT.size());
+            }
+            writer.WriteString(topic);
+            writer.WriteColumn(t), writer.WriteColumn(offsets), writer.WriteColumn(evT);
+            writer.WriteColumn(evX), writer.WriteColumn(evY), writer.WriteColumn(evP);
+        }
+
+        if (!writer.IsGood()) {
+            std::filesystem::remove(tmpFilename);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpFilename, filename);
+    return true;
+}
+
+bool CalibDataManager::LoadCalibDataFromCache(const std::string &filename) {
+    if (!std::filesystem::exists(filename)) {
+        return false;
+    }
+    CalibDataCacheReader reader(filename);
+    if (!reader.IsMapped()) {
+        return false;
+    }
+
+    try {
+        if (reader.ReadString() != CalibDataCacheMagic ||
+            reader.ReadValue<std::uint64_t>() != CalibDataCacheVersion) {
+            spdlog::warn("the calibration data cache '{}' is outdated, reload data from bag.",
+                         filename);
+            return false;
+        }
+        const auto key = CalibDataCacheKey();
+        if (reader.ReadString() != key) {
+            spdlog::warn("the calibration data cache '{}' is not for current data, reload it.",
+                         filename);
+            return false;
+        }
+
+        // load into temporary containers, so that members are untouched once loading failed
+        decltype(_imuMes) imuMes;
+        decltype(_radarMes) radarMes;
+        decltype(_lidarMes) lidarMes;
+        decltype(_camMes) camMes;
+        decltype(_rgbdMes) rgbdMes;
+        decltype(_eventMes) eventMes;
+
+        auto timestamps = reader.ReadColumn<double>();
+        CalibDataCacheReader::CheckColumnSize(timestamps, 4);
+
+        // imu
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto gyro = reader.ReadColumn<double>(), acce = reader.ReadColumn<double>();
+            CalibDataCacheReader::CheckColumnSize(gyro, t.second * 3);
+            CalibDataCacheReader::CheckColumnSize(acce, t.second * 3);
+            auto &mes = imuMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                mes.push_back(IMUFrame::Create(t.first[j],
+                                               Eigen::Vector3d(gyro.first + j * 3),
+                                               Eigen::Vector3d(acce.first + j * 3)));
+            }
+        }
+
+        // radar
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto offsets = reader.ReadColumn<std::uint64_t>();
+            auto tarT = reader.ReadColumn<double>();
+            auto tarXYZ = reader.ReadColumn<double>(), tarVel = reader.ReadColumn<double>();
+            CalibDataCacheReader::CheckColumnSize(offsets, t.second + 1);
+            CalibDataCacheReader::CheckColumnSize(tarXYZ, tarT.second * 3);
+            CalibDataCacheReader::CheckColumnSize(tarVel, tarT.second);
+            CalibDataCacheReader::CheckColumnOffsets(offsets, tarT.second);
+            auto &mes = radarMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                std::vector<RadarTarget::Ptr> targets;
+                targets.reserve(offsets.first[j + 1] - offsets.first[j]);
+                for (auto k = offsets.first[j]; k < offsets.first[j + 1]; ++k) {
+                    targets.push_back(RadarTarget::Create(
+                        tarT.first[k], Eigen::Vector3d(tarXYZ.first + k * 3), tarVel.first[k]));
+                }
+                mes.push_back(RadarTargetArray::Create(t.first[j], targets));
+            }
+        }
+
+        // lidar
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto offsets = reader.ReadColumn<std::uint64_t>();
+            auto shapes = reader.ReadColumn<std::uint32_t>();
+            auto x = reader.ReadColumn<float>(), y = reader.ReadColumn<float>(),
+                 z = reader.ReadColumn<float>();
+            auto ptT = reader.ReadColumn<double>();
+            CalibDataCacheReader::CheckColumnSize(offsets, t.second + 1);
+            CalibDataCacheReader::CheckColumnSize(shapes, t.second * 3);
+            CalibDataCacheReader::CheckColumnSize(x, ptT.second);
+            CalibDataCacheReader::CheckColumnSize(y, ptT.second);
+            CalibDataCacheReader::CheckColumnSize(z, ptT.second);
+            CalibDataCacheReader::CheckColumnOffsets(offsets, ptT.second);
+            auto &mes = lidarMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                IKalibrPointCloud::Ptr scan(new IKalibrPointCloud);
+                scan->resize(offsets.first[j + 1] - offsets.first[j]);
+                for (auto k = offsets.first[j]; k < offsets.first[j + 1]; ++k) {
+                    auto &p = scan->points[k - offsets.first[j]];
+                    p.x = x.first[k], p.y = y.first[k], p.z = z.first[k];
+                    p.timestamp = ptT.first[k];
+                }
+                scan->width = shapes.first[j * 3 + 0];
+                scan->height = shapes.first[j * 3 + 1];
+                scan->is_dense = shapes.first[j * 3 + 2];
+                mes.push_back(LiDARFrame::Create(t.first[j], scan));
+                if (IsOptionWith(SpeedUpOption::CompactLiDARScans,
+                                 Configor::Preference::SpeedUps)) {
+                    mes.back()->Compact(Configor::Prior::CompactLiDARScanResolution);
+                }
+            }
+        }
+
+        // camera
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto ids = reader.ReadColumn<std::uint64_t>();
+            auto grey = reader.ReadMats(), color = reader.ReadMats();
+            CalibDataCacheReader::CheckColumnSize(ids, t.second);
+            if (grey.size() != t.second || color.size() != t.second) {
+                throw Status(Status::ERROR, "the calibration data cache is broken!");
+            }
+            auto &mes = camMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                mes.push_back(CameraFrame::Create(t.first[j], grey.at(j), color.at(j),
+                                                  static_cast<ns_veta::IndexT>(ids.first[j])));
+            }
+        }
+
+        // rgbd
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto ids = reader.ReadColumn<std::uint64_t>();
+            auto grey = reader.ReadMats(), color = reader.ReadMats(), depth = reader.ReadMats();
+            CalibDataCacheReader::CheckColumnSize(ids, t.second);
+            if (grey.size() != t.second || color.size() != t.second ||
+                depth.size() != t.second) {
+                throw Status(Status::ERROR, "the calibration data cache is broken!");
+            }
+            auto &mes = rgbdMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                mes.push_back(RGBDFrame::Create(t.first[j], grey.at(j), color.at(j), depth.at(j),
+                                                static_cast<ns_veta::IndexT>(ids.first[j])));
+            }
+        }
+
+        // event
+        for (auto i = reader.ReadValue<std::uint64_t>(); i > 0; --i) {
+            const auto topic = reader.ReadString();
+            auto t = reader.ReadColumn<double>();
+            auto offsets = reader.ReadColumn<std::uint64_t>();
+            auto evT = reader.ReadColumn<double>();
+            auto evX = reader.ReadColumn<std::uint16_t>(), evY = reader.ReadColumn<std::uint16_t>();
+            auto evP = reader.ReadColumn<std::uint8_t>();
+            CalibDataCacheReader::CheckColumnSize(offsets, t.second + 1);
+            CalibDataCacheReader::CheckColumnSize(evX, evT.second);
+            CalibDataCacheReader::CheckColumnSize(evY, evT.second);
+            CalibDataCacheReader::CheckColumnSize(evP, evT.second);
+            CalibDataCacheReader::CheckColumnOffsets(offsets, evT.second);
+            auto &mes = eventMes[topic];
+            mes.reserve(t.second);
+            for (std::size_t j = 0; j < t.second; ++j) {
+                const auto sIdx = offsets.first[j], eIdx = offsets.first[j + 1];
+                mes.push_back(EventArray::Create(
+                    t.first[j], std::vector<double>(evT.first + sIdx, evT.first + eIdx),
+                    std::vector<EventArray::PosScalar>(evX.first + sIdx, evX.first + eIdx),
+                    std::vector<EventArray::PosScalar>(evY.first + sIdx, evY.first + eIdx),
+                    std::vector<std::uint8_t>(evP.first + sIdx, evP.first + eIdx)));
+            }
+        }
+
+        _rawStartTimestamp = timestamps.first[0];
+        _rawEndTimestamp = timestamps.first[1];
+        _alignedStartTimestamp = timestamps.first[2];
+        _alignedEndTimestamp = timestamps.first[3];
+        _imuMes = std::move(imuMes);
+        _radarMes = std::move(radarMes);
+        _lidarMes = std::move(lidarMes);
+        _camMes = std::move(camMes);
+        _rgbdMes = std::move(rgbdMes);
+        _eventMes = std::move(eventMes);
+    } catch (const IKalibrStatus &status) {
+        spdlog::warn("load calibration data cache '{}' failed: '{}', reload data from bag.",
+                     filename, status.what);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace ns_ikalibr
@@ -34,6 +34,7 @@
 
 #include "calib/estimator.h"
 #include "calib/spat_temp_priori.h"
+#include "core/spline_pose_cache.h"
 #include "ctraj/core/trajectory_estimator.h"
 #include "factor/hand_eye_rot_align_factor.hpp"
 #include "factor/imu_gyro_factor.hpp"
@@ -51,9 +52,12 @@
 #include "factor/visual_proj_factor.hpp"
 #include "factor/visual_velocity_depth_factor.hpp"
 #include "util/utils_tpl.hpp"
+#include "cxxabi.h"
 #include "factor/vel_visual_inertial_align_factor.hpp"
 #include "factor/norm_flow_pure_rot_factor.hpp"
 #include "factor/ppp_trifocal_tensor_factor.hpp"
+#include "unordered_map"
+#include "array"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -65,11 +69,19 @@ std::shared_ptr<ceres::EigenQuaternionManifold> Estimator::QUATER_MANIFOLD(
     new ceres::EigenQuaternionManifold());
 std::shared_ptr<ceres::SphereManifold<3>> Estimator::GRAVITY_MANIFOLD(
     new ceres::SphereManifold<3>());
+thread_local std::vector<Estimator::ProblemOp> *Estimator::recordedOps = nullptr;
 
 ceres::Problem::Options Estimator::DefaultProblemOptions() {
     return ns_ctraj::TrajectoryEstimator<Configor::Prior::SplineOrder>::DefaultProblemOptions();
 }
 
+ceres::Problem::Options Estimator::PersistentProblemOptions() {
+    auto options = DefaultProblemOptions();
+    // residual blocks are removed one by one in 'RemoveNonPersistentBlocks'
+    options.enable_fast_removal = true;
+    return options;
+}
+
 ceres::Solver::Options Estimator::DefaultSolverOptions(int threadNum, bool toStdout, bool useCUDA) {
     auto defaultSolverOptions =
         ns_ctraj::TrajectoryEstimator<Configor::Prior::SplineOrder>::DefaultSolverOptions(
@@ -81,14 +93,17 @@ ceres::Solver::Options Estimator::DefaultSolverOptions(int threadNum, bool toStd
     return defaultSolverOptions;
 }
 
-Estimator::Estimator(SplineBundleType::Ptr splines, CalibParamManager::Ptr calibParamManager)
-    : ceres::Problem(DefaultProblemOptions()),
+Estimator::Estimator(SplineBundleType::Ptr splines,
+                     CalibParamManager::Ptr calibParamManager,
+                     const ceres::Problem::Options &options)
+    : ceres::Problem(options),
       splines(std::move(splines)),
       parMagr(std::move(calibParamManager)) {}
 
 Estimator::Ptr Estimator::Create(const SplineBundleType::Ptr &splines,
-                                 const CalibParamManager::Ptr &calibParamManager) {
-    return std::make_shared<Estimator>(splines, calibParamManager);
+                                 const CalibParamManager::Ptr &calibParamManager,
+                                 const ceres::Problem::Options &options) {
+    return std::make_shared<Estimator>(splines, calibParamManager, options);
 }
 
 ceres::Solver::Summary Estimator::Solve(const ceres::Solver::Options &options,
@@ -97,10 +112,209 @@ ceres::Solver::Summary Estimator::Solve(const ceres::Solver::Options &options,
         priori->AddSpatTempPrioriConstraint(*this, *parMagr);
     }
     ceres::Solver::Summary summary;
-    ceres::Solve(options, this, &summary);
+    if (IsOptionWith(SpeedUpOption::AutoLinearSolver, Configor::Preference::SpeedUps) &&
+        options.linear_solver_ordering == nullptr) {
+        ceres::Solve(SelectLinearSolver(options), this, &summary);
+        spdlog::info(
+            "linear solver used: '{}' (preconditioner: '{}'), linear solver time: {:.3f} (s), "
+            "total time: {:.3f} (s)",
+            ceres::LinearSolverTypeToString(summary.linear_solver_type_used),
+            ceres::PreconditionerTypeToString(summary.preconditioner_type_used),
+            summary.linear_solver_time_in_seconds, summary.total_time_in_seconds);
+    } else {
+        ceres::Solve(options, this, &summary);
+    }
+    // control points of splines may be changed
+    SplinePoseCache::SplinesChanged();
     return summary;
 }
 
+ceres::Solver::Options Estimator::SelectLinearSolver(const ceres::Solver::Options &options) const {
+    // the linear solver is determined by the user if cuda is used
+    if (Configor::Preference::UseCudaInSolving) {
+        return options;
+    }
+
+    const auto knots = GetKnotParamBlocks();
+    const auto calibParams = GetCalibParamBlocks();
+
+    // the remaining blocks are landmark candidates, e.g., inverse depths, the visual global scale
+    std::vector<ceres::ResidualBlockId> residualBlocks;
+    this->GetResidualBlocks(&residualBlocks);
+    std::unordered_map<double *, int> candidates;
+    std::vector<double *> blocks;
+    for (const auto &id : residualBlocks) {
+        this->GetParameterBlocksForResidualBlock(id, &blocks);
+        for (auto *block : blocks) {
+            if (knots.count(block) == 0 && calibParams.count(block) == 0) {
+                ++candidates[block];
+            }
+        }
+    }
+    /**
+     * landmarks to be eliminated should be an independent set, i.e., no two of them appear in one
+     * residual block. For each residual block, only the candidate involved in the fewest residual
+     * blocks is kept (shared ones such as the visual global scale are dropped)
+     */
+    auto LessShared = [&candidates](double *lhs, double *rhs) {
+        const int lc = candidates.at(lhs), rc = candidates.at(rhs);
+        return lc != rc ? lc < rc : std::less<double *>()(lhs, rhs);
+    };
+    std::unordered_set<double *> dropped;
+    for (const auto &id : residualBlocks) {
+        this->GetParameterBlocksForResidualBlock(id, &blocks);
+        double *kept = nullptr;
+        for (auto *block : blocks) {
+            if (candidates.count(block) == 0) {
+                continue;
+            }
+            if (kept == nullptr) {
+                kept = block;
+            } else if (LessShared(block, kept)) {
+                dropped.insert(kept);
+                kept = block;
+            } else {
+                dropped.insert(block);
+            }
+        }
+    }
+
+    // dimensions of the full system, and the reduced one after eliminating landmarks
+    std::vector<double *> paramBlocks;
+    this->GetParameterBlocks(&paramBlocks);
+    int landmarkCount = 0, knotCount = 0, otherCount = 0, fullDim = 0, reducedDim = 0;
+    for (auto *block : paramBlocks) {
+        const bool isLandmark = candidates.count(block) != 0 && dropped.count(block) == 0;
+        if (isLandmark) {
+            ++landmarkCount;
+        } else if (knots.count(block) != 0) {
+            ++knotCount;
+        } else {
+            ++otherCount;
+        }
+        if (this->IsParameterBlockConstant(block)) {
+            continue;
+        }
+        const int dim = this->ParameterBlockTangentSize(block);
+        fullDim += dim;
+        reducedDim += isLandmark ? 0 : dim;
+    }
+
+    auto result = options;
+    const bool sparseAvailable = ceres::IsSparseLinearAlgebraLibraryTypeAvailable(
+        options.sparse_linear_algebra_library_type);
+    if ((landmarkCount == 0 ? fullDim : reducedDim) <= Configor::Preference::DenseSchurDimMax) {
+        // small problems are solved as before, ceres finds the independent set for dense schur
+        result.linear_solver_type = ceres::DENSE_SCHUR;
+    } else if (landmarkCount == 0) {
+        if (sparseAvailable) {
+            result.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+        } else {
+            // the elimination group is found by ceres, as knots are not independent
+            result.linear_solver_type = ceres::ITERATIVE_SCHUR;
+            result.preconditioner_type = ceres::SCHUR_JACOBI;
+        }
+    } else if (sparseAvailable && reducedDim <= Configor::Preference::SparseSchurDimMax) {
+        result.linear_solver_type = ceres::SPARSE_SCHUR;
+    } else {
+        result.linear_solver_type = ceres::ITERATIVE_SCHUR;
+        // clustering knots and parameters by their visibility to landmarks pays off only when
+        // landmarks dominate the problem
+        result.preconditioner_type = sparseAvailable && landmarkCount > knotCount
+                                         ? ceres::CLUSTER_JACOBI
+                                         : ceres::SCHUR_JACOBI;
+    }
+
+    // the elimination ordering: landmarks (if exist) -> knots -> others
+    if (result.linear_solver_type == ceres::SPARSE_SCHUR ||
+        result.linear_solver_type == ceres::SPARSE_NORMAL_CHOLESKY ||
+        (result.linear_solver_type == ceres::ITERATIVE_SCHUR && landmarkCount != 0)) {
+        auto ordering = std::make_shared<ceres::ParameterBlockOrdering>();
+        const int offset = landmarkCount != 0 ? 1 : 0;
+        for (auto *block : paramBlocks) {
+            if (candidates.count(block) != 0 && dropped.count(block) == 0) {
+                ordering->AddElementToGroup(block, 0);
+            } else if (knots.count(block) != 0) {
+                ordering->AddElementToGroup(block, offset);
+            } else {
+                ordering->AddElementToGroup(block, offset + 1);
+            }
+        }
+        result.linear_solver_ordering = ordering;
+    }
+
+    spdlog::info(
+        "linear solver selected: '{}', landmark blocks: {}, knot blocks: {}, other blocks: {}, "
+        "full dimension: {}, reduced dimension: {}",
+        ceres::LinearSolverTypeToString(result.linear_solver_type), landmarkCount, knotCount,
+        otherCount, fullDim, reducedDim);
+    return result;
+}
+
+std::unordered_set<const double *> Estimator::GetKnotParamBlocks() const {
+    std::unordered_set<const double *> knots;
+    const auto &so3Spline = splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+        knots.insert(so3Spline.GetKnot(i).data());
+    }
+    const auto &scaleSpline = splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    for (int i = 0; i < static_cast<int>(scaleSpline.GetKnots().size()); ++i) {
+        knots.insert(scaleSpline.GetKnot(i).data());
+    }
+    return knots;
+}
+
+std::unordered_set<const double *> Estimator::GetCalibParamBlocks() const {
+    std::unordered_set<const double *> calibParams;
+    auto InvolveData = [&calibParams](const auto &params) {
+        for (const auto &[topic, par] : params) {
+            calibParams.insert(par.data());
+        }
+    };
+    auto InvolveValue = [&calibParams](const std::map<std::string, double> &params) {
+        for (const auto &[topic, par] : params) {
+            calibParams.insert(&par);
+        }
+    };
+    const auto &EXTRI = parMagr->EXTRI;
+    InvolveData(EXTRI.SO3_BiToBr);
+    InvolveData(EXTRI.POS_BiInBr);
+    InvolveData(EXTRI.SO3_RjToBr);
+    InvolveData(EXTRI.POS_RjInBr);
+    InvolveData(EXTRI.SO3_LkToBr);
+    InvolveData(EXTRI.POS_LkInBr);
+    InvolveData(EXTRI.SO3_CmToBr);
+    InvolveData(EXTRI.POS_CmInBr);
+    InvolveData(EXTRI.SO3_DnToBr);
+    InvolveData(EXTRI.POS_DnInBr);
+    InvolveData(EXTRI.SO3_EsToBr);
+    InvolveData(EXTRI.POS_EsInBr);
+    const auto &TEMPORAL = parMagr->TEMPORAL;
+    InvolveValue(TEMPORAL.TO_BiToBr);
+    InvolveValue(TEMPORAL.TO_RjToBr);
+    InvolveValue(TEMPORAL.TO_LkToBr);
+    InvolveValue(TEMPORAL.TO_CmToBr);
+    InvolveValue(TEMPORAL.TO_DnToBr);
+    InvolveValue(TEMPORAL.TO_EsToBr);
+    InvolveValue(TEMPORAL.RS_READOUT);
+    for (const auto &[topic, intri] : parMagr->INTRI.IMU) {
+        calibParams.insert({intri->GYRO.BIAS.data(), intri->GYRO.MAP_COEFF.data(),
+                            intri->ACCE.BIAS.data(), intri->ACCE.MAP_COEFF.data(),
+                            intri->SO3_AtoG.data()});
+    }
+    for (const auto &[topic, intri] : parMagr->INTRI.Camera) {
+        calibParams.insert(
+            {intri->FXAddress(), intri->FYAddress(), intri->CXAddress(), intri->CYAddress()});
+    }
+    for (const auto &[topic, intri] : parMagr->INTRI.RGBD) {
+        calibParams.insert({intri->intri->FXAddress(), intri->intri->FYAddress(),
+                            intri->intri->CXAddress(), intri->intri->CYAddress(), &intri->alpha,
+                            &intri->beta});
+    }
+    calibParams.insert(parMagr->GRAVITY.data());
+    return calibParams;
+}
+
 void Estimator::AddRdKnotsData(std::vector<double *> &paramBlockVec,
                                const Estimator::SplineBundleType::RdSplineType &spline,
                                const Estimator::SplineMetaType &splineMeta,
@@ -149,28 +363,21 @@ void Estimator::AddSo3KnotsData(std::vector<double *> &paramBlockVec,
     }
 }
 
-Eigen::MatrixXd Estimator::CRSMatrix2EigenMatrix(ceres::CRSMatrix *jacobian_crs_matrix) {
-    Eigen::MatrixXd J(jacobian_crs_matrix->num_rows, jacobian_crs_matrix->num_cols);
-    J.setZero();
-
-    std::vector<int> jacobian_crs_matrix_rows, jacobian_crs_matrix_cols;
-    std::vector<double> jacobian_crs_matrix_values;
-    jacobian_crs_matrix_rows = jacobian_crs_matrix->rows;
-    jacobian_crs_matrix_cols = jacobian_crs_matrix->cols;
-    jacobian_crs_matrix_values = jacobian_crs_matrix->values;
-
-    int cur_index_in_cols_and_values = 0;
-    // rows is a num_rows + 1 sized array
-    int row_size = static_cast<int>(jacobian_crs_matrix_rows.size()) - 1;
-    // outer loop traverse rows, inner loop traverse cols and values
-    for (int row_index = 0; row_index < row_size; ++row_index) {
-        while (cur_index_in_cols_and_values < jacobian_crs_matrix_rows[row_index + 1]) {
-            J(row_index, jacobian_crs_matrix_cols[cur_index_in_cols_and_values]) =
-                jacobian_crs_matrix_values[cur_index_in_cols_and_values];
-            cur_index_in_cols_and_values++;
-        }
+int Estimator::SegmentNumOfMeta(const SplineMetaType &meta) {
+    if (meta.segments.size() != 1) {
+        return 0;
     }
-    return J;
+    // 'n' consecutive segments of an uniform b-spline are controlled by 'SplineOrder + n - 1' knots
+    return static_cast<int>(meta.NumParameters()) - Configor::Prior::SplineOrder + 1;
+}
+
+Eigen::SparseMatrix<double, Eigen::RowMajor> Estimator::CRSMatrix2SparseMatrix(
+    const ceres::CRSMatrix &jacobianCRSMatrix) {
+    // the compressed row storage of ceres is exactly the one of a row-major eigen sparse matrix
+    return Eigen::Map<const Eigen::SparseMatrix<double, Eigen::RowMajor>>(
+        jacobianCRSMatrix.num_rows, jacobianCRSMatrix.num_cols,
+        static_cast<int>(jacobianCRSMatrix.values.size()), jacobianCRSMatrix.rows.data(),
+        jacobianCRSMatrix.cols.data(), jacobianCRSMatrix.values.data());
 }
 
 /**
@@ -209,28 +416,20 @@ void Estimator::AddIMUGyroMeasurement(const IMUFrame::Ptr &imuFrame,
     }
 
     // create a cost function
-    auto costFunc =
-        IMUGyroFactor<Configor::Prior::SplineOrder>::Create(so3Meta, imuFrame, gyroWeight);
-
-    // so3 knots param block [each has four sub params]
-    for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
-        costFunc->AddParameterBlock(4);
+    // param blocks: [ SO3 | ... | SO3 | GYRO_BIAS | GYRO_MAP_COEFF | SO3_AtoG | SO3_BiToBr |
+    // TO_BiToBr ]
+    ceres::CostFunction *costFunc;
+    if (IsOptionWith(SpeedUpOption::AnalyticIMUFactor, Configor::Preference::SpeedUps)) {
+        auto analyticCostFunc = IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>::Create(
+            so3Meta, imuFrame, gyroWeight);
+        SetSplineCostFuncBlocks<3, 3, 6, 4, 4, 1>(analyticCostFunc, so3Meta);
+        costFunc = analyticCostFunc;
+    } else {
+        using Functor = IMUGyroFactor<Configor::Prior::SplineOrder>;
+        costFunc = CreateSplineAutoDiffCostFunc<Functor, 3, 3, 6, 4, 4, 1>(
+            new Functor(so3Meta, imuFrame, gyroWeight), so3Meta);
     }
 
-    // GYRO gyroBias
-    costFunc->AddParameterBlock(3);
-    // GYRO map coeff
-    costFunc->AddParameterBlock(6);
-    // SO3_AtoG
-    costFunc->AddParameterBlock(4);
-    // SO3_BiToBr
-    costFunc->AddParameterBlock(4);
-    // TIME_OFFSET_BiToBc
-    costFunc->AddParameterBlock(1);
-
-    // set Residuals
-    costFunc->SetNumResiduals(3);
-
     // organize the param block vector
     std::vector<double *> paramBlockVec;
 
@@ -1440,23 +1639,133 @@ Estimator::InertialIntegrationBase(const std::vector<IMUFrame::Ptr> &data,
 
 Eigen::MatrixXd Estimator::GetHessianMatrix(const std::vector<double *> &consideredParBlocks,
                                             int numThread) {
+    // only the hessian of considered blocks is dense
+    return Eigen::MatrixXd(GetSparseHessianMatrix(consideredParBlocks, numThread));
+}
+
+Eigen::SparseMatrix<double> Estimator::GetSparseHessianMatrix(
+    const std::vector<double *> &consideredParBlocks,
+    int numThread,
+    const std::vector<ceres::ResidualBlockId> &consideredResBlocks) {
     // remove params that are not involved
     ceres::Problem::EvaluateOptions evalOpt;
     evalOpt.parameter_blocks = consideredParBlocks;
+    // all residual blocks are evaluated if empty
+    evalOpt.residual_blocks = consideredResBlocks;
     evalOpt.num_threads = numThread;
 
     // evaluate
     ceres::CRSMatrix jacobianCRSMatrix;
     this->Evaluate(evalOpt, nullptr, nullptr, nullptr, &jacobianCRSMatrix);
 
-    // obtain hessian matrix and residual vector
-    Eigen::MatrixXd JMat = CRSMatrix2EigenMatrix(&jacobianCRSMatrix);
-
-    Eigen::MatrixXd HMat = JMat.transpose() * JMat;
+    // obtain hessian matrix
+    Eigen::SparseMatrix<double, Eigen::RowMajor> JMat = CRSMatrix2SparseMatrix(jacobianCRSMatrix);
+    // release the jacobian in the crs format before the product
+    jacobianCRSMatrix = ceres::CRSMatrix();
 
+    Eigen::SparseMatrix<double> HMat = JMat.transpose() * JMat;
     return HMat;
 }
 
+Eigen::MatrixXd Estimator::GetMarginalInformation(
+    const std::vector<double *> &keptParBlocks,
+    int numThread,
+    const std::vector<ceres::ResidualBlockId> &consideredResBlocks) {
+    // the variable blocks to be kept, followed by the ones to be marginalized
+    std::vector<double *> evalBlocks;
+    std::unordered_set<const double *> involved;
+    int keptDim = 0;
+    for (auto *block : keptParBlocks) {
+        evalBlocks.push_back(block);
+        involved.insert(block);
+        keptDim += this->ParameterBlockTangentSize(block);
+    }
+    std::vector<double *> paramBlocks;
+    if (consideredResBlocks.empty()) {
+        this->GetParameterBlocks(&paramBlocks);
+    } else {
+        std::vector<double *> blocks;
+        for (const auto &id : consideredResBlocks) {
+            this->GetParameterBlocksForResidualBlock(id, &blocks);
+            paramBlocks.insert(paramBlocks.end(), blocks.cbegin(), blocks.cend());
+        }
+    }
+    for (auto *block : paramBlocks) {
+        if (involved.count(block) == 0 && !this->IsParameterBlockConstant(block)) {
+            evalBlocks.push_back(block);
+            involved.insert(block);
+        }
+    }
+
+    Eigen::SparseMatrix<double> HMat =
+        GetSparseHessianMatrix(evalBlocks, numThread, consideredResBlocks);
+    const int margDim = static_cast<int>(HMat.rows()) - keptDim;
+
+    // the schur complement of the marginalized part: S = A - B * C^{-1} * B^T
+    Eigen::MatrixXd SMat = HMat.topLeftCorner(keptDim, keptDim);
+    if (margDim > 0) {
+        Eigen::SparseMatrix<double> CMat = HMat.bottomRightCorner(margDim, margDim);
+        Eigen::SparseMatrix<double> BtMat = HMat.bottomLeftCorner(margDim, keptDim);
+        HMat.resize(0, 0);
+
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+        // a tiny shift makes gauge freedoms (e.g., the global yaw of splines) solvable
+        solver.setShift(std::max(CMat.diagonal().cwiseAbs().maxCoeff() * 1E-10,
+                                 std::numeric_limits<double>::epsilon()));
+        solver.compute(CMat);
+        if (solver.info() != Eigen::Success) {
+            throw Status(Status::CRITICAL,
+                         "the hessian of marginalized parameter blocks can not be factorized!");
+        }
+        Eigen::MatrixXd XMat = solver.solve(Eigen::MatrixXd(BtMat));
+        SMat.noalias() -= BtMat.transpose() * XMat;
+    }
+    return SMat;
+}
+
+Eigen::MatrixXd Estimator::GetMarginalCovariance(const std::vector<double *> &parBlocks,
+                                                 int numThread) {
+    // the variable blocks to be kept (the given ones)
+    std::vector<double *> keptBlocks;
+    std::vector<int> offsets(parBlocks.size());
+    int dim = 0;
+    for (int i = 0; i < static_cast<int>(parBlocks.size()); ++i) {
+        auto *block = parBlocks.at(i);
+        if (!this->HasParameterBlock(block)) {
+            throw Status(Status::CRITICAL, "the given parameter block is not in the problem!");
+        }
+        offsets.at(i) = dim;
+        dim += this->ParameterBlockTangentSize(block);
+        if (!this->IsParameterBlockConstant(block)) {
+            keptBlocks.push_back(block);
+        }
+    }
+
+    // the marginal covariance of variable blocks, unobservable directions are zeros
+    Eigen::MatrixXd keptCov = GetMarginalInformation(keptBlocks, numThread)
+                                  .completeOrthogonalDecomposition()
+                                  .pseudoInverse();
+
+    // scatter to the given blocks, zeros for constant ones
+    // ranges of variable blocks: [offset in given blocks, offset in kept blocks, tangent size]
+    std::vector<std::array<int, 3>> keptRanges;
+    for (int i = 0, keptOffset = 0; i < static_cast<int>(parBlocks.size()); ++i) {
+        if (this->IsParameterBlockConstant(parBlocks.at(i))) {
+            continue;
+        }
+        const int size = this->ParameterBlockTangentSize(parBlocks.at(i));
+        keptRanges.push_back({offsets.at(i), keptOffset, size});
+        keptOffset += size;
+    }
+    Eigen::MatrixXd cov = Eigen::MatrixXd::Zero(dim, dim);
+    for (const auto &[ri, ki, ni] : keptRanges) {
+        for (const auto &[rj, kj, nj] : keptRanges) {
+            cov.block(ri, rj, ni, nj) = keptCov.block(ki, kj, ni, nj);
+        }
+    }
+    return cov;
+}
+
 void Estimator::PrintParameterInfo() const {
     std::vector<double *> parameterBlocks;
     this->GetParameterBlocks(&parameterBlocks);
@@ -1475,6 +1784,413 @@ void Estimator::PrintParameterInfo() const {
         totalParamBlocks, numOptimizedParamBlock, numOptimizedParameter);
 }
 
+std::map<std::string, int> Estimator::GetResidualBlockCountOfFactors() const {
+    // obtain the factor name from the demangled type name of the cost function, e.g.,
+    // 'ceres::DynamicAutoDiffCostFunction<ns_ikalibr::IMUGyroFactor<4>, 4>' --> 'IMUGyroFactor'
+    auto FactorName = [](const std::type_info &info) {
+        int status = 0;
+        std::unique_ptr<char, void (*)(void *)> demangled(
+            abi::__cxa_demangle(info.name(), nullptr, nullptr, &status), std::free);
+        std::string name = status == 0 ? demangled.get() : info.name();
+        for (auto lt = name.find('<'); lt != std::string::npos; lt = name.find('<')) {
+            const std::string base = name.substr(0, lt);
+            const bool isWrapper = base.rfind("ceres::", 0) == 0 ||
+                                   (base.size() > 7 && base.substr(base.size() - 7) == "Adaptor");
+            if (!isWrapper) {
+                name = base;
+                break;
+            }
+            // the first template argument of the wrapper is the wrapped functor
+            int depth = 0;
+            std::size_t end = lt + 1;
+            for (; end < name.size(); ++end) {
+                const char c = name.at(end);
+                if (c == '<') {
+                    ++depth;
+                } else if ((c == '>' || c == ',') && depth == 0) {
+                    break;
+                } else if (c == '>') {
+                    --depth;
+                }
+            }
+            name = name.substr(lt + 1, end - lt - 1);
+            name.erase(0, name.find_first_not_of(' '));
+        }
+        if (auto pos = name.rfind("::"); pos != std::string::npos) {
+            name = name.substr(pos + 2);
+        }
+        return name;
+    };
+
+    std::vector<ceres::ResidualBlockId> residualBlocks;
+    this->GetResidualBlocks(&residualBlocks);
+    std::map<std::string, int> counts;
+    for (const auto &id : residualBlocks) {
+        const auto *costFunc = this->GetCostFunctionForResidualBlock(id);
+        ++counts[FactorName(typeid(*costFunc))];
+    }
+    return counts;
+}
+
+void Estimator::MarkResidualBlocksPersistent() {
+    std::vector<ceres::ResidualBlockId> residualBlocks;
+    this->GetResidualBlocks(&residualBlocks);
+    persistentBlocks.insert(residualBlocks.cbegin(), residualBlocks.cend());
+}
+
+void Estimator::RemoveNonPersistentBlocks() {
+    std::vector<ceres::ResidualBlockId> residualBlocks;
+    this->GetResidualBlocks(&residualBlocks);
+    for (const auto &id : residualBlocks) {
+        if (persistentBlocks.count(id) == 0) {
+            this->RemoveResidualBlock(id);
+        }
+    }
+    // parameter blocks only involved in removed residual blocks, e.g., inverse depths of visual
+    // landmarks and extrinsics of lidars, are removed as well, as their memory may be released
+    std::vector<double *> paramBlocks;
+    this->GetParameterBlocks(&paramBlocks);
+    std::vector<ceres::ResidualBlockId> involved;
+    for (auto *paramBlock : paramBlocks) {
+        this->GetResidualBlocksForParameterBlock(paramBlock, &involved);
+        if (involved.empty()) {
+            this->RemoveParameterBlock(paramBlock);
+        }
+    }
+}
+
+void Estimator::SetInertialAndRadarParamsState(Opt option) {
+    auto SetState = [this](double *paramBlock, bool setToConst) {
+        if (!this->HasParameterBlock(paramBlock)) {
+            return;
+        }
+        if (setToConst) {
+            this->SetParameterBlockConstant(paramBlock);
+        } else {
+            this->SetParameterBlockVariable(paramBlock);
+        }
+    };
+
+    // knots of splines
+    auto &so3Spline = splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+        SetState(so3Spline.GetKnot(i).data(), !IsOptionWith(Opt::OPT_SO3_SPLINE, option));
+    }
+    auto &scaleSpline = splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    for (int i = 0; i < static_cast<int>(scaleSpline.GetKnots().size()); ++i) {
+        SetState(scaleSpline.GetKnot(i).data(), !IsOptionWith(Opt::OPT_SCALE_SPLINE, option));
+    }
+
+    // imus
+    for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+        const auto &intri = parMagr->INTRI.IMU.at(topic);
+        SetState(intri->GYRO.BIAS.data(), !IsOptionWith(Opt::OPT_GYRO_BIAS, option));
+        SetState(intri->GYRO.MAP_COEFF.data(), !IsOptionWith(Opt::OPT_GYRO_MAP_COEFF, option));
+        SetState(intri->ACCE.BIAS.data(), !IsOptionWith(Opt::OPT_ACCE_BIAS, option));
+        SetState(intri->ACCE.MAP_COEFF.data(), !IsOptionWith(Opt::OPT_ACCE_MAP_COEFF, option));
+        SetState(intri->SO3_AtoG.data(), !IsOptionWith(Opt::OPT_SO3_AtoG, option));
+        SetState(parMagr->EXTRI.SO3_BiToBr.at(topic).data(),
+                 !IsOptionWith(Opt::OPT_SO3_BiToBr, option));
+        SetState(parMagr->EXTRI.POS_BiInBr.at(topic).data(),
+                 !IsOptionWith(Opt::OPT_POS_BiInBr, option));
+        SetState(&parMagr->TEMPORAL.TO_BiToBr.at(topic),
+                 !IsOptionWith(Opt::OPT_TO_BiToBr, option));
+    }
+    SetState(parMagr->GRAVITY.data(), !IsOptionWith(Opt::OPT_GRAVITY, option));
+
+    // radars
+    for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+        SetState(parMagr->EXTRI.SO3_RjToBr.at(topic).data(),
+                 !IsOptionWith(Opt::OPT_SO3_RjToBr, option));
+        SetState(parMagr->EXTRI.POS_RjInBr.at(topic).data(),
+                 !IsOptionWith(Opt::OPT_POS_RjInBr, option));
+        SetState(&parMagr->TEMPORAL.TO_RjToBr.at(topic),
+                 !IsOptionWith(Opt::OPT_TO_RjToBr, option));
+    }
+}
+
+/**
+ * the index of the first knot controlling the segment where the time is, the time is clamped to
+ * the range of the spline, and knots are uniformly distributed with the given time distance
+ */
+template <class SplineType>
+static int KnotIndexOfTime(const SplineType &spline, double knotDist, double time) {
+    const int idx = static_cast<int>(std::floor((time - spline.MinTime()) / knotDist));
+    const int knotCount = static_cast<int>(spline.GetKnots().size());
+    return std::clamp(idx, 0, knotCount - Configor::Prior::SplineOrder);
+}
+
+void Estimator::SetTimeWindow(double sTime, double eTime) {
+    timeWindow = {sTime, eTime};
+    allKnots = GetKnotParamBlocks();
+    windowKnots.clear();
+    auto InvolveKnots = [this, sTime, eTime](const auto &spline, double knotDist) {
+        const int sIdx = KnotIndexOfTime(spline, knotDist, sTime);
+        const int eIdx = KnotIndexOfTime(spline, knotDist, eTime) + Configor::Prior::SplineOrder;
+        for (int i = sIdx; i < eIdx; ++i) {
+            windowKnots.insert(spline.GetKnot(i).data());
+        }
+    };
+    InvolveKnots(splines->GetSo3Spline(Configor::Preference::SO3_SPLINE),
+                 Configor::Prior::KnotTimeDist::SO3Spline);
+    InvolveKnots(splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                 Configor::Prior::KnotTimeDist::ScaleSpline);
+
+    // the max magnitude of current time offsets, data are stamped by their sensors
+    double maxTimeOffset = 0.0;
+    const auto &TEMPORAL = parMagr->TEMPORAL;
+    for (const auto *TO : {&TEMPORAL.TO_BiToBr, &TEMPORAL.TO_RjToBr, &TEMPORAL.TO_LkToBr,
+                           &TEMPORAL.TO_CmToBr, &TEMPORAL.TO_DnToBr, &TEMPORAL.TO_EsToBr}) {
+        for (const auto &[topic, value] : *TO) {
+            maxTimeOffset = std::max(maxTimeOffset, std::abs(value));
+        }
+    }
+    const double knotDist = std::max(Configor::Prior::KnotTimeDist::SO3Spline,
+                                     Configor::Prior::KnotTimeDist::ScaleSpline);
+    windowMargin = maxTimeOffset + Configor::Prior::TimeOffsetPadding +
+                   Configor::Prior::ReadoutTimePadding + Configor::Prior::SplineOrder * knotDist;
+}
+
+bool Estimator::IsKnotOutOfTimeWindow(const double *block) const {
+    return timeWindow != std::nullopt && allKnots.count(block) != 0 &&
+           windowKnots.count(block) == 0;
+}
+
+bool Estimator::MayInvolveTimeWindow(double sTime, double eTime) const {
+    if (timeWindow == std::nullopt) {
+        return true;
+    }
+    return eTime > timeWindow->first - windowMargin && sTime < timeWindow->second + windowMargin;
+}
+
+void Estimator::FixTimeWindowHeadKnots() {
+    if (timeWindow == std::nullopt) {
+        return;
+    }
+    auto FixKnots = [this](const auto &spline, double knotDist) {
+        const int sIdx = KnotIndexOfTime(spline, knotDist, timeWindow->first);
+        // the first window starts from the head of the spline, nothing to be fixed
+        if (sIdx == 0) {
+            return;
+        }
+        for (int i = sIdx; i < sIdx + Configor::Prior::SplineOrder - 1; ++i) {
+            auto *data = const_cast<double *>(spline.GetKnot(i).data());
+            if (this->HasParameterBlock(data)) {
+                this->SetParameterBlockConstant(data);
+            }
+        }
+    };
+    FixKnots(splines->GetSo3Spline(Configor::Preference::SO3_SPLINE),
+             Configor::Prior::KnotTimeDist::SO3Spline);
+    FixKnots(splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+             Configor::Prior::KnotTimeDist::ScaleSpline);
+}
+
+std::vector<ceres::ResidualBlockId> Estimator::GetResidualBlocksLeavingTimeWindow(
+    double nextSTime) const {
+    // knots before the next time window
+    std::unordered_set<const double *> leavingKnots;
+    auto InvolveKnots = [&leavingKnots, nextSTime](const auto &spline, double knotDist) {
+        const int eIdx = KnotIndexOfTime(spline, knotDist, nextSTime);
+        for (int i = 0; i < eIdx; ++i) {
+            leavingKnots.insert(spline.GetKnot(i).data());
+        }
+    };
+    InvolveKnots(splines->GetSo3Spline(Configor::Preference::SO3_SPLINE),
+                 Configor::Prior::KnotTimeDist::SO3Spline);
+    InvolveKnots(splines->GetRdSpline(Configor::Preference::SCALE_SPLINE),
+                 Configor::Prior::KnotTimeDist::ScaleSpline);
+    const auto knots = timeWindow != std::nullopt ? allKnots : GetKnotParamBlocks();
+
+    std::vector<ceres::ResidualBlockId> residualBlocks, leavingBlocks;
+    this->GetResidualBlocks(&residualBlocks);
+    std::vector<double *> blocks;
+    for (const auto &id : residualBlocks) {
+        this->GetParameterBlocksForResidualBlock(id, &blocks);
+        bool involveKnots = false, involveLeavingKnots = false;
+        for (auto *block : blocks) {
+            involveKnots |= knots.count(block) != 0;
+            involveLeavingKnots |= leavingKnots.count(block) != 0;
+        }
+        // residual blocks involving no knot, e.g., priors, are carried by the marginalization
+        if (!involveKnots || involveLeavingKnots) {
+            leavingBlocks.push_back(id);
+        }
+    }
+    return leavingBlocks;
+}
+
+MarginalizationPrior::Ptr Estimator::MarginalizeToPrior(
+    const std::vector<ceres::ResidualBlockId> &residualBlocks, int numThread) {
+    if (residualBlocks.empty()) {
+        return nullptr;
+    }
+    // variable spatiotemporal parameters and intrinsics involved in given residual blocks are kept
+    const auto calibParams = GetCalibParamBlocks();
+    std::vector<double *> keptBlocks, blocks;
+    std::unordered_set<const double *> kept;
+    for (const auto &id : residualBlocks) {
+        this->GetParameterBlocksForResidualBlock(id, &blocks);
+        for (auto *block : blocks) {
+            if (calibParams.count(block) != 0 && kept.count(block) == 0 &&
+                !this->IsParameterBlockConstant(block)) {
+                keptBlocks.push_back(block);
+                kept.insert(block);
+            }
+        }
+    }
+    if (keptBlocks.empty()) {
+        return nullptr;
+    }
+
+    auto prior = MarginalizationPrior::Create();
+    prior->information = GetMarginalInformation(keptBlocks, numThread, residualBlocks);
+    for (auto *block : keptBlocks) {
+        prior->blocks.push_back(block);
+        prior->manifolds.push_back(this->GetManifold(block));
+        prior->linPoints.emplace_back(
+            Eigen::Map<const Eigen::VectorXd>(block, this->ParameterBlockSize(block)));
+    }
+    return prior;
+}
+
+void Estimator::AddMarginalizationPrior(const MarginalizationPrior::Ptr &prior) {
+    if (prior == nullptr) {
+        return;
+    }
+    for (int i = 0; i < static_cast<int>(prior->blocks.size()); ++i) {
+        auto *block = prior->blocks.at(i);
+        if (this->HasParameterBlock(block)) {
+            continue;
+        }
+        // manifolds of spatiotemporal parameters are the static ones of this class
+        const auto *manifold = prior->manifolds.at(i);
+        if (manifold == nullptr) {
+            this->AddParameterBlock(block, prior->AmbientSize(i));
+        } else if (manifold == QUATER_MANIFOLD.get()) {
+            this->AddParameterBlock(block, prior->AmbientSize(i), QUATER_MANIFOLD.get());
+        } else if (manifold == GRAVITY_MANIFOLD.get()) {
+            this->AddParameterBlock(block, prior->AmbientSize(i), GRAVITY_MANIFOLD.get());
+        } else {
+            throw Status(Status::CRITICAL,
+                         "unknown manifold of the parameter block in the marginalization prior!");
+        }
+    }
+    auto costFunc = MarginalizationPriorFactor::Create(prior);
+    this->AddResidualBlock(costFunc, nullptr, prior->blocks);
+}
+
+ceres::ResidualBlockId Estimator::AddResidualBlock(ceres::CostFunction *costFunction,
+                                                   ceres::LossFunction *lossFunction,
+                                                   const std::vector<double *> &parameterBlocks) {
+    if (recordedOps != nullptr) {
+        // the time window is checked when the residual block is actually added
+        recordedOps->push_back({ProblemOp::Type::ADD_RESIDUAL_BLOCK, nullptr, 0, 0.0, nullptr,
+                                costFunction, lossFunction, parameterBlocks});
+        return nullptr;
+    }
+    for (auto *block : parameterBlocks) {
+        if (IsKnotOutOfTimeWindow(block)) {
+            // parameter blocks of the dropped residual block are not added, configurations of
+            // callers on them (manifolds, bounds, constant, ...) are skipped as well
+            delete costFunction;
+            delete lossFunction;
+            return nullptr;
+        }
+    }
+    return ceres::Problem::AddResidualBlock(costFunction, lossFunction, parameterBlocks);
+}
+
+void Estimator::AddParameterBlock(double *values, int size) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back({ProblemOp::Type::ADD_PARAM_BLOCK, values, size});
+    } else if (!IsKnotOutOfTimeWindow(values)) {
+        ceres::Problem::AddParameterBlock(values, size);
+    }
+}
+
+void Estimator::AddParameterBlock(double *values, int size, ceres::Manifold *manifold) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back(
+            {ProblemOp::Type::ADD_PARAM_BLOCK_WITH_MANIFOLD, values, size, 0.0, manifold});
+    } else if (!IsKnotOutOfTimeWindow(values)) {
+        ceres::Problem::AddParameterBlock(values, size, manifold);
+    }
+}
+
+void Estimator::SetManifold(double *values, ceres::Manifold *manifold) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back({ProblemOp::Type::SET_MANIFOLD, values, 0, 0.0, manifold});
+    } else if (timeWindow == std::nullopt || this->HasParameterBlock(values)) {
+        ceres::Problem::SetManifold(values, manifold);
+    }
+}
+
+void Estimator::SetParameterBlockConstant(const double *values) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back({ProblemOp::Type::SET_CONSTANT, const_cast<double *>(values)});
+    } else if (timeWindow == std::nullopt || this->HasParameterBlock(values)) {
+        ceres::Problem::SetParameterBlockConstant(values);
+    }
+}
+
+void Estimator::SetParameterLowerBound(double *values, int index, double lowerBound) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back({ProblemOp::Type::SET_LOWER_BOUND, values, index, lowerBound});
+    } else if (timeWindow == std::nullopt || this->HasParameterBlock(values)) {
+        ceres::Problem::SetParameterLowerBound(values, index, lowerBound);
+    }
+}
+
+void Estimator::SetParameterUpperBound(double *values, int index, double upperBound) {
+    if (recordedOps != nullptr) {
+        recordedOps->push_back({ProblemOp::Type::SET_UPPER_BOUND, values, index, upperBound});
+    } else if (timeWindow == std::nullopt || this->HasParameterBlock(values)) {
+        ceres::Problem::SetParameterUpperBound(values, index, upperBound);
+    }
+}
+
+void Estimator::SetRecordedOps(std::vector<ProblemOp> *ops) { recordedOps = ops; }
+
+void Estimator::ApplyRecordedOps(std::vector<ProblemOp> &ops) {
+    for (const auto &op : ops) {
+        switch (op.type) {
+            case ProblemOp::Type::ADD_PARAM_BLOCK:
+                this->AddParameterBlock(op.block, op.index);
+                break;
+            case ProblemOp::Type::ADD_PARAM_BLOCK_WITH_MANIFOLD:
+                this->AddParameterBlock(op.block, op.index, op.manifold);
+                break;
+            case ProblemOp::Type::SET_MANIFOLD:
+                this->SetManifold(op.block, op.manifold);
+                break;
+            case ProblemOp::Type::SET_CONSTANT:
+                this->SetParameterBlockConstant(op.block);
+                break;
+            case ProblemOp::Type::SET_LOWER_BOUND:
+                this->SetParameterLowerBound(op.block, op.index, op.bound);
+                break;
+            case ProblemOp::Type::SET_UPPER_BOUND:
+                this->SetParameterUpperBound(op.block, op.index, op.bound);
+                break;
+            case ProblemOp::Type::ADD_RESIDUAL_BLOCK:
+                this->AddResidualBlock(op.costFunc, op.lossFunc, op.blocks);
+                break;
+        }
+    }
+    std::vector<ProblemOp>().swap(ops);
+}
+
+void Estimator::DiscardRecordedOps(std::vector<ProblemOp> &ops) {
+    for (const auto &op : ops) {
+        if (op.type == ProblemOp::Type::ADD_RESIDUAL_BLOCK) {
+            delete op.costFunc;
+            delete op.lossFunc;
+        }
+    }
+    std::vector<ProblemOp>().swap(ops);
+}
+
 /**
  * param blocks:
  * [ SO3 | ... | SO3 | SO3_EsToBr | TO_EsToBr | FX | FY | CX | CY ]
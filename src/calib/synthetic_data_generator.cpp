@@ -0,0 +1,514 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/synthetic_data_generator.h"
+#include "sensor/imu_intrinsic.hpp"
+#include "spdlog/spdlog.h"
+#include "util/status.hpp"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+SyntheticDataGenerator::SyntheticDataGenerator(CalibParamManager::Ptr parMagr,
+                                               double st,
+                                               double et,
+                                               std::uint32_t seed,
+                                               int landmarkNum)
+    : _parMagr(std::move(parMagr)),
+      _splines(nullptr),
+      _seed(seed),
+      _engine(seed) {
+    if (et - st < 1.0) {
+        throw Status(Status::ERROR, "the time range of the synthetic data is too short: {:.3f} (s)",
+                     et - st);
+    }
+    CreateGroundTruthSplines(st, et);
+    CreateScene(landmarkNum);
+}
+
+SyntheticDataGenerator::Ptr SyntheticDataGenerator::Create(const CalibParamManager::Ptr &parMagr,
+                                                           double st,
+                                                           double et,
+                                                           std::uint32_t seed,
+                                                           int landmarkNum) {
+    return std::make_shared<SyntheticDataGenerator>(parMagr, st, et, seed, landmarkNum);
+}
+
+const SyntheticDataGenerator::SplineBundleType::Ptr &SyntheticDataGenerator::GetSplines() const {
+    return _splines;
+}
+
+const std::vector<Eigen::Vector3d> &SyntheticDataGenerator::GetLandmarks() const {
+    return _landmarks;
+}
+
+void SyntheticDataGenerator::CreateGroundTruthSplines(double st, double et) {
+    // the knot distance of the ground-truth splines, which is small enough to represent the motion
+    constexpr double KnotDist = 0.02;
+    auto so3SplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                              ns_ctraj::SplineType::So3Spline, st, et, KnotDist);
+    auto posSplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                              ns_ctraj::SplineType::RdSpline, st, et, KnotDist);
+    _splines = SplineBundleType::Create({so3SplineInfo, posSplineInfo});
+
+    /**
+     * sinusoidal motions on all six degrees of freedom with incommensurable frequencies, to
+     * sufficiently excite the spatiotemporal parameters. The reference IMU moves around the center
+     * of the room, i.e., (0, 0, 2) in the world frame
+     */
+    auto SO3_BrToW = [](double t) {
+        const double roll = 0.35 * std::sin(1.1 * t);
+        const double pitch = 0.30 * std::sin(0.8 * t + 1.0);
+        const double yaw = 0.90 * std::sin(0.5 * t) + 0.30 * std::sin(1.7 * t);
+        return Sophus::SO3d(Eigen::Quaterniond(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()) *
+                                               Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY()) *
+                                               Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX())));
+    };
+    auto POS_BrInW = [](double t) {
+        return Eigen::Vector3d(1.2 * std::sin(0.9 * t), 1.0 * std::sin(0.7 * t + 0.5),
+                               2.0 + 0.4 * std::sin(1.3 * t));
+    };
+
+    // control points are sampled from the continuous motion, the ground truth is the spline itself
+    auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+        so3Spline.GetKnot(i) = SO3_BrToW(st + (i - 1) * KnotDist);
+    }
+    auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    for (int i = 0; i < static_cast<int>(posSpline.GetKnots().size()); ++i) {
+        posSpline.GetKnot(i) = POS_BrInW(st + (i - 1) * KnotDist);
+    }
+}
+
+void SyntheticDataGenerator::CreateScene(int landmarkNum) {
+    _room = {Eigen::Vector3d(-10.0, -8.0, 0.0), Eigen::Vector3d(10.0, 8.0, 5.0)};
+
+    // pillars are placed away from the trajectory, i.e., outside the 4x4 (m) central area
+    std::uniform_real_distribution<double> xDist(-8.5, 8.5), yDist(-6.5, 6.5);
+    std::uniform_real_distribution<double> sizeDist(0.3, 1.0);
+    while (_pillars.size() < 8) {
+        Eigen::Vector3d center(xDist(_engine), yDist(_engine), 0.0);
+        if (std::abs(center(0)) < 4.0 && std::abs(center(1)) < 4.0) {
+            continue;
+        }
+        const double size = sizeDist(_engine);
+        _pillars.push_back({center - Eigen::Vector3d(size, size, 0.0),
+                            center + Eigen::Vector3d(size, size, _room.max(2))});
+    }
+
+    // landmarks are obtained by casting random rays from the center of the room
+    const Eigen::Vector3d center(0.0, 0.0, 2.0);
+    std::normal_distribution<double> dirDist(0.0, 1.0);
+    _landmarks.reserve(landmarkNum);
+    while (static_cast<int>(_landmarks.size()) < landmarkNum) {
+        Eigen::Vector3d dir(dirDist(_engine), dirDist(_engine), dirDist(_engine));
+        if (dir.norm() < 1E-3) {
+            continue;
+        }
+        dir.normalize();
+        if (auto dist = RayCast(center, dir); dist) {
+            _landmarks.emplace_back(center + *dist * dir);
+        }
+    }
+    const Eigen::Vector3d roomSize = _room.max - _room.min;
+    spdlog::info("synthetic scene: room: [{:.1f}, {:.1f}, {:.1f}] (m), pillars: {}, landmarks: {}",
+                 roomSize(0), roomSize(1), roomSize(2), _pillars.size(), _landmarks.size());
+}
+
+Sophus::SE3d SyntheticDataGenerator::CurBrToW(double timeByBr) const {
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    return {so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr)};
+}
+
+bool SyntheticDataGenerator::TimeInRange(double timeByBr) const {
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    return timeByBr >= std::max(so3Spline.MinTime(), posSpline.MinTime()) &&
+           timeByBr < std::min(so3Spline.MaxTime(), posSpline.MaxTime());
+}
+
+std::optional<Sophus::SE3d> SyntheticDataGenerator::CurSenToW(const Sophus::SE3d &SE3_SenToBr,
+                                                              double TO_SenToBr,
+                                                              double timeBySen) const {
+    const double timeByBr = timeBySen + TO_SenToBr;
+    if (!TimeInRange(timeByBr)) {
+        return {};
+    }
+    return CurBrToW(timeByBr) * SE3_SenToBr;
+}
+
+double SyntheticDataGenerator::GaussianNoise(std::mt19937 &engine, double sigma) {
+    // a zero sigma is invalid for 'std::normal_distribution', i.e., no noise
+    return sigma > 0.0 ? std::normal_distribution<double>(0.0, sigma)(engine) : 0.0;
+}
+
+std::optional<double> SyntheticDataGenerator::RayCast(const Eigen::Vector3d &origin,
+                                                      const Eigen::Vector3d &dir) const {
+    // the room (the origin is inside): the nearest exit
+    double dist = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; ++i) {
+        if (dir(i) > 1E-9) {
+            dist = std::min(dist, (_room.max(i) - origin(i)) / dir(i));
+        } else if (dir(i) < -1E-9) {
+            dist = std::min(dist, (_room.min(i) - origin(i)) / dir(i));
+        }
+    }
+    if (dist <= 0.0) {
+        // the origin is outside the room
+        return {};
+    }
+    // the pillars: the nearest entry (slab method)
+    for (const auto &pillar : _pillars) {
+        double tMin = -std::numeric_limits<double>::max();
+        double tMax = std::numeric_limits<double>::max();
+        for (int i = 0; i < 3 && tMin <= tMax; ++i) {
+            if (std::abs(dir(i)) < 1E-9) {
+                if (origin(i) < pillar.min(i) || origin(i) > pillar.max(i)) {
+                    tMin = std::numeric_limits<double>::max();
+                }
+                continue;
+            }
+            double t1 = (pillar.min(i) - origin(i)) / dir(i);
+            double t2 = (pillar.max(i) - origin(i)) / dir(i);
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        if (tMin <= tMax && tMin > 0.0) {
+            dist = std::min(dist, tMin);
+        }
+    }
+    return dist;
+}
+
+std::vector<IMUFrame::Ptr> SyntheticDataGenerator::SimulateIMU(const std::string &topic,
+                                                               double freq,
+                                                               double gyroNoise,
+                                                               double acceNoise) {
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+
+    const auto SE3_BiToBr = _parMagr->EXTRI.SE3_BiToBr(topic);
+    const double TO_BiToBr = _parMagr->TEMPORAL.TO_BiToBr.at(topic);
+    const auto &intri = _parMagr->INTRI.IMU.at(topic);
+    const Eigen::Vector3d &POS_BiInBr = SE3_BiToBr.translation();
+
+    auto Noise = [this](double sigma) {
+        return Eigen::Vector3d(GaussianNoise(_engine, sigma), GaussianNoise(_engine, sigma),
+                               GaussianNoise(_engine, sigma));
+    };
+
+    std::vector<IMUFrame::Ptr> frames;
+    const double st = so3Spline.MinTime() - TO_BiToBr, et = so3Spline.MaxTime() - TO_BiToBr;
+    frames.reserve(static_cast<std::size_t>((et - st) * freq) + 1);
+    for (double timeByBi = st; timeByBi < et; timeByBi += 1.0 / freq) {
+        const double timeByBr = timeByBi + TO_BiToBr;
+        if (!TimeInRange(timeByBr)) {
+            continue;
+        }
+        const Sophus::SO3d SO3_BrToW = so3Spline.Evaluate(timeByBr);
+        const Eigen::Vector3d ANG_VEL_BrToWInBr = so3Spline.VelocityBody(timeByBr);
+        const Eigen::Vector3d ANG_ACCE_BrToWInBr = so3Spline.AccelerationBody(timeByBr);
+        const Eigen::Vector3d LIN_ACCE_BrToWInW = posSpline.Evaluate<2>(timeByBr);
+
+        // the kinematics of the IMU, which is rigidly connected to the reference IMU
+        const Eigen::Vector3d LIN_ACCE_BiToWInW =
+            LIN_ACCE_BrToWInW +
+            SO3_BrToW * (ANG_ACCE_BrToWInBr.cross(POS_BiInBr) +
+                         ANG_VEL_BrToWInBr.cross(ANG_VEL_BrToWInBr.cross(POS_BiInBr)));
+        const Eigen::Vector3d ANG_VEL_BiToWInW = SO3_BrToW * ANG_VEL_BrToWInBr;
+        const Sophus::SO3d SO3_BiToW = SO3_BrToW * SE3_BiToBr.so3();
+
+        auto frame = IMUIntrinsics::KinematicsToInertialMes(
+            timeByBi, LIN_ACCE_BiToWInW, ANG_VEL_BiToWInW, SO3_BiToW, _parMagr->GRAVITY);
+        frame = intri->InvolveIntri(frame);
+        frames.push_back(IMUFrame::Create(timeByBi, frame->GetGyro() + Noise(gyroNoise),
+                                          frame->GetAcce() + Noise(acceNoise)));
+    }
+    return frames;
+}
+
+std::vector<LiDARFrame::Ptr> SyntheticDataGenerator::SimulateLiDAR(const std::string &topic,
+                                                                   double freq,
+                                                                   int rings,
+                                                                   int columns,
+                                                                   double rangeNoise) {
+    const auto SE3_LkToBr = _parMagr->EXTRI.SE3_LkToBr(topic);
+    const double TO_LkToBr = _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+
+    // beams of the lidar, elevation angle: [-15, 15] (deg)
+    std::vector<double> elevations(rings);
+    for (int r = 0; r < rings; ++r) {
+        elevations.at(r) = (-15.0 + 30.0 * r / std::max(rings - 1, 1)) * IMUIntrinsics::DEG_TO_RAD;
+    }
+
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const double st = so3Spline.MinTime() - TO_LkToBr, et = so3Spline.MaxTime() - TO_LkToBr;
+    std::vector<double> frameTimes;
+    for (double timeByLk = st; timeByLk + 1.0 / freq < et; timeByLk += 1.0 / freq) {
+        frameTimes.push_back(timeByLk);
+    }
+    std::vector<LiDARFrame::Ptr> frames(frameTimes.size(), nullptr);
+
+    // each frame owns its random engine seeded deterministically, so that the simulation is
+    // reproducible while performed in parallel
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) default(none) \
+    shared(frameTimes, frames, elevations, SE3_LkToBr, TO_LkToBr, freq, rings, columns, rangeNoise)
+    for (int i = 0; i < static_cast<int>(frameTimes.size()); ++i) {
+        std::mt19937 engine(_seed + static_cast<std::uint32_t>(i));
+
+        const double timebase = frameTimes.at(i);
+        IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
+        cloud->is_dense = false;
+        cloud->reserve(rings * columns);
+
+        for (int c = 0; c < columns; ++c) {
+            // points in a column are sampled at the same time
+            const double timeByLk = timebase + c / (columns * freq);
+            auto SE3_LkToW = CurSenToW(SE3_LkToBr, TO_LkToBr, timeByLk);
+            if (!SE3_LkToW) {
+                continue;
+            }
+            const double azimuth = 2.0 * M_PI * c / columns;
+            for (int r = 0; r < rings; ++r) {
+                const double elevation = elevations.at(r);
+                const Eigen::Vector3d dirInLk(std::cos(elevation) * std::cos(azimuth),
+                                              std::cos(elevation) * std::sin(azimuth),
+                                              std::sin(elevation));
+                auto range = RayCast(SE3_LkToW->translation(), SE3_LkToW->so3() * dirInLk);
+                if (!range || *range < 1.0 || *range > 100.0) {
+                    continue;
+                }
+                const Eigen::Vector3d pInLk = (*range + GaussianNoise(engine, rangeNoise)) * dirInLk;
+                IKalibrPoint p;
+                p.x = static_cast<float>(pInLk(0));
+                p.y = static_cast<float>(pInLk(1));
+                p.z = static_cast<float>(pInLk(2));
+                p.timestamp = timeByLk;
+                cloud->push_back(p);
+            }
+        }
+        frames.at(i) = LiDARFrame::Create(timebase, cloud);
+    }
+    return frames;
+}
+
+std::vector<RadarTargetArray::Ptr> SyntheticDataGenerator::SimulateRadar(const std::string &topic,
+                                                                         double freq,
+                                                                         int targetNum,
+                                                                         double velNoise) {
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+
+    const auto SE3_RjToBr = _parMagr->EXTRI.SE3_RjToBr(topic);
+    const double TO_RjToBr = _parMagr->TEMPORAL.TO_RjToBr.at(topic);
+
+    // the field of view of the radar: azimuth: [-60, 60] (deg), elevation: [-15, 15] (deg)
+    const double azimuthMax = 60.0 * IMUIntrinsics::DEG_TO_RAD;
+    const double elevationMax = 15.0 * IMUIntrinsics::DEG_TO_RAD;
+
+    std::vector<RadarTargetArray::Ptr> arrays;
+    const double st = so3Spline.MinTime() - TO_RjToBr, et = so3Spline.MaxTime() - TO_RjToBr;
+    for (double timeByRj = st; timeByRj < et; timeByRj += 1.0 / freq) {
+        const double timeByBr = timeByRj + TO_RjToBr;
+        if (!TimeInRange(timeByBr)) {
+            continue;
+        }
+        const Sophus::SE3d SE3_BrToW = CurBrToW(timeByBr);
+        const Sophus::SE3d SE3_WToRj = (SE3_BrToW * SE3_RjToBr).inverse();
+        const Eigen::Vector3d ANG_VEL_BrToWInW = SE3_BrToW.so3() * so3Spline.VelocityBody(timeByBr);
+        const Eigen::Vector3d LIN_VEL_RjToWInW =
+            posSpline.Evaluate<1>(timeByBr) +
+            ANG_VEL_BrToWInW.cross(SE3_BrToW.so3() * SE3_RjToBr.translation());
+        const Eigen::Vector3d LIN_VEL_RjToWInRj = SE3_WToRj.so3() * LIN_VEL_RjToWInW;
+
+        std::vector<RadarTarget::Ptr> targets;
+        for (const auto &lm : _landmarks) {
+            const Eigen::Vector3d lmInRj = SE3_WToRj * lm;
+            const double range = lmInRj.norm();
+            if (lmInRj(0) < 0.5 || range > 50.0 ||
+                std::abs(std::atan2(lmInRj(1), lmInRj(0))) > azimuthMax ||
+                std::abs(std::asin(lmInRj(2) / range)) > elevationMax) {
+                continue;
+            }
+            // the radial velocity of the static target with respect to the radar
+            const double radialVel = -lmInRj.dot(LIN_VEL_RjToWInRj) / range + GaussianNoise(_engine, velNoise);
+            targets.push_back(RadarTarget::Create(timeByRj, lmInRj, radialVel));
+        }
+        if (targets.empty()) {
+            continue;
+        }
+        if (static_cast<int>(targets.size()) > targetNum) {
+            std::shuffle(targets.begin(), targets.end(), _engine);
+            targets.resize(targetNum);
+        }
+        arrays.push_back(RadarTargetArray::Create(timeByRj, targets));
+    }
+    return arrays;
+}
+
+ns_veta::Veta::Ptr SyntheticDataGenerator::SimulateCameraFeatures(const std::string &topic,
+                                                                  double freq,
+                                                                  double pixelNoise) {
+    const auto SE3_CmToBr = _parMagr->EXTRI.SE3_CmToBr(topic);
+    const double TO_CmToBr = _parMagr->TEMPORAL.TO_CmToBr.at(topic);
+    const auto &intri = _parMagr->INTRI.Camera.at(topic);
+
+    auto veta = ns_veta::Veta::Create();
+    const ns_veta::IndexT intriIdx = 0;
+    veta->intrinsics.insert({intriIdx, intri});
+
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const double st = so3Spline.MinTime() - TO_CmToBr, et = so3Spline.MaxTime() - TO_CmToBr;
+    ns_veta::IndexT viewId = 0;
+    for (double timeByCm = st; timeByCm < et; timeByCm += 1.0 / freq) {
+        auto SE3_CmToW = CurSenToW(SE3_CmToBr, TO_CmToBr, timeByCm);
+        if (!SE3_CmToW) {
+            continue;
+        }
+        const Sophus::SE3d SE3_WToCm = SE3_CmToW->inverse();
+        const ns_veta::IndexT poseId = viewId;
+        veta->views.insert({viewId, ns_veta::View::Create(timeByCm, viewId, intriIdx, poseId,
+                                                          intri->imgWidth, intri->imgHeight)});
+        veta->poses.insert(
+            {poseId, ns_veta::Posed(SE3_CmToW->so3().matrix(), SE3_CmToW->translation())});
+
+        ns_veta::IndexT featId = 0;
+        for (int lmId = 0; lmId < static_cast<int>(_landmarks.size()); ++lmId) {
+            const Eigen::Vector3d lmInCm = SE3_WToCm * _landmarks.at(lmId);
+            if (lmInCm(2) < 0.2) {
+                continue;
+            }
+            Eigen::Vector2d feat = intri->CamToImg({lmInCm(0) / lmInCm(2), lmInCm(1) / lmInCm(2)});
+            if (feat(0) < 0.0 || feat(0) >= intri->imgWidth || feat(1) < 0.0 ||
+                feat(1) >= intri->imgHeight) {
+                continue;
+            }
+            feat += Eigen::Vector2d(GaussianNoise(_engine, pixelNoise),
+                                    GaussianNoise(_engine, pixelNoise));
+            auto &lm = veta->structure[lmId];
+            lm.X = _landmarks.at(lmId);
+            lm.obs.insert({viewId, ns_veta::Observation(feat, featId++)});
+        }
+        ++viewId;
+    }
+
+    // landmarks observed only once are useless
+    for (auto iter = veta->structure.begin(); iter != veta->structure.end();) {
+        if (iter->second.obs.size() < 2) {
+            iter = veta->structure.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    return veta;
+}
+
+std::vector<EventArray::Ptr> SyntheticDataGenerator::SimulateEvents(const std::string &topic,
+                                                                    double arrayFreq,
+                                                                    double sampleFreq) {
+    const auto SE3_EsToBr = _parMagr->EXTRI.SE3_EsToBr(topic);
+    const double TO_EsToBr = _parMagr->TEMPORAL.TO_EsToBr.at(topic);
+    const auto &intri = _parMagr->INTRI.Camera.at(topic);
+
+    // the (distorted) pixel of each landmark at the last sampling, invalid if it's not in view
+    static constexpr int InvalidPixel = -1;
+    std::vector<Eigen::Vector2i> lastPixels(_landmarks.size(), Eigen::Vector2i::Constant(InvalidPixel));
+    auto Project = [&intri](const Sophus::SE3d &SE3_WToEs, const Eigen::Vector3d &lm) {
+        const Eigen::Vector3d lmInEs = SE3_WToEs * lm;
+        if (lmInEs(2) < 0.2) {
+            return Eigen::Vector2i::Constant(InvalidPixel).eval();
+        }
+        const Eigen::Vector2d pixel =
+            intri->GetDistoPixel(intri->CamToImg({lmInEs(0) / lmInEs(2), lmInEs(1) / lmInEs(2)}));
+        const int x = static_cast<int>(std::round(pixel(0)));
+        const int y = static_cast<int>(std::round(pixel(1)));
+        if (x < 0 || x >= static_cast<int>(intri->imgWidth) || y < 0 ||
+            y >= static_cast<int>(intri->imgHeight)) {
+            return Eigen::Vector2i::Constant(InvalidPixel).eval();
+        }
+        return Eigen::Vector2i(x, y);
+    };
+
+    std::vector<EventArray::Ptr> arrays;
+    std::vector<double> evTimestamps;
+    std::vector<EventArray::PosScalar> evXs, evYs;
+    std::vector<std::uint8_t> evPolarities;
+    auto AddEvent = [&](double t, const Eigen::Vector2i &pixel, bool polarity) {
+        evTimestamps.push_back(t);
+        evXs.push_back(static_cast<EventArray::PosScalar>(pixel(0)));
+        evYs.push_back(static_cast<EventArray::PosScalar>(pixel(1)));
+        evPolarities.push_back(polarity);
+    };
+
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const double st = so3Spline.MinTime() - TO_EsToBr, et = so3Spline.MaxTime() - TO_EsToBr;
+    double arrayEndTime = st + 1.0 / arrayFreq;
+    for (double timeByEs = st; timeByEs < et; timeByEs += 1.0 / sampleFreq) {
+        if (timeByEs >= arrayEndTime) {
+            if (!evTimestamps.empty()) {
+                arrays.push_back(EventArray::Create(arrayEndTime, std::move(evTimestamps),
+                                                    std::move(evXs), std::move(evYs),
+                                                    std::move(evPolarities)));
+                evTimestamps.clear(), evXs.clear(), evYs.clear(), evPolarities.clear();
+            }
+            arrayEndTime += 1.0 / arrayFreq;
+        }
+        auto SE3_EsToW = CurSenToW(SE3_EsToBr, TO_EsToBr, timeByEs);
+        if (!SE3_EsToW) {
+            continue;
+        }
+        const Sophus::SE3d SE3_WToEs = SE3_EsToW->inverse();
+        for (int i = 0; i < static_cast<int>(_landmarks.size()); ++i) {
+            const Eigen::Vector2i pixel = Project(SE3_WToEs, _landmarks.at(i));
+            Eigen::Vector2i &lastPixel = lastPixels.at(i);
+            if (pixel != lastPixel) {
+                // the edge leaves the old pixel and arrives at the new one
+                if (lastPixel(0) != InvalidPixel) {
+                    AddEvent(timeByEs, lastPixel, false);
+                }
+                if (pixel(0) != InvalidPixel) {
+                    AddEvent(timeByEs, pixel, true);
+                }
+                lastPixel = pixel;
+            }
+        }
+    }
+    return arrays;
+}
+
+}  // namespace ns_ikalibr
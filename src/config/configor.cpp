@@ -38,6 +38,7 @@
 #include "magic_enum_flags.hpp"
 #include "ros/package.h"
 #include "filesystem"
+#include "omp.h"
 #include "cereal/types/vector.hpp"
 #include "cereal/types/set.hpp"
 
@@ -64,9 +65,31 @@ const static std::map<std::string, OutputOption> OutputOptionMap = {
     {"RadarDopplerErrors", OutputOption::RadarDopplerErrors},
     {"VisualOpticalFlowErrors", OutputOption::VisualOpticalFlowErrors},
     {"LiDARPointToSurfelErrors", OutputOption::LiDARPointToSurfelErrors},
+    {"ProfileReport", OutputOption::ProfileReport},
     {"ALL", OutputOption::ALL},
 };
 
+const static std::map<std::string, SpeedUpOption> SpeedUpOptionMap = {
+    {"NONE", SpeedUpOption::NONE},
+    {"ParallelDataLoading", SpeedUpOption::ParallelDataLoading},
+    {"CalibDataCache", SpeedUpOption::CalibDataCache},
+    {"AnalyticIMUFactor", SpeedUpOption::AnalyticIMUFactor},
+    {"ParallelInitPrep", SpeedUpOption::ParallelInitPrep},
+    {"ParallelDataAssociation", SpeedUpOption::ParallelDataAssociation},
+    {"IncrementalDataAssociation", SpeedUpOption::IncrementalDataAssociation},
+    {"MultiResolutionNDT", SpeedUpOption::MultiResolutionNDT},
+    {"CompactLiDARScans", SpeedUpOption::CompactLiDARScans},
+    {"InformativePointToSurfel", SpeedUpOption::InformativePointToSurfel},
+    {"ParallelSurfelMapBuild", SpeedUpOption::ParallelSurfelMapBuild},
+    {"TiledLiDARMap", SpeedUpOption::TiledLiDARMap},
+    {"WarmStartLiDAROdometry", SpeedUpOption::WarmStartLiDAROdometry},
+    {"PersistentEstimator", SpeedUpOption::PersistentEstimator},
+    {"AutoLinearSolver", SpeedUpOption::AutoLinearSolver},
+    {"SlidingWindowOptimization", SpeedUpOption::SlidingWindowOptimization},
+    {"ParallelProblemBuild", SpeedUpOption::ParallelProblemBuild},
+    {"ALL", SpeedUpOption::ALL},
+};
+
 // ------------------------
 // static initialized filed
 // ------------------------
@@ -93,12 +116,23 @@ double Configor::Prior::GravityNorm = {};
 double Configor::Prior::TimeOffsetPadding = {};
 double Configor::Prior::ReadoutTimePadding = {};
 double Configor::Prior::MapDownSample = {};
+// the edge length of tiles (m) of the global lidar map when 'TiledLiDARMap' is enabled
+const double Configor::Prior::MapTileSize = 20.0;
+// tiles are spilled to the disk once they hold more points than this
+const std::size_t Configor::Prior::MapTilePointMax = 1 << 20;
+// points of tiles kept in memory, the fullest tiles are spilled to the disk once exceeded
+const std::size_t Configor::Prior::MapInMemoryPointMax = 1 << 24;
+// time length of windows in the sliding-window optimization, and the overlap of adjacent ones
+const double Configor::Prior::SlidingWindowLength = 60.0;
+const double Configor::Prior::SlidingWindowOverlap = 10.0;
 
 double Configor::Prior::KnotTimeDist::SO3Spline = {};
 double Configor::Prior::KnotTimeDist::ScaleSpline = {};
 
 double Configor::Prior::NDTLiDAROdometer::Resolution = {};
 double Configor::Prior::NDTLiDAROdometer::KeyFrameDownSample = {};
+// levels of the resolution pyramid (resolution doubled per level) when 'MultiResolutionNDT' is on
+const int Configor::Prior::NDTLiDAROdometer::PyramidLevels = 3;
 
 double Configor::Prior::LiDARDataAssociate::PointToSurfelMax = {};
 double Configor::Prior::LiDARDataAssociate::PlanarityMin = {};
@@ -109,7 +143,16 @@ const std::size_t Configor::Prior::LiDARDataAssociate::SurfelPointMin = 100;
 // 0.1, 0.2, 0.4, 0.8, 1.6, ...
 const double Configor::Prior::LiDARDataAssociate::MapResolution = 0.1;
 const std::uint8_t Configor::Prior::LiDARDataAssociate::MapDepthLevels = 16;
+// the octree depth at which points are partitioned when 'ParallelSurfelMapBuild' is enabled, i.e.,
+// each partition is a cube of 'MapResolution * 2^MapPartitionDepth' (3.2 m)
+const std::uint8_t Configor::Prior::LiDARDataAssociate::MapPartitionDepth = 5;
+// maps with fewer points than this are built serially, as partitioning does not pay off
+const std::size_t Configor::Prior::LiDARDataAssociate::ParallelMapBuildPointMin = 100000;
 const int Configor::Prior::LiDARDataAssociate::PointToSurfelCountInScan = 200;
+// the residual budget of each scan when 'InformativePointToSurfel' is enabled
+const int Configor::Prior::LiDARDataAssociate::InformativePointToSurfelCountInScan = 20;
+// scans whose points move less than this value (m) are kept in the incremental re-association
+const double Configor::Prior::LiDARDataAssociate::ScanMovementMin = 0.01;
 
 // the loss function used for radar factor (m/s) (on the direction of target)
 const double Configor::Prior::LossForRadarDopplerFactor = 0.1;
@@ -120,9 +163,19 @@ const double Configor::Prior::LossForReprojFactor = 1.0;
 // the loss function used for visual optical flow factor (pixel) (on the image pixel plane)
 const double Configor::Prior::LossForOpticalFlowFactor = 30.0;
 
+// the position quantization resolution (m) of compact lidar scans ('CompactLiDARScans'), zero
+// keeps float positions, e.g., 0.002 stores positions as 16-bit integers
+const float Configor::Prior::CompactLiDARScanResolution = 0.0f;
+
 bool Configor::Prior::OptTemporalParams = {};
 
 bool Configor::Preference::UseCudaInSolving = {};
+// reduced systems larger than 'DenseSchurDimMax' are solved by sparse factorizations, and those
+// larger than 'SparseSchurDimMax' by iterative (preconditioned conjugate gradients) ones
+const int Configor::Preference::DenseSchurDimMax = 2000;
+const int Configor::Preference::SparseSchurDimMax = 100000;
+// threads are not worth spawning for building residual blocks of a few measurements
+const int Configor::Preference::ParallelProblemBuildMin = 1000;
 OutputOption Configor::Preference::Outputs = OutputOption::NONE;
 std::set<std::string> Configor::Preference::OutputsStr = {};
 std::string Configor::Preference::OutputDataFormatStr = {};
@@ -133,6 +186,8 @@ const std::map<CerealArchiveType::Enum, std::string> Configor::Preference::FileE
     {CerealArchiveType::Enum::XML, ".xml"},
     {CerealArchiveType::Enum::BINARY, ".bin"}};
 int Configor::Preference::ThreadsToUse = {};
+SpeedUpOption Configor::Preference::SpeedUps = SpeedUpOption::NONE;
+std::set<std::string> Configor::Preference::SpeedUpsStr = {};
 const std::string Configor::Preference::SO3_SPLINE = "SO3_SPLINE";
 const std::string Configor::Preference::SCALE_SPLINE = "SCALE_SPLINE";
 double Configor::Preference::SplineScaleInViewer = {};
@@ -242,6 +297,14 @@ int Configor::Preference::AvailableThreads() {
     }
 }
 
+int Configor::Preference::AvailableThreadsInRegion() {
+    int threads = AvailableThreads();
+    for (int level = omp_get_level(); level > 0; --level) {
+        threads /= std::max(1, omp_get_team_size(level));
+    }
+    return std::max(1, threads);
+}
+
 Configor::Configor() = default;
 
 void Configor::PrintMainFields() {
@@ -274,7 +337,7 @@ void Configor::PrintMainFields() {
     std::string RGBDTopics = ssRGBDTopics.str();
     std::string EventTopics = ssEventTopics.str();
 
-    auto GetOptString = [](OutputOption opt) -> std::string {
+    auto GetOptString = [](auto opt) -> std::string {
         std::stringstream stringStream;
         stringStream << magic_enum::enum_flags_name(opt);
         return stringStream.str();
@@ -287,7 +350,7 @@ void Configor::PrintMainFields() {
             DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                 DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
                     DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT
-                        DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT,
+                        DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT DESC_FORMAT,
         DESC_FIELD(IMUTopics), DESC_FIELD(RadarTopics), DESC_FIELD(LiDARTopics),
         DESC_FIELD(CameraTopics), DESC_FIELD(RGBDTopics), DESC_FIELD(EventTopics),
         DESC_FIELD(DataStream::ReferIMU), DESC_FIELD(DataStream::BagPath),
@@ -304,7 +367,8 @@ void Configor::PrintMainFields() {
         DESC_FIELD(Prior::LossForReprojFactor), DESC_FIELD(Prior::LossForOpticalFlowFactor),
         DESC_FIELD(Preference::UseCudaInSolving), "Preference::OutputDataFormat",
         Preference::OutputDataFormatStr, "Preference::Outputs", GetOptString(Preference::Outputs),
-        DESC_FIELD(Preference::ThreadsToUse));
+        DESC_FIELD(Preference::ThreadsToUse), "Preference::SpeedUps",
+        GetOptString(Preference::SpeedUps));
 
 #undef DESC_FIELD
 #undef DESC_FORMAT
@@ -540,6 +604,13 @@ bool Configor::LoadConfigure(const std::string &filename, CerealArchiveType::Enu
             Configor::Preference::Outputs |= iter->second;
         }
     }
+    for (const auto &speedUp : Preference::SpeedUpsStr) {
+        if (auto iter = SpeedUpOptionMap.find(speedUp); iter == SpeedUpOptionMap.cend()) {
+            throw Status(Status::CRITICAL, "unsupported speed-up option: '{}'!!!", speedUp);
+        } else {
+            Configor::Preference::SpeedUps |= iter->second;
+        }
+    }
 
     // perform checking
     ns_ikalibr::Configor::CheckConfigure();
@@ -277,16 +277,17 @@ EventCircleTracking::TimeVaryingCircle::Ptr EventCircleTracking::FitTimeVaryingC
 
     auto ComputeCenter = [&st, &et](const EventArray::Ptr& ary) {
         Eigen::Vector2d c(0.0, 0.0);
-        for (const auto& event : ary->GetEvents()) {
-            c += event->GetPos().cast<double>();
-            if (st > event->GetTimestamp()) {
-                st = event->GetTimestamp();
+        for (std::size_t i = 0; i != ary->GetEventNum(); ++i) {
+            c += ary->GetEventPos(i).cast<double>();
+            const double t = ary->GetEventTimestamp(i);
+            if (st > t) {
+                st = t;
             }
-            if (et < event->GetTimestamp()) {
-                et = event->GetTimestamp();
+            if (et < t) {
+                et = t;
             }
         }
-        return c / static_cast<double>(ary->GetEvents().size());
+        return c / static_cast<double>(ary->GetEventNum());
     };
     Eigen::Vector2d c1 = ComputeCenter(ary1), c2 = ComputeCenter(ary2);
 
@@ -298,8 +299,8 @@ EventCircleTracking::TimeVaryingCircle::Ptr EventCircleTracking::FitTimeVaryingC
     ceres::Problem problem;
 
     auto AddResidualsToProblem = [&circle, &problem, &avgDistThd](const EventArray::Ptr& ary) {
-        for (const auto& event : ary->GetEvents()) {
-            auto cf = TimeVaryingCircleFittingFactor::Create(event, 1.0);
+        for (std::size_t i = 0; i != ary->GetEventNum(); ++i) {
+            auto cf = TimeVaryingCircleFittingFactor::Create(ary->GetEvent(i), 1.0);
             cf->AddParameterBlock(2);
             cf->AddParameterBlock(2);
             cf->AddParameterBlock(3);
@@ -328,13 +329,13 @@ EventCircleTracking::TimeVaryingCircle::Ptr EventCircleTracking::FitTimeVaryingC
     } else {
         // compute average point to circle distance
         double avgDist = 0.0;
-        for (const auto& event : ary1->GetEvents()) {
-            avgDist += circle->PointToCircleDistance(event);
-        }
-        for (const auto& event : ary2->GetEvents()) {
-            avgDist += circle->PointToCircleDistance(event);
+        for (const auto& ary : {ary1, ary2}) {
+            for (std::size_t i = 0; i != ary->GetEventNum(); ++i) {
+                avgDist +=
+                    circle->PointToCircleDistance(ary->GetEventTimestamp(i), ary->GetEventPos(i));
+            }
         }
-        avgDist /= static_cast<double>(ary1->GetEvents().size() + ary2->GetEvents().size());
+        avgDist /= static_cast<double>(ary1->GetEventNum() + ary2->GetEventNum());
         // std::cout << "avgDist: " << avgDist << std::endl;
         if (avgDist > avgDistThd) {
             return nullptr;
@@ -388,11 +389,13 @@ EventCircleTracking::RawEventsOfCircleClusterPairs(
             continue;
         }
 
-        auto cAry = EventArray::Create(cEventAry.back()->GetTimestamp(),
-                                       {cEventAry.cbegin(), cEventAry.cend()});
+        auto cAry = EventArray::Create(
+            cEventAry.back()->GetTimestamp(),
+            std::vector<Event::Ptr>(cEventAry.cbegin(), cEventAry.cend()));
 
-        auto rAry = EventArray::Create(rEventAry.back()->GetTimestamp(),
-                                       {rEventAry.cbegin(), rEventAry.cend()});
+        auto rAry = EventArray::Create(
+            rEventAry.back()->GetTimestamp(),
+            std::vector<Event::Ptr>(rEventAry.cbegin(), rEventAry.cend()));
 
         eventsOfCluster.push_back({cAry, rAry});
     }
@@ -73,10 +73,12 @@ ActiveEventSurface::Ptr ActiveEventSurface::Create(const ns_veta::PinholeIntrins
 }
 
 void ActiveEventSurface::GrabEvent(const Event::Ptr &event, bool drawEventMat) {
-    const bool ep = event->GetPolarity();
-    const std::uint16_t ex = event->GetPos()(0), ey = event->GetPos()(1);
-    const double et = event->GetTimestamp();
+    GrabEvent(event->GetTimestamp(), event->GetPos()(0), event->GetPos()(1), event->GetPolarity(),
+              drawEventMat);
+}
 
+void ActiveEventSurface::GrabEvent(
+    double et, std::uint16_t ex, std::uint16_t ey, bool ep, bool drawEventMat) {
     // update Surface of Active Events
     const int pol = ep ? 1 : 0;
     const int polInv = !ep ? 1 : 0;
@@ -99,8 +101,12 @@ void ActiveEventSurface::GrabEvent(const Event::Ptr &event, bool drawEventMat) {
 }
 
 void ActiveEventSurface::GrabEvent(const EventArray::Ptr &events, bool drawEventMat) {
-    for (const auto &event : events->GetEvents()) {
-        GrabEvent(event, drawEventMat);
+    const auto &ets = events->GetEventTimestamps();
+    const auto &exs = events->GetEventXs();
+    const auto &eys = events->GetEventYs();
+    const auto &eps = events->GetEventPolarities();
+    for (std::size_t i = 0; i != ets.size(); ++i) {
+        GrabEvent(ets[i], exs[i], eys[i], eps[i], drawEventMat);
     }
 }
 
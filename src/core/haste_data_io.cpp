@@ -96,14 +96,17 @@ std::pair<std::string, EventsInfo::SubBatch> HASTEDataIO::SaveRawEventDataAsText
     std::stringstream buffer;
     std::size_t eventCount = 0;
     for (auto iter = fromIter; iter != toIter; ++iter) {
-        const auto &events = (*iter)->GetEvents();
-        for (const auto &event : events) {
+        const auto &ets = (*iter)->GetEventTimestamps();
+        const auto &exs = (*iter)->GetEventXs();
+        const auto &eys = (*iter)->GetEventYs();
+        const auto &eps = (*iter)->GetEventPolarities();
+        for (std::size_t i = 0; i != ets.size(); ++i) {
             // todo: this is too too slow!!! modify haste to support binary data loading
-            buffer << fmt::format("{:.9f} {} {} {}\n",                    // time, x, y, polarity
-                                  event->GetTimestamp(),                  // time
-                                  event->GetPos()(0),                     // x
-                                  event->GetPos()(1),                     // y
-                                  static_cast<int>(event->GetPolarity())  // polarity
+            buffer << fmt::format("{:.9f} {} {} {}\n",       // time, x, y, polarity
+                                  ets[i],                    // time
+                                  exs[i],                    // x
+                                  eys[i],                    // y
+                                  static_cast<int>(eps[i])  // polarity
             );
             ++eventCount;
         }
@@ -184,13 +187,16 @@ std::pair<std::string, EventsInfo::SubBatch> HASTEDataIO::SaveRawEventDataAsBina
     std::ofstream ofEvents(eventsPath, std::ios::binary);
     std::size_t eventCount = 0;
     for (auto iter = fromIter; iter != toIter; ++iter) {
-        const auto &events = (*iter)->GetEvents();
-        for (const auto &event : events) {
+        const auto &ets = (*iter)->GetEventTimestamps();
+        const auto &exs = (*iter)->GetEventXs();
+        const auto &eys = (*iter)->GetEventYs();
+        const auto &eps = (*iter)->GetEventPolarities();
+        for (std::size_t i = 0; i != ets.size(); ++i) {
             // time (float), x (uint16_t), y (uint16_t), polarity (boolean)
-            auto time = static_cast<float>(event->GetTimestamp());
-            std::uint16_t x = event->GetPos()(0);
-            std::uint16_t y = event->GetPos()(1);
-            bool polarity = event->GetPolarity();
+            auto time = static_cast<float>(ets[i]);
+            std::uint16_t x = exs[i];
+            std::uint16_t y = eys[i];
+            bool polarity = eps[i];
 
             ofEvents.write(reinterpret_cast<const char *>(&time), sizeof(time));
             ofEvents.write(reinterpret_cast<const char *>(&x), sizeof(x));
@@ -41,30 +41,45 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
-LiDAROdometer::LiDAROdometer(float ndtResolution, int threads)
+LiDAROdometer::LiDAROdometer(float ndtResolution, int threads, int pyramidLevels)
     : _ndtResolution(ndtResolution),
       _threads(threads),
+      _pyramidLevels(std::max(pyramidLevels, 1)),
       _map(nullptr),
       _mapTime(0.0),
-      _ndt(new pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>),
-      _initialized(false) {
-    // init the ndt omp object
-    _ndt->setResolution(ndtResolution);
-    _ndt->setNumThreads(threads);
-    _ndt->setNeighborhoodSearchMethod(pclomp::DIRECT7);
-    _ndt->setTransformationEpsilon(1E-3);
-    _ndt->setStepSize(0.01);
-    _ndt->setMaximumIterations(50);
+      _ndt(nullptr),
+      _initialized(false),
+      _lastKeyPos(0.0, 0.0, 0.0),
+      _lastKeyYPR(0.0, 0.0, 0.0) {
+    // init the ndt omp objects from the coarsest level to the finest one
+    for (int level = _pyramidLevels - 1; level >= 0; --level) {
+        // the resolution is doubled per level, so as the convergence related thresholds
+        const float scale = static_cast<float>(1 << level);
+        // the source is as sparse as the resolution of the level allows
+        _sourceLeafSizes.push_back(0.5f * scale);
+        pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr ndt(
+            new pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>);
+        ndt->setResolution(ndtResolution * scale);
+        ndt->setNumThreads(threads);
+        ndt->setNeighborhoodSearchMethod(pclomp::DIRECT7);
+        ndt->setTransformationEpsilon(1E-3 * scale);
+        ndt->setStepSize(0.01 * scale);
+        ndt->setMaximumIterations(50);
+        _ndtPyramid.push_back(ndt);
+    }
+    _ndt = _ndtPyramid.back();
 }
 
-LiDAROdometer::Ptr LiDAROdometer::Create(float ndtResolution, int threads) {
-    return std::make_shared<LiDAROdometer>(ndtResolution, threads);
+LiDAROdometer::Ptr LiDAROdometer::Create(float ndtResolution, int threads, int pyramidLevels) {
+    return std::make_shared<LiDAROdometer>(ndtResolution, threads, pyramidLevels);
 }
 
 ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
                                          const Eigen::Matrix4d &predCurToLast,
                                          bool updateMap) {
     ns_ctraj::Posed curLtoM;
+    // sources of levels in registration, down sampled using leaf sizes in '_sourceLeafSizes'
+    std::vector<IKalibrPointCloud::Ptr> sources;
     if (!_initialized) {
         // identity
         curLtoM = ns_ctraj::Posed(frame->GetTimestamp());
@@ -77,24 +92,38 @@ ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
         _initialized = true;
 
     } else {
-        // down sample
-        IKalibrPointCloud::Ptr filterCloud(new IKalibrPointCloud());
-        DownSampleCloud(frame->GetScan(), filterCloud, 0.5);
-        _ndt->setInputSource(filterCloud);
-
         // organize the pred pose from cur frame to map
 
         Eigen::Matrix4d predCurLtoM = this->_poseSeq.back().se3().matrix() * predCurToLast;
+        Eigen::Matrix4f guess = predCurLtoM.cast<float>();
+        // obtain the scan once, as it is converted on demand for compacted frames
+        const auto scan = frame->GetScan();
+
+        // register coarse to fine, each level starts from the result of the coarser one
         IKalibrPointCloud::Ptr outputCloud(new IKalibrPointCloud());
-        _ndt->align(*outputCloud, predCurLtoM.cast<float>());
+        for (int i = 0; i < static_cast<int>(_ndtPyramid.size()); ++i) {
+            const auto &ndt = _ndtPyramid.at(i);
+            // down sample
+            IKalibrPointCloud::Ptr filterCloud(new IKalibrPointCloud());
+            DownSampleCloud(scan, filterCloud, _sourceLeafSizes.at(i));
+            ndt->setInputSource(filterCloud);
+            sources.push_back(filterCloud);
+
+            ndt->align(*outputCloud, guess);
+
+            // a diverged coarse level is skipped, the finer one starts from the previous guess
+            if (ndt == _ndt || ndt->hasConverged()) {
+                guess = ndt->getFinalTransformation();
+            }
+        }
 
         // get pose
-        Eigen::Matrix4d pose = _ndt->getFinalTransformation().cast<double>();
+        Eigen::Matrix4d pose = guess.cast<double>();
         curLtoM = ns_ctraj::Posed::FromT(pose, frame->GetTimestamp());
     }
 
     if (updateMap && CheckKeyFrame(curLtoM)) {
-        UpdateMap(frame, curLtoM);
+        UpdateMap(frame, curLtoM, sources);
         _keyFrameIdx.push_back(_frames.size());
     }
 
@@ -105,15 +134,12 @@ ns_ctraj::Posed LiDAROdometer::FeedFrame(const LiDARFrame::Ptr &frame,
 }
 
 bool LiDAROdometer::CheckKeyFrame(const ns_ctraj::Posed &LtoM) {
-    static Eigen::Vector3d lastPos(0.0, 0.0, 0.0);
-    static Eigen::Vector3d lastYPR(0.0, 0.0, 0.0);
-
     Eigen::Vector3d curPos = LtoM.t;
-    double posDist = (curPos - lastPos).norm();
+    double posDist = (curPos - _lastKeyPos).norm();
 
     // get current rotMat, ypr
     Eigen::Vector3d curYPR = RotMatToYPR(LtoM.so3.matrix());
-    Eigen::Vector3d deltaAngle = curYPR - lastYPR;
+    Eigen::Vector3d deltaAngle = curYPR - _lastKeyYPR;
     for (int i = 0; i < 3; i++) {
         deltaAngle(i) = NormalizeAngle(deltaAngle(i));
     }
@@ -122,36 +148,50 @@ bool LiDAROdometer::CheckKeyFrame(const ns_ctraj::Posed &LtoM) {
     if (_frames.empty() || posDist > 0.2 || deltaAngle(0) > 5.0 || deltaAngle(1) > 5.0 ||
         deltaAngle(2) > 5.0) {
         // update state
-        lastPos = curPos;
-        lastYPR = curYPR;
+        _lastKeyPos = curPos;
+        _lastKeyYPR = curYPR;
         return true;
     }
     return false;
 }
 
-void LiDAROdometer::UpdateMap(const LiDARFrame::Ptr &frame, const ns_ctraj::Posed &LtoM) {
+void LiDAROdometer::UpdateMap(const LiDARFrame::Ptr &frame,
+                              const ns_ctraj::Posed &LtoM,
+                              const std::vector<IKalibrPointCloud::Ptr> &sources) {
+    IKalibrPointCloud::ConstPtr newCloud;
     // update the first map frame using all points after this program is fine
     if (_frames.empty()) {
         // copy the frame point cloud to the map
-        *_map += *frame->GetScan();
+        newCloud = frame->GetScan();
     } else {
-        // down sample
-        IKalibrPointCloud::Ptr filteredCloud(new IKalibrPointCloud);
-        DownSampleCloud(frame->GetScan(), filteredCloud, _ndtResolution);
+        // down sample, the source in registration is reused if it's down sampled with the same
+        // leaf size as the map
+        IKalibrPointCloud::Ptr downSampled = nullptr;
+        for (int i = 0; i < static_cast<int>(sources.size()); ++i) {
+            if (_sourceLeafSizes.at(i) == _ndtResolution) {
+                downSampled = sources.at(i);
+            }
+        }
+        if (downSampled == nullptr) {
+            downSampled = boost::make_shared<IKalibrPointCloud>();
+            DownSampleCloud(frame->GetScan(), downSampled, _ndtResolution);
+        }
 
         // transform
-        IKalibrPointCloud::Ptr transformCloud(new IKalibrPointCloud);
-        pcl::transformPointCloud(*filteredCloud, *transformCloud,
-                                 LtoM.se3().matrix().cast<float>());
-
-        *_map += *transformCloud;
+        IKalibrPointCloud::Ptr transformed = boost::make_shared<IKalibrPointCloud>();
+        pcl::transformPointCloud(*downSampled, *transformed, LtoM.se3().matrix().cast<float>());
+        newCloud = transformed;
     }
+    *_map += *newCloud;
 
-    // set the target point cloud
-    _ndt->setInputTarget(_map);
+    // update the targets of ndt levels, only voxels covered by the new key frame are recomputed,
+    // thus the cost is linear in the size of the key frame rather than in that of the growing map
+    for (const auto &ndt : _ndtPyramid) {
+        ndt->appendInputTarget(_map, newCloud);
+    }
 }
 
-void LiDAROdometer::DownSampleCloud(const IKalibrPointCloud::Ptr &inCloud,
+void LiDAROdometer::DownSampleCloud(const IKalibrPointCloud::ConstPtr &inCloud,
                                     const IKalibrPointCloud::Ptr &outCloud,
                                     float leafSize) {
     pcl::VoxelGrid<IKalibrPoint> filter;
@@ -178,4 +218,23 @@ const pclomp::NormalDistributionsTransform<IKalibrPoint, IKalibrPoint>::Ptr &LiD
 }
 
 double LiDAROdometer::GetMapTime() const { return _mapTime; }
-}  // namespace ns_ikalibr
\ No newline at end of file
+
+std::optional<Eigen::Matrix4d> LiDAROdometer::GetRelativePose(double lastTime,
+                                                              double curTime) const {
+    // poses are sorted by their timestamps, as frames are fed in order
+    auto poseAt = [this](double time) -> const ns_ctraj::Posed * {
+        auto iter = std::lower_bound(
+            _poseSeq.cbegin(), _poseSeq.cend(), time,
+            [](const ns_ctraj::Posed &pose, double t) { return pose.timeStamp < t; });
+        if (iter == _poseSeq.cend() || iter->timeStamp != time) {
+            return nullptr;
+        }
+        return &*iter;
+    };
+    const auto *lastLtoM = poseAt(lastTime), *curLtoM = poseAt(curTime);
+    if (lastLtoM == nullptr || curLtoM == nullptr) {
+        return std::nullopt;
+    }
+    return (lastLtoM->se3().inverse() * curLtoM->se3()).matrix();
+}
+}  // namespace ns_ikalibr
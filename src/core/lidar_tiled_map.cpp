@@ -0,0 +1,227 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/lidar_tiled_map.h"
+#include "pcl/filters/voxel_grid.h"
+#include "pcl/io/pcd_io.h"
+#include "spdlog/spdlog.h"
+#include "algorithm"
+#include "atomic"
+#include "chrono"
+#include "cmath"
+#include "filesystem"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+LiDARTiledMap::LiDARTiledMap(double tileSize,
+                             float leafSize,
+                             std::size_t tilePointMax,
+                             std::size_t inMemoryPointMax)
+    : _tileSize(tileSize),
+      _leafSize(leafSize),
+      _tilePointMax(tilePointMax),
+      _inMemoryPointMax(inMemoryPointMax),
+      _inMemoryPoints(0) {
+    static std::atomic<std::uint64_t> MapCount = 0;
+    _spillDir = (std::filesystem::temp_directory_path() /
+                 fmt::format("ikalibr-tiles-{}-{}",
+                             std::chrono::steady_clock::now().time_since_epoch().count(),
+                             MapCount++))
+                    .string();
+}
+
+LiDARTiledMap::Ptr LiDARTiledMap::Create(double tileSize,
+                                         float leafSize,
+                                         std::size_t tilePointMax,
+                                         std::size_t inMemoryPointMax) {
+    return std::make_shared<LiDARTiledMap>(tileSize, leafSize, tilePointMax, inMemoryPointMax);
+}
+
+LiDARTiledMap::~LiDARTiledMap() {
+    std::error_code ec;
+    std::filesystem::remove_all(_spillDir, ec);
+}
+
+void LiDARTiledMap::Insert(const IKalibrPointCloud::ConstPtr &cloudInW) {
+    if (cloudInW == nullptr) {
+        return;
+    }
+    for (const auto &p : cloudInW->points) {
+        if (IS_POS_NAN(p)) {
+            continue;
+        }
+        const auto key = KeyOf(p);
+        auto &tile = _tiles[key];
+        if (tile.cloud == nullptr) {
+            tile.cloud = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
+        }
+        tile.cloud->push_back(p), ++_inMemoryPoints;
+
+        // this tile is filled, spill it
+        if (tile.cloud->size() >= _tilePointMax) {
+            Spill(key, tile);
+        }
+    }
+
+    if (_inMemoryPoints <= _inMemoryPointMax) {
+        return;
+    }
+    // too many points are kept in memory, spill the fullest tiles
+    std::vector<std::pair<std::size_t, TileKey>> tileSizes;
+    tileSizes.reserve(_tiles.size());
+    for (const auto &[key, tile] : _tiles) {
+        if (tile.cloud != nullptr && !tile.cloud->empty()) {
+            tileSizes.emplace_back(tile.cloud->size(), key);
+        }
+    }
+    std::sort(tileSizes.begin(), tileSizes.end(), std::greater<>());
+    for (const auto &[size, key] : tileSizes) {
+        if (_inMemoryPoints <= _inMemoryPointMax / 2) {
+            break;
+        }
+        Spill(key, _tiles.at(key));
+    }
+}
+
+std::vector<LiDARTiledMap::TileKey> LiDARTiledMap::GetTileKeys() const {
+    std::vector<TileKey> keys;
+    keys.reserve(_tiles.size());
+    for (const auto &[key, tile] : _tiles) {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+IKalibrPointCloud::Ptr LiDARTiledMap::LoadTile(const TileKey &key, bool downSample) const {
+    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
+    auto iter = _tiles.find(key);
+    if (iter == _tiles.cend()) {
+        return cloud;
+    }
+    const auto &tile = iter->second;
+    for (int i = 0; i < tile.chunks; ++i) {
+        const auto filename = ChunkFilename(key, i);
+        IKalibrPointCloud chunk;
+        if (pcl::io::loadPCDFile<IKalibrPoint>(filename, chunk) == -1) {
+            throw Status(Status::CRITICAL, "failed to load the spilled map chunk '{}'!", filename);
+        }
+        *cloud += chunk;
+    }
+    if (tile.cloud != nullptr) {
+        *cloud += *tile.cloud;
+    }
+    return downSample ? DownSample(cloud) : cloud;
+}
+
+void LiDARTiledMap::ForEachTile(
+    const std::function<void(const TileKey &, const IKalibrPointCloud::Ptr &)> &func,
+    bool downSample) const {
+    for (const auto &[key, tile] : _tiles) {
+        func(key, LoadTile(key, downSample));
+    }
+}
+
+IKalibrPointCloud::Ptr LiDARTiledMap::ToCloud() const {
+    IKalibrPointCloud::Ptr map(new IKalibrPointCloud);
+    ForEachTile([&map](const TileKey &, const IKalibrPointCloud::Ptr &cloud) { *map += *cloud; },
+                true);
+    return map;
+}
+
+std::size_t LiDARTiledMap::SaveTiles(const std::string &dir) const {
+    std::size_t count = 0;
+    ForEachTile(
+        [&dir, &count](const TileKey &key, const IKalibrPointCloud::Ptr &cloud) {
+            if (cloud->empty()) {
+                return;
+            }
+            const auto filename = dir + "/" + TileName(key) + ".pcd";
+            if (pcl::io::savePCDFile(filename, *cloud, true) == -1) {
+                spdlog::warn("save lidar map tile as : '{}' failed!", filename);
+            } else {
+                ++count;
+            }
+        },
+        true);
+    return count;
+}
+
+std::string LiDARTiledMap::TileName(const TileKey &key) {
+    return fmt::format("tile_{}_{}_{}", key[0], key[1], key[2]);
+}
+
+LiDARTiledMap::TileKey LiDARTiledMap::KeyOf(const IKalibrPoint &p) const {
+    return {static_cast<int>(std::floor(p.x / _tileSize)),
+            static_cast<int>(std::floor(p.y / _tileSize)),
+            static_cast<int>(std::floor(p.z / _tileSize))};
+}
+
+IKalibrPointCloud::Ptr LiDARTiledMap::DownSample(const IKalibrPointCloud::Ptr &cloud) const {
+    if (_leafSize <= 0.0f || cloud->empty()) {
+        return cloud;
+    }
+    pcl::VoxelGrid<IKalibrPoint> filter;
+    filter.setInputCloud(cloud);
+    filter.setLeafSize(_leafSize, _leafSize, _leafSize);
+
+    IKalibrPointCloud::Ptr cloudDownSampled(new IKalibrPointCloud);
+    filter.filter(*cloudDownSampled);
+    return cloudDownSampled;
+}
+
+std::string LiDARTiledMap::ChunkFilename(const TileKey &key, int chunk) const {
+    return fmt::format("{}/{}_{}.pcd", _spillDir, TileName(key), chunk);
+}
+
+void LiDARTiledMap::Spill(const TileKey &key, Tile &tile) {
+    if (tile.cloud == nullptr || tile.cloud->empty()) {
+        return;
+    }
+    if (!std::filesystem::exists(_spillDir) && !std::filesystem::create_directories(_spillDir)) {
+        throw Status(Status::CRITICAL, "failed to create the directory '{}' to spill map tiles!",
+                     _spillDir);
+    }
+    const auto filename = ChunkFilename(key, tile.chunks);
+    if (pcl::io::savePCDFileBinary(filename, *tile.cloud) == -1) {
+        throw Status(Status::CRITICAL, "failed to spill the map chunk to '{}'!", filename);
+    }
+    ++tile.chunks;
+    _inMemoryPoints -= tile.cloud->size();
+    tile.cloud = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
+}
+}  // namespace ns_ikalibr
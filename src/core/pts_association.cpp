@@ -33,7 +33,11 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "core/pts_association.h"
+#include "core/lidar_tiled_map.h"
 #include "factor/data_correspondence.h"
+#include "util/utils_tpl.hpp"
+#include "unordered_map"
+#include "cmath"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -92,12 +96,34 @@ PointToSurfelAssociator::PointToSurfelAssociator(const IKalibrPointCloud::Ptr &m
     InsertCloudToSurfelMap<IKalibrPoint>(_smp, *mapInW);
 }
 
+PointToSurfelAssociator::PointToSurfelAssociator(const LiDARTiledMapPtr &tiledMapInW,
+                                                 double resolution,
+                                                 std::uint8_t depth) {
+    _smp = ufo::map::SurfelMap(resolution, depth);
+    tiledMapInW->ForEachTile([this](const auto &, const IKalibrPointCloud::Ptr &tile) {
+        InsertCloudToSurfelMap<IKalibrPoint>(_smp, *tile);
+    });
+}
+
 PointToSurfelAssociator::Ptr PointToSurfelAssociator::Create(const IKalibrPointCloud::Ptr &mapInW,
                                                              double resolution,
                                                              std::uint8_t depth) {
     return std::make_shared<PointToSurfelAssociator>(mapInW, resolution, depth);
 }
 
+PointToSurfelAssociator::Ptr PointToSurfelAssociator::Create(const LiDARTiledMapPtr &tiledMapInW,
+                                                             double resolution,
+                                                             std::uint8_t depth) {
+    return std::make_shared<PointToSurfelAssociator>(tiledMapInW, resolution, depth);
+}
+
+ufo::map::Code PointToSurfelAssociator::VoxelCode(float x,
+                                                  float y,
+                                                  float z,
+                                                  std::uint8_t depth) const {
+    return _smp.toCode(ufo::map::Point3(x, y, z), depth);
+}
+
 double PointToSurfelAssociator::SurfelScore(const ufo::map::SurfelMap &m, const ufo::map::Node &n) {
     const auto &s = m.getSurfel(n);
     double score = s.getPlanarity();
@@ -117,10 +143,144 @@ Eigen::Vector4d PointToSurfelAssociator::SurfelCoeffs(const ufo::map::SurfelMap:
 
 const ufo::map::SurfelMap &PointToSurfelAssociator::GetSurfelMap() const { return _smp; }
 
+void PointToSurfelAssociator::InsertCloud(const IKalibrPointCloud::ConstPtr &cloudInW) {
+    if (cloudInW == nullptr) {
+        return;
+    }
+    ufo::map::PointCloud ufoCloud;
+    ufoCloud.reserve(cloudInW->size());
+    for (const auto &p : cloudInW->points) {
+        if (!IS_POS_NAN(p)) {
+            ufoCloud.push_back(ufo::map::Point3(p.x, p.y, p.z));
+        }
+    }
+    _smp.insertSurfelPoint(std::begin(ufoCloud), std::end(ufoCloud));
+}
+
+void PointToSurfelAssociator::EraseCloud(const IKalibrPointCloud::ConstPtr &cloudInW) {
+    if (cloudInW == nullptr) {
+        return;
+    }
+    ufo::map::PointCloud ufoCloud;
+    ufoCloud.reserve(cloudInW->size());
+    for (const auto &p : cloudInW->points) {
+        if (!IS_POS_NAN(p)) {
+            ufoCloud.push_back(ufo::map::Point3(p.x, p.y, p.z));
+        }
+    }
+    _smp.eraseSurfelPoint(std::begin(ufoCloud), std::end(ufoCloud));
+}
+
+void PointToSurfelAssociator::InsertPointsToSurfelMap(ufo::map::SurfelMap &map,
+                                                      const ufo::map::PointCloud &ufoCloud) {
+    if (!IsOptionWith(SpeedUpOption::ParallelSurfelMapBuild, Configor::Preference::SpeedUps) ||
+        ufoCloud.size() < Configor::Prior::LiDARDataAssociate::ParallelMapBuildPointMin) {
+        map.insertSurfelPoint(std::begin(ufoCloud), std::end(ufoCloud));
+        return;
+    }
+    namespace ufopred = ufo::map::predicate;
+    using Surfel = ufo::map::SurfelMap::Surfel;
+
+    const double resolution = map.getResolution();
+    const auto depthLevels = map.getTreeDepthLevels();
+    const int partDepth = std::min<int>(Configor::Prior::LiDARDataAssociate::MapPartitionDepth,
+                                        depthLevels - 1);
+    // the partition grid is aligned with the octree, so a partition is exactly a sub-tree
+    const double partSize = std::ldexp(resolution, partDepth);
+
+    const int threads = Configor::Preference::AvailableThreads();
+    const int ptsCount = static_cast<int>(ufoCloud.size());
+
+    // packed key of the partition (21 bits per axis)
+    auto PartitionKey = [partSize](const ufo::map::Point3 &p) {
+        constexpr std::int64_t offset = 1 << 20, mask = (1 << 21) - 1;
+        auto i = (static_cast<std::int64_t>(std::floor(p.x / partSize)) + offset) & mask;
+        auto j = (static_cast<std::int64_t>(std::floor(p.y / partSize)) + offset) & mask;
+        auto k = (static_cast<std::int64_t>(std::floor(p.z / partSize)) + offset) & mask;
+        return static_cast<std::uint64_t>(i | (j << 21) | (k << 42));
+    };
+
+    // ----------------------------------------------------------
+    // partition points by octree key, each thread owns its chunk
+    // ----------------------------------------------------------
+    using PartitionBuckets = std::unordered_map<std::uint64_t, ufo::map::PointCloud>;
+    std::vector<PartitionBuckets> bucketsOfThread(threads);
+#pragma omp parallel for num_threads(threads) schedule(static) default(none) \
+    shared(threads, ptsCount, ufoCloud, bucketsOfThread, PartitionKey)
+    for (int t = 0; t < threads; ++t) {
+        const int beg = static_cast<int>(static_cast<std::int64_t>(ptsCount) * t / threads);
+        const int end = static_cast<int>(static_cast<std::int64_t>(ptsCount) * (t + 1) / threads);
+        auto &buckets = bucketsOfThread.at(t);
+        for (int i = beg; i < end; ++i) {
+            const auto &p = ufoCloud[i];
+            buckets[PartitionKey(p)].push_back(p);
+        }
+    }
+
+    std::vector<std::uint64_t> partitions;
+    {
+        std::unordered_map<std::uint64_t, int> partitionIdx;
+        for (const auto &buckets : bucketsOfThread) {
+            for (const auto &[key, pts] : buckets) {
+                if (partitionIdx.insert({key, static_cast<int>(partitions.size())}).second) {
+                    partitions.push_back(key);
+                }
+            }
+        }
+    }
+    const int partCount = static_cast<int>(partitions.size());
+
+    // ------------------------------------------------------------------------
+    // build sub-trees independently and collect their leaf surfels for merging
+    // ------------------------------------------------------------------------
+    std::vector<std::vector<std::pair<ufo::map::Code, Surfel>>> leavesOfPart(partCount);
+    std::vector<std::exception_ptr> exceptions(partCount, nullptr);
+#pragma omp parallel for num_threads(threads) schedule(dynamic) default(none)              \
+    shared(partCount, partitions, bucketsOfThread, leavesOfPart, exceptions, resolution, \
+               depthLevels)
+    for (int i = 0; i < partCount; ++i) {
+        try {
+            const auto key = partitions.at(i);
+            ufo::map::PointCloud pts;
+            for (const auto &buckets : bucketsOfThread) {
+                if (auto iter = buckets.find(key); iter != buckets.cend()) {
+                    pts.insert(pts.end(), iter->second.cbegin(), iter->second.cend());
+                }
+            }
+            ufo::map::SurfelMap subMap(resolution, depthLevels);
+            subMap.insertSurfelPoint(std::begin(pts), std::end(pts));
+
+            auto &leaves = leavesOfPart.at(i);
+            for (const auto &node : subMap.query(ufopred::HasSurfel() && ufopred::DepthMax(0))) {
+                leaves.emplace_back(node.code(), subMap.getSurfel(node));
+            }
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
+        }
+    }
+    for (const auto &exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+    // release the partitioned points before merging
+    decltype(bucketsOfThread)().swap(bucketsOfThread);
+
+    // -----------------------------------------------------------------------------
+    // merge leaf surfels (far fewer than points), and propagate them to inner nodes
+    // -----------------------------------------------------------------------------
+    for (const auto &leaves : leavesOfPart) {
+        for (const auto &[code, surfel] : leaves) {
+            map.insertSurfel(code, surfel, false);
+        }
+    }
+    map.updateModifiedNodes();
+}
+
 std::vector<PointToSurfelCorr::Ptr> PointToSurfelAssociator::Association(
-    const IKalibrPointCloud::Ptr &mapCloud,
-    const IKalibrPointCloud::Ptr &rawCloud,
-    const PointToSurfelCondition &condition) {
+    const IKalibrPointCloud::ConstPtr &mapCloud,
+    const IKalibrPointCloud::ConstPtr &rawCloud,
+    const PointToSurfelCondition &condition) const {
     if (mapCloud == nullptr || rawCloud == nullptr) {
         return {};
     }
@@ -45,6 +45,8 @@
 #include "opengv/sac/Ransac.hpp"
 #include "opengv/sac_problems/relative_pose/RotationOnlySacProblem.hpp"
 #include "opengv/relative_pose/CentralRelativeAdapter.hpp"
+#include "atomic"
+#include "mutex"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -191,8 +193,13 @@ bool RotOnlyVisualOdometer::GrabFrame(const CameraFrame::Ptr &curFrame,
     _trackFeatLast = trackedFeats;
 
     // spdlog::info("show tracked features on the image...");
-    ShowCurrentFrame();
-    cv::waitKey(1);
+    {
+        // the highgui is not thread-safe, while odometers of cameras may run concurrently
+        static std::mutex showMutex;
+        std::lock_guard<std::mutex> lock(showMutex);
+        ShowCurrentFrame();
+        cv::waitKey(1);
+    }
 #undef VISUALIZATION
     return true;
 }
@@ -353,7 +360,8 @@ const std::vector<std::pair<double, Sophus::SO3d>> &RotOnlyVisualOdometer::GetRo
 RotOnlyVisualOdometer::~RotOnlyVisualOdometer() { cv::destroyAllWindows(); }
 
 ns_veta::IndexT RotOnlyVisualOdometer::GenNewLmId() {
-    static ns_veta::IndexT id = 0;
+    // ids are unique among odometers running concurrently, and increasing for each odometer
+    static std::atomic<ns_veta::IndexT> id{0};
     return ++id;
 }
 
@@ -34,6 +34,7 @@
 
 #include "core/scan_undistortion.h"
 #include "calib/calib_param_manager.h"
+#include "omp.h"
 #include "sensor/lidar.h"
 #include "util/tqdm.h"
 #include "util/utils_tpl.hpp"
@@ -61,21 +62,10 @@ ScanUndistortion::Ptr ScanUndistortion::Create(const SplineBundleType::Ptr &spli
 
 std::vector<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(
     const std::vector<LiDARFrame::Ptr> &data, const std::string &topic, Option option) {
-    std::vector<LiDARFrame::Ptr> lidarUndistFrames;
-
-    auto bar = std::make_shared<tqdm>();
     bool correctPos = IsOptionWith(Option::UNDIST_POS, option);
-    for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-        bar->progress(i, static_cast<int>(data.size()));
-
-        if (auto undistLidarFrame = UndistortToScan(data.at(i), topic, correctPos)) {
-            lidarUndistFrames.push_back(*undistLidarFrame);
-        } else {
-            lidarUndistFrames.push_back(nullptr);
-        }
-    }
-    bar->finish();
-    return lidarUndistFrames;
+    return UndistortFrames(data, [this, &topic, correctPos](const LiDARFrame::Ptr &frame) {
+        return UndistortToScan(frame, topic, correctPos);
+    });
 }
 
 std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFrame::Ptr &lidarFrame,
@@ -93,58 +83,8 @@ std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFram
 
     Sophus::SE3d refToScan = scanToRef.inverse();
 
-    // prepare
-    IKalibrPointCloud::Ptr undistScan(new IKalibrPointCloud);
-    auto rawScan = lidarFrame->GetScan();
-    // assign
-    undistScan->header = rawScan->header;
-    undistScan->height = rawScan->height;
-    undistScan->width = rawScan->width;
-    undistScan->resize(rawScan->height * rawScan->width);
-    undistScan->is_dense = rawScan->is_dense;
-
-    for (int h = 0; h < static_cast<int>(rawScan->height); h++) {
-        for (int w = 0; w < static_cast<int>(rawScan->width); w++) {
-            const auto &rawPoint = rawScan->points[h * rawScan->width + w];
-            IKalibrPoint undistPoint;
-
-            if (IS_POS_NAN(rawPoint)) {
-                SET_POS_NAN(undistPoint)
-            } else {
-                double pTimeByBr = rawPoint.timestamp + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
-
-                if (_so3Spline.TimeStampInRange(pTimeByBr) &&
-                    _posSpline.TimeStampInRange(pTimeByBr)) {
-                    Sophus::SE3d pRefIMUToW(_so3Spline.Evaluate(pTimeByBr),
-                                            _posSpline.Evaluate(pTimeByBr));
-                    auto pointToRef = pRefIMUToW * _parMagr->EXTRI.SE3_LkToBr(topic);
-
-                    Sophus::SE3d pointToScan = refToScan * pointToRef;
-
-                    Eigen::Vector3d rp(rawPoint.x, rawPoint.y, rawPoint.z), up;
-                    if (correctPos) {
-                        up = pointToScan * rp;
-                    } else {
-                        up = pointToScan.so3() * rp;
-                    }
-
-                    undistPoint.x = static_cast<float>(up(0));
-                    undistPoint.y = static_cast<float>(up(1));
-                    undistPoint.z = static_cast<float>(up(2));
-                    undistPoint.timestamp = rawPoint.timestamp;
-                    // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-                    // undistPoint.intensity = rawPoint.intensity;
-                } else {
-                    // we can't undistort it
-                    SET_POS_NAN(undistPoint)
-                }
-            }
-            // undistScan->at(w, h) = undistPoint;
-            undistScan->points[h * rawScan->width + w] = undistPoint;
-        }
-    }
-
-    return LiDARFrame::Create(lidarFrame->GetTimestamp(), undistScan);
+    return LiDARFrame::Create(lidarFrame->GetTimestamp(),
+                              UndistortScan(lidarFrame->GetScan(), topic, correctPos, refToScan));
 }
 
 // --------------
@@ -153,21 +93,10 @@ std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToScan(const LiDARFram
 
 std::vector<LiDARFrame::Ptr> ScanUndistortion::UndistortToRef(
     const std::vector<LiDARFrame::Ptr> &data, const std::string &topic, Option option) {
-    std::vector<LiDARFrame::Ptr> lidarUndistFramesInRef;
-
-    auto bar = std::make_shared<tqdm>();
     bool correctPos = IsOptionWith(Option::UNDIST_POS, option);
-    for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-        bar->progress(i, static_cast<int>(data.size()));
-
-        if (auto undistLidarFrame = UndistortToRef(data.at(i), topic, correctPos)) {
-            lidarUndistFramesInRef.push_back(*undistLidarFrame);
-        } else {
-            lidarUndistFramesInRef.push_back(nullptr);
-        }
-    }
-    bar->finish();
-    return lidarUndistFramesInRef;
+    return UndistortFrames(data, [this, &topic, correctPos](const LiDARFrame::Ptr &frame) {
+        return UndistortToRef(frame, topic, correctPos);
+    });
 }
 
 std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToRef(const LiDARFrame::Ptr &lidarFrame,
@@ -177,55 +106,130 @@ std::optional<LiDARFrame::Ptr> ScanUndistortion::UndistortToRef(const LiDARFrame
     if (!_so3Spline.TimeStampInRange(scanTimeByBr) || !_posSpline.TimeStampInRange(scanTimeByBr)) {
         return {};
     }
-    // prepare
+    return LiDARFrame::Create(
+        lidarFrame->GetTimestamp(),
+        UndistortScan(lidarFrame->GetScan(), topic, correctPos, Sophus::SE3d()));
+}
+
+// ------
+// common
+// ------
+
+std::vector<LiDARFrame::Ptr> ScanUndistortion::UndistortFrames(
+    const std::vector<LiDARFrame::Ptr> &data,
+    const std::function<std::optional<LiDARFrame::Ptr>(const LiDARFrame::Ptr &)> &undistorter) {
+    const int frameCount = static_cast<int>(data.size());
+    std::vector<LiDARFrame::Ptr> lidarUndistFrames(frameCount, nullptr);
+    std::vector<std::exception_ptr> exceptions(frameCount, nullptr);
+
+    // frames are independent, the splines and parameters are only read here. If called in a
+    // parallel region (e.g., undistortion of multiple lidars), threads are shared by the teams
+    const int threads = Configor::Preference::AvailableThreadsInRegion();
+    int finished = 0;
+    auto bar = std::make_shared<tqdm>();
+#pragma omp parallel for num_threads(threads) schedule(dynamic) default(none) \
+    shared(frameCount, data, undistorter, lidarUndistFrames, exceptions, finished, bar)
+    for (int i = 0; i < frameCount; ++i) {
+        try {
+            if (auto undistLidarFrame = undistorter(data.at(i))) {
+                lidarUndistFrames.at(i) = *undistLidarFrame;
+            }
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
+        }
+#pragma omp critical
+        { bar->progress(finished++, frameCount); }
+    }
+    bar->finish();
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return lidarUndistFrames;
+}
+
+IKalibrPointCloud::Ptr ScanUndistortion::UndistortScan(const IKalibrPointCloud::ConstPtr &rawScan,
+                                                       const std::string &topic,
+                                                       bool correctPos,
+                                                       const Sophus::SE3d &SE3_WToTar) const {
+    const double TO_LkToBr = _parMagr->TEMPORAL.TO_LkToBr.at(topic);
+    const Sophus::SE3d SE3_LkToBr = _parMagr->EXTRI.SE3_LkToBr(topic);
+
+    // prepare, points that can't be undistorted are nan points
     IKalibrPointCloud::Ptr undistScan(new IKalibrPointCloud);
-    auto rawScan = lidarFrame->GetScan();
-    // assign
     undistScan->header = rawScan->header;
     undistScan->height = rawScan->height;
     undistScan->width = rawScan->width;
     undistScan->resize(rawScan->height * rawScan->width);
     undistScan->is_dense = rawScan->is_dense;
+    for (auto &p : undistScan->points) {
+        SET_POS_NAN(p)
+    }
 
-    for (int h = 0; h < static_cast<int>(rawScan->height); h++) {
-        for (int w = 0; w < static_cast<int>(rawScan->width); w++) {
-            const auto &rawPoint = rawScan->points[h * rawScan->width + w];
-            IKalibrPoint undistPoint;
-
-            if (IS_POS_NAN(rawPoint)) {
-                SET_POS_NAN(undistPoint)
-            } else {
-                double pTimeByBr = rawPoint.timestamp + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
-
-                if (_so3Spline.TimeStampInRange(pTimeByBr) &&
-                    _posSpline.TimeStampInRange(pTimeByBr)) {
-                    Sophus::SE3d pBrToW(_so3Spline.Evaluate(pTimeByBr),
-                                        _posSpline.Evaluate(pTimeByBr));
-                    auto pointToW = pBrToW * _parMagr->EXTRI.SE3_LkToBr(topic);
-
-                    Eigen::Vector3d rp(rawPoint.x, rawPoint.y, rawPoint.z), up;
-                    if (correctPos) {
-                        up = pointToW * rp;
-                    } else {
-                        up = pointToW.so3() * rp;
-                    }
-
-                    undistPoint.x = static_cast<float>(up(0));
-                    undistPoint.y = static_cast<float>(up(1));
-                    undistPoint.z = static_cast<float>(up(2));
-                    undistPoint.timestamp = rawPoint.timestamp;
-                    // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-                    // undistPoint.intensity = rawPoint.intensity;
-                } else {
-                    // we can't undistort it (no condition)
-                    SET_POS_NAN(undistPoint)
-                }
-            }
-            // undistScan->at(w, h) = undistPoint;
-            undistScan->points[h * rawScan->width + w] = undistPoint;
+    /**
+     * points of a multi-beam lidar are fired in columns, i.e., many points share the same
+     * timestamp. Thus we sort valid points by their timestamps and evaluate splines only once for
+     * each distinct timestamp, then transform the contiguous points with the same pose together
+     */
+    std::vector<int> order;
+    order.reserve(rawScan->size());
+    for (int i = 0; i < static_cast<int>(rawScan->size()); ++i) {
+        if (!IS_POS_NAN(rawScan->points[i])) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&rawScan](int i, int j) {
+        return rawScan->points[i].timestamp < rawScan->points[j].timestamp;
+    });
+
+    const int count = static_cast<int>(order.size());
+    Eigen::Matrix3Xd pts(3, count);
+    for (int i = 0; i < count; ++i) {
+        const auto &rp = rawScan->points[order[i]];
+        pts.col(i) = Eigen::Vector3d(rp.x, rp.y, rp.z);
+    }
+
+    std::vector<bool> valid(count, false);
+    for (int beg = 0, end = 0; beg < count; beg = end) {
+        // find the points sharing the same timestamp
+        const auto timestamp = rawScan->points[order[beg]].timestamp;
+        while (end < count && rawScan->points[order[end]].timestamp == timestamp) {
+            ++end;
+        }
+
+        double pTimeByBr = timestamp + TO_LkToBr;
+        if (!_so3Spline.TimeStampInRange(pTimeByBr) || !_posSpline.TimeStampInRange(pTimeByBr)) {
+            // we can't undistort them
+            continue;
+        }
+        Sophus::SE3d pRefIMUToW(_so3Spline.Evaluate(pTimeByBr), _posSpline.Evaluate(pTimeByBr));
+        Sophus::SE3d pointToTar = SE3_WToTar * pRefIMUToW * SE3_LkToBr;
+
+        auto block = pts.middleCols(beg, end - beg);
+        if (correctPos) {
+            block = (pointToTar.so3().matrix() * block).colwise() + pointToTar.translation();
+        } else {
+            block = pointToTar.so3().matrix() * block;
+        }
+        std::fill(valid.begin() + beg, valid.begin() + end, true);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (!valid[i]) {
+            continue;
         }
+        const auto &rawPoint = rawScan->points[order[i]];
+        auto &undistPoint = undistScan->points[order[i]];
+        undistPoint.x = static_cast<float>(pts(0, i));
+        undistPoint.y = static_cast<float>(pts(1, i));
+        undistPoint.z = static_cast<float>(pts(2, i));
+        undistPoint.timestamp = rawPoint.timestamp;
+        // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
+        // undistPoint.intensity = rawPoint.intensity;
     }
 
-    return LiDARFrame::Create(lidarFrame->GetTimestamp(), undistScan);
+    return undistScan;
 }
-}  // namespace ns_ikalibr
\ No newline at end of file
+}  // namespace ns_ikalibr
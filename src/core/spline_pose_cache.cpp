@@ -0,0 +1,154 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "core/spline_pose_cache.h"
+#include "numeric"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+std::atomic<std::uint64_t> SplinePoseCache::SplineEpoch = {0};
+
+SplinePoseCache::SplinePoseCache(const SplineBundleType::Ptr &splines, std::size_t capacity)
+    : _so3Spline(splines->GetSo3Spline(Configor::Preference::SO3_SPLINE)),
+      _posSpline(splines->GetRdSpline(Configor::Preference::SCALE_SPLINE)),
+      _capacity(capacity),
+      _epoch(SplineEpoch.load()) {}
+
+SplinePoseCache::Ptr SplinePoseCache::Create(const SplineBundleType::Ptr &splines,
+                                             std::size_t capacity) {
+    return std::make_shared<SplinePoseCache>(splines, capacity);
+}
+
+void SplinePoseCache::SplinesChanged() { ++SplineEpoch; }
+
+std::optional<Sophus::SE3d> SplinePoseCache::BrToW(double timeByBr) {
+    const auto epoch = SplineEpoch.load();
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        if (_epoch == epoch) {
+            if (auto iter = _cache.find(timeByBr); iter != _cache.cend()) {
+                return iter->second;
+            }
+        }
+    }
+    // evaluate without locking, so that queries from multiple threads are not serialized
+    auto pose = Evaluate(timeByBr);
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    SyncEpoch();
+    // splines are not changed during the evaluation
+    if (_epoch == epoch) {
+        if (_cache.size() >= _capacity) {
+            _cache.clear();
+        }
+        _cache.emplace(timeByBr, pose);
+    }
+    return pose;
+}
+
+std::vector<std::optional<Sophus::SE3d>> SplinePoseCache::BrToW(
+    const std::vector<double> &timesByBr) {
+    // sort and deduplicate times
+    std::vector<std::size_t> order(timesByBr.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&timesByBr](std::size_t i, std::size_t j) { return timesByBr[i] < timesByBr[j]; });
+    std::vector<std::pair<std::size_t, std::size_t>> groups;
+    for (std::size_t beg = 0, end = 0; beg < order.size(); beg = end) {
+        while (end < order.size() && timesByBr[order[end]] == timesByBr[order[beg]]) {
+            ++end;
+        }
+        groups.emplace_back(beg, end);
+    }
+
+    const auto epoch = SplineEpoch.load();
+    std::vector<std::optional<Sophus::SE3d>> uniquePoses(groups.size());
+    std::vector<bool> cached(groups.size(), false);
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        for (std::size_t i = 0; _epoch == epoch && i < groups.size(); ++i) {
+            if (auto iter = _cache.find(timesByBr[order[groups[i].first]]);
+                iter != _cache.cend()) {
+                uniquePoses[i] = iter->second, cached[i] = true;
+            }
+        }
+    }
+    // sorted times query neighboring knots of splines in order, which is cache-friendly
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (!cached[i]) {
+            uniquePoses[i] = Evaluate(timesByBr[order[groups[i].first]]);
+        }
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        SyncEpoch();
+        for (std::size_t i = 0; _epoch == epoch && i < groups.size(); ++i) {
+            if (cached[i]) {
+                continue;
+            }
+            if (_cache.size() >= _capacity) {
+                _cache.clear();
+            }
+            _cache.emplace(timesByBr[order[groups[i].first]], uniquePoses[i]);
+        }
+    }
+
+    // assign to all duplicated times
+    std::vector<std::optional<Sophus::SE3d>> poses(timesByBr.size());
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        for (std::size_t j = groups[i].first; j < groups[i].second; ++j) {
+            poses[order[j]] = uniquePoses[i];
+        }
+    }
+    return poses;
+}
+
+std::optional<Sophus::SE3d> SplinePoseCache::Evaluate(double timeByBr) const {
+    if (!_so3Spline.TimeStampInRange(timeByBr) || !_posSpline.TimeStampInRange(timeByBr)) {
+        return {};
+    }
+    return Sophus::SE3d(_so3Spline.Evaluate(timeByBr), _posSpline.Evaluate(timeByBr));
+}
+
+void SplinePoseCache::SyncEpoch() {
+    if (const auto epoch = SplineEpoch.load(); _epoch != epoch) {
+        _cache.clear();
+        _epoch = epoch;
+    }
+}
+}  // namespace ns_ikalibr
@@ -62,7 +62,12 @@ template struct IMUAcceFactor<Configor::Prior::SplineOrder, 2>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 1>;
 template struct IMUAcceFactor<Configor::Prior::SplineOrder, 0>;
 
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 2>;
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 1>;
+template struct IMUAcceAnalyticFactor<Configor::Prior::SplineOrder, 0>;
+
 template struct IMUGyroFactor<Configor ::Prior::SplineOrder>;
+template struct IMUGyroAnalyticFactor<Configor::Prior::SplineOrder>;
 
 template struct LiDARInertialAlignHelper<Configor::Prior::SplineOrder>;
 template struct LiDARInertialAlignFactor<Configor::Prior::SplineOrder>;
@@ -38,6 +38,7 @@
 #include "cv_bridge/cv_bridge.h"
 #include "util/status.hpp"
 #include "spdlog/fmt/fmt.h"
+#include "atomic"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -81,51 +82,45 @@ CameraModelType CameraDataLoader::GetCameraModel() const { return _model; }
 void CameraDataLoader::RefineImgMsgWrongEncoding(const sensor_msgs::Image::Ptr &msg) {
     if (msg->encoding == sensor_msgs::image_encodings::TYPE_8UC1) {
         msg->encoding = sensor_msgs::image_encodings::MONO8;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_8UC1, msg->encoding);
-            warn = true;
         }
     } else if (msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
         msg->encoding = sensor_msgs::image_encodings::MONO16;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_16UC1, msg->encoding);
-            warn = true;
         }
     } else if (msg->encoding == sensor_msgs::image_encodings::TYPE_8UC3) {
         msg->encoding = sensor_msgs::image_encodings::BGR8;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_8UC3, msg->encoding);
-            warn = true;
         }
     } else if (msg->encoding == sensor_msgs::image_encodings::TYPE_8UC4) {
         msg->encoding = sensor_msgs::image_encodings::BGRA8;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_8UC4, msg->encoding);
-            warn = true;
         }
     } else if (msg->encoding == sensor_msgs::image_encodings::TYPE_16UC3) {
         msg->encoding = sensor_msgs::image_encodings::BGR16;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_16UC3, msg->encoding);
-            warn = true;
         }
     } else if (msg->encoding == sensor_msgs::image_encodings::TYPE_16UC4) {
         msg->encoding = sensor_msgs::image_encodings::BGRA16;
-        static bool warn = false;
-        if (!warn) {
+        static std::atomic<bool> warn(false);
+        if (!warn.exchange(true)) {
             spdlog::warn("encoding type of images is wrong: '{}', change encoding type to '{}'",
                          sensor_msgs::image_encodings::TYPE_16UC4, msg->encoding);
-            warn = true;
         }
     }
 }
@@ -34,6 +34,7 @@
 
 #include "sensor/event.h"
 #include "veta/camera/pinhole.h"
+#include "util/status.hpp"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -57,36 +58,94 @@ Event::PosType Event::GetPos() const { return _pos; }
 
 bool Event::GetPolarity() const { return _polarity; }
 
-EventArray::EventArray(double timestamp, const std::vector<Event::Ptr>& events)
+EventArray::EventArray(double timestamp,
+                       std::vector<double> evTimestamps,
+                       std::vector<PosScalar> evXs,
+                       std::vector<PosScalar> evYs,
+                       std::vector<std::uint8_t> evPolarities)
     : _timestamp(timestamp),
-      _events(events) {}
+      _evTimestamps(std::move(evTimestamps)),
+      _evXs(std::move(evXs)),
+      _evYs(std::move(evYs)),
+      _evPolarities(std::move(evPolarities)) {
+    if (_evXs.size() != _evTimestamps.size() || _evYs.size() != _evTimestamps.size() ||
+        _evPolarities.size() != _evTimestamps.size()) {
+        throw Status(Status::ERROR,
+                     "the sizes of event fields are inconsistent: t: {}, x: {}, y: {}, p: {}",
+                     _evTimestamps.size(), _evXs.size(), _evYs.size(), _evPolarities.size());
+    }
+}
+
+EventArray::Ptr EventArray::Create(double timestamp,
+                                   std::vector<double> evTimestamps,
+                                   std::vector<PosScalar> evXs,
+                                   std::vector<PosScalar> evYs,
+                                   std::vector<std::uint8_t> evPolarities) {
+    return std::make_shared<EventArray>(timestamp, std::move(evTimestamps), std::move(evXs),
+                                        std::move(evYs), std::move(evPolarities));
+}
 
 EventArray::Ptr EventArray::Create(double timestamp, const std::vector<Event::Ptr>& events) {
-    return std::make_shared<EventArray>(timestamp, events);
+    std::vector<double> evTimestamps(events.size());
+    std::vector<PosScalar> evXs(events.size()), evYs(events.size());
+    std::vector<std::uint8_t> evPolarities(events.size());
+    for (std::size_t i = 0; i != events.size(); ++i) {
+        const auto& event = events.at(i);
+        evTimestamps[i] = event->GetTimestamp();
+        evXs[i] = event->GetPos()(0), evYs[i] = event->GetPos()(1);
+        evPolarities[i] = event->GetPolarity();
+    }
+    return Create(timestamp, std::move(evTimestamps), std::move(evXs), std::move(evYs),
+                  std::move(evPolarities));
 }
 
 double EventArray::GetTimestamp() const { return _timestamp; }
 
-std::vector<Event::Ptr> EventArray::GetEvents() const { return _events; }
-
 void EventArray::SetTimestamp(double timestamp) { _timestamp = timestamp; }
 
+std::size_t EventArray::GetEventNum() const { return _evTimestamps.size(); }
+
+bool EventArray::IsEmpty() const { return _evTimestamps.empty(); }
+
+double EventArray::GetEventTimestamp(std::size_t idx) const { return _evTimestamps[idx]; }
+
+Event::PosType EventArray::GetEventPos(std::size_t idx) const {
+    return {_evXs[idx], _evYs[idx]};
+}
+
+bool EventArray::GetEventPolarity(std::size_t idx) const { return _evPolarities[idx]; }
+
+Event::Ptr EventArray::GetEvent(std::size_t idx) const {
+    return Event::Create(GetEventTimestamp(idx), GetEventPos(idx), GetEventPolarity(idx));
+}
+
+const std::vector<double>& EventArray::GetEventTimestamps() const { return _evTimestamps; }
+
+const std::vector<EventArray::PosScalar>& EventArray::GetEventXs() const { return _evXs; }
+
+const std::vector<EventArray::PosScalar>& EventArray::GetEventYs() const { return _evYs; }
+
+const std::vector<std::uint8_t>& EventArray::GetEventPolarities() const { return _evPolarities; }
+
+void EventArray::ShiftEventTimestamps(double dt) {
+    for (double& t : _evTimestamps) {
+        t += dt;
+    }
+}
+
+void EventArray::DrawRawEventFrame(cv::Mat& eventFrame) const {
+    // red for positive events, blue for negative ones
+    static const cv::Vec3b colors[2] = {cv::Vec3b(255, 0, 0), cv::Vec3b(0, 0, 255)};
+    for (std::size_t i = 0; i != _evTimestamps.size(); ++i) {
+        eventFrame.at<cv::Vec3b>(_evYs[i], _evXs[i]) = colors[_evPolarities[i] ? 1 : 0];
+    }
+}
+
 cv::Mat EventArray::DrawRawEventFrame(const ns_veta::PinholeIntrinsic::Ptr& intri) const {
     cv::Mat eventFrame =
         cv::Mat(static_cast<int>(intri->imgHeight), static_cast<int>(intri->imgWidth), CV_8UC3,
                 cv::Scalar(255, 255, 255));
-
-    for (const auto& event : _events) {
-        cv::Vec3b color;
-        if (event->GetPolarity()) {
-            // red
-            color = cv::Vec3b(0, 0, 255);
-        } else {
-            // blue
-            color = cv::Vec3b(255, 0, 0);
-        }
-        eventFrame.at<cv::Vec3b>(event->GetPos()(1), event->GetPos()(0)) = color;
-    }
+    DrawRawEventFrame(eventFrame);
     return eventFrame;
 }
 
@@ -98,17 +157,7 @@ cv::Mat EventArray::DrawRawEventFrame(const std::vector<Ptr>::const_iterator& sI
                 cv::Scalar(255, 255, 255));
 
     for (auto iter = sIter; iter != eIter; ++iter) {
-        for (const auto& event : (*iter)->GetEvents()) {
-            cv::Vec3b color;
-            if (event->GetPolarity()) {
-                // red
-                color = cv::Vec3b(0, 0, 255);
-            } else {
-                // blue
-                color = cv::Vec3b(255, 0, 0);
-            }
-            eventFrame.at<cv::Vec3b>(event->GetPos()(1), event->GetPos()(0)) = color;
-        }
+        (*iter)->DrawRawEventFrame(eventFrame);
     }
 
     return eventFrame;
@@ -80,19 +80,7 @@ EventArray::Ptr PropheseeEventDataLoader::UnpackData(const rosbag::MessageInstan
 
     CheckMessage<ikalibr::PropheseeEventArray>(msg);
 
-    std::vector<Event::Ptr> events(msg->events.size());
-
-    for (int i = 0; i < static_cast<int>(msg->events.size()); i++) {
-        const auto& event = msg->events.at(i);
-        events.at(i) =
-            Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y), event.polarity);
-    }
-
-    if (msg->header.stamp.isZero()) {
-        return EventArray::Create(events.back()->GetTimestamp(), events);
-    } else {
-        return EventArray::Create(msg->header.stamp.toSec(), events);
-    }
+    return UnpackEventArray<ikalibr::PropheseeEventArray>(msg);
 }
 
 DVSEventDataLoader::DVSEventDataLoader(EventModelType model)
@@ -107,17 +95,6 @@ EventArray::Ptr DVSEventDataLoader::UnpackData(const rosbag::MessageInstance& ms
 
     CheckMessage<ikalibr::DVSEventArray>(msg);
 
-    std::vector<Event::Ptr> events(msg->events.size());
-
-    for (int i = 0; i < static_cast<int>(msg->events.size()); i++) {
-        const auto& event = msg->events.at(i);
-        events.at(i) =
-            Event::Create(event.ts.toSec(), Event::PosType(event.x, event.y), event.polarity);
-    }
-    if (msg->header.stamp.isZero()) {
-        return EventArray::Create(events.back()->GetTimestamp(), events);
-    } else {
-        return EventArray::Create(msg->header.stamp.toSec(), events);
-    }
+    return UnpackEventArray<ikalibr::DVSEventArray>(msg);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
@@ -37,6 +37,7 @@
 //
 
 #include "sensor/lidar.h"
+#include "util/status.hpp"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -44,23 +45,154 @@ bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
 
 namespace ns_ikalibr {
 
+// ----------------
+// LiDARCompactScan
+// ----------------
+
+LiDARCompactScan::LiDARCompactScan(const IKalibrPointCloud &scan,
+                                   double timebase,
+                                   float resolution)
+    : _width(scan.width),
+      _height(scan.height),
+      _isDense(scan.is_dense),
+      _resolution(0.0f) {
+    const std::size_t size = scan.size();
+    if (resolution > 0.0f) {
+        // enlarge the resolution if the scan exceeds the 16-bit range
+        float maxAbs = 0.0f;
+        for (const auto &p : scan.points) {
+            if (!IS_POS_NAN(p)) {
+                maxAbs = std::max({maxAbs, std::abs(p.x), std::abs(p.y), std::abs(p.z)});
+            }
+        }
+        constexpr auto QUANT_MAX = static_cast<float>(std::numeric_limits<std::int16_t>::max());
+        _resolution = std::max(resolution, maxAbs / QUANT_MAX);
+        for (int k = 0; k < 3; ++k) {
+            _quantPos.at(k).resize(size);
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto &p = scan.points[i];
+            for (int k = 0; k < 3; ++k) {
+                _quantPos.at(k)[i] = IS_POS_NAN(p) ? QUANT_NAN
+                                                   : static_cast<std::int16_t>(std::lround(
+                                                         p.data[k] / _resolution));
+            }
+        }
+    } else {
+        for (int k = 0; k < 3; ++k) {
+            _pos.at(k).resize(size);
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                _pos.at(k)[i] = scan.points[i].data[k];
+            }
+        }
+    }
+    _timeOffsets.resize(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        _timeOffsets[i] = static_cast<float>(scan.points[i].timestamp - timebase);
+    }
+}
+
+LiDARCompactScan::Ptr LiDARCompactScan::Create(const IKalibrPointCloud &scan,
+                                               double timebase,
+                                               float resolution) {
+    return std::make_shared<LiDARCompactScan>(scan, timebase, resolution);
+}
+
+IKalibrPointCloud::Ptr LiDARCompactScan::ToCloud(double timebase) const {
+    IKalibrPointCloud::Ptr scan(new IKalibrPointCloud);
+    scan->resize(Size());
+    scan->width = _width;
+    scan->height = _height;
+    scan->is_dense = _isDense;
+    for (std::size_t i = 0; i < scan->size(); ++i) {
+        auto &p = scan->points[i];
+        p.getVector3fMap() = GetPosition(i);
+        p.timestamp = timebase + static_cast<double>(_timeOffsets[i]);
+    }
+    return scan;
+}
+
+std::size_t LiDARCompactScan::Size() const { return _timeOffsets.size(); }
+
+Eigen::Vector3f LiDARCompactScan::GetPosition(std::size_t idx) const {
+    if (_resolution > 0.0f) {
+        if (_quantPos[0][idx] == QUANT_NAN) {
+            return Eigen::Vector3f::Constant(NAN);
+        }
+        return Eigen::Vector3f(_quantPos[0][idx], _quantPos[1][idx], _quantPos[2][idx]) *
+               _resolution;
+    } else {
+        return {_pos[0][idx], _pos[1][idx], _pos[2][idx]};
+    }
+}
+
+float LiDARCompactScan::GetTimeOffset(std::size_t idx) const { return _timeOffsets[idx]; }
+
+std::size_t LiDARCompactScan::MemoryBytes() const {
+    std::size_t bytes = _timeOffsets.capacity() * sizeof(float);
+    for (int k = 0; k < 3; ++k) {
+        bytes += _pos[k].capacity() * sizeof(float);
+        bytes += _quantPos[k].capacity() * sizeof(std::int16_t);
+    }
+    return bytes;
+}
+
+// ----------
+// LiDARFrame
+// ----------
+
 LiDARFrame::LiDARFrame(double timestamp, IKalibrPointCloud::Ptr scan)
     : _timestamp(timestamp),
-      _scan(std::move(scan)) {}
+      _scan(std::move(scan)),
+      _compactScan(nullptr) {}
 
 LiDARFrame::Ptr LiDARFrame::Create(double timestamp, const IKalibrPointCloud::Ptr &scan) {
     return std::make_shared<LiDARFrame>(timestamp, scan);
 }
 
-IKalibrPointCloud::Ptr LiDARFrame::GetScan() const { return this->_scan; }
+IKalibrPointCloud::ConstPtr LiDARFrame::GetScan() const {
+    if (_compactScan != nullptr) {
+        return _compactScan->ToCloud(_timestamp);
+    }
+    return this->_scan;
+}
+
+const IKalibrPointCloud::Ptr &LiDARFrame::GetMutableScan() {
+    if (_compactScan != nullptr) {
+        throw Status(Status::CRITICAL, "the scan of a compacted lidar frame can't be modified!");
+    }
+    return this->_scan;
+}
 
 double LiDARFrame::GetTimestamp() const { return _timestamp; }
 
 std::ostream &operator<<(std::ostream &os, const LiDARFrame &frame) {
-    os << "size: " << frame._scan->size() << ", width: " << frame._scan->width
-       << ", height: " << frame._scan->height << ", timestamp: " << frame._timestamp;
+    const auto scan = frame.GetScan();
+    os << "size: " << scan->size() << ", width: " << scan->width << ", height: " << scan->height
+       << ", timestamp: " << frame._timestamp;
     return os;
 }
 
 void LiDARFrame::SetTimestamp(double timestamp) { _timestamp = timestamp; }
+
+void LiDARFrame::Compact(float resolution) {
+    if (_compactScan != nullptr) {
+        return;
+    }
+    _compactScan = LiDARCompactScan::Create(*_scan, _timestamp, resolution);
+    _scan = nullptr;
+}
+
+bool LiDARFrame::IsCompact() const { return _compactScan != nullptr; }
+
+LiDARFrame::Ptr LiDARFrame::Decompacted(const LiDARFrame::Ptr &frame) {
+    if (frame == nullptr || !frame->IsCompact()) {
+        return frame;
+    }
+    return LiDARFrame::Create(frame->_timestamp, frame->_compactScan->ToCloud(frame->_timestamp));
+}
+
+const LiDARCompactScan::Ptr &LiDARFrame::GetCompactScan() const { return _compactScan; }
 }  // namespace ns_ikalibr
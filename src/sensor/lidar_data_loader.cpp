@@ -39,11 +39,15 @@
 #include "sensor/lidar_data_loader.h"
 #include "ikalibr/LivoxCustomMsg.h"
 #include "sensor_msgs/PointCloud2.h"
+#include "sensor_msgs/point_cloud2_iterator.h"
 #include "spdlog/spdlog.h"
 #include "util/status.hpp"
 #include "velodyne_msgs/VelodynePacket.h"
 #include "velodyne_pointcloud/pointcloudXYZIRT.h"
 #include "velodyne_pointcloud/rawdata.h"
+#include "array"
+#include "cstring"
+#include "type_traits"
 
 namespace {
 bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
@@ -90,6 +94,161 @@ LiDARDataLoader::Ptr LiDARDataLoader::GetLoader(const std::string &lidarModelStr
 
 LidarModelType LiDARDataLoader::GetLiDARModel() const { return _lidarModel; }
 
+IKalibrPointCloud::Ptr LiDARDataLoader::DecodePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                                          const std::string &timeField,
+                                                          double timeBase,
+                                                          double timeScale,
+                                                          double depthMin,
+                                                          double depthMax) {
+    const auto layout = GetPointCloud2Layout(msg, timeField);
+
+    if (static_cast<std::size_t>(msg.width) * layout.pointStep > msg.row_step ||
+        static_cast<std::size_t>(msg.height) * msg.row_step > msg.data.size()) {
+        throw Status(Status::CRITICAL,
+                     "the data buffer of the 'sensor_msgs::PointCloud2' message is incomplete!");
+    }
+
+    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
+    cloud->is_dense = false;
+    cloud->resize(static_cast<std::size_t>(msg.width) * msg.height);
+
+    // dispatch on the datatype of the time field once, rather than once per point, the type is
+    // passed by 'std::common_type<Type>', whose member 'type' is 'Type'
+    std::size_t j;
+    auto Decode = [&](auto timeType) {
+        using TimeType = typename decltype(timeType)::type;
+        return DecodePointCloud2<TimeType>(msg, layout, timeBase, timeScale, depthMin, depthMax,
+                                           *cloud);
+    };
+    if (!layout.time) {
+        j = Decode(std::common_type<void>());
+    } else {
+        switch (layout.time->second) {
+            case sensor_msgs::PointField::INT8:
+                j = Decode(std::common_type<std::int8_t>());
+                break;
+            case sensor_msgs::PointField::UINT8:
+                j = Decode(std::common_type<std::uint8_t>());
+                break;
+            case sensor_msgs::PointField::INT16:
+                j = Decode(std::common_type<std::int16_t>());
+                break;
+            case sensor_msgs::PointField::UINT16:
+                j = Decode(std::common_type<std::uint16_t>());
+                break;
+            case sensor_msgs::PointField::INT32:
+                j = Decode(std::common_type<std::int32_t>());
+                break;
+            case sensor_msgs::PointField::UINT32:
+                j = Decode(std::common_type<std::uint32_t>());
+                break;
+            case sensor_msgs::PointField::FLOAT32:
+                j = Decode(std::common_type<float>());
+                break;
+            case sensor_msgs::PointField::FLOAT64:
+                j = Decode(std::common_type<double>());
+                break;
+            default:
+                throw Status(Status::CRITICAL,
+                             "unknown datatype of the time field '" + timeField +
+                                 "' in the 'sensor_msgs::PointCloud2' message!");
+        }
+    }
+    cloud->resize(j);
+
+    return cloud;
+}
+
+LiDARDataLoader::PointCloud2Layout LiDARDataLoader::GetPointCloud2Layout(
+    const sensor_msgs::PointCloud2 &msg, const std::string &timeField) {
+    std::lock_guard<std::mutex> lock(_pc2LayoutMutex);
+    if (_pc2Layout && _pc2Layout->pointStep == msg.point_step &&
+        _pc2Layout->fieldCount == msg.fields.size()) {
+        return *_pc2Layout;
+    }
+
+    PointCloud2Layout layout{msg.point_step, msg.fields.size(), 0, 0, 0, std::nullopt};
+    std::array<bool, 3> xyzFound{false, false, false};
+    for (const auto &field : msg.fields) {
+        const int size = sensor_msgs::sizeOfPointField(field.datatype);
+        if (size <= 0 || field.offset + size > msg.point_step) {
+            continue;
+        }
+        if (field.name == "x" || field.name == "y" || field.name == "z") {
+            if (field.datatype != sensor_msgs::PointField::FLOAT32) {
+                continue;
+            }
+            const int idx = field.name.front() - 'x';
+            (idx == 0 ? layout.xOffset : (idx == 1 ? layout.yOffset : layout.zOffset)) =
+                field.offset;
+            xyzFound.at(idx) = true;
+        } else if (field.name == timeField) {
+            layout.time = {field.offset, field.datatype};
+        }
+    }
+    if (!xyzFound.at(0) || !xyzFound.at(1) || !xyzFound.at(2)) {
+        throw Status(Status::CRITICAL,
+                     "the 'sensor_msgs::PointCloud2' message of lidar '" +
+                         std::string(EnumCast::enumToString(GetLiDARModel())) +
+                         "' does not contain float32 'x', 'y' and 'z' fields!");
+    }
+    if (!layout.time) {
+        spdlog::warn(
+            "the 'sensor_msgs::PointCloud2' message of lidar '{}' does not contain the time field "
+            "'{}', zero is used as the time of points!",
+            EnumCast::enumToString(GetLiDARModel()), timeField);
+    }
+    _pc2Layout = layout;
+    return layout;
+}
+
+template <typename TimeType>
+std::size_t LiDARDataLoader::DecodePointCloud2(const sensor_msgs::PointCloud2 &msg,
+                                               const PointCloud2Layout &layout,
+                                               double timeBase,
+                                               double timeScale,
+                                               double depthMin,
+                                               double depthMax,
+                                               IKalibrPointCloud &cloud) {
+    // compare the squared depth, no square root is required
+    const double sqDepthMin = depthMin * depthMin, sqDepthMax = depthMax * depthMax;
+
+    std::size_t j = 0;
+    for (std::uint32_t r = 0; r < msg.height; ++r) {
+        const std::uint8_t *row = msg.data.data() + static_cast<std::size_t>(r) * msg.row_step;
+        for (std::uint32_t c = 0; c < msg.width; ++c) {
+            const std::uint8_t *src = row + static_cast<std::size_t>(c) * layout.pointStep;
+
+            float x, y, z;
+            std::memcpy(&x, src + layout.xOffset, sizeof(float));
+            std::memcpy(&y, src + layout.yOffset, sizeof(float));
+            std::memcpy(&z, src + layout.zOffset, sizeof(float));
+            if (std::isnan(x) || std::isnan(y) || std::isnan(z)) {
+                continue;
+            }
+
+            const double sqDepth = x * x + y * y + z * z;
+            if (sqDepth > sqDepthMax || sqDepth < sqDepthMin) {
+                continue;
+            }
+
+            double time = 0.0;
+            if constexpr (!std::is_void_v<TimeType>) {
+                TimeType value;
+                std::memcpy(&value, src + layout.time->first, sizeof(TimeType));
+                time = static_cast<double>(value);
+            }
+
+            IKalibrPoint &dstPoint = cloud.points[j++];
+            dstPoint.x = x;
+            dstPoint.y = y;
+            dstPoint.z = z;
+            dstPoint.timestamp = timeBase + timeScale * time;
+        }
+    }
+    return j;
+}
+
 // ----------
 // Velodyne16
 // ----------
@@ -123,7 +282,7 @@ LiDARFrame::Ptr Velodyne16::UnpackScan(
     LiDARFrame::Ptr output = LiDARFrame::Create(lidarMsg->header.stamp.toSec());
 
     // point cloud
-    auto scan = output->GetScan();
+    const auto &scan = output->GetMutableScan();
     scan->height = 16;
     scan->width = 24 * (int)lidarMsg->packets.size();
     scan->is_dense = false;
@@ -305,40 +464,13 @@ LiDARFrame::Ptr VelodynePoints::UnpackScan(const rosbag::MessageInstance &msgIns
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    PosIRTPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
     if (lidarMsg->header.stamp.isZero()) {
         Status(Status::WARNING, "lidar scan with zero timestamp exists!!!");
     }
     double timebase = lidarMsg->header.stamp.toSec();
 
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 200 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + src.time;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
+    // the time of points is relative to the header stamp (second)
+    auto cloud = DecodePointCloud2(*lidarMsg, "time", timebase, 1.0, 1.0, 200.0);
 
     return LiDARFrame::Create(timebase, cloud);
 }
@@ -359,40 +491,13 @@ LiDARFrame::Ptr OusterLiDAR::UnpackScan(const rosbag::MessageInstance &msgInstan
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    OusterPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
     if (lidarMsg->header.stamp.isZero()) {
         Status(Status::WARNING, "lidar scan with zero timestamp exists!!!");
     }
     double timebase = lidarMsg->header.stamp.toSec();
 
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 60 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + static_cast<double>(src.t) * 1E-9;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
+    // the time of points is relative to the header stamp (nanosecond)
+    auto cloud = DecodePointCloud2(*lidarMsg, "t", timebase, 1E-9, 1.0, 60.0);
 
     return LiDARFrame::Create(timebase, cloud);
 }
@@ -413,40 +518,13 @@ LiDARFrame::Ptr OusterRing16LiDAR::UnpackScan(const rosbag::MessageInstance &msg
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    OusterRing16PointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
     if (lidarMsg->header.stamp.isZero()) {
         Status(Status::WARNING, "lidar scan with zero timestamp exists!!!");
     }
     double timebase = lidarMsg->header.stamp.toSec();
 
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 60 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = timebase + static_cast<double>(src.t) * 1E-9;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
+    // the time of points is relative to the header stamp (nanosecond)
+    auto cloud = DecodePointCloud2(*lidarMsg, "t", timebase, 1E-9, 1.0, 60.0);
 
     return LiDARFrame::Create(timebase, cloud);
 }
@@ -467,41 +545,13 @@ LiDARFrame::Ptr PandarXTLiDAR::UnpackScan(const rosbag::MessageInstance &msgInst
 
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    PandarPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
     if (lidarMsg->header.stamp.isZero()) {
         Status(Status::WARNING, "lidar scan with zero timestamp exists!!!");
     }
     double timebase = lidarMsg->header.stamp.toSec();
 
-    /// point cloud
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    std::size_t j = 0;
-    for (const auto &src : pcIn) {
-        if (IS_POS_NAN(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-
-        if (depth > 100 || depth < 1) {
-            continue;
-        } else {
-            IKalibrPoint dstPoint;
-            dstPoint.x = src.x;
-            dstPoint.y = src.y;
-            dstPoint.z = src.z;
-            dstPoint.timestamp = src.timestamp;
-            // attention: use 'PointXYZT' as 'IKalibrPoint' rather than 'PointXYZIT' here
-            // dstPoint.intensity = src.intensity;
-            cloud->at(j++) = dstPoint;
-        }
-    }
-    cloud->resize(j);
+    // the time of points is absolute (second)
+    auto cloud = DecodePointCloud2(*lidarMsg, "timestamp", 0.0, 1.0, 1.0, 100.0);
 
     return LiDARFrame::Create(timebase, cloud);
 }
@@ -571,37 +621,13 @@ LiDARFrame::Ptr RSLIDAR_POINTS::UnpackScan(const rosbag::MessageInstance &msgIns
         msgInstance.instantiate<sensor_msgs::PointCloud2>();
     CheckMessage<sensor_msgs::PointCloud2>(lidarMsg);
 
-    RsPointCloud pcIn;
-    pcl::fromROSMsg(*lidarMsg, pcIn);
-
     if (lidarMsg->header.stamp.isZero()) {
         SPDLOG_WARN("RSLIDAR_POINTS scan with zero timestamp.");
     }
     double timebase = lidarMsg->header.stamp.toSec();
 
-    IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud());
-    cloud->is_dense = false;
-    cloud->resize(pcIn.size());
-
-    size_t validCount = 0;
-    for (const auto &src : pcIn) {
-        if (!pcl::isFinite(src)) {
-            continue;
-        }
-
-        double depth = sqrt(src.x * src.x + src.y * src.y + src.z * src.z);
-        if (depth < 1.0 || depth > 100.0) {
-            continue;
-        }
-
-        IKalibrPoint point;
-        point.x = src.x;
-        point.y = src.y;
-        point.z = src.z;
-        point.timestamp = src.timestamp;
-        cloud->points[validCount++] = point;
-    }
-    cloud->resize(validCount);
+    // the time of points is absolute (second)
+    auto cloud = DecodePointCloud2(*lidarMsg, "timestamp", 0.0, 1.0, 1.0, 100.0);
 
     return LiDARFrame::Create(timebase, cloud);
 }
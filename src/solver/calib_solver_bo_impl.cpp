@@ -34,6 +34,7 @@
 
 #include "solver/calib_solver_tpl.hpp"
 #include "magic_enum_flags.hpp"
+#include "util/profiler.h"
 #include "util/utils_tpl.hpp"
 
 namespace {
@@ -49,8 +50,7 @@ CalibSolver::BackUp::Ptr CalibSolver::BatchOptimization(
     const std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> &rgbdCorrs,
     const std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> &visualVelCorrs,
     const std::map<std::string, std::vector<OpticalFlowCurveCorr::Ptr>> &eventCorrs,
-    const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>> &rgbdPtsCorrs)
-    const {
+    const std::optional<std::map<std::string, std::vector<PointToSurfelCorrPtr>>> &rgbdPtsCorrs) {
     // a lambda function to obtain the string of current optimization option
     auto GetOptString = [](OptOption opt) -> std::string {
         std::stringstream stringStream;
@@ -85,172 +85,309 @@ CalibSolver::BackUp::Ptr CalibSolver::BatchOptimization(
         return visualOpt;
     };
 
+    // raw measurements of imus and radars are directly fused into the estimator, such factors are
+    // independent of data associations
+    auto AddInertialAndRadarFactors = [this](Estimator::Ptr &estimator, OptOption opt) {
+        switch (GetScaleType()) {
+            case TimeDeriv::LIN_ACCE_SPLINE: {
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_ACCE_SPLINE>(estimator, topic, opt);
+                    this->AddGyroFactor(estimator, topic, opt);
+                }
+            } break;
+            case TimeDeriv::LIN_VEL_SPLINE: {
+                for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+                    this->AddRadarFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, opt);
+                }
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, opt);
+                    this->AddGyroFactor(estimator, topic, opt);
+                }
+            } break;
+            case TimeDeriv::LIN_POS_SPLINE: {
+                for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
+                    this->AddRadarFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, opt);
+                }
+                for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
+                    this->AddAcceFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, opt);
+                    this->AddGyroFactor(estimator, topic, opt);
+                }
+            } break;
+        }
+    };
+
     spdlog::info("Optimization option: {}", GetOptString(optOption));
+    Profiler::Scope profile("BatchOptimization");
 
-    auto estimator = Estimator::Create(_splines, _parMagr);
     auto visualGlobalScale = std::make_shared<double>(1.0);
     constexpr bool OPTICAL_FLOW_EST_INV_DEPTH = true;
 
-    switch (GetScaleType()) {
-        case TimeDeriv::LIN_ACCE_SPLINE: {
-            /**
-             * only when imu-only multi-imu calibration is required, the linear acceleration spline
-             * would be maintained
-             */
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_ACCE_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
-        } break;
-        case TimeDeriv::LIN_VEL_SPLINE: {
-            /**
-             * when rgbds or radars are involved in the calibration, a linear velocity spline would
-             * be maintained in the estimator
-             */
-            for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
-                this->AddRadarFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
-            }
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_VEL_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
-            for (const auto &[topic, corrs] : rgbdCorrs) {
-                /**
-                 * We have directly removed 'AddRGBDOpticalFlowFactor' in the new version and
-                 * replaced it with 'AddRGBDOpticalFlowReprojFactor' to avoid the introduction of
-                 * prior model errors from 'AddRGBDOpticalFlowFactor'.
-                 */
-                // this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
-                //                                OPTICAL_FLOW_EST_INV_DEPTH>(
-                //     estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-
+    // factors from data associations, and inertial and radar ones if required
+    auto AddFactors = [&](Estimator::Ptr &estimator, bool withInertialAndRadar) {
+        switch (GetScaleType()) {
+            case TimeDeriv::LIN_ACCE_SPLINE: {
                 /**
-                 * when vel spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence, under the assumption of uniform velocity
-                 * variation
+                 * only when imu-only multi-imu calibration is required, the linear acceleration
+                 * spline would be maintained
                  */
-                this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
-                                                     OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : visualVelCorrs) {
+                if (withInertialAndRadar) {
+                    AddInertialAndRadarFactors(estimator, optOption);
+                }
+            } break;
+            case TimeDeriv::LIN_VEL_SPLINE: {
                 /**
-                 * We have directly removed 'AddVisualOpticalFlowFactor' in the new version and
-                 * replaced it with 'AddVisualOpticalFlowReprojFactor' to avoid the introduction of
-                 * prior model errors from 'AddVisualOpticalFlowFactor'.
+                 * when rgbds or radars are involved in the calibration, a linear velocity spline
+                 * would be maintained in the estimator
                  */
-                // this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
-                //                                  OPTICAL_FLOW_EST_INV_DEPTH>(
-                //     estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                if (withInertialAndRadar) {
+                    AddInertialAndRadarFactors(estimator, optOption);
+                }
+                for (const auto &[topic, corrs] : rgbdCorrs) {
+                    /**
+                     * We have directly removed 'AddRGBDOpticalFlowFactor' in the new version and
+                     * replaced it with 'AddRGBDOpticalFlowReprojFactor' to avoid the introduction
+                     * of prior model errors from 'AddRGBDOpticalFlowFactor'.
+                     */
+                    // this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
+                    //                                OPTICAL_FLOW_EST_INV_DEPTH>(
+                    //     estimator, topic, corrs,
+                    //     RefineReadoutTimeOptForCameras(topic, optOption));
 
-                /**
-                 * when vel spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence, under the assumption of uniform velocity
-                 * variation
-                 */
-                this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
-                                                       OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when vel spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence, under the assumption of uniform
+                     * velocity variation
+                     */
+                    this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
+                                                         OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                for (const auto &[topic, corrs] : visualVelCorrs) {
+                    /**
+                     * We have directly removed 'AddVisualOpticalFlowFactor' in the new version
+                     * and replaced it with 'AddVisualOpticalFlowReprojFactor' to avoid the
+                     * introduction of prior model errors from 'AddVisualOpticalFlowFactor'.
+                     */
+                    // this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
+                    //                                  OPTICAL_FLOW_EST_INV_DEPTH>(
+                    //     estimator, topic, corrs,
+                    //     RefineReadoutTimeOptForCameras(topic, optOption));
 
-                // this->AddVisualPPPTrifocalTensorFactor<TimeDeriv::LIN_VEL_SPLINE>(
-                //     estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : eventCorrs) {
-                this->AddEventOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
-                                                OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when vel spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence, under the assumption of uniform velocity
-                 * variation
-                 */
-                // todo: poor performance due to poor event-based feature tracking
-                // this->AddEventOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
-                //                                       OPTICAL_FLOW_EST_INV_DEPTH>(
-                //     estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-        } break;
-        case TimeDeriv::LIN_POS_SPLINE: {
-            /*
-             * when lidars or optical cameras are involved in the calibration, a translation spline
-             * would be maintained in the estimator
-             */
-            for (const auto &[topic, corrs] : lidarPtsCorrs) {
-                this->AddLiDARPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
-                                                                             corrs, optOption);
-            }
-            for (const auto &[topic, corrs] : visualReprojCorrs) {
-                this->AddVisualReprojectionFactor<TimeDeriv::LIN_POS_SPLINE>(
-                    estimator, topic, corrs, visualGlobalScale.get(),
-                    RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, _] : Configor::DataStream::RadarTopics) {
-                this->AddRadarFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
-            }
-            for (const auto &[topic, _] : Configor::DataStream::IMUTopics) {
-                this->AddAcceFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic, optOption);
-                this->AddGyroFactor(estimator, topic, optOption);
-            }
-            for (const auto &[topic, corrs] : rgbdCorrs) {
-                this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
-                                               OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when pos spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence
-                 */
-                this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                     OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when vel spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence, under the assumption of uniform
+                     * velocity variation
+                     */
+                    this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
+                                                           OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
 
-                // this->AddVisualPPPTrifocalTensorFactor<TimeDeriv::LIN_VEL_SPLINE>(
-                //     estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : visualVelCorrs) {
-                this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                 OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when pos spline is maintained, we add additional reprojection constraints for
-                 * optical flow tracking correspondence
-                 */
-                this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                       OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            for (const auto &[topic, corrs] : eventCorrs) {
-                this->AddEventOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-                /**
-                 * when pos spline is maintained, we add additional reprojection constraints
-                 * for optical flow tracking correspondence
-                 */
-                this->AddEventOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
-                                                      OPTICAL_FLOW_EST_INV_DEPTH>(
-                    estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
-            }
-            if (rgbdPtsCorrs != std::nullopt) {
-                /**
-                 * such point-to-surfel data association is not necessary, if it exists, we add to
-                 * the estimator
+                    // this->AddVisualPPPTrifocalTensorFactor<TimeDeriv::LIN_VEL_SPLINE>(
+                    //     estimator, topic, corrs,
+                    //     RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                for (const auto &[topic, corrs] : eventCorrs) {
+                    this->AddEventOpticalFlowFactor<TimeDeriv::LIN_VEL_SPLINE,
+                                                    OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when vel spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence, under the assumption of uniform
+                     * velocity variation
+                     */
+                    // todo: poor performance due to poor event-based feature tracking
+                    // this->AddEventOpticalFlowReprojFactor<TimeDeriv::LIN_VEL_SPLINE,
+                    //                                       OPTICAL_FLOW_EST_INV_DEPTH>(
+                    //     estimator, topic, corrs,
+                    //     RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+            } break;
+            case TimeDeriv::LIN_POS_SPLINE: {
+                /*
+                 * when lidars or optical cameras are involved in the calibration, a translation
+                 * spline would be maintained in the estimator
                  */
-                for (const auto &[topic, corrs] : *rgbdPtsCorrs) {
-                    this->AddRGBDPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
-                                                                                corrs, optOption);
+                for (const auto &[topic, corrs] : lidarPtsCorrs) {
+                    this->AddLiDARPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(estimator, topic,
+                                                                                 corrs, optOption);
+                }
+                for (const auto &[topic, corrs] : visualReprojCorrs) {
+                    this->AddVisualReprojectionFactor<TimeDeriv::LIN_POS_SPLINE>(
+                        estimator, topic, corrs, visualGlobalScale.get(),
+                        RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                if (withInertialAndRadar) {
+                    AddInertialAndRadarFactors(estimator, optOption);
+                }
+                for (const auto &[topic, corrs] : rgbdCorrs) {
+                    this->AddRGBDOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                   OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when pos spline is maintained, we add additional reprojection constraints for
+                     * optical flow tracking correspondence
+                     */
+                    this->AddRGBDOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                         OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+
+                    // this->AddVisualPPPTrifocalTensorFactor<TimeDeriv::LIN_VEL_SPLINE>(
+                    //     estimator, topic, corrs,
+                    //     RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                for (const auto &[topic, corrs] : visualVelCorrs) {
+                    this->AddVisualOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                     OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when pos spline is maintained, we add additional reprojection constraints for
+                     * optical flow tracking correspondence
+                     */
+                    this->AddVisualOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                           OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                for (const auto &[topic, corrs] : eventCorrs) {
+                    this->AddEventOpticalFlowFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                    OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                    /**
+                     * when pos spline is maintained, we add additional reprojection constraints
+                     * for optical flow tracking correspondence
+                     */
+                    this->AddEventOpticalFlowReprojFactor<TimeDeriv::LIN_POS_SPLINE,
+                                                          OPTICAL_FLOW_EST_INV_DEPTH>(
+                        estimator, topic, corrs, RefineReadoutTimeOptForCameras(topic, optOption));
+                }
+                if (rgbdPtsCorrs != std::nullopt) {
+                    /**
+                     * such point-to-surfel data association is not necessary, if it exists, we add
+                     * to the estimator
+                     */
+                    for (const auto &[topic, corrs] : *rgbdPtsCorrs) {
+                        this->AddRGBDPointToSurfelFactor<TimeDeriv::LIN_POS_SPLINE>(
+                            estimator, topic, corrs, optOption);
+                    }
                 }
+            } break;
+        }
+    };
+
+    /**
+     * the sliding-window optimization is designed for very long recordings, where the spline over
+     * the whole recording is too large to be optimized jointly. Overlapping time windows are
+     * optimized one by one, residual blocks leaving the window are marginalized into a prior on
+     * spatiotemporal parameters and intrinsics, which is carried to the next window
+     */
+    const bool sliding =
+        IsOptionWith(SpeedUpOption::SlidingWindowOptimization, Configor::Preference::SpeedUps);
+    /**
+     * if the persistent estimator is enabled, inertial and radar residual blocks are added only
+     * once and kept alive over batch optimizations, only their parameter blocks are switched
+     * between constant and variable by the option of each stage. Association-dependent ones are
+     * removed and re-added in each stage. As the spline segments involved in inertial and radar
+     * factors depend on whether time offsets are optimized (time padding), the estimator is
+     * rebuilt once these options change. It is not used in the sliding-window optimization
+     */
+    const bool persistent =
+        !sliding &&
+        IsOptionWith(SpeedUpOption::PersistentEstimator, Configor::Preference::SpeedUps);
+    Estimator::Ptr estimator;
+    ceres::Solver::Summary sum;
+    if (!sliding) {
+        const OptOption structOpt =
+            optOption & (OptOption::OPT_TO_BiToBr | OptOption::OPT_TO_RjToBr);
+        if (!persistent) {
+            estimator = Estimator::Create(_splines, _parMagr);
+        } else if (_persistentEstimator != nullptr && _persistentEstimatorOpt == structOpt) {
+            estimator = _persistentEstimator;
+            // residual blocks of the last batch optimization from associations and priori
+            estimator->RemoveNonPersistentBlocks();
+            estimator->SetInertialAndRadarParamsState(optOption);
+            spdlog::info("reuse the persistent estimator for inertial and radar factors");
+        } else {
+            estimator =
+                Estimator::Create(_splines, _parMagr, Estimator::PersistentProblemOptions());
+            AddInertialAndRadarFactors(estimator, optOption);
+            estimator->MarkResidualBlocksPersistent();
+            _persistentEstimator = estimator;
+            _persistentEstimatorOpt = structOpt;
+        }
+
+        AddFactors(estimator, !persistent);
+
+        // make this problem full rank
+        estimator->SetRefIMUParamsConstant();
+
+        estimator->PrintParameterInfo();
+
+        sum = estimator->Solve(_ceresOption, this->_priori);
+    } else {
+        const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        const double st = std::max(so3Spline.MinTime(), scaleSpline.MinTime());
+        const double et = std::min(so3Spline.MaxTime(), scaleSpline.MaxTime());
+        std::vector<std::pair<double, double>> windows;
+        for (double sTime = st;;
+             sTime = windows.back().second - Configor::Prior::SlidingWindowOverlap) {
+            const double eTime = std::min(sTime + Configor::Prior::SlidingWindowLength, et);
+            windows.emplace_back(sTime, eTime);
+            if (eTime >= et) {
+                break;
             }
-        } break;
-    }
+        }
 
-    // make this problem full rank
-    estimator->SetRefIMUParamsConstant();
+        MarginalizationPrior::Ptr prior = nullptr;
+        for (int i = 0; i < static_cast<int>(windows.size()); ++i) {
+            const auto &[sTime, eTime] = windows.at(i);
+            spdlog::info("optimize the time window [{:.3f}, {:.3f}] ({}/{})", sTime, eTime, i + 1,
+                         windows.size());
+            estimator = Estimator::Create(_splines, _parMagr);
+            estimator->SetTimeWindow(sTime, eTime);
+            AddFactors(estimator, true);
+            // information of residual blocks left in previous windows
+            estimator->AddMarginalizationPrior(prior);
+            // knots shared with the previous window have been optimized there
+            estimator->FixTimeWindowHeadKnots();
 
-    estimator->PrintParameterInfo();
+            // make this problem full rank
+            estimator->SetRefIMUParamsConstant();
 
-    auto sum = estimator->Solve(_ceresOption, this->_priori);
+            // the priori is only added in the first window, and then carried by the prior
+            sum = estimator->Solve(_ceresOption, i == 0 ? this->_priori : nullptr);
+            spdlog::info("time window ({}/{}) is optimized, final cost: {:.6f}", i + 1,
+                         windows.size(), sum.final_cost);
+
+            if (i + 1 < static_cast<int>(windows.size())) {
+                prior = estimator->MarginalizeToPrior(
+                    estimator->GetResidualBlocksLeavingTimeWindow(windows.at(i + 1).first),
+                    Configor::Preference::AvailableThreads());
+            }
+        }
+        profile.AddMetric("time_windows", static_cast<int>(windows.size()));
+    }
     spdlog::info("here is the summary:\n{}\n", sum.BriefReport());
 
+    // the problem size and solver timings of this batch optimization
+    for (const auto &[factor, count] : estimator->GetResidualBlockCountOfFactors()) {
+        profile.AddMetric("residual_blocks/" + factor, count);
+    }
+    profile.AddMetric("residual_blocks", sum.num_residual_blocks)
+        .AddMetric("residuals", sum.num_residuals)
+        .AddMetric("parameter_blocks", sum.num_parameter_blocks)
+        .AddMetric("effective_parameters", sum.num_effective_parameters)
+        .AddMetric("successful_steps", sum.num_successful_steps)
+        .AddMetric("unsuccessful_steps", sum.num_unsuccessful_steps)
+        .AddMetric("solver/preprocessor_time", sum.preprocessor_time_in_seconds)
+        .AddMetric("solver/minimizer_time", sum.minimizer_time_in_seconds)
+        .AddMetric("solver/postprocessor_time", sum.postprocessor_time_in_seconds)
+        .AddMetric("solver/total_time", sum.total_time_in_seconds)
+        .AddMetric("solver/linear_solver_time", sum.linear_solver_time_in_seconds)
+        .AddMetric("solver/residual_evaluation_time", sum.residual_evaluation_time_in_seconds)
+        .AddMetric("solver/jacobian_evaluation_time", sum.jacobian_evaluation_time_in_seconds)
+        .AddMetric("solver/initial_cost", sum.initial_cost)
+        .AddMetric("solver/final_cost", sum.final_cost);
+
     // align states to the gravity after the batch optimization is finished
     AlignStatesToGravity();
 
@@ -333,6 +470,7 @@ CalibSolver::BackUp::Ptr CalibSolver::BatchOptimization(
     }
     // do not back up the maps
     backUp->lidarMap = nullptr;
+    backUp->lidarTiledMap = nullptr;
     backUp->radarMap = nullptr;
     return backUp;
 }
@@ -36,9 +36,11 @@
 #include "calib/calib_param_manager.h"
 #include "calib/ceres_callback.h"
 #include "calib/estimator.h"
+#include "calib/estimator_tpl.hpp"
 #include "calib/spat_temp_priori.h"
 #include "core/colmap_data_io.h"
 #include "core/optical_flow_trace.h"
+#include "core/spline_pose_cache.h"
 #include "core/vision_only_sfm.h"
 #include "factor/data_correspondence.h"
 #include "opencv2/highgui.hpp"
@@ -105,11 +107,15 @@ CalibSolver::CalibSolver(CalibDataManager::Ptr calibDataManager,
           Configor::Preference::AvailableThreads(), true, Configor::Preference::UseCudaInSolving)),
       _viewer(nullptr),
       _initAsset(new InitAsset),
+      _lidarMapAsset(nullptr),
+      _persistentEstimator(nullptr),
+      _persistentEstimatorOpt(OptOption::NONE),
       _solveFinished(false) {
     // create so3 and linear scale splines given start and end times, knot distances
     _splines = CreateSplineBundle(
         _dataMagr->GetCalibStartTimestamp(), _dataMagr->GetCalibEndTimestamp(),
         Configor::Prior::KnotTimeDist::SO3Spline, Configor::Prior::KnotTimeDist::ScaleSpline);
+    _poseCache = SplinePoseCache::Create(_splines);
 
     // create viewer
     _viewer = Viewer::Create(_parMagr, _splines);
@@ -156,13 +162,7 @@ std::optional<Sophus::SE3d> CalibSolver::CurBrToW(double timeByBr) const {
         throw Status(Status::CRITICAL,
                      "'CurBrToW' error, scale spline is not translation spline!!!");
     }
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
-    } else {
-        return Sophus::SE3d(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-    }
+    return _poseCache->BrToW(timeByBr);
 }
 
 std::optional<Sophus::SE3d> CalibSolver::CurLkToW(double timeByLk, const std::string &topic) const {
@@ -171,14 +171,10 @@ std::optional<Sophus::SE3d> CalibSolver::CurLkToW(double timeByLk, const std::st
                      "'CurLkToW' error, scale spline is not translation spline!!!");
     }
     double timeByBr = timeByLk + _parMagr->TEMPORAL.TO_LkToBr.at(topic);
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
+    if (auto curBrToW = _poseCache->BrToW(timeByBr)) {
+        return *curBrToW * _parMagr->EXTRI.SE3_LkToBr(topic);
     } else {
-        Sophus::SE3d curBrToW(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-        return curBrToW * _parMagr->EXTRI.SE3_LkToBr(topic);
+        return {};
     }
 }
 
@@ -188,14 +184,10 @@ std::optional<Sophus::SE3d> CalibSolver::CurCmToW(double timeByCm, const std::st
                      "'CurCmToW' error, scale spline is not translation spline!!!");
     }
     double timeByBr = timeByCm + _parMagr->TEMPORAL.TO_CmToBr.at(topic);
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
+    if (auto curBrToW = _poseCache->BrToW(timeByBr)) {
+        return *curBrToW * _parMagr->EXTRI.SE3_CmToBr(topic);
     } else {
-        Sophus::SE3d curBrToW(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-        return curBrToW * _parMagr->EXTRI.SE3_CmToBr(topic);
+        return {};
     }
 }
 
@@ -205,14 +197,10 @@ std::optional<Sophus::SE3d> CalibSolver::CurEsToW(double timeByEs, const std::st
                      "'CurEsToW' error, scale spline is not translation spline!!!");
     }
     double timeByBr = timeByEs + _parMagr->TEMPORAL.TO_EsToBr.at(topic);
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
+    if (auto curBrToW = _poseCache->BrToW(timeByBr)) {
+        return *curBrToW * _parMagr->EXTRI.SE3_EsToBr(topic);
     } else {
-        Sophus::SE3d curBrToW(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-        return curBrToW * _parMagr->EXTRI.SE3_EsToBr(topic);
+        return {};
     }
 }
 
@@ -222,14 +210,10 @@ std::optional<Sophus::SE3d> CalibSolver::CurDnToW(double timeByDn, const std::st
                      "'CurDnToW' error, scale spline is not translation spline!!!");
     }
     double timeByBr = timeByDn + _parMagr->TEMPORAL.TO_DnToBr.at(topic);
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
+    if (auto curBrToW = _poseCache->BrToW(timeByBr)) {
+        return *curBrToW * _parMagr->EXTRI.SE3_DnToBr(topic);
     } else {
-        Sophus::SE3d curBrToW(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-        return curBrToW * _parMagr->EXTRI.SE3_DnToBr(topic);
+        return {};
     }
 }
 
@@ -239,15 +223,62 @@ std::optional<Sophus::SE3d> CalibSolver::CurRjToW(double timeByRj, const std::st
                      "'CurRjToW' error, scale spline is not translation spline!!!");
     }
     double timeByBr = timeByRj + _parMagr->TEMPORAL.TO_RjToBr.at(topic);
-    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &posSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
-
-    if (!so3Spline.TimeStampInRange(timeByBr) || !posSpline.TimeStampInRange(timeByBr)) {
-        return {};
+    if (auto curBrToW = _poseCache->BrToW(timeByBr)) {
+        return *curBrToW * _parMagr->EXTRI.SE3_RjToBr(topic);
     } else {
-        Sophus::SE3d curBrToW(so3Spline.Evaluate(timeByBr), posSpline.Evaluate(timeByBr));
-        return curBrToW * _parMagr->EXTRI.SE3_RjToBr(topic);
+        return {};
+    }
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurSenToW(
+    const std::vector<double> &timesBySen,
+    double TO_SenToBr,
+    const Sophus::SE3d &SE3_SenToBr) const {
+    if (GetScaleType() != TimeDeriv::LIN_POS_SPLINE) {
+        throw Status(Status::CRITICAL,
+                     "'CurSenToW' error, scale spline is not translation spline!!!");
+    }
+    std::vector<double> timesByBr(timesBySen.size());
+    for (int i = 0; i < static_cast<int>(timesBySen.size()); ++i) {
+        timesByBr.at(i) = timesBySen.at(i) + TO_SenToBr;
     }
+    auto poses = _poseCache->BrToW(timesByBr);
+    for (auto &pose : poses) {
+        if (pose != std::nullopt) {
+            pose = *pose * SE3_SenToBr;
+        }
+    }
+    return poses;
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurLkToW(
+    const std::vector<double> &timesByLk, const std::string &topic) const {
+    return CurSenToW(timesByLk, _parMagr->TEMPORAL.TO_LkToBr.at(topic),
+                     _parMagr->EXTRI.SE3_LkToBr(topic));
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurCmToW(
+    const std::vector<double> &timesByCm, const std::string &topic) const {
+    return CurSenToW(timesByCm, _parMagr->TEMPORAL.TO_CmToBr.at(topic),
+                     _parMagr->EXTRI.SE3_CmToBr(topic));
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurEsToW(
+    const std::vector<double> &timesByEs, const std::string &topic) const {
+    return CurSenToW(timesByEs, _parMagr->TEMPORAL.TO_EsToBr.at(topic),
+                     _parMagr->EXTRI.SE3_EsToBr(topic));
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurDnToW(
+    const std::vector<double> &timesByDn, const std::string &topic) const {
+    return CurSenToW(timesByDn, _parMagr->TEMPORAL.TO_DnToBr.at(topic),
+                     _parMagr->EXTRI.SE3_DnToBr(topic));
+}
+
+std::vector<std::optional<Sophus::SE3d>> CalibSolver::CurRjToW(
+    const std::vector<double> &timesByRj, const std::string &topic) const {
+    return CurSenToW(timesByRj, _parMagr->TEMPORAL.TO_RjToBr.at(topic),
+                     _parMagr->EXTRI.SE3_RjToBr(topic));
 }
 
 TimeDeriv::ScaleSplineType CalibSolver::GetScaleType() {
@@ -292,6 +323,7 @@ void CalibSolver::AlignStatesToGravity() const {
         // attention: for three kinds of scale splines, this holds
         scaleSpline.GetKnot(i) = SO3_RefToW * scaleSpline.GetKnot(i) /* + Eigen::Vector3d::Zero()*/;
     }
+    SplinePoseCache::SplinesChanged();
 }
 
 void CalibSolver::StoreImagesForSfM(const std::string &topic,
@@ -717,9 +749,15 @@ void CalibSolver::AddGyroFactor(Estimator::Ptr &estimator,
                                 Estimator::Opt option) const {
     double weight = Configor::DataStream::IMUTopics.at(imuTopic).GyroWeight;
 
-    for (const auto &item : _dataMagr->GetIMUMeasurements(imuTopic)) {
+    const auto &data = _dataMagr->GetIMUMeasurements(imuTopic);
+    estimator->AddInParallel(static_cast<int>(data.size()), [&](int i) {
+        const auto &item = data.at(i);
+        const double time = item->GetTimestamp();
+        if (!estimator->MayInvolveTimeWindow(time, time)) {
+            return;
+        }
         estimator->AddIMUGyroMeasurement(item, imuTopic, option, weight);
-    }
+    });
 }
 
 std::vector<Eigen::Vector2d> CalibSolver::FindTexturePoints(const cv::Mat &eventFrame, int num) {
@@ -762,7 +800,7 @@ std::vector<Eigen::Vector2d> CalibSolver::FindTexturePointsAt(
     while (true) {
         bool updated = false;
         if (std::distance(data.cbegin(), fIter) > 0) {
-            accumulatedEventNum += (*fIter)->GetEvents().size();
+            accumulatedEventNum += (*fIter)->GetEventNum();
             if (accumulatedEventNum > eventNumThd) {
                 break;
             } else {
@@ -772,7 +810,7 @@ std::vector<Eigen::Vector2d> CalibSolver::FindTexturePointsAt(
         }
 
         if (std::distance(bIter, data.cend()) > 0) {
-            accumulatedEventNum += (*bIter)->GetEvents().size();
+            accumulatedEventNum += (*bIter)->GetEventNum();
             if (accumulatedEventNum > eventNumThd) {
                 break;
             } else {
@@ -843,7 +881,7 @@ void CalibSolver::SaveEventDataForFeatureTracking(const std::string &topic,
         std::size_t accumulatedEventNum = 0;
         for (auto iter = headIter; iter != tailIter; ++iter) {
             saeCreator->GrabEvent(*iter, true);
-            accumulatedEventNum += (*iter)->GetEvents().size();
+            accumulatedEventNum += (*iter)->GetEventNum();
             /**
              *        |--> event data to be accumulated to locate seed positions
              * ----|-------------------|----
@@ -892,7 +930,7 @@ void CalibSolver::SaveEventDataForFeatureTracking(const std::string &topic,
                              subWS, topic, subEventDataIdx);
             }
         }
-        double seedTime = (*seedIter)->GetEvents().back()->GetTimestamp();
+        double seedTime = (*seedIter)->GetEventTimestamps().back();
         auto [c, i] = HASTEDataIO::SaveRawEventDataAsBinary(headIter,  // from
                                                             tailIter,  // to
                                                             intri,     // intrinsics
@@ -989,7 +1027,7 @@ void CalibSolver::SaveEventDataForFeatureTracking(const std::string &topic,
             BATCH_TIME_WIN_THD * 2;
 
         for (auto curIter = matSIter; curIter != eventMes.cend(); ++curIter) {
-            accumulatedEventCount += (*curIter)->GetEvents().size();
+            accumulatedEventCount += (*curIter)->GetEventNum();
             if (accumulatedEventCount > EVENT_FRAME_NUM_THD) {
                 /**
                  * If the number of events accumulates to a certain number, we construct it into an
@@ -34,6 +34,7 @@
 
 #include "calib/calib_data_manager.h"
 #include "calib/calib_param_manager.h"
+#include "core/lidar_tiled_map.h"
 #include "core/optical_flow_trace.h"
 #include "core/pts_association.h"
 #include "core/scan_undistortion.h"
@@ -45,6 +46,7 @@
 #include "solver/calib_solver.h"
 #include "spdlog/spdlog.h"
 #include "util/cloud_define.hpp"
+#include "util/profiler.h"
 #include "util/tqdm.h"
 #include "viewer/viewer.h"
 
@@ -59,6 +61,7 @@ CalibSolver::BuildGlobalMapOfLiDAR() const {
     if (!Configor::IsLiDARIntegrated()) {
         return {};
     }
+    Profiler::Scope profile("BuildGlobalMapOfLiDAR");
 
     // -------------------------------------------
     // undisto frames and build map in world frame
@@ -88,6 +91,77 @@ CalibSolver::BuildGlobalMapOfLiDAR() const {
     return {newMapCloud, undistFrames};
 }
 
+LiDARTiledMap::Ptr CalibSolver::BuildTiledGlobalMapOfLiDAR(
+    std::map<std::string, std::vector<LiDARFrame::Ptr>> *undistFrames) const {
+    if (!Configor::IsLiDARIntegrated()) {
+        return {};
+    }
+    Profiler::Scope profile("BuildTiledGlobalMapOfLiDAR");
+
+    // -------------------------------------------------------------------
+    // undisto frames in batches and stream them to tiles of the global map
+    // -------------------------------------------------------------------
+    auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
+
+    auto tiledMap = LiDARTiledMap::Create();
+    // frames of a batch are undistorted concurrently, and then merged to tiles in order
+    const int batchSize = Configor::Preference::AvailableThreads();
+    std::vector<LiDARFrame::Ptr> batch(batchSize);
+    std::vector<std::exception_ptr> exceptions(batchSize);
+    for (const auto &item : _dataMagr->GetLiDARMeasurements()) {
+        const auto &topic = item.first;
+        const auto &data = item.second;
+        spdlog::info("undistort scans for lidar '{}' and marge them to map tiles...", topic);
+
+        std::vector<LiDARFrame::Ptr> *framesInMap = nullptr;
+        if (undistFrames != nullptr) {
+            framesInMap = &(*undistFrames)[topic];
+            framesInMap->reserve(data.size());
+        }
+
+        const int frameCount = static_cast<int>(data.size());
+        auto bar = std::make_shared<tqdm>();
+        for (int beg = 0; beg < frameCount; beg += batchSize) {
+            bar->progress(beg, frameCount);
+            const int end = std::min(beg + batchSize, frameCount);
+            std::fill(batch.begin(), batch.end(), nullptr);
+            std::fill(exceptions.begin(), exceptions.end(), nullptr);
+
+#pragma omp parallel for num_threads(batchSize) default(none) \
+    shared(beg, end, data, topic, undistHelper, batch, exceptions)
+            for (int i = beg; i < end; ++i) {
+                try {
+                    if (auto frame = undistHelper->UndistortToRef(data.at(i), topic, true)) {
+                        batch.at(i - beg) = *frame;
+                    }
+                } catch (...) {
+                    exceptions.at(i - beg) = std::current_exception();
+                }
+            }
+            for (const auto &exception : exceptions) {
+                if (exception != nullptr) {
+                    std::rethrow_exception(exception);
+                }
+            }
+
+            for (int i = beg; i < end; ++i) {
+                const auto &frame = batch.at(i - beg);
+                if (frame != nullptr) {
+                    tiledMap->Insert(frame->GetScan());
+                }
+                if (framesInMap != nullptr) {
+                    // keep the index consistent with raw frames
+                    framesInMap->push_back(frame);
+                }
+            }
+        }
+        bar->finish();
+    }
+    spdlog::info("global lidar map is tiled into {} tiles", tiledMap->GetTileKeys().size());
+
+    return tiledMap;
+}
+
 IKalibrPointCloud::Ptr CalibSolver::BuildGlobalMapOfRadar() const {
     if (!Configor::IsRadarIntegrated() || GetScaleType() != TimeDeriv::LIN_POS_SPLINE) {
         return {};
@@ -100,8 +174,16 @@ IKalibrPointCloud::Ptr CalibSolver::BuildGlobalMapOfRadar() const {
         IKalibrPointCloud::Ptr curRadarCloud(new IKalibrPointCloud);
         curRadarCloud->reserve(data.size() * data.front()->GetTargets().size());
         for (const auto &ary : data) {
-            for (const auto &frame : ary->GetTargets()) {
-                auto SE3_CurRjToW = CurRjToW(frame->GetTimestamp(), topic);
+            // targets in an array usually share the same timestamp, query poses in batch
+            const auto &targets = ary->GetTargets();
+            std::vector<double> timestamps(targets.size());
+            for (int i = 0; i < static_cast<int>(targets.size()); ++i) {
+                timestamps.at(i) = targets.at(i)->GetTimestamp();
+            }
+            const auto poses = CurRjToW(timestamps, topic);
+            for (int i = 0; i < static_cast<int>(targets.size()); ++i) {
+                const auto &frame = targets.at(i);
+                const auto &SE3_CurRjToW = poses.at(i);
                 if (SE3_CurRjToW == std::nullopt) {
                     continue;
                 }
@@ -259,6 +341,7 @@ std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAsso
     if (!Configor::IsLiDARIntegrated()) {
         return {};
     }
+    Profiler::Scope profile("DataAssociationForLiDARs");
 
     // ---------------------------------
     // Step 1: down sample the map cloud
@@ -281,6 +364,114 @@ std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAsso
         // we use the dense map to create data associator for high-perform point-to-surfel search
         map, Configor::Prior::LiDARDataAssociate::MapResolution,
         Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+
+    return DataAssociationForLiDARs(associator, mapDownSampled, undistFrames, ptsCountInEachScan);
+}
+
+std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAssociationForLiDARs(
+    const LiDARTiledMap::Ptr &tiledMap, int ptsCountInEachScan) const {
+    if (!Configor::IsLiDARIntegrated()) {
+        return {};
+    }
+    Profiler::Scope profile("DataAssociationForLiDARs");
+
+    // ----------------------------------------------------------------
+    // Step 1: build the surfel map from raw points of tiles, one by one
+    // ----------------------------------------------------------------
+    auto associator = PointToSurfelAssociator::Create(
+        tiledMap, Configor::Prior::LiDARDataAssociate::MapResolution,
+        Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+
+    auto condition = PointToSurfelCondition();
+    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+    _viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
+    // the whole map isn't assembled, down sampled tiles are added to the viewer one by one
+    tiledMap->ForEachTile(
+        [this](const LiDARTiledMap::TileKey &, const IKalibrPointCloud::Ptr &tile) {
+            if (tile->empty()) {
+                return;
+            }
+            _viewer->AddAlignedCloud(tile, Viewer::VIEW_MAP, -_parMagr->GRAVITY.cast<float>(),
+                                     2.0f);
+            _viewer->AddCloud(tile, Viewer::VIEW_ASSOCIATION,
+                              ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+        },
+        true);
+
+    // ------------------------------------------------
+    // Step 2: undistort and associate scans one by one
+    // ------------------------------------------------
+    // undistorted scans are dropped once associated, only their correspondences are kept
+    auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
+
+    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
+    std::size_t count = 0;
+    for (const auto &item : _dataMagr->GetLiDARMeasurements()) {
+        const auto &topic = item.first;
+        const auto &rawFrames = item.second;
+        spdlog::info("undistort scans and perform point to surfel association for '{}'...", topic);
+
+        /**
+         * each scan is undistorted and associated by a single thread (the nested point-level
+         * parallel region in the associator is inactive here). The surfel map is only queried in
+         * this phase, thus no synchronization is required
+         */
+        const int frameCount = static_cast<int>(rawFrames.size());
+        std::vector<std::vector<PointToSurfelCorr::Ptr>> corrsOfScans(frameCount);
+        std::vector<std::exception_ptr> exceptions(frameCount, nullptr);
+        int finished = 0;
+        auto bar = std::make_shared<tqdm>();
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) shared(frameCount, rawFrames, topic, undistHelper, associator, condition, \
+                             corrsOfScans, exceptions, finished, bar)
+        for (int i = 0; i < frameCount; ++i) {
+            try {
+                // the scan of a compacted frame is converted once for undistortion and association
+                const auto rawFrame = LiDARFrame::Decompacted(rawFrames.at(i));
+                if (rawFrame != nullptr) {
+                    if (auto frameInMap = undistHelper->UndistortToRef(rawFrame, topic, true)) {
+                        corrsOfScans.at(i) = associator->Association(
+                            (*frameInMap)->GetScan(), rawFrame->GetScan(), condition);
+                    }
+                }
+            } catch (...) {
+                exceptions.at(i) = std::current_exception();
+            }
+#pragma omp critical
+            { bar->progress(finished++, frameCount); }
+        }
+        bar->finish();
+
+        for (const auto &exception : exceptions) {
+            if (exception != nullptr) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
+        auto &curPointToSurfel = pointToSurfel[topic];
+        for (auto &corrs : corrsOfScans) {
+            AppendPointToSurfelOfScan(curPointToSurfel, corrs);
+            // deconstruction
+            corrs.clear();
+        }
+
+        // downsample
+        int expectCount = ptsCountInEachScan * frameCount;
+        curPointToSurfel = DownsamplePointToSurfel(curPointToSurfel, expectCount);
+        count += curPointToSurfel.size();
+    }
+    spdlog::info("total point to surfel count for LiDARs: {}", count);
+    _viewer->AddPointToSurfel(associator->GetSurfelMap(), pointToSurfel, Viewer::VIEW_ASSOCIATION);
+
+    return pointToSurfel;
+}
+
+std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAssociationForLiDARs(
+    const PointToSurfelAssociator::Ptr &associator,
+    IKalibrPointCloud::Ptr mapDownSampled,
+    const std::map<std::string, std::vector<LiDARFrame::Ptr>> &undistFrames,
+    int ptsCountInEachScan) const {
     auto condition = PointToSurfelCondition();
     _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
     _viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
@@ -290,51 +481,35 @@ std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> CalibSolver::DataAsso
     // deconstruction
     mapDownSampled.reset();
 
-    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
-
-    std::size_t count = 0;
-    std::shared_ptr<tqdm> bar;
+    std::map<std::string,
+             std::vector<std::pair<IKalibrPointCloud::ConstPtr, IKalibrPointCloud::ConstPtr>>>
+        scans;
     for (const auto &[topic, framesInMap] : undistFrames) {
         const auto &rawFrames = _dataMagr->GetLiDARMeasurements(topic);
-        spdlog::info("perform point to surfel association for lidar '{}'...", topic);
-
-        // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
-        pointToSurfel[topic] = {};
-        auto &curPointToSurfel = pointToSurfel.at(topic);
-        bar = std::make_shared<tqdm>();
+        auto &curScans = scans[topic];
+        curScans.reserve(framesInMap.size());
         for (int i = 0; i < static_cast<int>(framesInMap.size()); ++i) {
-            bar->progress(i, static_cast<int>(framesInMap.size()));
-
             if (framesInMap.at(i) == nullptr || rawFrames.at(i) == nullptr) {
                 continue;
             }
+            curScans.emplace_back(framesInMap.at(i)->GetScan(), rawFrames.at(i)->GetScan());
+        }
+    }
+    auto corrsOfScans = PointToSurfelAssociation(associator, condition, scans);
 
-            auto ptsVec = associator->Association(framesInMap.at(i)->GetScan(),
-                                                  rawFrames.at(i)->GetScan(), condition);
-
-            curPointToSurfel.insert(curPointToSurfel.end(), ptsVec.cbegin(), ptsVec.cend());
+    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
+    std::size_t count = 0;
+    for (const auto &[topic, framesInMap] : undistFrames) {
+        const auto &rawFrames = _dataMagr->GetLiDARMeasurements(topic);
+        // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
+        auto &curPointToSurfel = pointToSurfel[topic];
+        for (const auto &corrs : corrsOfScans[topic]) {
+            AppendPointToSurfelOfScan(curPointToSurfel, corrs);
         }
-        bar->finish();
 
         // downsample
         int expectCount = ptsCountInEachScan * static_cast<int>(rawFrames.size());
-        if (static_cast<int>(curPointToSurfel.size()) > expectCount) {
-            std::map<ufo::map::Node, std::vector<PointToSurfelCorr::Ptr>> nodes;
-            for (const auto &corr : curPointToSurfel) {
-                nodes[corr->node].push_back(corr);
-            }
-            std::size_t numEachNode = expectCount / nodes.size() + 1;
-            curPointToSurfel.clear();
-
-            // uniform sampling
-            std::default_random_engine engine(
-                std::chrono::steady_clock::now().time_since_epoch().count());
-            for (const auto &[node, corrs] : nodes) {
-                auto newCorrs =
-                    SamplingWoutReplace2(engine, corrs, std::min(corrs.size(), numEachNode));
-                curPointToSurfel.insert(curPointToSurfel.end(), newCorrs.cbegin(), newCorrs.cend());
-            }
-        }
+        curPointToSurfel = DownsamplePointToSurfel(curPointToSurfel, expectCount);
         count += curPointToSurfel.size();
     }
     spdlog::info("total point to surfel count for LiDARs: {}", count);
@@ -388,49 +563,35 @@ std::map<std::string, std::vector<PointToSurfelCorrPtr>> CalibSolver::DataAssoci
     // deconstruction
     mapDownSampled.reset();
 
-    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
-
-    std::size_t count = 0;
-    std::shared_ptr<tqdm> bar;
+    std::map<std::string,
+             std::vector<std::pair<IKalibrPointCloud::ConstPtr, IKalibrPointCloud::ConstPtr>>>
+        scans;
     for (const auto &[topic, framesInMap] : scanInGFrame) {
-        spdlog::info("perform point to surfel association for rgbd '{}'...", topic);
-
-        // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
         const auto &rawFrames = scanInLFrame.at(topic);
-        auto &curPointToSurfel = pointToSurfel[topic];
-        bar = std::make_shared<tqdm>();
+        auto &curScans = scans[topic];
+        curScans.reserve(framesInMap.size());
         for (int i = 0; i < static_cast<int>(framesInMap.size()); ++i) {
-            bar->progress(i, static_cast<int>(framesInMap.size()));
-
             if (framesInMap.at(i) == nullptr || rawFrames.at(i) == nullptr) {
                 continue;
             }
+            curScans.emplace_back(framesInMap.at(i), rawFrames.at(i));
+        }
+    }
+    auto corrsOfScans = PointToSurfelAssociation(associator, condition, scans);
 
-            auto ptsVec = associator->Association(framesInMap.at(i), rawFrames.at(i), condition);
-
-            curPointToSurfel.insert(curPointToSurfel.end(), ptsVec.cbegin(), ptsVec.cend());
+    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
+    std::size_t count = 0;
+    for (const auto &[topic, framesInMap] : scanInGFrame) {
+        // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
+        const auto &rawFrames = scanInLFrame.at(topic);
+        auto &curPointToSurfel = pointToSurfel[topic];
+        for (const auto &corrs : corrsOfScans[topic]) {
+            curPointToSurfel.insert(curPointToSurfel.end(), corrs.cbegin(), corrs.cend());
         }
-        bar->finish();
 
         // downsample
         int expectCount = ptsCountInEachScan * static_cast<int>(rawFrames.size());
-        if (static_cast<int>(curPointToSurfel.size()) > expectCount) {
-            std::map<ufo::map::Node, std::vector<PointToSurfelCorr::Ptr>> nodes;
-            for (const auto &corr : curPointToSurfel) {
-                nodes[corr->node].push_back(corr);
-            }
-            std::size_t numEachNode = expectCount / nodes.size() + 1;
-            curPointToSurfel.clear();
-
-            // uniform sampling
-            std::default_random_engine engine(
-                std::chrono::steady_clock::now().time_since_epoch().count());
-            for (const auto &[node, corrs] : nodes) {
-                auto newCorrs =
-                    SamplingWoutReplace2(engine, corrs, std::min(corrs.size(), numEachNode));
-                curPointToSurfel.insert(curPointToSurfel.end(), newCorrs.cbegin(), newCorrs.cend());
-            }
-        }
+        curPointToSurfel = DownsamplePointToSurfel(curPointToSurfel, expectCount);
         count += curPointToSurfel.size();
     }
     spdlog::info("total point to surfel count for RGBDs: {}", count);
@@ -439,11 +600,199 @@ std::map<std::string, std::vector<PointToSurfelCorrPtr>> CalibSolver::DataAssoci
     return pointToSurfel;
 }
 
+std::map<std::string, std::vector<std::vector<PointToSurfelCorr::Ptr>>>
+CalibSolver::PointToSurfelAssociation(
+    const PointToSurfelAssociator::Ptr &associator,
+    const PointToSurfelCondition &condition,
+    const std::map<
+        std::string,
+        std::vector<std::pair<IKalibrPointCloud::ConstPtr, IKalibrPointCloud::ConstPtr>>> &scans) {
+    std::map<std::string, std::vector<std::vector<PointToSurfelCorr::Ptr>>> corrsOfScans;
+    for (const auto &[topic, curScans] : scans) {
+        corrsOfScans[topic].resize(curScans.size());
+    }
+
+    if (!IsOptionWith(SpeedUpOption::ParallelDataAssociation, Configor::Preference::SpeedUps)) {
+        for (const auto &[topic, curScans] : scans) {
+            spdlog::info("perform point to surfel association for '{}'...", topic);
+            auto &curCorrsOfScans = corrsOfScans.at(topic);
+            auto bar = std::make_shared<tqdm>();
+            for (int i = 0; i < static_cast<int>(curScans.size()); ++i) {
+                bar->progress(i, static_cast<int>(curScans.size()));
+                const auto &[scanInG, scanInL] = curScans.at(i);
+                curCorrsOfScans.at(i) = associator->Association(scanInG, scanInL, condition);
+            }
+            bar->finish();
+        }
+        return corrsOfScans;
+    }
+
+    // flatten scans of all sensors, so that threads are balanced over topics
+    std::vector<std::pair<std::string, std::size_t>> tasks;
+    for (const auto &[topic, curScans] : scans) {
+        for (std::size_t i = 0; i < curScans.size(); ++i) {
+            tasks.emplace_back(topic, i);
+        }
+    }
+    spdlog::info("perform point to surfel association for {} scans of {} sensors in parallel...",
+                 tasks.size(), scans.size());
+
+    /**
+     * each scan is associated by a single thread (the nested point-level parallel region in the
+     * associator is inactive here), and stored to its own buffer. The surfel map is only queried
+     * in this phase, thus no synchronization is required
+     */
+    std::vector<std::vector<PointToSurfelCorr::Ptr>> corrsOfTasks(tasks.size());
+    std::vector<std::exception_ptr> exceptions(tasks.size(), nullptr);
+    const int taskCount = static_cast<int>(tasks.size());
+    int finished = 0;
+    auto bar = std::make_shared<tqdm>();
+#pragma omp parallel for num_threads(Configor::Preference::AvailableThreads()) schedule(dynamic) \
+    default(none) \
+    shared(taskCount, tasks, scans, associator, condition, corrsOfTasks, exceptions, finished, bar)
+    for (int i = 0; i < taskCount; ++i) {
+        try {
+            const auto &[topic, idx] = tasks.at(i);
+            const auto &[scanInG, scanInL] = scans.at(topic).at(idx);
+            corrsOfTasks.at(i) = associator->Association(scanInG, scanInL, condition);
+        } catch (...) {
+            exceptions.at(i) = std::current_exception();
+        }
+#pragma omp critical
+        { bar->progress(finished++, taskCount); }
+    }
+    bar->finish();
+
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    for (int i = 0; i < taskCount; ++i) {
+        const auto &[topic, idx] = tasks.at(i);
+        corrsOfScans.at(topic).at(idx) = std::move(corrsOfTasks.at(i));
+    }
+    return corrsOfScans;
+}
+
+std::vector<PointToSurfelCorr::Ptr> CalibSolver::DownsamplePointToSurfel(
+    const std::vector<PointToSurfelCorr::Ptr> &corrs, int expectCount) {
+    if (static_cast<int>(corrs.size()) <= expectCount) {
+        return corrs;
+    }
+    std::map<ufo::map::Node, std::vector<PointToSurfelCorr::Ptr>> nodes;
+    for (const auto &corr : corrs) {
+        nodes[corr->node].push_back(corr);
+    }
+    std::size_t numEachNode = expectCount / nodes.size() + 1;
+
+    // uniform sampling
+    std::vector<PointToSurfelCorr::Ptr> sampled;
+    std::default_random_engine engine(std::chrono::steady_clock::now().time_since_epoch().count());
+    for (const auto &[node, nodeCorrs] : nodes) {
+        auto newCorrs =
+            SamplingWoutReplace2(engine, nodeCorrs, std::min(nodeCorrs.size(), numEachNode));
+        sampled.insert(sampled.end(), newCorrs.cbegin(), newCorrs.cend());
+    }
+    return sampled;
+}
+
+std::vector<PointToSurfelCorr::Ptr> CalibSolver::SelectInformativePointToSurfel(
+    const std::vector<PointToSurfelCorr::Ptr> &corrs, int budget) {
+    if (static_cast<int>(corrs.size()) <= budget) {
+        return corrs;
+    }
+    // the rotational information is computed around the center of the scan in the map
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    for (const auto &corr : corrs) {
+        center += corr->pInMap;
+    }
+    center /= static_cast<double>(corrs.size());
+
+    // bucket by the surfel and the quantized normal (sign-canonicalized), the correspondence with
+    // the max weight is the candidate of the bucket
+    constexpr double NORM_BIN = 0.25;
+    std::map<std::pair<ufo::map::Node, std::array<int, 3>>, PointToSurfelCorr::Ptr> buckets;
+    for (const auto &corr : corrs) {
+        Eigen::Vector3d norm = corr->surfelInW.head<3>();
+        int maxIdx;
+        norm.cwiseAbs().maxCoeff(&maxIdx);
+        if (norm(maxIdx) < 0.0) {
+            norm = -norm;
+        }
+        std::array<int, 3> normBin{};
+        for (int k = 0; k < 3; ++k) {
+            normBin.at(k) = static_cast<int>(std::round(norm(k) / NORM_BIN));
+        }
+        auto &candidate = buckets[{corr->node, normBin}];
+        if (candidate == nullptr || candidate->weight < corr->weight) {
+            candidate = corr;
+        }
+    }
+
+    // the jacobians of point-to-plane residuals w.r.t. [translation, rotation] of the scan
+    std::vector<PointToSurfelCorr::Ptr> candidates;
+    std::vector<Eigen::Matrix<double, 6, 1>> jacobians;
+    candidates.reserve(buckets.size()), jacobians.reserve(buckets.size());
+    for (const auto &[key, corr] : buckets) {
+        const Eigen::Vector3d norm = corr->surfelInW.head<3>();
+        Eigen::Matrix<double, 6, 1> jacobian;
+        jacobian << norm, (corr->pInMap - center).cross(norm);
+        candidates.push_back(corr);
+        jacobians.push_back(corr->weight * jacobian);
+    }
+    if (static_cast<int>(candidates.size()) <= budget) {
+        return candidates;
+    }
+
+    /**
+     * greedy log-det maximization, by the matrix determinant lemma, the gain of adding a
+     * candidate 'j' is 'log(1 + j^T * info^{-1} * j)', so the one with max 'j^T * cov * j' is taken
+     */
+    std::vector<PointToSurfelCorr::Ptr> selected;
+    selected.reserve(budget);
+    std::vector<bool> taken(candidates.size(), false);
+    Eigen::Matrix<double, 6, 6> info = 1E-6 * Eigen::Matrix<double, 6, 6>::Identity();
+    for (int k = 0; k < budget; ++k) {
+        const Eigen::Matrix<double, 6, 6> cov =
+            info.ldlt().solve(Eigen::Matrix<double, 6, 6>::Identity());
+        int bestIdx = -1;
+        double bestGain = -1.0;
+        for (int i = 0; i < static_cast<int>(candidates.size()); ++i) {
+            if (taken.at(i)) {
+                continue;
+            }
+            const double gain = jacobians.at(i).dot(cov * jacobians.at(i));
+            if (gain > bestGain) {
+                bestGain = gain, bestIdx = i;
+            }
+        }
+        taken.at(bestIdx) = true;
+        selected.push_back(candidates.at(bestIdx));
+        info += jacobians.at(bestIdx) * jacobians.at(bestIdx).transpose();
+    }
+    return selected;
+}
+
+void CalibSolver::AppendPointToSurfelOfScan(
+    std::vector<PointToSurfelCorr::Ptr> &dst,
+    const std::vector<PointToSurfelCorr::Ptr> &corrsOfScan) {
+    if (IsOptionWith(SpeedUpOption::InformativePointToSurfel, Configor::Preference::SpeedUps)) {
+        const auto selected = SelectInformativePointToSurfel(
+            corrsOfScan, Configor::Prior::LiDARDataAssociate::InformativePointToSurfelCountInScan);
+        dst.insert(dst.end(), selected.cbegin(), selected.cend());
+    } else {
+        dst.insert(dst.end(), corrsOfScan.cbegin(), corrsOfScan.cend());
+    }
+}
+
 std::map<std::string, std::vector<VisualReProjCorrSeq::Ptr>>
 CalibSolver::DataAssociationForPosCameras() const {
     if (!Configor::IsPosCameraIntegrated()) {
         return {};
     }
+    Profiler::Scope profile("DataAssociationForPosCameras");
 
     std::map<std::string, std::vector<VisualReProjCorrSeq::Ptr>> corrs;
     for (const auto &[topic, sfmData] : _dataMagr->GetSfMData()) {
@@ -495,6 +844,7 @@ std::vector<OpticalFlowTripleTrace::Ptr> CalibSolver::CreateOpticalFlowTrace(
 
 std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> CalibSolver::DataAssociationForRGBDs(
     bool estDepth) {
+    Profiler::Scope profile("DataAssociationForRGBDs");
     const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
     const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
 
@@ -637,6 +987,7 @@ std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> CalibSolver::DataAssoci
 
 std::map<std::string, std::vector<OpticalFlowCorr::Ptr>> CalibSolver::DataAssociationForVelCameras()
     const {
+    Profiler::Scope profile("DataAssociationForVelCameras");
     const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
     const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
 
@@ -866,6 +1217,7 @@ std::map<std::string, std::vector<OpticalFlowCorrPtr>> CalibSolver::DataAssociat
 
 std::map<std::string, std::vector<OpticalFlowCurveCorr::Ptr>>
 CalibSolver::DataAssociationForEventCameras(bool) const {
+    Profiler::Scope profile("DataAssociationForEventCameras");
     const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
     const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
 
@@ -0,0 +1,335 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "calib/calib_data_manager.h"
+#include "calib/calib_param_manager.h"
+#include "core/lidar_tiled_map.h"
+#include "core/pts_association.h"
+#include "core/scan_undistortion.h"
+#include "factor/data_correspondence.h"
+#include "pcl/filters/voxel_grid.h"
+#include "solver/calib_solver.h"
+#include "spdlog/spdlog.h"
+#include "util/cloud_define.hpp"
+#include "util/profiler.h"
+#include "viewer/viewer.h"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+std::pair<IKalibrPointCloud::Ptr, std::map<std::string, std::vector<PointToSurfelCorr::Ptr>>>
+CalibSolver::IncrementalDataAssociationForLiDARs(int ptsCountInEachScan) {
+    if (!Configor::IsLiDARIntegrated()) {
+        return {};
+    }
+    Profiler::Scope profile("IncrementalDataAssociationForLiDARs");
+
+    const auto condition = PointToSurfelCondition();
+
+    // lidar poses at the start, middle, and end of the scan under the current splines
+    auto curScanPoses = [this](const LiDARMapAsset::ScanState &state, const std::string &topic) {
+        return std::array<std::optional<Sophus::SE3d>, 3>{
+            CurLkToW(state.timeMin, topic), CurLkToW((state.timeMin + state.timeMax) * 0.5, topic),
+            CurLkToW(state.timeMax, topic)};
+    };
+
+    /**
+     * candidate surfels of a point are the ones containing it in depths ['QueryDepthMin',
+     * 'QueryDepthMax'], which all lie in the voxel of depth 'QueryDepthMax' containing it. Thus
+     * only points in voxels (of this depth) touched by erased or inserted points need to be
+     * re-associated. Voxels are identified by the codes of the surfel map itself
+     */
+    std::set<ufo::map::Code> touchedVoxels;
+    auto voxelOf = [this, depth = condition.queryDepthMax](float x, float y, float z) {
+        return _lidarMapAsset->associator->VoxelCode(x, y, z, depth);
+    };
+    auto touchVoxels = [&touchedVoxels, &voxelOf](const LiDARFrame::Ptr &frame) {
+        if (frame == nullptr) {
+            return;
+        }
+        for (const auto &p : frame->GetScan()->points) {
+            if (!IS_POS_NAN(p)) {
+                touchedVoxels.insert(voxelOf(p.x, p.y, p.z));
+            }
+        }
+    };
+
+    // scans (or part of scans) to be associated, and the indices of their states
+    std::map<std::string,
+             std::vector<std::pair<IKalibrPointCloud::ConstPtr, IKalibrPointCloud::ConstPtr>>>
+        scans;
+    std::map<std::string, std::vector<std::size_t>> scanIndices;
+
+    if (_lidarMapAsset == nullptr) {
+        // -----------------------------------------------------------------
+        // build the persistent surfel map from all undistorted scans (once)
+        // -----------------------------------------------------------------
+        std::map<std::string, std::vector<LiDARFrame::Ptr>> undistFrames;
+        _lidarMapAsset = std::make_shared<LiDARMapAsset>();
+        if (IsOptionWith(SpeedUpOption::TiledLiDARMap, Configor::Preference::SpeedUps)) {
+            // undistorted frames are kept, since they are erased from the surfel map later
+            auto tiledMap = BuildTiledGlobalMapOfLiDAR(&undistFrames);
+            _lidarMapAsset->associator = PointToSurfelAssociator::Create(
+                tiledMap, Configor::Prior::LiDARDataAssociate::MapResolution,
+                Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+        } else {
+            IKalibrPointCloud::Ptr map;
+            std::tie(map, undistFrames) = BuildGlobalMapOfLiDAR();
+            _lidarMapAsset->associator = PointToSurfelAssociator::Create(
+                map, Configor::Prior::LiDARDataAssociate::MapResolution,
+                Configor::Prior::LiDARDataAssociate::MapDepthLevels);
+        }
+
+        for (const auto &[topic, framesInMap] : undistFrames) {
+            const auto &rawFrames = _dataMagr->GetLiDARMeasurements(topic);
+            auto &states = _lidarMapAsset->scans[topic];
+            states.resize(framesInMap.size());
+            for (std::size_t i = 0; i < framesInMap.size(); ++i) {
+                auto &state = states.at(i);
+                const auto &rawScan = rawFrames.at(i)->GetScan();
+                state.timeMin = state.timeMax = rawFrames.at(i)->GetTimestamp();
+                state.rangeMax = 0.0;
+                bool first = true;
+                for (const auto &p : rawScan->points) {
+                    if (IS_POS_NAN(p)) {
+                        continue;
+                    }
+                    if (first) {
+                        state.timeMin = state.timeMax = p.timestamp, first = false;
+                    }
+                    state.timeMin = std::min(state.timeMin, static_cast<double>(p.timestamp));
+                    state.timeMax = std::max(state.timeMax, static_cast<double>(p.timestamp));
+                    state.rangeMax = std::max(
+                        state.rangeMax, Eigen::Vector3d(p.x, p.y, p.z).norm());
+                }
+                state.frameInMap = framesInMap.at(i);
+                state.SE3_LkToW = curScanPoses(state, topic);
+
+                if (state.frameInMap != nullptr) {
+                    scans[topic].emplace_back(state.frameInMap->GetScan(), rawScan);
+                    scanIndices[topic].push_back(i);
+                }
+            }
+        }
+    } else {
+        // ----------------------------------------------------------------
+        // re-undistort and re-insert scans moved under the updated splines
+        // ----------------------------------------------------------------
+        auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
+        const auto &associator = _lidarMapAsset->associator;
+
+        for (auto &[topic, states] : _lidarMapAsset->scans) {
+            const auto &rawFrames = _dataMagr->GetLiDARMeasurements(topic);
+
+            std::vector<std::size_t> movedIndices;
+            std::vector<LiDARFrame::Ptr> movedRawFrames;
+            std::vector<std::array<std::optional<Sophus::SE3d>, 3>> movedPoses;
+            for (std::size_t i = 0; i < states.size(); ++i) {
+                const auto &state = states.at(i);
+                auto poses = curScanPoses(state, topic);
+                // the upper bound of the movement of points in this scan
+                double movement = 0.0;
+                for (int j = 0; j < static_cast<int>(poses.size()); ++j) {
+                    const auto &oldPose = state.SE3_LkToW.at(j), &newPose = poses.at(j);
+                    if (oldPose == std::nullopt && newPose == std::nullopt) {
+                        continue;
+                    } else if (oldPose == std::nullopt || newPose == std::nullopt) {
+                        movement = std::numeric_limits<double>::infinity();
+                        break;
+                    }
+                    const double rot = (newPose->so3() * oldPose->so3().inverse()).log().norm();
+                    const double pos = (newPose->translation() - oldPose->translation()).norm();
+                    movement = std::max(movement, rot * state.rangeMax + pos);
+                }
+                if (movement > Configor::Prior::LiDARDataAssociate::ScanMovementMin) {
+                    movedIndices.push_back(i);
+                    // the scan of a compacted frame is converted once for undistortion and
+                    // association
+                    movedRawFrames.push_back(LiDARFrame::Decompacted(rawFrames.at(i)));
+                    movedPoses.push_back(poses);
+                }
+            }
+            spdlog::info("{} of {} scans of lidar '{}' moved, re-insert them to the surfel map...",
+                         movedIndices.size(), states.size(), topic);
+            if (movedIndices.empty()) {
+                continue;
+            }
+
+            auto undistFrames =
+                undistHelper->UndistortToRef(movedRawFrames, topic, ScanUndistortion::Option::ALL);
+            for (std::size_t j = 0; j < movedIndices.size(); ++j) {
+                auto &state = states.at(movedIndices.at(j));
+                // erase old points
+                touchVoxels(state.frameInMap);
+                if (state.frameInMap != nullptr) {
+                    associator->EraseCloud(state.frameInMap->GetScan());
+                }
+                // insert new points
+                state.frameInMap = undistFrames.at(j);
+                state.SE3_LkToW = movedPoses.at(j);
+                state.corrs.clear();
+                touchVoxels(state.frameInMap);
+                if (state.frameInMap != nullptr) {
+                    associator->InsertCloud(state.frameInMap->GetScan());
+                    scans[topic].emplace_back(state.frameInMap->GetScan(),
+                                              movedRawFrames.at(j)->GetScan());
+                    scanIndices[topic].push_back(movedIndices.at(j));
+                }
+            }
+        }
+
+        // -----------------------------------------------------------------------
+        // collect points of unmoved scans lying in touched voxels to re-associate
+        // -----------------------------------------------------------------------
+        std::size_t affectedCount = 0;
+        for (auto &[topic, states] : _lidarMapAsset->scans) {
+            if (touchedVoxels.empty()) {
+                break;
+            }
+            const auto &rawFrames = _dataMagr->GetLiDARMeasurements(topic);
+            // scans that are to be associated are the moved ones
+            std::set<std::size_t> moved(scanIndices[topic].cbegin(), scanIndices[topic].cend());
+            for (std::size_t i = 0; i < states.size(); ++i) {
+                auto &state = states.at(i);
+                if (state.frameInMap == nullptr || moved.count(i) != 0) {
+                    continue;
+                }
+                // remove correspondences whose surfels may be changed
+                auto iter = std::remove_if(
+                    state.corrs.begin(), state.corrs.end(),
+                    [&touchedVoxels, &voxelOf](const PointToSurfelCorr::Ptr &corr) {
+                        // 'pInMap' is converted from the float point losslessly
+                        const Eigen::Vector3f p = corr->pInMap.cast<float>();
+                        return touchedVoxels.count(voxelOf(p(0), p(1), p(2))) != 0;
+                    });
+                state.corrs.erase(iter, state.corrs.end());
+
+                // points lying in touched voxels
+                const auto &scanInG = state.frameInMap->GetScan();
+                std::vector<int> touchedIndices;
+                for (int k = 0; k < static_cast<int>(scanInG->size()); ++k) {
+                    const auto &p = scanInG->at(k);
+                    if (!IS_POS_NAN(p) && touchedVoxels.count(voxelOf(p.x, p.y, p.z)) != 0) {
+                        touchedIndices.push_back(k);
+                    }
+                }
+                if (touchedIndices.empty()) {
+                    continue;
+                }
+                // the raw scan is obtained for affected scans only, as the scans of compacted
+                // frames are converted on demand
+                const auto scanInL = rawFrames.at(i)->GetScan();
+                IKalibrPointCloud::Ptr subScanInG(new IKalibrPointCloud);
+                IKalibrPointCloud::Ptr subScanInL(new IKalibrPointCloud);
+                for (int k : touchedIndices) {
+                    subScanInG->push_back(scanInG->at(k));
+                    subScanInL->push_back(scanInL->at(k));
+                }
+                affectedCount += subScanInG->size();
+                scans[topic].emplace_back(subScanInG, subScanInL);
+                scanIndices[topic].push_back(i);
+            }
+        }
+        spdlog::info("{} points of unmoved scans lie in changed surfels, re-associate them...",
+                     affectedCount);
+    }
+
+    // ------------------------------------------------------
+    // perform data association for scans (or part of scans)
+    // ------------------------------------------------------
+    const auto &associator = _lidarMapAsset->associator;
+    auto corrsOfScans = PointToSurfelAssociation(associator, condition, scans);
+    for (auto &[topic, curCorrsOfScans] : corrsOfScans) {
+        auto &states = _lidarMapAsset->scans.at(topic);
+        const auto &indices = scanIndices.at(topic);
+        for (std::size_t j = 0; j < curCorrsOfScans.size(); ++j) {
+            auto &corrs = states.at(indices.at(j)).corrs;
+            corrs.insert(corrs.end(), curCorrsOfScans.at(j).cbegin(), curCorrsOfScans.at(j).cend());
+        }
+    }
+
+    // ---------------------------------------------------
+    // merge scans to the global map and visualize results
+    // ---------------------------------------------------
+    IKalibrPointCloud::Ptr mapCloud(new IKalibrPointCloud);
+    for (const auto &[topic, states] : _lidarMapAsset->scans) {
+        for (const auto &state : states) {
+            if (state.frameInMap != nullptr) {
+                *mapCloud += *state.frameInMap->GetScan();
+            }
+        }
+    }
+    IKalibrPointCloud::Ptr newMapCloud(new IKalibrPointCloud);
+    std::vector<int> index;
+    pcl::removeNaNFromPointCloud(*mapCloud, *newMapCloud, index);
+    mapCloud.reset();
+
+    pcl::VoxelGrid<IKalibrPoint> filter;
+    filter.setInputCloud(newMapCloud);
+    auto size = static_cast<float>(Configor::Prior::MapDownSample);
+    filter.setLeafSize(size, size, size);
+
+    IKalibrPointCloud::Ptr mapDownSampled(new IKalibrPointCloud);
+    filter.filter(*mapDownSampled);
+
+    _viewer->AddAlignedCloud(mapDownSampled, Viewer::VIEW_MAP, -_parMagr->GRAVITY.cast<float>(),
+                             2.0f);
+    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+    _viewer->AddSurfelMap(associator->GetSurfelMap(), condition, Viewer::VIEW_ASSOCIATION);
+    _viewer->AddCloud(mapDownSampled, Viewer::VIEW_ASSOCIATION,
+                      ns_viewer::Colour::Black().WithAlpha(0.2f), 2.0f);
+
+    // -----------------------------------------------------------------
+    // for each scan, we keep 'ptsCountInEachScan' point to surfel corrs
+    // -----------------------------------------------------------------
+    std::map<std::string, std::vector<PointToSurfelCorr::Ptr>> pointToSurfel;
+    std::size_t count = 0;
+    for (const auto &[topic, states] : _lidarMapAsset->scans) {
+        auto &curPointToSurfel = pointToSurfel[topic];
+        for (const auto &state : states) {
+            AppendPointToSurfelOfScan(curPointToSurfel, state.corrs);
+        }
+        int expectCount = ptsCountInEachScan * static_cast<int>(states.size());
+        curPointToSurfel = DownsamplePointToSurfel(curPointToSurfel, expectCount);
+        count += curPointToSurfel.size();
+    }
+    spdlog::info("total point to surfel count for LiDARs: {}", count);
+    _viewer->AddPointToSurfel(associator->GetSurfelMap(), pointToSurfel, Viewer::VIEW_ASSOCIATION);
+
+    return {newMapCloud, pointToSurfel};
+}
+}  // namespace ns_ikalibr
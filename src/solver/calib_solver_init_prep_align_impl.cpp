@@ -0,0 +1,158 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "solver/calib_solver.h"
+#include "calib/calib_param_manager.h"
+#include "spdlog/spdlog.h"
+#include "util/profiler.h"
+#include "util/utils_tpl.hpp"
+#include "viewer/viewer.h"
+#include "omp.h"
+#include "functional"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+
+void CalibSolver::InitPrepSensorInertialAlign() {
+    /**
+     * the preparations build and solve estimators on the shared splines and parameters, and update
+     * the viewer, thus they are performed one after another in the following order. The only
+     * independent and heavy work is the LiDAR odometry, which only involves parameters of LiDARs.
+     * If 'ParallelInitPrep' is enabled (and no spatiotemporal priori couples parameters of
+     * different sensors), it runs beside the camera preparations on a copy of the parameters, whose
+     * LiDAR rotations are merged afterwards. Its viewer updates are deferred and then performed by
+     * the calling thread, in the same order as the sequential processing
+     */
+    if (!IsOptionWith(SpeedUpOption::ParallelInitPrep, Configor::Preference::SpeedUps) ||
+        _priori != nullptr || !Configor::IsLiDARIntegrated()) {
+        const std::vector<std::pair<std::string, std::function<void()>>> tasks = {
+            // visual-inertial (pos scale spline based)
+            {"InitPrepPosCameraInertialAlign", [this] { InitPrepPosCameraInertialAlign(); }},
+            // visual-inertial (vel scale spline based)
+            {"InitPrepVelCameraInertialAlign", [this] { InitPrepVelCameraInertialAlign(); }},
+            // rgbd-inertial
+            {"InitPrepRGBDInertialAlign", [this] { InitPrepRGBDInertialAlign(); }},
+            // lidar-inertial
+            {"InitPrepLiDARInertialAlign", [this] { InitPrepLiDARInertialAlign(); }},
+            // radar-inertial
+            {"InitPrepRadarInertialAlign", [this] { InitPrepRadarInertialAlign(); }},
+            // inertial-inertial
+            {"InitPrepInertialInertialAlign", [this] { InitPrepInertialInertialAlign(); }},
+        };
+        for (const auto &[name, task] : tasks) {
+            Profiler::Scope profile(name);
+            task();
+        }
+        return;
+    }
+
+    spdlog::info("perform the LiDAR odometry beside the camera preparations...");
+    /**
+     * odometers and estimators in each preparation would spawn their own threads, nested regions
+     * (odometers of lidars, the undistortion, and the ndt) share 'AvailableThreads()' by
+     * 'AvailableThreadsInRegion()', rather than each spawning 'AvailableThreads()' threads
+     */
+    const int maxActiveLevels = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(maxActiveLevels, 3));
+
+    const auto lidarParMagr = std::make_shared<CalibParamManager>(*_parMagr);
+    std::vector<std::function<void()>> lidarViewerUpdates;
+    std::exception_ptr lidarException = nullptr, cameraException = nullptr;
+#pragma omp parallel sections num_threads(2) default(none) \
+    shared(lidarParMagr, lidarViewerUpdates, lidarException, cameraException)
+    {
+#pragma omp section
+        {
+            try {
+                Profiler::Scope profile("InitPrepLiDAROdometry");
+                InitPrepLiDAROdometry(lidarParMagr, &lidarViewerUpdates);
+            } catch (...) {
+                lidarException = std::current_exception();
+            }
+        }
+#pragma omp section
+        {
+            try {
+                {
+                    Profiler::Scope profile("InitPrepPosCameraInertialAlign");
+                    InitPrepPosCameraInertialAlign();
+                }
+                {
+                    Profiler::Scope profile("InitPrepVelCameraInertialAlign");
+                    InitPrepVelCameraInertialAlign();
+                }
+                {
+                    Profiler::Scope profile("InitPrepRGBDInertialAlign");
+                    InitPrepRGBDInertialAlign();
+                }
+            } catch (...) {
+                cameraException = std::current_exception();
+            }
+        }
+    }
+    omp_set_max_active_levels(maxActiveLevels);
+
+    // rethrow in the sequential order, so that the reported error is the same as the sequential
+    // processing
+    for (const auto &exception : {cameraException, lidarException}) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    // merge the recovered rotations of LiDARs, and then update the viewer in the sequential order
+    for (const auto &[topic, _] : Configor::DataStream::LiDARTopics) {
+        _parMagr->EXTRI.SO3_LkToBr.at(topic) = lidarParMagr->EXTRI.SO3_LkToBr.at(topic);
+    }
+    for (const auto &update : lidarViewerUpdates) {
+        update();
+    }
+
+    {
+        Profiler::Scope profile("InitPrepLiDARHandEyeAlign");
+        InitPrepLiDARHandEyeAlign();
+    }
+    {
+        Profiler::Scope profile("InitPrepRadarInertialAlign");
+        InitPrepRadarInertialAlign();
+    }
+    {
+        Profiler::Scope profile("InitPrepInertialInertialAlign");
+        InitPrepInertialInertialAlign();
+    }
+}
+}  // namespace ns_ikalibr
@@ -41,6 +41,7 @@
 #include "solver/calib_solver.h"
 #include "spdlog/spdlog.h"
 #include "util/tqdm.h"
+#include "util/utils_tpl.hpp"
 #include "viewer/viewer.h"
 
 namespace {
@@ -53,74 +54,159 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
     if (!Configor::IsLiDARIntegrated()) {
         return;
     }
+    InitPrepLiDAROdometry(_parMagr, nullptr);
+    InitPrepLiDARHandEyeAlign();
+}
+
+void CalibSolver::InitPrepLiDAROdometry(const CalibParamManager::Ptr &parMagr,
+                                        std::vector<std::function<void()>> *viewerUpdates) const {
+    if (!Configor::IsLiDARIntegrated()) {
+        return;
+    }
     const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
-    const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+
     /**
-     * we throw the head and tail data as the rotations from the fitted SO3 Spline in that range are
-     * poor
+     * the lidars are independent in the following two procedures, if the concurrent
+     * initialization is enabled, they would be performed in parallel (one thread for each lidar)
      */
-    const double st = std::max(so3Spline.MinTime(), scaleSpline.MinTime()) +  // the max as start
-                      Configor::Prior::TimeOffsetPadding;
-    const double et = std::min(so3Spline.MaxTime(), scaleSpline.MaxTime()) -  // the min as end
-                      Configor::Prior::TimeOffsetPadding;
+    const auto &lidarMes = _dataMagr->GetLiDARMeasurements();
+    std::vector<std::string> lidarTopics;
+    lidarTopics.reserve(lidarMes.size());
+    for (const auto &[topic, _] : lidarMes) {
+        lidarTopics.push_back(topic);
+    }
+    const int lidarThreads =
+        IsOptionWith(SpeedUpOption::ParallelInitPrep, Configor::Preference::SpeedUps)
+            ? static_cast<int>(lidarTopics.size())
+            : 1;
+    std::vector<std::exception_ptr> exceptions(lidarTopics.size(), nullptr);
+    // register scans coarse to fine in the odometers if the resolution pyramid is enabled
+    const int ndtPyramidLevels =
+        IsOptionWith(SpeedUpOption::MultiResolutionNDT, Configor::Preference::SpeedUps)
+            ? Configor::Prior::NDTLiDAROdometer::PyramidLevels
+            : 1;
+    // odometers of the first pass (on raw scans), kept to warm start the second pass
+    const bool warmStart =
+        IsOptionWith(SpeedUpOption::WarmStartLiDAROdometry, Configor::Preference::SpeedUps);
+    std::vector<LiDAROdometer::Ptr> rawOdometers(lidarTopics.size(), nullptr);
+    // the frame-by-frame visualization is only performed when the viewer is used in place serially
+    const bool viewFrames = viewerUpdates == nullptr && lidarThreads == 1;
+
+    /**
+     * viewer updates are performed in place, or deferred to the caller. Updates of lidars processed
+     * in parallel are kept per topic, and then performed (or deferred) in the topic order, so that
+     * the viewer is only touched by one thread and the colours of maps are deterministic
+     */
+    auto PerformViewerUpdate = [viewerUpdates](std::function<void()> update) {
+        if (viewerUpdates != nullptr) {
+            viewerUpdates->push_back(std::move(update));
+        } else {
+            update();
+        }
+    };
+    std::vector<std::vector<std::function<void()>>> lidarViewerUpdates(lidarTopics.size());
+    auto UpdateViewer = [lidarThreads, &lidarViewerUpdates, &PerformViewerUpdate](
+                            int k, std::function<void()> update) {
+        if (lidarThreads > 1) {
+            lidarViewerUpdates.at(k).push_back(std::move(update));
+        } else {
+            PerformViewerUpdate(std::move(update));
+        }
+    };
+    auto FlushViewerUpdates = [&lidarViewerUpdates, &PerformViewerUpdate]() {
+        for (auto &updates : lidarViewerUpdates) {
+            for (auto &update : updates) {
+                PerformViewerUpdate(std::move(update));
+            }
+            updates.clear();
+        }
+    };
 
     /**
      * we use the ndt to recover rotations of lidar scans and use them to recovce the extrinsisc
      * rotation of lidars
      */
     spdlog::info("LiDARs are integrated, initializing extrinsic rotations of LiDARs...");
-    for (const auto &[topic, data] : _dataMagr->GetLiDARMeasurements()) {
-        spdlog::info("performing ndt odometer for '{}' for extrinsic rotation initialization...",
-                     topic);
-
-        auto lidarOdometer = LiDAROdometer::Create(
-            // the resolution of ndt
-            static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
-            // the thread count to used
-            Configor::Preference::AvailableThreads());
-
-        auto rotEstimator = RotationEstimator::Create();
-        auto bar = std::make_shared<tqdm>();
-        for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-            bar->progress(i, static_cast<int>(data.size()));
-            // just for visualization
-            _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-            _viewer->AddAlignedCloud(data.at(i)->GetScan(), Viewer::VIEW_ASSOCIATION);
-
-            // run the lidar odometer(feed frame to ndt solver)
-            lidarOdometer->FeedFrame(data.at(i));
-
-            // we run rotation solver when frame size is 50, 55, 60, ...
-            if (lidarOdometer->FrameSize() < 50 || lidarOdometer->FrameSize() % 5 != 0) {
-                continue;
-            }
+#pragma omp parallel for num_threads(lidarThreads) schedule(dynamic) default(none) \
+    shared(lidarTopics, lidarMes, so3Spline, ndtPyramidLevels, warmStart, rawOdometers, \
+               exceptions, parMagr, viewFrames, UpdateViewer)
+    for (int k = 0; k < static_cast<int>(lidarTopics.size()); ++k) {
+        try {
+            const auto &topic = lidarTopics.at(k);
+            const auto &data = lidarMes.at(topic);
+            spdlog::info(
+                "performing ndt odometer for '{}' for extrinsic rotation initialization...", topic);
 
-            // estimate the rotation
-            rotEstimator->Estimate(so3Spline, lidarOdometer->GetOdomPoseVec());
+            auto lidarOdometer = LiDAROdometer::Create(
+                // the resolution of ndt
+                static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
+                // the thread count to used, which is shared by odometers run in parallel
+                Configor::Preference::AvailableThreadsInRegion(),
+                // the levels of the ndt resolution pyramid
+                ndtPyramidLevels);
+
+            auto rotEstimator = RotationEstimator::Create();
+            auto bar = std::make_shared<tqdm>();
+            for (int i = 0; i < static_cast<int>(data.size()); ++i) {
+                bar->progress(i, static_cast<int>(data.size()));
+                // just for visualization
+                if (viewFrames) {
+                    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+                    // the viewer takes a mutable cloud, while scans of frames are read-only
+                    _viewer->AddAlignedCloud(
+                        boost::make_shared<IKalibrPointCloud>(*data.at(i)->GetScan()),
+                        Viewer::VIEW_ASSOCIATION);
+                }
 
-            // check solver status
-            if (rotEstimator->SolveStatus()) {
-                // update extrinsic rotation from lidar to the reference imu
-                _parMagr->EXTRI.SO3_LkToBr.at(topic) = rotEstimator->GetSO3SensorToSpline();
-                // once we solve the rotation successfully, just break
-                bar->finish();
-                break;
+                // run the lidar odometer(feed frame to ndt solver)
+                lidarOdometer->FeedFrame(data.at(i));
+
+                // we run rotation solver when frame size is 50, 55, 60, ...
+                if (lidarOdometer->FrameSize() < 50 || lidarOdometer->FrameSize() % 5 != 0) {
+                    continue;
+                }
+
+                // estimate the rotation
+                rotEstimator->Estimate(so3Spline, lidarOdometer->GetOdomPoseVec());
+
+                // check solver status
+                if (rotEstimator->SolveStatus()) {
+                    // update extrinsic rotation from lidar to the reference imu
+                    parMagr->EXTRI.SO3_LkToBr.at(topic) = rotEstimator->GetSO3SensorToSpline();
+                    // once we solve the rotation successfully, just break
+                    bar->finish();
+                    break;
+                }
+            }
+            if (!rotEstimator->SolveStatus()) {
+                throw Status(Status::ERROR,
+                             "initialize rotation 'SO3_LkToBr' failed, this may be related to the "
+                             "'NDTResolution' of lidar odometer.");
+            } else {
+                spdlog::info("extrinsic rotation of '{}' is recovered using '{:06}' frames", topic,
+                             lidarOdometer->GetOdomPoseVec().size());
             }
+            if (warmStart) {
+                rawOdometers.at(k) = lidarOdometer;
+            }
+            // update viewer: add global map and update sensor spatiotemporal visualization
+            UpdateViewer(k, [this, map = lidarOdometer->GetMap()] {
+                _viewer->AddCloud(map, Viewer::VIEW_MAP, ns_viewer::Entity::GetUniqueColour(),
+                                  2.0f);
+                _viewer->UpdateSensorViewer();
+            });
+        } catch (...) {
+            exceptions.at(k) = std::current_exception();
         }
-        if (!rotEstimator->SolveStatus()) {
-            throw Status(Status::ERROR,
-                         "initialize rotation 'SO3_LkToBr' failed, this may be related to the "
-                         "'NDTResolution' of lidar odometer.");
-        } else {
-            spdlog::info("extrinsic rotation of '{}' is recovered using '{:06}' frames", topic,
-                         lidarOdometer->GetOdomPoseVec().size());
+    }
+    // rethrow in the topic order, so that the reported error is the same as the sequential one
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
         }
-        // update viewer: add global map and update sensor spatiotemporal visualization
-        _viewer->AddCloud(lidarOdometer->GetMap(), Viewer::VIEW_MAP,
-                          ns_viewer::Entity::GetUniqueColour(), 2.0f);
-        _viewer->UpdateSensorViewer();
     }
-    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+    FlushViewerUpdates();
+    PerformViewerUpdate([this] { _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION); });
 
     /**
      * once the extrinsic rotations are recovered, we use the prior rotations to undistort lidar
@@ -128,68 +214,142 @@ void CalibSolver::InitPrepLiDARInertialAlign() const {
      */
     auto &lidarOdometers = _initAsset->lidarOdometers;
     auto &undistFramesInScan = _initAsset->undistFramesInScan;
-    auto undistHelper = ScanUndistortion::Create(_splines, _parMagr);
-
-    for (const auto &[topic, data] : _dataMagr->GetLiDARMeasurements()) {
-        spdlog::info("undistort scans for lidar '{}'...", topic);
-
-        // undistort rotation only using 'UNDIST_SO3' in initialization
-        undistFramesInScan[topic] = undistHelper->UndistortToScan(
-            // raw lidar scans
-            data,
-            // the ros topic
-            topic, ScanUndistortion::Option::UNDIST_SO3);
-
-        spdlog::info("rerun odometer for lidar '{}' using undistorted scans...", topic);
-
-        lidarOdometers[topic] = LiDAROdometer::Create(
-            // resolution of ndt
-            static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
-            // the thread count for solving
-            Configor::Preference::AvailableThreads());
-
-        const auto &undistFrames = undistFramesInScan.at(topic);
-        auto bar = std::make_shared<tqdm>();
-        for (int i = 0; i < static_cast<int>(undistFrames.size()); ++i) {
-            bar->progress(i, static_cast<int>(undistFrames.size()));
-
-            // clear the viewer
-            _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-            _viewer->AddAlignedCloud(data.at(i)->GetScan(), Viewer::VIEW_ASSOCIATION);
-
-            auto curUndistFrame = undistFrames.at(i);
-            // we compute the prior rotation from the estimated rotation spline and extrinsics
-            Eigen::Matrix4d predCurToLast = Eigen::Matrix4d::Identity();
-            if (i == 0) {
-                predCurToLast = Eigen::Matrix4d::Identity();
-            } else {
-                auto lastUndistFrame = undistFrames.at(i - 1);
+    auto undistHelper = ScanUndistortion::Create(_splines, parMagr);
+    // create the entries in advance, so that the maps would not be reorganized in parallel
+    for (const auto &topic : lidarTopics) {
+        lidarOdometers[topic] = nullptr;
+        undistFramesInScan[topic] = {};
+    }
 
-                if (curUndistFrame == nullptr || lastUndistFrame == nullptr) {
-                    continue;
-                }
+#pragma omp parallel for num_threads(lidarThreads) schedule(dynamic) default(none) \
+    shared(lidarTopics, lidarMes, lidarOdometers, undistFramesInScan, undistHelper, \
+               ndtPyramidLevels, warmStart, rawOdometers, exceptions, parMagr, viewFrames, \
+               UpdateViewer)
+    for (int k = 0; k < static_cast<int>(lidarTopics.size()); ++k) {
+        try {
+            const auto &topic = lidarTopics.at(k);
+            const auto &data = lidarMes.at(topic);
+            spdlog::info("undistort scans for lidar '{}'...", topic);
 
-                auto curLtoRef = this->CurLkToW(curUndistFrame->GetTimestamp(), topic);
-                auto lastLtoRef = this->CurLkToW(lastUndistFrame->GetTimestamp(), topic);
+            // undistort rotation only using 'UNDIST_SO3' in initialization
+            auto &undistFrames = undistFramesInScan.at(topic);
+            undistFrames = undistHelper->UndistortToScan(
+                // raw lidar scans
+                data,
+                // the ros topic
+                topic, ScanUndistortion::Option::UNDIST_SO3);
 
-                // if query pose successfully
-                if (curLtoRef && lastLtoRef) {
-                    Sophus::SO3d SO3_CurToLast = lastLtoRef->so3().inverse() * curLtoRef->so3();
-                    // note that the translation has not been initialized
-                    predCurToLast = ns_ctraj::Posed(SO3_CurToLast, Eigen::Vector3d::Zero()).T();
-                } else {
+            spdlog::info("rerun odometer for lidar '{}' using undistorted scans...", topic);
+
+            auto &lidarOdometer = lidarOdometers.at(topic);
+            lidarOdometer = LiDAROdometer::Create(
+                // resolution of ndt
+                static_cast<float>(Configor::Prior::NDTLiDAROdometer::Resolution),
+                // the thread count for solving, which is shared by odometers run in parallel
+                Configor::Preference::AvailableThreadsInRegion(),
+                // the levels of the ndt resolution pyramid
+                ndtPyramidLevels);
+
+            auto bar = std::make_shared<tqdm>();
+            for (int i = 0; i < static_cast<int>(undistFrames.size()); ++i) {
+                bar->progress(i, static_cast<int>(undistFrames.size()));
+
+                // clear the viewer
+                if (viewFrames) {
+                    _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+                    // the viewer takes a mutable cloud, while scans of frames are read-only
+                    _viewer->AddAlignedCloud(
+                        boost::make_shared<IKalibrPointCloud>(*data.at(i)->GetScan()),
+                        Viewer::VIEW_ASSOCIATION);
+                }
+
+                auto curUndistFrame = undistFrames.at(i);
+                // we compute the prior rotation from the estimated rotation spline and extrinsics
+                Eigen::Matrix4d predCurToLast = Eigen::Matrix4d::Identity();
+                if (i == 0) {
                     predCurToLast = Eigen::Matrix4d::Identity();
+                } else {
+                    auto lastUndistFrame = undistFrames.at(i - 1);
+
+                    if (curUndistFrame == nullptr || lastUndistFrame == nullptr) {
+                        continue;
+                    }
+
+                    // the spatiotemporal parameters are the ones in 'parMagr'
+                    const double TO_LkToBr = parMagr->TEMPORAL.TO_LkToBr.at(topic);
+                    const Sophus::SO3d &SO3_LkToBr = parMagr->EXTRI.SO3_LkToBr.at(topic);
+                    auto curBrToW = _poseCache->BrToW(curUndistFrame->GetTimestamp() + TO_LkToBr);
+                    auto lastBrToW = _poseCache->BrToW(lastUndistFrame->GetTimestamp() + TO_LkToBr);
+
+                    // if query pose successfully
+                    if (curBrToW && lastBrToW) {
+                        Sophus::SO3d SO3_CurToLast = (lastBrToW->so3() * SO3_LkToBr).inverse() *
+                                                     curBrToW->so3() * SO3_LkToBr;
+                        // note that the translation has not been initialized
+                        predCurToLast =
+                            ns_ctraj::Posed(SO3_CurToLast, Eigen::Vector3d::Zero()).T();
+                    } else {
+                        predCurToLast = Eigen::Matrix4d::Identity();
+                    }
+
+                    if (warmStart) {
+                        const double lastTime = lastUndistFrame->GetTimestamp();
+                        const double curTime = curUndistFrame->GetTimestamp();
+                        // the translation is warm started using the pose of the first pass
+                        auto relPose = rawOdometers.at(k)->GetRelativePose(lastTime, curTime);
+                        // otherwise, using the motion of the last frame in this pass
+                        if (relPose == std::nullopt && i > 1 && undistFrames.at(i - 2) != nullptr) {
+                            const double prevTime = undistFrames.at(i - 2)->GetTimestamp();
+                            relPose = lidarOdometer->GetRelativePose(prevTime, lastTime);
+                            if (relPose != std::nullopt) {
+                                // constant velocity
+                                relPose->block<3, 1>(0, 3) *=
+                                    (curTime - lastTime) / (lastTime - prevTime);
+                            }
+                        }
+                        if (relPose != std::nullopt) {
+                            predCurToLast.block<3, 1>(0, 3) = relPose->block<3, 1>(0, 3);
+                        }
+                    }
                 }
+                lidarOdometer->FeedFrame(curUndistFrame, predCurToLast, i < 100);
             }
-            lidarOdometers.at(topic)->FeedFrame(curUndistFrame, predCurToLast, i < 100);
+            bar->finish();
+
+            // update the viewer, add global lidar map
+            UpdateViewer(k, [this, map = lidarOdometer->GetMap()] {
+                _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
+                _viewer->AddCloud(map, Viewer::VIEW_MAP, ns_viewer::Entity::GetUniqueColour(),
+                                  2.0f);
+            });
+        } catch (...) {
+            exceptions.at(k) = std::current_exception();
+        }
+    }
+    for (const auto &exception : exceptions) {
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
         }
-        bar->finish();
+    }
+    rawOdometers.clear();
+    FlushViewerUpdates();
+}
 
-        // update the viewer, add global lidar map
-        _viewer->ClearViewer(Viewer::VIEW_ASSOCIATION);
-        _viewer->AddCloud(lidarOdometers.at(topic)->GetMap(), Viewer::VIEW_MAP,
-                          ns_viewer::Entity::GetUniqueColour(), 2.0f);
+void CalibSolver::InitPrepLiDARHandEyeAlign() const {
+    if (!Configor::IsLiDARIntegrated()) {
+        return;
     }
+    const auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+    const auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+    /**
+     * we throw the head and tail data as the rotations from the fitted SO3 Spline in that range are
+     * poor
+     */
+    const double st = std::max(so3Spline.MinTime(), scaleSpline.MinTime()) +  // the max as start
+                      Configor::Prior::TimeOffsetPadding;
+    const double et = std::min(so3Spline.MaxTime(), scaleSpline.MaxTime()) -  // the min as end
+                      Configor::Prior::TimeOffsetPadding;
+    const auto &lidarOdometers = _initAsset->lidarOdometers;
 
     /**
      * based the more accurate rotations, we refine initialized extrinsic rotations. if time offsets
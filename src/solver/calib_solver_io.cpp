@@ -35,6 +35,7 @@
 #include "calib/calib_data_manager.h"
 #include "calib/calib_param_manager.h"
 #include "calib/estimator.h"
+#include "core/lidar_tiled_map.h"
 #include "cereal/types/list.hpp"
 #include "cereal/types/utility.hpp"
 #include "factor/data_correspondence.h"
@@ -241,6 +242,7 @@ void CalibSolverIO::SaveHessianMatrix() const {
     for (auto &[topic, item] : _solver->_parMagr->TEMPORAL.RS_READOUT) {
         InvolveParameter(&item, "RS_READOUT-" + topic);
     }
+    const auto spatTempCount = parAddress.size();
 
     // intrinsics
     for (auto &[topic, intri] : _solver->_parMagr->INTRI.IMU) {
@@ -286,6 +288,31 @@ void CalibSolverIO::SaveHessianMatrix() const {
         ar, Configor::Preference::OutputDataFormat, cereal::make_nvp("row", hessianMat.rows()),
         cereal::make_nvp("col", hessianMat.cols()), cereal::make_nvp("hessian", hessianMat),
         cereal::make_nvp("par_order_size", parOrderSize));
+
+    /**
+     * standard deviations of spatiotemporal parameters (in tangent spaces), the marginal
+     * covariance is obtained from the sparse hessian of the whole problem, in which all other
+     * parameters (knots, intrinsics, landmarks, ...) are marginalized
+     */
+    std::vector<double *> spatTempAddress(parAddress.cbegin(),
+                                          parAddress.cbegin() + spatTempCount);
+    auto covMat =
+        estimator->GetMarginalCovariance(spatTempAddress, Configor::Preference::AvailableThreads());
+    std::vector<std::pair<std::string, std::vector<double>>> parStdDev;
+    for (int i = 0, offset = 0; i < static_cast<int>(spatTempCount); ++i) {
+        const auto &[name, size] = parOrderSize.at(i);
+        std::vector<double> stdDev(size);
+        for (int j = 0; j < size; ++j) {
+            stdDev.at(j) = std::sqrt(std::max(covMat(offset + j, offset + j), 0.0));
+        }
+        parStdDev.emplace_back(name, stdDev);
+        offset += size;
+    }
+    filename = saveDir + "/marginal_std_dev" + Configor::GetFormatExtension();
+    std::ofstream stdDevFile(filename);
+    auto stdDevAr = GetOutputArchiveVariant(stdDevFile, Configor::Preference::OutputDataFormat);
+    SerializeByOutputArchiveVariant(stdDevAr, Configor::Preference::OutputDataFormat,
+                                    cereal::make_nvp("par_std_dev", parStdDev));
     spdlog::info("saving hessian matrix finished!");
 }
 
@@ -305,7 +332,7 @@ void CalibSolverIO::VerifyVisualLiDARConsistency() const {
         return;
     }
 
-    auto covisibility = VisualLiDARCovisibility::Create(_solver->_backup->lidarMap);
+    auto covisibility = VisualLiDARCovisibility::Create(GetLiDARMap());
     // for cameras
     std::shared_ptr<tqdm> bar;
     for (const auto &[topic, _] : Configor::DataStream::CameraTopics) {
@@ -682,6 +709,7 @@ void CalibSolverIO::SaveVisualColorizedMap() const {
     } else {
         return;
     }
+    const auto lidarMap = GetLiDARMap();
 
     // cameras
     for (const auto &[topic, _] : Configor::DataStream::PosCameraTopics()) {
@@ -697,7 +725,7 @@ void CalibSolverIO::SaveVisualColorizedMap() const {
         const auto shader = ColorizedCloudMap::CreateForCameras(
             topic, frames, _solver->_dataMagr->GetSfMData(topic), _solver->_splines,
             _solver->_parMagr);
-        auto colorizedMap = shader->Colorize(_solver->_backup->lidarMap);
+        auto colorizedMap = shader->Colorize(lidarMap);
         auto filename = subSaveDir + "/colorized_map.pcd";
         if (pcl::io::savePCDFile(filename, *colorizedMap, true) == -1) {
             spdlog::warn("save colorized map as : '{}' failed!", filename);
@@ -748,7 +776,7 @@ void CalibSolverIO::SaveVisualColorizedMap() const {
                 topic);
         }
 
-        auto colorizedMap = shader->Colorize(_solver->_backup->lidarMap);
+        auto colorizedMap = shader->Colorize(lidarMap);
         auto filename = subSaveDir + "/colorized_map.pcd";
         if (pcl::io::savePCDFile(filename, *colorizedMap, true) == -1) {
             spdlog::warn("save colorized map as : '{}' failed!", filename);
@@ -1048,6 +1076,20 @@ void CalibSolverIO::SaveLiDARMaps() const {
         // deconstruct
         surfelCloud.reset();
 
+        if (_solver->_backup->lidarTiledMap != nullptr) {
+            // save tiles one by one, rather than assembling a single unwieldy map
+            auto tileSaveDir = subSaveDir + "/tiles";
+            if (!TryCreatePath(tileSaveDir)) {
+                spdlog::warn("create sub directory to save lidar map tiles failed: '{}'",
+                             tileSaveDir);
+                return;
+            }
+            spdlog::info("save global lidar map tiles...");
+            auto count = _solver->_backup->lidarTiledMap->SaveTiles(tileSaveDir);
+            spdlog::info("save {} global lidar map tiles to '{}'", count, tileSaveDir);
+            return;
+        }
+
         filename = subSaveDir + "/gravity_aligned_map.pcd";
 
         // create colorized map by aligning to the gravity
@@ -1065,6 +1107,14 @@ void CalibSolverIO::SaveLiDARMaps() const {
     }
 }
 
+IKalibrPointCloud::Ptr CalibSolverIO::GetLiDARMap() const {
+    if (_solver->_backup->lidarMap == nullptr && _solver->_backup->lidarTiledMap != nullptr) {
+        // assemble the whole (down sampled) map from tiles
+        return _solver->_backup->lidarTiledMap->ToCloud();
+    }
+    return _solver->_backup->lidarMap;
+}
+
 void CalibSolverIO::SaveVisualMaps() const {
     if (CalibSolver::GetScaleType() != TimeDeriv::ScaleSplineType::LIN_POS_SPLINE) {
         return;
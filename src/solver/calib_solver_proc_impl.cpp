@@ -36,6 +36,7 @@
 #include "factor/point_to_surfel_factor.hpp"
 #include "solver/batch_opt_option.hpp"
 #include "solver/calib_solver.h"
+#include "util/profiler.h"
 #include "util/utils_tpl.hpp"
 #include "viewer/viewer.h"
 
@@ -58,7 +59,10 @@ void CalibSolver::Process() {
      * gyroscope. If multiple gyroscopes (IMUs) are involved, the extrinsic rotations and time
      * offsets would be also recovered
      */
-    this->InitSO3Spline();
+    {
+        Profiler::Scope profile("InitSO3Spline");
+        this->InitSO3Spline();
+    }
     if (outputParams) {
         SaveStageCalibParam(_parMagr, "stage_1_rot_fit");
     }
@@ -68,18 +72,20 @@ void CalibSolver::Process() {
      * for each type of sensor, the preparation is first performed to obtain necessary quantities
      * for one-shot sensor-inertial alignment
      */
-    this->InitPrepPosCameraInertialAlign();  // visual-inertial (pos scale spline based)
-    this->InitPrepVelCameraInertialAlign();  // visual-inertial (vel scale spline based)
-    this->InitPrepRGBDInertialAlign();       // rgbd-inertial
-    this->InitPrepLiDARInertialAlign();      // lidar-inertial
-    this->InitPrepRadarInertialAlign();      // radar-inertial
-    this->InitPrepInertialInertialAlign();   // inertial-inertial
+    // visual-inertial, rgbd-inertial, lidar-inertial, radar-inertial, and inertial-inertial
+    {
+        Profiler::Scope profile("InitPrepSensorInertialAlign");
+        this->InitPrepSensorInertialAlign();
+    }
 
     // this->InitPrepEventInertialAlign();        // point-based optical flow event-inertial
     // this->InitPrepEventInertialAlignLineBased();  // line-based norm flow event-inertial
     // this->InitPrepEventInertialAlignCircleBased();  // circle-based norm flow event-inertial
 
-    this->InitSensorInertialAlign();  // one-shot sensor-inertial alignment
+    {
+        Profiler::Scope profile("InitSensorInertialAlign");
+        this->InitSensorInertialAlign();  // one-shot sensor-inertial alignment
+    }
 
     if (outputParams) {
         SaveStageCalibParam(_parMagr, "stage_2_align");
@@ -88,7 +94,10 @@ void CalibSolver::Process() {
     /**
      * recover the linear scale spline using quantities from the one-shot sensor-inertial alignment
      */
-    this->InitScaleSpline();
+    {
+        Profiler::Scope profile("InitScaleSpline");
+        this->InitScaleSpline();
+    }
 
     if (outputParams) {
         SaveStageCalibParam(_parMagr, "stage_3_scale_fit");
@@ -98,7 +107,10 @@ void CalibSolver::Process() {
      * this is the end of the initialization procedure, also the start of the batch optimizaion.
      * some preparation operatiors would be performed here
      */
-    this->InitPrepBatchOpt();
+    {
+        Profiler::Scope profile("InitPrepBatchOpt");
+        this->InitPrepBatchOpt();
+    }
 
     /**
      * once the initialization procedure is finished, we print the recovered spatiotemporal
@@ -138,6 +150,15 @@ void CalibSolver::Process() {
                 // undistorted frame expressed in the global map
                 _initAsset->undistFramesInMap, ptsCountInEachScan);
             _initAsset = nullptr;  // deconstruct data from initialization
+        } else if (IsOptionWith(SpeedUpOption::IncrementalDataAssociation,
+                                Configor::Preference::SpeedUps)) {
+            // only scans moved under the updated splines are re-inserted and re-associated
+            lidarPtsCorr = IncrementalDataAssociationForLiDARs(ptsCountInEachScan).second;
+        } else if (IsOptionWith(SpeedUpOption::TiledLiDARMap, Configor::Preference::SpeedUps)) {
+            // scans are undistorted and associated one by one against the out-of-core map
+            auto curTiledMap = BuildTiledGlobalMapOfLiDAR();
+            lidarPtsCorr = DataAssociationForLiDARs(curTiledMap, ptsCountInEachScan);
+            // 'curTiledMap' (and its spilled tiles) would be deconstructed here
         } else {
             auto [curGlobalMap, curUndistFramesInMap] = BuildGlobalMapOfLiDAR();
             lidarPtsCorr = DataAssociationForLiDARs(
@@ -244,13 +265,26 @@ void CalibSolver::Process() {
     _viewer->ClearViewer(Viewer::VIEW_MAP);
     if (Configor::IsLiDARIntegrated()) {
         spdlog::info("build final lidar map and point-to-surfel correspondences...");
-        // aligned map
-        const auto final = BuildGlobalMapOfLiDAR();
-        _backup->lidarMap = std::get<0>(final);
-        // use large 'ptsCountInEachScan' to keep all point-to-surfel corrs
-        // lidar map and corr map would be added to the viewer in this function
-        _backup->lidarCorrs =
-            DataAssociationForLiDARs(std::get<0>(final), std::get<1>(final), 100000);
+        if (IsOptionWith(SpeedUpOption::IncrementalDataAssociation,
+                         Configor::Preference::SpeedUps)) {
+            // use large 'ptsCountInEachScan' to keep all point-to-surfel corrs
+            std::tie(_backup->lidarMap, _backup->lidarCorrs) =
+                IncrementalDataAssociationForLiDARs(100000);
+            _lidarMapAsset = nullptr;
+        } else if (IsOptionWith(SpeedUpOption::TiledLiDARMap, Configor::Preference::SpeedUps)) {
+            // the tiled map is kept, by-products consume it tile by tile
+            _backup->lidarTiledMap = BuildTiledGlobalMapOfLiDAR();
+            // use large 'ptsCountInEachScan' to keep all point-to-surfel corrs
+            _backup->lidarCorrs = DataAssociationForLiDARs(_backup->lidarTiledMap, 100000);
+        } else {
+            // aligned map
+            const auto final = BuildGlobalMapOfLiDAR();
+            _backup->lidarMap = std::get<0>(final);
+            // use large 'ptsCountInEachScan' to keep all point-to-surfel corrs
+            // lidar map and corr map would be added to the viewer in this function
+            _backup->lidarCorrs =
+                DataAssociationForLiDARs(std::get<0>(final), std::get<1>(final), 100000);
+        }
     }
     if (Configor::IsRadarIntegrated() && GetScaleType() == TimeDeriv::LIN_POS_SPLINE) {
         spdlog::info("build final radar map...");
@@ -0,0 +1,140 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "util/profiler.h"
+#include "cereal/archives/json.hpp"
+#include "cereal/types/vector.hpp"
+#include "spdlog/spdlog.h"
+#include "filesystem"
+#include "fstream"
+#include "algorithm"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+std::mutex Profiler::_mutex = {};
+std::vector<ProfileRecord> Profiler::_records = {};
+const std::chrono::steady_clock::time_point Profiler::_origin = std::chrono::steady_clock::now();
+
+Profiler::Scope::Scope(std::string stage)
+    : _wallStart(std::chrono::steady_clock::now()),
+      _cpuStart(std::clock()) {
+    _record.stage = std::move(stage);
+    _record.startTime = ElapsedTime();
+}
+
+Profiler::Scope &Profiler::Scope::AddMetric(const std::string &key, double value) {
+    _record.metrics[key] = value;
+    return *this;
+}
+
+Profiler::Scope::~Scope() {
+    _record.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - _wallStart)
+                           .count();
+    _record.cpuTime = static_cast<double>(std::clock() - _cpuStart) / CLOCKS_PER_SEC;
+    std::tie(_record.rss, _record.peakRSS) = ResidentSetSize();
+    Commit(std::move(_record));
+}
+
+void Profiler::Commit(ProfileRecord record) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    record.index = static_cast<int>(
+        std::count_if(_records.cbegin(), _records.cend(),
+                      [&record](const ProfileRecord &r) { return r.stage == record.stage; }));
+    spdlog::debug(
+        "profile stage '{}-{}': wall time {:.3f} (s), cpu time {:.3f} (s), peak rss {:.1f} (MB)",
+        record.stage, record.index, record.wallTime, record.cpuTime, record.peakRSS);
+    _records.push_back(std::move(record));
+}
+
+std::vector<ProfileRecord> Profiler::GetRecords() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _records;
+}
+
+std::pair<double, double> Profiler::ResidentSetSize() {
+    // 'VmRSS' and 'VmHWM' are in kB, zeros would be returned on the non-linux platform
+    double rss = 0.0, peakRSS = 0.0;
+    std::ifstream file("/proc/self/status");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            rss = std::stod(line.substr(6)) / 1024.0;
+        } else if (line.rfind("VmHWM:", 0) == 0) {
+            peakRSS = std::stod(line.substr(6)) / 1024.0;
+        }
+    }
+    return {rss, peakRSS};
+}
+
+double Profiler::ElapsedTime() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - _origin).count();
+}
+
+void Profiler::SaveReport(const std::string &saveDir) {
+    if (!std::filesystem::exists(saveDir) && !std::filesystem::create_directories(saveDir)) {
+        spdlog::warn("create directory failed: '{}', the profile report would not be saved",
+                     saveDir);
+        return;
+    }
+    spdlog::info("saving profile report to dir: '{}'...", saveDir);
+    const auto records = GetRecords();
+    {
+        std::ofstream file(saveDir + "/profile.json");
+        cereal::JSONOutputArchive ar(file);
+        ar(cereal::make_nvp("time_unit", std::string("s")),
+           cereal::make_nvp("memory_unit", std::string("MB")), cereal::make_nvp("stages", records));
+    }
+    {
+        std::ofstream file(saveDir + "/stages.csv");
+        file << "stage,index,start_time,wall_time,cpu_time,rss,peak_rss\n";
+        for (const auto &r : records) {
+            file << fmt::format("{},{},{:.6f},{:.6f},{:.6f},{:.3f},{:.3f}\n", r.stage, r.index,
+                                r.startTime, r.wallTime, r.cpuTime, r.rss, r.peakRSS);
+        }
+    }
+    {
+        std::ofstream file(saveDir + "/metrics.csv");
+        file << "stage,index,metric,value\n";
+        for (const auto &r : records) {
+            for (const auto &[key, value] : r.metrics) {
+                file << fmt::format("{},{},{},{}\n", r.stage, r.index, key, value);
+            }
+        }
+    }
+    spdlog::info("saving profile report finished!");
+}
+}  // namespace ns_ikalibr
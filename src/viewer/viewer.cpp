@@ -81,12 +81,14 @@ std::shared_ptr<Viewer> ns_ikalibr::Viewer::Create(const CalibParamManager::Ptr
 }
 
 Viewer &Viewer::UpdateSensorViewer() {
+    std::lock_guard<std::recursive_mutex> lock(_entityMutex);
     ClearViewer(VIEW_SENSORS);
     _entities.at(VIEW_SENSORS) = _parMagr->VisualizationSensors(*this, VIEW_SENSORS);
     return *this;
 }
 
 Viewer &Viewer::UpdateSplineViewer(double dt) {
+    std::lock_guard<std::recursive_mutex> lock(_entityMutex);
     ClearViewer(VIEW_SPLINE);
 
     // spline poses
@@ -190,6 +192,7 @@ ns_viewer::MultiViewerConfigor Viewer::GenViewerConfigor() {
 }
 
 Viewer &Viewer::ClearViewer(const std::string &view) {
+    std::lock_guard<std::recursive_mutex> lock(_entityMutex);
     this->RemoveEntity(_entities.at(view), view);
     _entities.at(view).clear();
     return *this;
@@ -293,6 +296,7 @@ Viewer &Viewer::AddPointToSurfel(
 }
 
 Viewer &Viewer::PopBackEntity(const std::string &view) {
+    std::lock_guard<std::recursive_mutex> lock(_entityMutex);
     auto &curEntities = _entities.at(view);
     if (!curEntities.empty()) {
         this->RemoveEntity(curEntities.back(), view);
@@ -342,6 +346,7 @@ Viewer &Viewer::AddVeta(const ns_veta::Veta::Ptr &veta,
 
 Viewer &Viewer::AddEntityLocal(const std::vector<ns_viewer::Entity::Ptr> &entities,
                                const std::string &view) {
+    std::lock_guard<std::recursive_mutex> lock(_entityMutex);
     auto ids = this->AddEntity(entities, view);
     _entities.at(view).insert(_entities.at(view).end(), ids.cbegin(), ids.cend());
     return *this;
@@ -515,12 +520,13 @@ Viewer &Viewer::AddEventData(const std::vector<EventArray::Ptr>::const_iterator
                              float ptSize) {
     pcl::PointCloud<ColorPoint>::Ptr cloud(new ColorPointCloud);
     for (auto iter = sIter; iter != eIter; ++iter) {
-        for (const auto &event : (*iter)->GetEvents()) {
-            Eigen::Vector2f p = event->GetPos().cast<float>() * ptScales.first;
-            float t = ((float)event->GetTimestamp() - sTime) * ptScales.second;
+        const auto &ary = *iter;
+        for (std::size_t i = 0; i != ary->GetEventNum(); ++i) {
+            Eigen::Vector2f p = ary->GetEventPos(i).cast<float>() * ptScales.first;
+            float t = ((float)ary->GetEventTimestamp(i) - sTime) * ptScales.second;
             ColorPoint cp;
             cp.x = p(0), cp.y = p(1), cp.z = t;
-            if (event->GetPolarity()) {
+            if (ary->GetEventPolarity(i)) {
                 cp.b = 255;
                 cp.r = cp.g = 0;
             } else {
@@ -545,14 +551,13 @@ Viewer &Viewer::AddEventData(const EventArray::Ptr &ary,
         return *this;
     }
     pcl::PointCloud<ColorPoint>::Ptr cloud(new ColorPointCloud);
-    const auto &events = ary->GetEvents();
-    for (const auto &event : events) {
-        Eigen::Vector2f p = event->GetPos().cast<float>() * ptScales.first;
-        float t = ((float)event->GetTimestamp() - sTime) * ptScales.second;
+    for (std::size_t i = 0; i != ary->GetEventNum(); ++i) {
+        Eigen::Vector2f p = ary->GetEventPos(i).cast<float>() * ptScales.first;
+        float t = ((float)ary->GetEventTimestamp(i) - sTime) * ptScales.second;
         ColorPoint cp;
         cp.x = p(0), cp.y = p(1), cp.z = t;
         if (color == std::nullopt) {
-            if (event->GetPolarity()) {
+            if (ary->GetEventPolarity(i)) {
                 cp.b = 255;
                 cp.r = cp.g = 0;
             } else {
@@ -581,7 +586,8 @@ Viewer &Viewer::AddEventData(const std::list<EventPtr> &ary,
     if (ary.empty()) {
         return *this;
     }
-    auto eAry = EventArray::Create(ary.back()->GetTimestamp(), {ary.cbegin(), ary.cend()});
+    auto eAry = EventArray::Create(ary.back()->GetTimestamp(),
+                                   std::vector<EventPtr>(ary.cbegin(), ary.cend()));
     return AddEventData(eAry, sTime, view, ptScales, color, ptSize);
 }
 }  // namespace ns_ikalibr
\ No newline at end of file
@@ -0,0 +1,227 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "calib/estimator_tpl.hpp"
+#include "ctraj/core/spline_bundle.h"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * the problem built by 'Estimator::AddInParallel' (the speed-up option 'ParallelProblemBuild')
+ * should be identical to the one built serially: the same residual blocks in the same order, the
+ * same parameter blocks with the same states (constant or not, bounds, manifolds), and thus the
+ * same evaluation. Inertial and point-to-surfel factors are added on randomly generated splines
+ */
+class EstimatorParallelBuildTest : public ::testing::Test {
+protected:
+    using SplineBundleType = Estimator::SplineBundleType;
+    using Opt = Estimator::Opt;
+
+    static constexpr double KnotDist = 0.05;
+    static constexpr double STime = 0.0, ETime = 10.0;
+    static constexpr double TOPadding = 0.02;
+    // more than 'ParallelProblemBuildMin' measurements of each kind
+    static constexpr int IMUFrameCount = 1500;
+    static constexpr int PointToSurfelCount = 1500;
+
+    const std::string IMUTopic = "/imu", LiDARTopic = "/lidar";
+    // spatiotemporal parameters and splines are all optimized, to involve bounds of time offsets
+    const Opt Option = Opt::OPT_SO3_SPLINE | Opt::OPT_SCALE_SPLINE | Opt::OPT_SO3_BiToBr |
+                       Opt::OPT_POS_BiInBr | Opt::OPT_TO_BiToBr | Opt::OPT_SO3_LkToBr |
+                       Opt::OPT_POS_LkInBr | Opt::OPT_TO_LkToBr | Opt::OPT_GYRO_BIAS |
+                       Opt::OPT_ACCE_BIAS | Opt::OPT_GRAVITY;
+
+    std::mt19937 _engine{20240101};
+    SplineBundleType::Ptr _splines;
+    CalibParamManager::Ptr _parMagr;
+
+    std::vector<IMUFrame::Ptr> _imuFrames;
+    std::vector<PointToSurfelCorr::Ptr> _pointToSurfel;
+
+    // configure fields changed by this test
+    SpeedUpOption _speedUps{};
+    double _timeOffsetPadding{};
+
+protected:
+    void SetUp() override {
+        _speedUps = Configor::Preference::SpeedUps;
+        _timeOffsetPadding = Configor::Prior::TimeOffsetPadding;
+        Configor::Prior::TimeOffsetPadding = TOPadding;
+
+        auto so3SplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                                  ns_ctraj::SplineType::So3Spline, STime, ETime,
+                                                  KnotDist);
+        auto scaleSplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                                    ns_ctraj::SplineType::RdSpline, STime, ETime,
+                                                    KnotDist);
+        _splines = SplineBundleType::Create({so3SplineInfo, scaleSplineInfo});
+
+        auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = Sophus::SO3d::exp(RandomVec3(M_PI));
+        }
+        auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (int i = 0; i < static_cast<int>(scaleSpline.GetKnots().size()); ++i) {
+            scaleSpline.GetKnot(i) = RandomVec3(5.0);
+        }
+
+        _parMagr = CalibParamManager::Create({IMUTopic}, {}, {LiDARTopic});
+        _parMagr->GRAVITY = Eigen::Vector3d(0.0, 0.0, -9.8);
+        _parMagr->EXTRI.SO3_LkToBr.at(LiDARTopic) = Sophus::SO3d::exp(RandomVec3(M_PI));
+        _parMagr->EXTRI.POS_LkInBr.at(LiDARTopic) = RandomVec3(0.5);
+
+        // keep the (padded) time away from the boundaries of the splines
+        std::uniform_real_distribution<double> timeDist(STime + 2.0 * TOPadding,
+                                                        ETime - 2.0 * TOPadding - KnotDist);
+        for (int i = 0; i < IMUFrameCount; ++i) {
+            _imuFrames.push_back(
+                IMUFrame::Create(timeDist(_engine), RandomVec3(3.0), RandomVec3(20.0)));
+        }
+        for (int i = 0; i < PointToSurfelCount; ++i) {
+            Eigen::Vector4d surfel;
+            surfel << RandomVec3(1.0).normalized(), RandomVec3(10.0)(0);
+            _pointToSurfel.push_back(
+                PointToSurfelCorr::Create(timeDist(_engine), RandomVec3(20.0), 1.0, surfel));
+        }
+    }
+
+    void TearDown() override {
+        Configor::Preference::SpeedUps = _speedUps;
+        Configor::Prior::TimeOffsetPadding = _timeOffsetPadding;
+    }
+
+    Eigen::Vector3d RandomVec3(double range) {
+        std::uniform_real_distribution<double> dist(-range, range);
+        return {dist(_engine), dist(_engine), dist(_engine)};
+    }
+
+    // build the problem, in parallel if 'ParallelProblemBuild' is set
+    Estimator::Ptr Build(SpeedUpOption speedUps) {
+        Configor::Preference::SpeedUps = speedUps;
+        auto estimator = Estimator::Create(_splines, _parMagr);
+        estimator->AddInParallel(IMUFrameCount, [&](int i) {
+            estimator->AddIMUGyroMeasurement(_imuFrames.at(i), IMUTopic, Option, 1.0);
+            estimator->AddIMUAcceMeasurement<TimeDeriv::LIN_POS_SPLINE>(_imuFrames.at(i),
+                                                                        IMUTopic, Option, 1.0);
+        });
+        estimator->AddInParallel(PointToSurfelCount, [&](int i) {
+            estimator->AddLiDARPointToSurfelConstraint<TimeDeriv::LIN_POS_SPLINE>(
+                _pointToSurfel.at(i), LiDARTopic, Option, 1.0);
+        });
+        return estimator;
+    }
+
+    static void ExpectSameParameterBlocks(const Estimator &serial, const Estimator &parallel) {
+        std::vector<double *> serialBlocks, parallelBlocks;
+        serial.GetParameterBlocks(&serialBlocks);
+        parallel.GetParameterBlocks(&parallelBlocks);
+        ASSERT_EQ(serialBlocks, parallelBlocks);
+
+        for (double *block : serialBlocks) {
+            const int size = serial.ParameterBlockSize(block);
+            ASSERT_EQ(size, parallel.ParameterBlockSize(block));
+            EXPECT_EQ(serial.IsParameterBlockConstant(block),
+                      parallel.IsParameterBlockConstant(block));
+            EXPECT_EQ(serial.GetManifold(block), parallel.GetManifold(block));
+            for (int i = 0; i < size; ++i) {
+                EXPECT_EQ(serial.GetParameterLowerBound(block, i),
+                          parallel.GetParameterLowerBound(block, i));
+                EXPECT_EQ(serial.GetParameterUpperBound(block, i),
+                          parallel.GetParameterUpperBound(block, i));
+            }
+        }
+    }
+
+    static void ExpectSameResidualBlocks(const Estimator &serial, const Estimator &parallel) {
+        std::vector<ceres::ResidualBlockId> serialIds, parallelIds;
+        serial.GetResidualBlocks(&serialIds);
+        parallel.GetResidualBlocks(&parallelIds);
+        ASSERT_EQ(serialIds.size(), parallelIds.size());
+
+        for (std::size_t i = 0; i < serialIds.size(); ++i) {
+            std::vector<double *> serialBlocks, parallelBlocks;
+            serial.GetParameterBlocksForResidualBlock(serialIds.at(i), &serialBlocks);
+            parallel.GetParameterBlocksForResidualBlock(parallelIds.at(i), &parallelBlocks);
+            ASSERT_EQ(serialBlocks, parallelBlocks) << "residual block " << i;
+
+            const auto *serialCostFunc = serial.GetCostFunctionForResidualBlock(serialIds.at(i));
+            const auto *parallelCostFunc =
+                parallel.GetCostFunctionForResidualBlock(parallelIds.at(i));
+            EXPECT_EQ(typeid(*serialCostFunc), typeid(*parallelCostFunc)) << "residual block " << i;
+            EXPECT_EQ(serialCostFunc->num_residuals(), parallelCostFunc->num_residuals());
+            EXPECT_EQ(serial.GetLossFunctionForResidualBlock(serialIds.at(i)) == nullptr,
+                      parallel.GetLossFunctionForResidualBlock(parallelIds.at(i)) == nullptr);
+        }
+    }
+
+    static void ExpectSameEvaluation(Estimator &serial, Estimator &parallel) {
+        double serialCost, parallelCost;
+        std::vector<double> serialResiduals, parallelResiduals;
+        std::vector<double> serialGradient, parallelGradient;
+        ceres::CRSMatrix serialJacobian, parallelJacobian;
+        ASSERT_TRUE(serial.Evaluate(ceres::Problem::EvaluateOptions(), &serialCost,
+                                    &serialResiduals, &serialGradient, &serialJacobian));
+        ASSERT_TRUE(parallel.Evaluate(ceres::Problem::EvaluateOptions(), &parallelCost,
+                                      &parallelResiduals, &parallelGradient, &parallelJacobian));
+
+        // the same cost functions are evaluated on the same parameters in the same order
+        EXPECT_EQ(serialCost, parallelCost);
+        EXPECT_EQ(serialResiduals, parallelResiduals);
+        EXPECT_EQ(serialGradient, parallelGradient);
+        EXPECT_EQ(serialJacobian.num_rows, parallelJacobian.num_rows);
+        EXPECT_EQ(serialJacobian.num_cols, parallelJacobian.num_cols);
+        EXPECT_EQ(serialJacobian.rows, parallelJacobian.rows);
+        EXPECT_EQ(serialJacobian.cols, parallelJacobian.cols);
+        EXPECT_EQ(serialJacobian.values, parallelJacobian.values);
+    }
+};
+
+TEST_F(EstimatorParallelBuildTest, ParallelMatchesSerial) {
+    if (Configor::Preference::AvailableThreads() < 2) {
+        GTEST_SKIP() << "the problem is built serially with less than two threads";
+    }
+    auto serial = Build(SpeedUpOption::NONE);
+    auto parallel = Build(SpeedUpOption::ParallelProblemBuild);
+
+    ASSERT_GT(serial->NumResidualBlocks(), 0);
+    ExpectSameParameterBlocks(*serial, *parallel);
+    ExpectSameResidualBlocks(*serial, *parallel);
+    ExpectSameEvaluation(*serial, *parallel);
+}
+}  // namespace ns_ikalibr
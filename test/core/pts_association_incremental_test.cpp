@@ -0,0 +1,199 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "core/pts_association.h"
+#include "factor/data_correspondence.h"
+#include "random"
+#include "set"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * the incremental data association erases and inserts scans from/to a persistent surfel map, and
+ * only re-associates points in the voxels (of depth 'queryDepthMax') touched by these scans. Thus
+ * (1) an incrementally updated map should associate points as a map rebuilt from scratch does,
+ * and (2) associations of points out of touched voxels should remain unchanged after the update
+ */
+class PtsAssociationIncrementalTest : public ::testing::Test {
+protected:
+    static constexpr double Resolution = 0.1;
+    static constexpr std::uint8_t DepthLevels = 16;
+    static constexpr double PointStep = 0.04;
+    static constexpr double Noise = 0.002;
+
+    std::mt19937 _engine{20240101};
+
+    const PointToSurfelCondition _condition = PointToSurfelCondition(0.05, 1, 3, 5, 0.6);
+
+    // static part of the map: a floor and a wall
+    IKalibrPointCloud::Ptr _static;
+    // the scan to be erased, and the one to be inserted, i.e., a moved wall
+    IKalibrPointCloud::Ptr _erased, _inserted;
+
+protected:
+    void SetUp() override {
+        _static = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
+        _erased = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
+        _inserted = IKalibrPointCloud::Ptr(new IKalibrPointCloud);
+
+        AddPlanePoints(_static, Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d::UnitX(),
+                       Eigen::Vector3d::UnitY(), 4.0, 4.0);
+        AddPlanePoints(_static, Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d::UnitY(),
+                       Eigen::Vector3d::UnitZ(), 4.0, 2.0);
+        AddPlanePoints(_erased, Eigen::Vector3d(2.0, 1.5, 0.0), Eigen::Vector3d::UnitX(),
+                       Eigen::Vector3d::UnitZ(), 1.5, 2.0);
+        AddPlanePoints(_inserted, Eigen::Vector3d(2.0, 2.3, 0.0), Eigen::Vector3d::UnitX(),
+                       Eigen::Vector3d::UnitZ(), 1.5, 2.0);
+    }
+
+    void AddPlanePoints(const IKalibrPointCloud::Ptr &cloud,
+                        const Eigen::Vector3d &origin,
+                        const Eigen::Vector3d &u,
+                        const Eigen::Vector3d &v,
+                        double uLen,
+                        double vLen) {
+        std::normal_distribution<double> noise(0.0, Noise);
+        const Eigen::Vector3d n = u.cross(v).normalized();
+        for (double a = 0.0; a < uLen; a += PointStep) {
+            for (double b = 0.0; b < vLen; b += PointStep) {
+                Eigen::Vector3d p = origin + a * u + b * v + noise(_engine) * n;
+                IKalibrPoint point;
+                point.x = static_cast<float>(p(0));
+                point.y = static_cast<float>(p(1));
+                point.z = static_cast<float>(p(2));
+                point.timestamp = 0.0;
+                cloud->push_back(point);
+            }
+        }
+    }
+
+    static IKalibrPointCloud::Ptr Merge(const IKalibrPointCloud::Ptr &a,
+                                        const IKalibrPointCloud::Ptr &b) {
+        IKalibrPointCloud::Ptr cloud(new IKalibrPointCloud);
+        *cloud += *a;
+        *cloud += *b;
+        return cloud;
+    }
+
+    // query points, whose timestamps are their indices, to identify correspondences
+    static IKalibrPointCloud::Ptr QueryCloud(const IKalibrPointCloud::Ptr &cloud) {
+        IKalibrPointCloud::Ptr query(new IKalibrPointCloud(*cloud));
+        for (std::size_t i = 0; i < query->size(); ++i) {
+            query->at(i).timestamp = static_cast<double>(i);
+        }
+        return query;
+    }
+
+    static std::map<std::size_t, PointToSurfelCorr::Ptr> Associate(
+        const PointToSurfelAssociator::Ptr &associator,
+        const IKalibrPointCloud::Ptr &query,
+        const PointToSurfelCondition &condition) {
+        std::map<std::size_t, PointToSurfelCorr::Ptr> corrs;
+        for (const auto &corr : associator->Association(query, query, condition)) {
+            corrs.insert({static_cast<std::size_t>(corr->timestamp), corr});
+        }
+        return corrs;
+    }
+};
+
+TEST_F(PtsAssociationIncrementalTest, IncrementalMatchesFullRebuild) {
+    auto incremental =
+        PointToSurfelAssociator::Create(Merge(_static, _erased), Resolution, DepthLevels);
+    incremental->EraseCloud(_erased);
+    incremental->InsertCloud(_inserted);
+
+    auto full =
+        PointToSurfelAssociator::Create(Merge(_static, _inserted), Resolution, DepthLevels);
+
+    const auto query = QueryCloud(Merge(_static, _inserted));
+    const auto incCorrs = Associate(incremental, query, _condition);
+    const auto fullCorrs = Associate(full, query, _condition);
+
+    ASSERT_FALSE(fullCorrs.empty());
+    ASSERT_EQ(incCorrs.size(), fullCorrs.size());
+    for (const auto &[idx, fullCorr] : fullCorrs) {
+        auto iter = incCorrs.find(idx);
+        ASSERT_TRUE(iter != incCorrs.cend()) << "point " << idx << " isn't associated";
+        const auto &incCorr = iter->second;
+        EXPECT_TRUE(incCorr->node.code() == fullCorr->node.code()) << "point " << idx;
+        EXPECT_NEAR(incCorr->weight, fullCorr->weight, 1E-4) << "point " << idx;
+        EXPECT_TRUE(incCorr->surfelInW.isApprox(fullCorr->surfelInW, 1E-4))
+            << "point " << idx << ", incremental: " << incCorr->surfelInW.transpose()
+            << ", full: " << fullCorr->surfelInW.transpose();
+    }
+}
+
+TEST_F(PtsAssociationIncrementalTest, UntouchedVoxelsKeepCorrespondences) {
+    auto associator =
+        PointToSurfelAssociator::Create(Merge(_static, _erased), Resolution, DepthLevels);
+
+    const auto query = QueryCloud(_static);
+    const auto oldCorrs = Associate(associator, query, _condition);
+
+    // the touched voxels, identified in the same way as the incremental data association
+    std::set<ufo::map::Code> touchedVoxels;
+    for (const auto &cloud : {_erased, _inserted}) {
+        for (const auto &p : cloud->points) {
+            touchedVoxels.insert(associator->VoxelCode(p.x, p.y, p.z, _condition.queryDepthMax));
+        }
+    }
+
+    associator->EraseCloud(_erased);
+    associator->InsertCloud(_inserted);
+    const auto newCorrs = Associate(associator, query, _condition);
+
+    std::size_t untouchedCount = 0;
+    for (std::size_t i = 0; i < query->size(); ++i) {
+        const auto &p = query->at(i);
+        if (touchedVoxels.count(associator->VoxelCode(p.x, p.y, p.z, _condition.queryDepthMax))) {
+            continue;
+        }
+        ++untouchedCount;
+        auto oldIter = oldCorrs.find(i), newIter = newCorrs.find(i);
+        ASSERT_EQ(oldIter == oldCorrs.cend(), newIter == newCorrs.cend()) << "point " << i;
+        if (oldIter == oldCorrs.cend()) {
+            continue;
+        }
+        EXPECT_TRUE(oldIter->second->node.code() == newIter->second->node.code()) << "point " << i;
+        EXPECT_EQ(oldIter->second->surfelInW, newIter->second->surfelInW) << "point " << i;
+    }
+    // both touched and untouched voxels should exist for a meaningful check
+    EXPECT_GT(untouchedCount, 0);
+    EXPECT_LT(untouchedCount, query->size());
+}
+}  // namespace ns_ikalibr
@@ -0,0 +1,288 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "ceres/dynamic_autodiff_cost_function.h"
+#include "ctraj/core/spline_bundle.h"
+#include "factor/imu_gyro_factor.hpp"
+#include "factor/imu_acce_factor.hpp"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * the analytic-jacobian inertial factors should be identical to their auto-diff counterparts, in
+ * both residuals and jacobians (in the ambient spaces of parameter blocks). splines, measurements
+ * and spatiotemporal parameters are all randomly generated
+ */
+class IMUAnalyticFactorTest : public ::testing::Test {
+protected:
+    static constexpr int Order = Configor::Prior::SplineOrder;
+    using SplineBundleType = ns_ctraj::SplineBundle<Order>;
+    using SplineMetaType = ns_ctraj::SplineMeta<Order>;
+
+    static constexpr double KnotDist = 0.05;
+    static constexpr double STime = 0.0, ETime = 2.0;
+    // the time padding considered when time offsets are optimized
+    static constexpr double TOPadding = 0.02;
+    static constexpr int TrialCount = 50;
+
+    std::mt19937 _engine{20240101};
+    SplineBundleType::Ptr _splines;
+
+    // intrinsics and spatiotemporal parameters
+    Eigen::Vector3d _bias, _gravity, _POS_BiInBr;
+    Eigen::Matrix<double, 6, 1> _mapCoeff;
+    Sophus::SO3d _SO3_AtoG, _SO3_BiToBr;
+    double _TO_BiToBr{};
+
+protected:
+    void SetUp() override { Randomize(); }
+
+    // generates new splines and parameters
+    void Randomize() {
+        auto so3SplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SO3_SPLINE,
+                                                  ns_ctraj::SplineType::So3Spline, STime, ETime,
+                                                  KnotDist);
+        auto scaleSplineInfo = ns_ctraj::SplineInfo(Configor::Preference::SCALE_SPLINE,
+                                                    ns_ctraj::SplineType::RdSpline, STime, ETime,
+                                                    KnotDist);
+        _splines = SplineBundleType::Create({so3SplineInfo, scaleSplineInfo});
+
+        auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        for (int i = 0; i < static_cast<int>(so3Spline.GetKnots().size()); ++i) {
+            so3Spline.GetKnot(i) = Sophus::SO3d::exp(RandomVec3(M_PI));
+        }
+        auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (int i = 0; i < static_cast<int>(scaleSpline.GetKnots().size()); ++i) {
+            scaleSpline.GetKnot(i) = RandomVec3(5.0);
+        }
+
+        _bias = RandomVec3(0.1);
+        _gravity = Eigen::Vector3d(0.0, 0.0, -9.8) + RandomVec3(0.5);
+        _POS_BiInBr = RandomVec3(0.5);
+        _mapCoeff << Eigen::Vector3d::Ones() + RandomVec3(0.05), RandomVec3(0.01);
+        _SO3_AtoG = Sophus::SO3d::exp(RandomVec3(0.05));
+        _SO3_BiToBr = Sophus::SO3d::exp(RandomVec3(M_PI));
+        _TO_BiToBr = std::uniform_real_distribution<double>(-TOPadding, TOPadding)(_engine);
+    }
+
+    Eigen::Vector3d RandomVec3(double range) {
+        std::uniform_real_distribution<double> dist(-range, range);
+        return {dist(_engine), dist(_engine), dist(_engine)};
+    }
+
+    IMUFrame::Ptr RandomFrame() {
+        // keep the (padded) time away from the boundaries of the splines
+        std::uniform_real_distribution<double> timeDist(STime + 2.0 * TOPadding,
+                                                        ETime - 2.0 * TOPadding - KnotDist);
+        return IMUFrame::Create(timeDist(_engine), RandomVec3(3.0), RandomVec3(20.0));
+    }
+
+    /**
+     * spline metas of a frame, a time range is involved if the time offset is optimized,
+     * otherwise only the exact time of the frame (by the reference IMU) is considered
+     */
+    std::pair<SplineMetaType, SplineMetaType> ComputeMetas(const IMUFrame::Ptr &frame,
+                                                           bool withTO) const {
+        const double t = frame->GetTimestamp();
+        const auto range = withTO ? std::make_pair(t - TOPadding, t + TOPadding)
+                                  : std::make_pair(t + _TO_BiToBr, t + _TO_BiToBr);
+        SplineMetaType so3Meta, scaleMeta;
+        _splines->CalculateSo3SplineMeta(Configor::Preference::SO3_SPLINE, {range}, so3Meta);
+        _splines->CalculateRdSplineMeta(Configor::Preference::SCALE_SPLINE, {range}, scaleMeta);
+        return {so3Meta, scaleMeta};
+    }
+
+    template <int... BlockSizes>
+    static void SetCostFuncBlocks(ceres::DynamicCostFunction *costFunc,
+                                  int numResiduals,
+                                  const SplineMetaType &so3Meta,
+                                  const SplineMetaType *scaleMeta = nullptr) {
+        for (int i = 0; i < static_cast<int>(so3Meta.NumParameters()); ++i) {
+            costFunc->AddParameterBlock(4);
+        }
+        if (scaleMeta != nullptr) {
+            for (int i = 0; i < static_cast<int>(scaleMeta->NumParameters()); ++i) {
+                costFunc->AddParameterBlock(3);
+            }
+        }
+        (costFunc->AddParameterBlock(BlockSizes), ...);
+        costFunc->SetNumResiduals(numResiduals);
+    }
+
+    void AddKnotBlocks(std::vector<double *> &blocks,
+                       const SplineMetaType &so3Meta,
+                       const SplineMetaType *scaleMeta = nullptr) {
+        auto &so3Spline = _splines->GetSo3Spline(Configor::Preference::SO3_SPLINE);
+        for (const auto &seg : so3Meta.segments) {
+            auto idx = so3Spline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+            for (int i = 0; i < static_cast<int>(seg.NumParameters()); ++i) {
+                blocks.push_back(so3Spline.GetKnot(idx + i).data());
+            }
+        }
+        if (scaleMeta == nullptr) {
+            return;
+        }
+        auto &scaleSpline = _splines->GetRdSpline(Configor::Preference::SCALE_SPLINE);
+        for (const auto &seg : scaleMeta->segments) {
+            auto idx = scaleSpline.ComputeTIndex(seg.t0 + seg.dt * 0.5).second;
+            for (int i = 0; i < static_cast<int>(seg.NumParameters()); ++i) {
+                blocks.push_back(scaleSpline.GetKnot(idx + i).data());
+            }
+        }
+    }
+
+    // evaluates both cost functions and compares residuals and jacobians of all blocks
+    static void ExpectSameEvaluation(const ceres::CostFunction &analytic,
+                                     const ceres::CostFunction &autoDiff,
+                                     const std::vector<double *> &blocks) {
+        ASSERT_EQ(analytic.num_residuals(), autoDiff.num_residuals());
+        ASSERT_EQ(analytic.parameter_block_sizes(), autoDiff.parameter_block_sizes());
+        ASSERT_EQ(analytic.parameter_block_sizes().size(), blocks.size());
+
+        const int numResiduals = analytic.num_residuals();
+        const auto &sizes = analytic.parameter_block_sizes();
+
+        std::vector<std::vector<double>> jAnalytic(sizes.size()), jAutoDiff(sizes.size());
+        std::vector<double *> jAnalyticPtr(sizes.size()), jAutoDiffPtr(sizes.size());
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            jAnalytic.at(i).resize(numResiduals * sizes.at(i));
+            jAutoDiff.at(i).resize(numResiduals * sizes.at(i));
+            jAnalyticPtr.at(i) = jAnalytic.at(i).data();
+            jAutoDiffPtr.at(i) = jAutoDiff.at(i).data();
+        }
+        std::vector<double> rAnalytic(numResiduals), rAutoDiff(numResiduals);
+
+        ASSERT_TRUE(analytic.Evaluate(blocks.data(), rAnalytic.data(), jAnalyticPtr.data()));
+        ASSERT_TRUE(autoDiff.Evaluate(blocks.data(), rAutoDiff.data(), jAutoDiffPtr.data()));
+
+        constexpr double Tolerance = 1E-6;
+        for (int r = 0; r < numResiduals; ++r) {
+            EXPECT_NEAR(rAnalytic.at(r), rAutoDiff.at(r),
+                        Tolerance * std::max(1.0, std::abs(rAutoDiff.at(r))))
+                << "residual " << r;
+        }
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            for (std::size_t k = 0; k < jAutoDiff.at(i).size(); ++k) {
+                EXPECT_NEAR(jAnalytic.at(i).at(k), jAutoDiff.at(i).at(k),
+                            Tolerance * std::max(1.0, std::abs(jAutoDiff.at(i).at(k))))
+                    << "jacobian of block " << i << ", element " << k;
+            }
+        }
+
+        // residuals without jacobians
+        std::vector<double> rOnly(numResiduals);
+        ASSERT_TRUE(analytic.Evaluate(blocks.data(), rOnly.data(), nullptr));
+        for (int r = 0; r < numResiduals; ++r) {
+            EXPECT_DOUBLE_EQ(rOnly.at(r), rAnalytic.at(r));
+        }
+    }
+
+    void CheckGyroFactor(bool withTO) {
+        for (int n = 0; n < TrialCount; ++n) {
+            Randomize();
+            const auto frame = RandomFrame();
+            const auto [so3Meta, scaleMeta] = ComputeMetas(frame, withTO);
+            const double weight = std::uniform_real_distribution<double>(0.1, 10.0)(_engine);
+
+            std::unique_ptr<ceres::DynamicCostFunction> analytic(
+                IMUGyroAnalyticFactor<Order>::Create(so3Meta, frame, weight));
+            std::unique_ptr<ceres::DynamicCostFunction> autoDiff(
+                IMUGyroFactor<Order>::Create(so3Meta, frame, weight));
+            SetCostFuncBlocks<3, 6, 4, 4, 1>(analytic.get(), 3, so3Meta);
+            SetCostFuncBlocks<3, 6, 4, 4, 1>(autoDiff.get(), 3, so3Meta);
+
+            std::vector<double *> blocks;
+            AddKnotBlocks(blocks, so3Meta);
+            blocks.push_back(_bias.data());
+            blocks.push_back(_mapCoeff.data());
+            blocks.push_back(_SO3_AtoG.data());
+            blocks.push_back(_SO3_BiToBr.data());
+            blocks.push_back(&_TO_BiToBr);
+
+            ExpectSameEvaluation(*analytic, *autoDiff, blocks);
+        }
+    }
+
+    template <int TimeDeriv>
+    void CheckAcceFactor(bool withTO) {
+        for (int n = 0; n < TrialCount; ++n) {
+            Randomize();
+            const auto frame = RandomFrame();
+            const auto [so3Meta, scaleMeta] = ComputeMetas(frame, withTO);
+            const double weight = std::uniform_real_distribution<double>(0.1, 10.0)(_engine);
+
+            std::unique_ptr<ceres::DynamicCostFunction> analytic(
+                IMUAcceAnalyticFactor<Order, TimeDeriv>::Create(so3Meta, scaleMeta, frame,
+                                                                 weight));
+            std::unique_ptr<ceres::DynamicCostFunction> autoDiff(
+                IMUAcceFactor<Order, TimeDeriv>::Create(so3Meta, scaleMeta, frame, weight));
+            SetCostFuncBlocks<3, 6, 3, 4, 3, 1>(analytic.get(), 3, so3Meta, &scaleMeta);
+            SetCostFuncBlocks<3, 6, 3, 4, 3, 1>(autoDiff.get(), 3, so3Meta, &scaleMeta);
+
+            std::vector<double *> blocks;
+            AddKnotBlocks(blocks, so3Meta, &scaleMeta);
+            blocks.push_back(_bias.data());
+            blocks.push_back(_mapCoeff.data());
+            blocks.push_back(_gravity.data());
+            blocks.push_back(_SO3_BiToBr.data());
+            blocks.push_back(_POS_BiInBr.data());
+            blocks.push_back(&_TO_BiToBr);
+
+            ExpectSameEvaluation(*analytic, *autoDiff, blocks);
+        }
+    }
+};
+
+TEST_F(IMUAnalyticFactorTest, GyroWithoutTimeOffset) { CheckGyroFactor(false); }
+
+TEST_F(IMUAnalyticFactorTest, GyroWithTimeOffset) { CheckGyroFactor(true); }
+
+TEST_F(IMUAnalyticFactorTest, AcceWithoutTimeOffset) {
+    // the scale spline is the linear acceleration, velocity and position one respectively
+    CheckAcceFactor<0>(false);
+    CheckAcceFactor<1>(false);
+    CheckAcceFactor<2>(false);
+}
+
+TEST_F(IMUAnalyticFactorTest, AcceWithTimeOffset) {
+    CheckAcceFactor<0>(true);
+    CheckAcceFactor<1>(true);
+    CheckAcceFactor<2>(true);
+}
+}  // namespace ns_ikalibr
@@ -0,0 +1,155 @@
+// iKalibr: Unified Targetless Spatiotemporal Calibration Framework
+// Copyright 2024, the School of Geodesy and Geomatics (SGG), Wuhan University, China
+// https://github.com/Unsigned-Long/iKalibr.git
+//
+// Author: Shuolong Chen (shlchen@whu.edu.cn)
+// GitHub: https://github.com/Unsigned-Long
+//  ORCID: 0000-0002-5283-9057
+//
+// Purpose: See .h/.hpp file.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * The names of its contributors can not be
+//   used to endorse or promote products derived from this software without
+//   specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "util/utils.h"
+#include "pclomp/voxel_grid_covariance_omp.hpp"
+#include "pcl/point_types.h"
+#include "random"
+
+namespace {
+bool IKALIBR_UNIQUE_NAME(_2_) = ns_ikalibr::_1_(__FILE__);
+}
+
+namespace ns_ikalibr {
+/**
+ * the ndt target of the lidar odometer is built incrementally key frame by key frame, the leaves
+ * (means and covariances) of which should be identical to the ones of a batch 'filter()' over the
+ * same accumulated map, even if the structure is switched from the batch mode in the middle
+ */
+class VoxelGridCovarianceIncrementalTest : public ::testing::Test {
+protected:
+    using PointType = pcl::PointXYZ;
+    using PointCloud = pcl::PointCloud<PointType>;
+    using VoxelGrid = pclomp::VoxelGridCovariance<PointType>;
+
+    static constexpr float Resolution = 1.0f;
+    static constexpr int FrameCount = 4;
+    static constexpr int PointsPerFrame = 2000;
+
+    std::mt19937 _engine{20240101};
+
+    // key frames, which overlap each other so that leaves are shared by frames
+    std::vector<PointCloud::Ptr> _frames;
+    // the accumulated map
+    PointCloud::Ptr _map;
+
+protected:
+    void SetUp() override {
+        std::uniform_real_distribution<float> xy(-4.0f, 4.0f);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        _map = PointCloud::Ptr(new PointCloud);
+        for (int i = 0; i < FrameCount; ++i) {
+            PointCloud::Ptr frame(new PointCloud);
+            const float shift = static_cast<float>(i);
+            for (int j = 0; j < PointsPerFrame; ++j) {
+                // a slanted ground and a wall, with negative coordinates included
+                const float x = xy(_engine) + shift, y = xy(_engine);
+                if (j % 2 == 0) {
+                    frame->push_back(PointType(x, y, 0.1f * x + noise(_engine)));
+                } else {
+                    frame->push_back(PointType(x, 2.5f + noise(_engine), 0.5f * y + 2.0f));
+                }
+            }
+            _frames.push_back(frame);
+            *_map += *frame;
+        }
+    }
+
+    static void BuildInBatch(VoxelGrid &grid, const PointCloud::Ptr &cloud) {
+        grid.setLeafSize(Resolution, Resolution, Resolution);
+        grid.setInputCloud(cloud);
+        grid.filter(true);
+    }
+
+    // compare leaves of all points in the map
+    void ExpectSameLeaves(VoxelGrid &incremental, VoxelGrid &batch) {
+        std::size_t validCount = 0;
+        for (auto p : _map->points) {
+            auto incLeaf = incremental.getLeaf(p);
+            auto batchLeaf = batch.getLeaf(p);
+            ASSERT_TRUE(incLeaf != nullptr);
+            ASSERT_TRUE(batchLeaf != nullptr);
+            ASSERT_EQ(incLeaf->getPointCount(), batchLeaf->getPointCount());
+            if (batchLeaf->getPointCount() < batch.getMinPointPerVoxel()) {
+                continue;
+            }
+            ++validCount;
+            EXPECT_TRUE(incLeaf->getMean().isApprox(batchLeaf->getMean(), 1E-6))
+                << "incremental: " << incLeaf->getMean().transpose()
+                << ", batch: " << batchLeaf->getMean().transpose();
+            EXPECT_TRUE(incLeaf->getCov().isApprox(batchLeaf->getCov(), 1E-6))
+                << "incremental:\n"
+                << incLeaf->getCov() << "\nbatch:\n"
+                << batchLeaf->getCov();
+        }
+        // leaves with valid distributions should exist for a meaningful check
+        EXPECT_GT(validCount, 0);
+    }
+};
+
+TEST_F(VoxelGridCovarianceIncrementalTest, IncrementalMatchesBatch) {
+    VoxelGrid incremental;
+    incremental.setLeafSize(Resolution, Resolution, Resolution);
+    for (const auto &frame : _frames) {
+        incremental.insertCloud(*frame);
+    }
+    ASSERT_TRUE(incremental.isIncremental());
+
+    VoxelGrid batch;
+    BuildInBatch(batch, _map);
+    ASSERT_FALSE(batch.isIncremental());
+
+    ExpectSameLeaves(incremental, batch);
+}
+
+TEST_F(VoxelGridCovarianceIncrementalTest, SwitchFromBatchKeepsInput) {
+    // the first frames are built in batch mode, then the remaining ones are inserted
+    PointCloud::Ptr head(new PointCloud);
+    for (int i = 0; i < FrameCount / 2; ++i) {
+        *head += *_frames.at(i);
+    }
+    VoxelGrid incremental;
+    BuildInBatch(incremental, head);
+    for (int i = FrameCount / 2; i < FrameCount; ++i) {
+        incremental.insertCloud(*_frames.at(i));
+    }
+    ASSERT_TRUE(incremental.isIncremental());
+
+    VoxelGrid batch;
+    BuildInBatch(batch, _map);
+
+    ExpectSameLeaves(incremental, batch);
+}
+}  // namespace ns_ikalibr